@@ -69,6 +69,22 @@ opt_set_Types(struct preparser_args *args, const char *arg)
     return true;
 }
 
+static bool
+opt_set_MaxMemory(struct preparser_args *args, const char *arg)
+{
+    assert(args != NULL);
+    assert(arg != NULL);
+
+    char *endptr = NULL;
+    unsigned long long max_memory = strtoull(arg, &endptr, 0);
+    if ((endptr != NULL && *endptr != '\0') || max_memory > SIZE_MAX >> 20) {
+        fprintf(stderr, "Error: Invalid memory limit `%s'\n", arg);
+        return false;
+    }
+    args->max_memory = max_memory << 20;
+    return true;
+}
+
 static bool
 opt_set_Type(struct preparser_args *args, const char *arg)
 {
@@ -131,6 +147,8 @@ opt_set_SeekSpeed(struct preparser_args *args, const char *arg)
         args->seek.speed = VLC_THUMBNAILER_SEEK_PRECISE;
     } else if (!strcmp(arg, "fast")) {
         args->seek.speed = VLC_THUMBNAILER_SEEK_FAST;
+    } else if (!strcmp(arg, "keyframe")) {
+        args->seek.speed = VLC_THUMBNAILER_SEEK_KEYFRAME;
     } else {
         fprintf(stderr, "Error: Unknown seek speed `%s'\n", arg);
         return false;
@@ -306,8 +324,9 @@ static const struct preparser_opt options[] = {
     opt_add_string("type", opt_set_Type, "Preparser type (parse/thumbnail/thumbnail_to_files)"),
     opt_add_string("fetch", opt_set_Fetch, "Preparser fetching (local/net/all)"),
     opt_add_bool("daemon", opt_set_Daemon, "Start the preparser as a daemon reading request from the stdin"),
+    opt_add_integer("max-memory", opt_set_MaxMemory, "Exit the daemon once its memory exceeds this limit (MiB)"),
     opt_add_bool(NULL, NULL, "thumbnail and thumbnail_to_files"),
-    opt_add_string("seek-speed", opt_set_SeekSpeed, "Set the seek speed (precise/fast)"),
+    opt_add_string("seek-speed", opt_set_SeekSpeed, "Set the seek speed (precise/fast/keyframe)"),
     opt_add_integer("seek-time", opt_set_SeekTime, "Set from where to seek (ms)"),
     opt_add_integer("seek-pos", opt_set_SeekPos, "Set the seek position"),
     opt_add_bool(NULL, NULL, "thumbnail_to_files"),
@@ -17,6 +17,7 @@ struct preparser_args {
     vlc_tick_t timeout;
     int types;
     bool daemon;
+    size_t max_memory; /* in bytes, 0 for no limit */
     struct {
         int type;
         float pos;
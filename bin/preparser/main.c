@@ -12,6 +12,9 @@
 #endif
 
 #include <assert.h>
+#ifdef HAVE_GETRUSAGE
+# include <sys/resource.h>
+#endif
 
 #include <vlc/vlc.h>
 #include <vlc_common.h>
@@ -414,8 +417,36 @@ preparser_args_Loop(vlc_object_t *obj, vlc_preparser_t *preparser,
  * Daemon
  *****************************************************************************/
 
+/**
+ * Check if the peak memory used by the process exceeds `max_memory` bytes.
+ */
+static bool
+preparser_daemon_MemoryExceeded(size_t max_memory)
+{
+#ifdef HAVE_GETRUSAGE
+    if (max_memory == 0) {
+        return false;
+    }
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return false;
+    }
+# ifdef __APPLE__
+    size_t max_rss = usage.ru_maxrss; /* in bytes */
+# else
+    size_t max_rss = (size_t)usage.ru_maxrss * 1024; /* in KiB */
+# endif
+    return max_rss > max_memory;
+#else
+    (void) max_memory;
+    return false;
+#endif
+}
+
 static int
-preparser_daemon_Loop(vlc_object_t *obj, vlc_preparser_t *preparser)
+preparser_daemon_Loop(vlc_object_t *obj, vlc_preparser_t *preparser,
+                      size_t max_memory)
 {
     assert(preparser != NULL);
 
@@ -464,6 +495,13 @@ preparser_daemon_Loop(vlc_object_t *obj, vlc_preparser_t *preparser)
             status = VLC_EGENERIC;
         }
         vlc_preparser_msg_Clean(&pp.req_msg);
+
+        /* Exit cleanly, the parent will start a new process for the next
+         * requests. */
+        if (status == VLC_SUCCESS
+         && preparser_daemon_MemoryExceeded(max_memory)) {
+            break;
+        }
     }
 
     if (pp.tls_in != NULL) {
@@ -504,6 +542,7 @@ int main(int argc, char **argv)
         .timeout = VLC_TICK_INVALID,
         .types = 0,
         .daemon = false,
+        .max_memory = 0,
         .seek.type = VLC_THUMBNAILER_SEEK_NONE,
         .seek.speed = VLC_THUMBNAILER_SEEK_FAST,
         .output.file_path = NULL,
@@ -545,7 +584,7 @@ int main(int argc, char **argv)
     }
 
     if (args.daemon) {
-        ret = preparser_daemon_Loop(obj, preparser);
+        ret = preparser_daemon_Loop(obj, preparser, args.max_memory);
     } else {
         ret = preparser_args_Loop(obj, preparser, argv + args.arg_idx,
                                   argc - args.arg_idx, &args);
@@ -121,6 +121,10 @@ struct decoder_t
      */
     int                 i_extra_picture_buffers;
 
+    /* Set by a packetizer that outputs already packetized frames as they
+     * are: the owner may then send such frames without calling it */
+    bool                b_passthrough;
+
     union
     {
 #       define VLCDEC_SUCCESS   VLC_SUCCESS
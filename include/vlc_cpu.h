@@ -142,6 +142,7 @@ unsigned vlc_CPU_raw(void);
 #  define VLC_CPU_SSE4_1 0x00000400
 #  define VLC_CPU_AVX    0x00002000
 #  define VLC_CPU_AVX2   0x00004000
+#  define VLC_CPU_AVX512 0x00008000 /* AVX-512 F and BW */
 
 #  if defined (__SSE__)
 #   define VLC_SSE
@@ -187,6 +188,12 @@ unsigned vlc_CPU_raw(void);
 #   define vlc_CPU_AVX2() ((vlc_CPU() & VLC_CPU_AVX2) != 0)
 #  endif
 
+#  if defined (__AVX512F__) && defined (__AVX512BW__)
+#   define vlc_CPU_AVX512() (1)
+#  else
+#   define vlc_CPU_AVX512() ((vlc_CPU() & VLC_CPU_AVX512) != 0)
+#  endif
+
 # else
 /**
  * Are single precision floating point operations "fast"?
@@ -545,6 +545,8 @@ struct input_stats_t
     uint64_t i_read_packets;
     uint64_t i_read_bytes;
     float f_input_bitrate;
+    uint64_t i_buffered_bytes;      /**< read ahead, not yet demuxed */
+    uint64_t i_buffer_underruns;
 
     /* Demux */
     uint64_t i_demux_read_packets;
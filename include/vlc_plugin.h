@@ -51,6 +51,7 @@ enum vlc_module_properties
     VLC_MODULE_HELP,
     VLC_MODULE_TEXTDOMAIN,
     VLC_MODULE_HELP_HTML,
+    VLC_MODULE_SIGNATURE,
     /* Insert new VLC_MODULE_* here */
 
     /* DO NOT EVER REMOVE, INSERT OR REPLACE ANY ITEM! It would break the ABI!
@@ -375,6 +376,19 @@ VLC_METADATA_EXPORTS
      || vlc_module_set (VLC_MODULE_SCORE, VLC_CHECKED_TYPE(int, score))) \
         goto error;
 
+/**
+ * Declares a stream signature of the module.
+ *
+ * The module is only probed automatically if one of its signatures matches
+ * the beginning of the stream. Modules requested by name are always probed.
+ * The magic must be a string literal; it may contain nul bytes.
+ */
+#define add_signature( offset, magic ) \
+    if (vlc_module_set (VLC_MODULE_SIGNATURE, VLC_CHECKED_TYPE(unsigned, offset), \
+                        VLC_CHECKED_TYPE(const char *, magic), \
+                        (size_t)(sizeof (magic) - 1))) \
+        goto error;
+
 #define set_callback(activate) \
     if (vlc_module_set(VLC_MODULE_CB_OPEN, #activate, (void *)(activate))) \
         goto error;
@@ -215,6 +215,11 @@ struct vlc_thumbnailer_arg
             VLC_THUMBNAILER_SEEK_PRECISE,
             /** Fast, but potentially imprecise */
             VLC_THUMBNAILER_SEEK_FAST,
+            /**
+             * Fastest: seek like VLC_THUMBNAILER_SEEK_FAST, then decode the
+             * first keyframe only, skipping the frames flagged as P or B
+             */
+            VLC_THUMBNAILER_SEEK_KEYFRAME,
         } speed;
     } seek;
 
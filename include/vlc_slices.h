@@ -0,0 +1,100 @@
+/*****************************************************************************
+ * vlc_slices.h: slice-parallel picture processing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_SLICES_H
+#define VLC_SLICES_H
+
+# ifdef __cplusplus
+extern "C" {
+# endif
+
+/**
+ * \defgroup slices Slice-parallel processing
+ * \ingroup cext
+ *
+ * Splits the processing of a picture into slices, run in parallel on a
+ * worker pool shared by the whole process.
+ *
+ * @{
+ */
+
+/** Maximum number of slices a picture is split into */
+#define VLC_SLICES_MAX 16
+
+/** Slices type (opaque) */
+typedef struct vlc_slices vlc_slices_t;
+
+/**
+ * Processes the slice number index out of count.
+ *
+ * How a picture is split into slices is up to the caller.
+ */
+typedef void (*vlc_slice_cb)(void *opaque, unsigned index, unsigned count);
+
+/**
+ * Creates a slice-parallel runner.
+ *
+ * The number of slices comes from the "slice-threads" option.
+ *
+ * \param obj the object processing the pictures
+ * \return the slices, or NULL if the processing should not be split
+ */
+VLC_API vlc_slices_t *
+vlc_slices_New(vlc_object_t *obj);
+
+/**
+ * Deletes a slice-parallel runner.
+ *
+ * \param slices the slices, or NULL
+ */
+VLC_API void
+vlc_slices_Delete(vlc_slices_t *slices);
+
+/**
+ * Returns the maximum number of slices, 1 if slices is NULL.
+ */
+VLC_API unsigned
+vlc_slices_Count(const vlc_slices_t *slices);
+
+/**
+ * Runs the callback for each slice, in parallel, and waits for completion.
+ *
+ * The calling thread processes the first slice. If count is 1, the callback
+ * runs from the calling thread only.
+ *
+ * A runner processes one picture at a time: it must not be used from several
+ * threads at once.
+ *
+ * \param slices the slices, or NULL
+ * \param count number of slices, at most vlc_slices_Count()
+ * \param cb the callback processing a slice
+ * \param opaque data passed to the callback
+ */
+VLC_API void
+vlc_slices_Run(vlc_slices_t *slices, unsigned count,
+               vlc_slice_cb cb, void *opaque);
+
+/** @} */
+
+# ifdef __cplusplus
+}
+# endif
+
+#endif
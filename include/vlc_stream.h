@@ -69,6 +69,7 @@ struct vlc_stream_operations {
             int (*get_seekpoint)(stream_t *, unsigned *);
             int (*get_size)(stream_t *, uint64_t *);
             int (*get_mtime)(stream_t *, uint64_t *);
+            int (*get_buffering)(stream_t *, uint64_t *, uint64_t *);
             int (*get_title_info)(stream_t *, input_title_t ***, int *);
             int (*get_content_type)(stream_t *, char **);
             int (*get_tags)(stream_t *, const block_t **);
@@ -270,6 +271,8 @@ enum stream_query_e
     STREAM_GET_SIGNAL,                      /**< arg1=(double *pf_quality), arg2=(double *pf_strength) res=can fail */
     STREAM_GET_TAGS,                        /**< arg1=(const block_t **) res=can fail */
     STREAM_GET_TYPE,                        /**< arg1=(int*) res=can fail */
+    STREAM_GET_BUFFERING,                   /**< arg1=(uint64_t *) buffered bytes,
+                                                 arg2=(uint64_t *) underruns res=can fail */
 
     STREAM_SET_PAUSE_STATE = 0x200,         /**< arg1=(bool) res=can fail */
     STREAM_SET_TITLE,                       /**< arg1=(int) res=can fail */
@@ -513,6 +516,22 @@ VLC_USED static inline int vlc_stream_GetMTime(stream_t *s, uint64_t *mtime)
     return vlc_stream_Control(s, STREAM_GET_MTIME, mtime);
 }
 
+/**
+ * Get the read-ahead buffering state.
+ *
+ * \param buffered pointer to the number of bytes read ahead but not yet
+ *                 consumed [OUT]
+ * \param underruns pointer to the number of times the consumer had to wait
+ *                  for data [OUT]
+ * \return VLC_SUCCESS, or an error if the stream is not buffered
+ */
+VLC_USED static inline int vlc_stream_GetBuffering(stream_t *s,
+                                                   uint64_t *buffered,
+                                                   uint64_t *underruns)
+{
+    return vlc_stream_Control(s, STREAM_GET_BUFFERING, buffered, underruns);
+}
+
 VLC_USED static inline int vlc_stream_GetTitleInfo(stream_t *s, input_title_t ***title_info, int *size)
 {
     return vlc_stream_Control(s, STREAM_GET_TITLE_INFO, title_info, size);
@@ -234,6 +234,54 @@ static inline char *str_format( vlc_player_t *player, input_item_t *item,
     return s2;
 }
 
+/**
+ * Compares the numbers at the first difference between two file names.
+ *
+ * This is the numerical part of vlc_filenamecmp(), for the callers which
+ * collate the file names by other means (e.g. with strxfrm() keys).
+ *
+ * \return the order of the numbers, or 0 if the file names are identical or
+ * must be compared by collation
+ */
+static inline int vlc_filenamecmp_numbers(const char *a, const char *b)
+{
+    size_t i;
+    char ca, cb;
+
+    /* Attempt to guess if the sorting algorithm should be alphabetic
+     * (i.e. collation) or numeric:
+     * - If the first mismatching characters are not both digits,
+     *   then collation is the only option.
+     * - If one of the first mismatching characters is 0 and the other is also
+     *   a digit, the comparands are probably left-padded numerical values.
+     *   It does not matter which algorithm is used: the zero will be smaller
+     *   than non-zero either way.
+     * - Otherwise, the comparands are numerical values, and might not be
+     *   aligned (i.e. not same order of magnitude). If so, collation would
+     *   fail. So numerical comparison is performed. */
+    for (i = 0; (ca = a[i]) == (cb = b[i]); i++)
+        if (ca == '\0')
+            return 0; /* strings are exactly identical */
+
+    if ((unsigned)(ca - '0') > 9 || (unsigned)(cb - '0') > 9)
+        return 0;
+
+    unsigned long long ua = strtoull(a + i, NULL, 10);
+    unsigned long long ub = strtoull(b + i, NULL, 10);
+
+    /* The number may be identical in two cases:
+     * - leading zero (e.g. "012" and "12")
+     * - overflow on both sides (#ULLONG_MAX) */
+    if (ua == ub)
+        return 0;
+
+    return (ua > ub) ? +1 : -1;
+}
+
+/**
+ * Compares two file names, the numbers in the file names by their values and
+ * the rest by collation.
+ */
 VLC_API int vlc_filenamecmp(const char *, const char *);
 
 void filename_sanitize(char *);
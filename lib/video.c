@@ -513,6 +513,7 @@ int libvlc_video_set_deinterlace( libvlc_media_player_t *p_mi, int deinterlace,
      && strcmp (psz_mode, "discard")  && strcmp (psz_mode, "linear")
      && strcmp (psz_mode, "mean")     && strcmp (psz_mode, "x")
      && strcmp (psz_mode, "yadif")    && strcmp (psz_mode, "yadif2x")
+     && strcmp (psz_mode, "bwdif")    && strcmp (psz_mode, "bwdif2x")
      && strcmp (psz_mode, "phosphor") && strcmp (psz_mode, "ivtc")
      && strcmp (psz_mode, "auto"))
         return -1;
@@ -38,6 +38,10 @@
 #include <vlc_aout.h>
 #include <vlc_block.h>
 #include <vlc_filter.h>
+#ifdef PLUGIN_X86
+# include <vlc_cpu.h>
+# include <immintrin.h>
+#endif
 
 /*****************************************************************************
  * Module descriptor
@@ -45,9 +49,15 @@
 static int  Open(vlc_object_t *);
 
 vlc_module_begin()
+#ifdef PLUGIN_X86
+    set_description(N_("x86 SIMD audio filter for PCM format conversion"))
+    set_subcategory(SUBCAT_AUDIO_AFILTER)
+    set_capability("audio converter", 2)
+#else
     set_description(N_("Audio filter for PCM format conversion"))
     set_subcategory(SUBCAT_AUDIO_AFILTER)
     set_capability("audio converter", 1)
+#endif
     set_callback(Open)
 vlc_module_end()
 
@@ -82,7 +92,7 @@ static int Open(vlc_object_t *object)
     return VLC_SUCCESS;
 }
 
-
+#ifndef PLUGIN_X86
 /*** from U8 ***/
 static block_t *U8toS16(filter_t *filter, block_t *bsrc)
 {
@@ -485,3 +495,339 @@ static const struct vlc_filter_operations *FindConversion(vlc_fourcc_t src, vlc_
     }
     return NULL;
 }
+
+#else /* PLUGIN_X86 */
+
+/*
+ * Only the conversions on the usual decoder to mixer path are vectorized
+ * here. Output is identical to the plain C module, which still handles all
+ * the other conversions.
+ */
+
+/*** S16N to FL32 ***/
+__attribute__((__target__("sse2")))
+static block_t *S16toFl32_SSE2(filter_t *filter, block_t *bsrc)
+{
+    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    if (unlikely(bdst == NULL))
+        goto out;
+
+    block_CopyProperties(bdst, bsrc);
+    const int16_t *src = (const int16_t *)bsrc->p_buffer;
+    float *dst = (float *)bdst->p_buffer;
+    size_t count = bsrc->i_buffer / 2;
+    const __m128 scale = _mm_set1_ps(0x1.p-15f);
+
+    for (; count >= 8; count -= 8, src += 8, dst += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)src);
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    while (count--)
+        *dst++ = *src++ * 0x1.p-15f;
+out:
+    block_Release(bsrc);
+    VLC_UNUSED(filter);
+    return bdst;
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__((__target__("avx2")))
+static block_t *S16toFl32_AVX2(filter_t *filter, block_t *bsrc)
+{
+    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    if (unlikely(bdst == NULL))
+        goto out;
+
+    block_CopyProperties(bdst, bsrc);
+    const int16_t *src = (const int16_t *)bsrc->p_buffer;
+    float *dst = (float *)bdst->p_buffer;
+    size_t count = bsrc->i_buffer / 2;
+    const __m256 scale = _mm256_set1_ps(0x1.p-15f);
+
+    for (; count >= 16; count -= 16, src += 16, dst += 16)
+    {
+        __m256i lo = _mm256_cvtepi16_epi32(
+                        _mm_loadu_si128((const __m128i *)src));
+        __m256i hi = _mm256_cvtepi16_epi32(
+                        _mm_loadu_si128((const __m128i *)(src + 8)));
+        _mm256_storeu_ps(dst, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(dst + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    while (count--)
+        *dst++ = *src++ * 0x1.p-15f;
+out:
+    block_Release(bsrc);
+    VLC_UNUSED(filter);
+    return bdst;
+}
+#endif
+
+/*** FL32 to S16N ***/
+/* Walken's trick, as in the plain C module, 4 or 8 samples at a time */
+static inline int16_t Fl32toS16Sample(float f)
+{
+    union { float f; int32_t i; } u;
+    u.f = f + 384.f;
+    if (u.i > 0x43c07fff)
+        return 32767;
+    if (u.i < 0x43bf8000)
+        return -32768;
+    return u.i - 0x43c00000;
+}
+
+__attribute__((__target__("sse2")))
+static inline __m128i Fl32toS16Bits_SSE2(__m128 f)
+{
+    const __m128i max = _mm_set1_epi32(0x43c07fff);
+    const __m128i min = _mm_set1_epi32(0x43bf8000);
+    __m128i v = _mm_castps_si128(_mm_add_ps(f, _mm_set1_ps(384.f)));
+    __m128i m;
+
+    /* no pminsd/pmaxsd before SSE4.1 */
+    m = _mm_cmpgt_epi32(v, max);
+    v = _mm_or_si128(_mm_and_si128(m, max), _mm_andnot_si128(m, v));
+    m = _mm_cmplt_epi32(v, min);
+    v = _mm_or_si128(_mm_and_si128(m, min), _mm_andnot_si128(m, v));
+    return _mm_sub_epi32(v, _mm_set1_epi32(0x43c00000));
+}
+
+__attribute__((__target__("sse2")))
+static block_t *Fl32toS16_SSE2(filter_t *filter, block_t *b)
+{
+    VLC_UNUSED(filter);
+    const float *src = (const float *)b->p_buffer;
+    int16_t *dst = (int16_t *)b->p_buffer;
+    size_t count = b->i_buffer / 4;
+
+    /* In place: each vector is loaded before its narrower result is stored */
+    for (; count >= 8; count -= 8, src += 8, dst += 8)
+    {
+        __m128i lo = Fl32toS16Bits_SSE2(_mm_loadu_ps(src));
+        __m128i hi = Fl32toS16Bits_SSE2(_mm_loadu_ps(src + 4));
+        _mm_storeu_si128((__m128i *)dst, _mm_packs_epi32(lo, hi));
+    }
+    while (count--)
+        *dst++ = Fl32toS16Sample(*src++);
+
+    b->i_buffer /= 2;
+    return b;
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__((__target__("avx2")))
+static inline __m256i Fl32toS16Bits_AVX2(__m256 f)
+{
+    __m256i v = _mm256_castps_si256(_mm256_add_ps(f, _mm256_set1_ps(384.f)));
+
+    v = _mm256_min_epi32(v, _mm256_set1_epi32(0x43c07fff));
+    v = _mm256_max_epi32(v, _mm256_set1_epi32(0x43bf8000));
+    return _mm256_sub_epi32(v, _mm256_set1_epi32(0x43c00000));
+}
+
+__attribute__((__target__("avx2")))
+static block_t *Fl32toS16_AVX2(filter_t *filter, block_t *b)
+{
+    VLC_UNUSED(filter);
+    const float *src = (const float *)b->p_buffer;
+    int16_t *dst = (int16_t *)b->p_buffer;
+    size_t count = b->i_buffer / 4;
+
+    for (; count >= 16; count -= 16, src += 16, dst += 16)
+    {
+        __m256i lo = Fl32toS16Bits_AVX2(_mm256_loadu_ps(src));
+        __m256i hi = Fl32toS16Bits_AVX2(_mm256_loadu_ps(src + 8));
+        /* packssdw works within 128-bits lanes: restore the sample order */
+        __m256i v = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+        _mm256_storeu_si256((__m256i *)dst, v);
+    }
+    while (count--)
+        *dst++ = Fl32toS16Sample(*src++);
+
+    b->i_buffer /= 2;
+    return b;
+}
+#endif
+
+/*** S32N to FL32 ***/
+__attribute__((__target__("sse2")))
+static block_t *S32toFl32_SSE2(filter_t *filter, block_t *b)
+{
+    VLC_UNUSED(filter);
+    const int32_t *src = (const int32_t *)b->p_buffer;
+    float *dst = (float *)b->p_buffer;
+    size_t count = b->i_buffer / 4;
+    const __m128 scale = _mm_set1_ps(0x1.p-31f);
+
+    for (; count >= 8; count -= 8, src += 8, dst += 8)
+    {
+        __m128i lo = _mm_loadu_si128((const __m128i *)src);
+        __m128i hi = _mm_loadu_si128((const __m128i *)(src + 4));
+        _mm_storeu_ps(dst, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    while (count--)
+        *dst++ = (float)(*src++) * 0x1.p-31f;
+    return b;
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__((__target__("avx2")))
+static block_t *S32toFl32_AVX2(filter_t *filter, block_t *b)
+{
+    VLC_UNUSED(filter);
+    const int32_t *src = (const int32_t *)b->p_buffer;
+    float *dst = (float *)b->p_buffer;
+    size_t count = b->i_buffer / 4;
+    const __m256 scale = _mm256_set1_ps(0x1.p-31f);
+
+    for (; count >= 16; count -= 16, src += 16, dst += 16)
+    {
+        __m256i lo = _mm256_loadu_si256((const __m256i *)src);
+        __m256i hi = _mm256_loadu_si256((const __m256i *)(src + 8));
+        _mm256_storeu_ps(dst, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(dst + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    while (count--)
+        *dst++ = (float)(*src++) * 0x1.p-31f;
+    return b;
+}
+#endif
+
+/*** FL32 to S32N ***/
+static inline int32_t Fl32toS32Sample(float f)
+{
+    float s = f * -((float)INT32_MIN);
+    if (s >= ((float)INT32_MAX))
+        return INT32_MAX;
+    if (s <= ((float)INT32_MIN))
+        return INT32_MIN;
+    return lroundf(s);
+}
+
+__attribute__((__target__("sse2")))
+static inline __m128i Fl32toS32Vector_SSE2(__m128 f)
+{
+    const __m128i max = _mm_set1_epi32(INT32_MAX);
+    const __m128i min = _mm_set1_epi32(INT32_MIN);
+    __m128 s = _mm_mul_ps(f, _mm_set1_ps(0x1.p31f));
+    __m128i v = _mm_cvttps_epi32(s);
+    __m128 frac = _mm_sub_ps(s, _mm_cvtepi32_ps(v));
+    __m128i m;
+
+    /* lroundf() rounds halfway cases away from zero */
+    v = _mm_sub_epi32(v, _mm_castps_si128(_mm_cmpge_ps(frac, _mm_set1_ps(.5f))));
+    v = _mm_add_epi32(v, _mm_castps_si128(_mm_cmple_ps(frac, _mm_set1_ps(-.5f))));
+
+    m = _mm_castps_si128(_mm_cmpge_ps(s, _mm_set1_ps(0x1.p31f)));
+    v = _mm_or_si128(_mm_and_si128(m, max), _mm_andnot_si128(m, v));
+    m = _mm_castps_si128(_mm_cmple_ps(s, _mm_set1_ps(-0x1.p31f)));
+    v = _mm_or_si128(_mm_and_si128(m, min), _mm_andnot_si128(m, v));
+    return v;
+}
+
+__attribute__((__target__("sse2")))
+static block_t *Fl32toS32_SSE2(filter_t *filter, block_t *b)
+{
+    VLC_UNUSED(filter);
+    const float *src = (const float *)b->p_buffer;
+    int32_t *dst = (int32_t *)b->p_buffer;
+    size_t count = b->i_buffer / 4;
+
+    for (; count >= 8; count -= 8, src += 8, dst += 8)
+    {
+        __m128i lo = Fl32toS32Vector_SSE2(_mm_loadu_ps(src));
+        __m128i hi = Fl32toS32Vector_SSE2(_mm_loadu_ps(src + 4));
+        _mm_storeu_si128((__m128i *)dst, lo);
+        _mm_storeu_si128((__m128i *)(dst + 4), hi);
+    }
+    while (count--)
+        *dst++ = Fl32toS32Sample(*src++);
+    return b;
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__((__target__("avx2")))
+static inline __m256i Fl32toS32Vector_AVX2(__m256 f)
+{
+    __m256 s = _mm256_mul_ps(f, _mm256_set1_ps(0x1.p31f));
+    __m256i v = _mm256_cvttps_epi32(s);
+    __m256 frac = _mm256_sub_ps(s, _mm256_cvtepi32_ps(v));
+
+    v = _mm256_sub_epi32(v, _mm256_castps_si256(
+            _mm256_cmp_ps(frac, _mm256_set1_ps(.5f), _CMP_GE_OQ)));
+    v = _mm256_add_epi32(v, _mm256_castps_si256(
+            _mm256_cmp_ps(frac, _mm256_set1_ps(-.5f), _CMP_LE_OQ)));
+
+    v = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(v),
+            _mm256_castsi256_ps(_mm256_set1_epi32(INT32_MAX)),
+            _mm256_cmp_ps(s, _mm256_set1_ps(0x1.p31f), _CMP_GE_OQ)));
+    v = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(v),
+            _mm256_castsi256_ps(_mm256_set1_epi32(INT32_MIN)),
+            _mm256_cmp_ps(s, _mm256_set1_ps(-0x1.p31f), _CMP_LE_OQ)));
+    return v;
+}
+
+__attribute__((__target__("avx2")))
+static block_t *Fl32toS32_AVX2(filter_t *filter, block_t *b)
+{
+    VLC_UNUSED(filter);
+    const float *src = (const float *)b->p_buffer;
+    int32_t *dst = (int32_t *)b->p_buffer;
+    size_t count = b->i_buffer / 4;
+
+    for (; count >= 16; count -= 16, src += 16, dst += 16)
+    {
+        __m256i lo = Fl32toS32Vector_AVX2(_mm256_loadu_ps(src));
+        __m256i hi = Fl32toS32Vector_AVX2(_mm256_loadu_ps(src + 8));
+        _mm256_storeu_si256((__m256i *)dst, lo);
+        _mm256_storeu_si256((__m256i *)(dst + 8), hi);
+    }
+    while (count--)
+        *dst++ = Fl32toS32Sample(*src++);
+    return b;
+}
+#endif
+
+/* */
+static const struct {
+    vlc_fourcc_t src;
+    vlc_fourcc_t dst;
+    struct vlc_filter_operations sse2;
+    struct vlc_filter_operations avx2;
+} cvt_x86[] = {
+#ifdef HAVE_AVX2_INTRINSICS
+# define AVX2(f) { .filter_audio = f }
+#else
+# define AVX2(f) { .filter_audio = NULL }
+#endif
+    { VLC_CODEC_S16N, VLC_CODEC_FL32,
+      { .filter_audio = S16toFl32_SSE2 }, AVX2(S16toFl32_AVX2) },
+    { VLC_CODEC_FL32, VLC_CODEC_S16N,
+      { .filter_audio = Fl32toS16_SSE2 }, AVX2(Fl32toS16_AVX2) },
+    { VLC_CODEC_S32N, VLC_CODEC_FL32,
+      { .filter_audio = S32toFl32_SSE2 }, AVX2(S32toFl32_AVX2) },
+    { VLC_CODEC_FL32, VLC_CODEC_S32N,
+      { .filter_audio = Fl32toS32_SSE2 }, AVX2(Fl32toS32_AVX2) },
+#undef AVX2
+};
+
+static const struct vlc_filter_operations *FindConversion(vlc_fourcc_t src, vlc_fourcc_t dst)
+{
+    if (!vlc_CPU_SSE2())
+        return NULL;
+
+    for (size_t i = 0; i < ARRAY_SIZE(cvt_x86); i++) {
+        if (cvt_x86[i].src == src &&
+            cvt_x86[i].dst == dst) {
+            if (vlc_CPU_AVX2() && cvt_x86[i].avx2.filter_audio != NULL)
+                return &cvt_x86[i].avx2;
+            return &cvt_x86[i].sse2;
+        }
+    }
+    return NULL;
+}
+#endif /* PLUGIN_X86 */
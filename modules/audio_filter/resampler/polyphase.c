@@ -0,0 +1,589 @@
+/*****************************************************************************
+ * polyphase.c : windowed-sinc polyphase resampler
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_cpu.h>
+#include <vlc_filter.h>
+#include <vlc_plugin.h>
+
+#ifdef HAVE_SSE2_INTRINSICS
+# include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+# include <arm_neon.h>
+#endif
+
+#define LOWLATENCY_TEXT N_("Low latency")
+#define LOWLATENCY_LONGTEXT N_( \
+    "Use a shorter filter: less delay and CPU usage, at the cost of a " \
+    "wider transition band and a weaker stop-band attenuation.")
+
+static int OpenConverter( vlc_object_t * );
+static int OpenResampler( vlc_object_t * );
+
+vlc_module_begin ()
+    set_shortname( N_("Polyphase resampler") )
+    set_description( N_("Windowed-sinc polyphase audio resampler") )
+    set_subcategory( SUBCAT_AUDIO_RESAMPLER )
+    add_bool( "polyphase-low-latency", false,
+              LOWLATENCY_TEXT, LOWLATENCY_LONGTEXT )
+    set_capability( "audio converter", 10 )
+    set_callback( OpenConverter )
+
+    add_submodule()
+    set_capability( "audio resampler", 10 )
+    set_callback( OpenResampler )
+    add_shortcut( "polyphase" )
+vlc_module_end ()
+
+/*
+ * Each output sample is the inner product of the last taps input samples
+ * with one row (phase) of a filter bank sampled from a Kaiser-windowed sinc.
+ *
+ * When the reduced rate ratio L/M has a small enough L (44.1<->48 kHz is
+ * 160/147, 48->96 kHz is 2/1...), the bank holds exactly the L phases that
+ * can occur and no interpolation is needed. Otherwise, typically when the
+ * input rate is nudged for drift compensation, a fixed set of phases is
+ * linearly interpolated.
+ */
+#define PHASES_EXACT_MAX 1024
+#define PHASES_INTERP     256
+
+typedef float (*dot_t)( const float *, const float *, unsigned );
+
+typedef struct
+{
+    /* Filter design */
+    unsigned taps;          /* per phase, a multiple of 8 */
+    double   rolloff;
+    double   beta;
+    dot_t    dot;
+
+    /* Filter bank: (phases + 1) rows of taps coefficients */
+    float   *coeffs;
+    unsigned phases;
+    bool     exact;
+    double   cutoff;
+
+    /* Stepping for the current input rate */
+    unsigned in_rate;
+    uint64_t den;           /* fraction denominator */
+    unsigned step_int;
+    uint64_t step_frac;
+
+    /* Planar input history, one row of stride samples per channel */
+    unsigned channels;
+    float   *buf;
+    size_t   stride;
+    size_t   avail;         /* valid samples per channel */
+    size_t   start;         /* first sample of the next window */
+    uint64_t frac;          /* fractional position of the next output */
+    bool     active;        /* some samples went through the filter */
+    vlc_tick_t next_pts;    /* timestamp following the last output */
+} filter_sys_t;
+
+/*****************************************************************************
+ * Inner products
+ *****************************************************************************/
+static float DotC( const float *a, const float *b, unsigned n )
+{
+    float s0 = 0.f, s1 = 0.f, s2 = 0.f, s3 = 0.f;
+
+    for( unsigned i = 0; i < n; i += 4 )
+    {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+#ifdef HAVE_SSE2_INTRINSICS
+__attribute__((__target__("sse")))
+static float DotSSE( const float *a, const float *b, unsigned n )
+{
+    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+
+    for( unsigned i = 0; i < n; i += 8 )
+    {
+        s0 = _mm_add_ps( s0, _mm_mul_ps( _mm_loadu_ps( a + i ),
+                                         _mm_load_ps( b + i ) ) );
+        s1 = _mm_add_ps( s1, _mm_mul_ps( _mm_loadu_ps( a + i + 4 ),
+                                         _mm_load_ps( b + i + 4 ) ) );
+    }
+    s0 = _mm_add_ps( s0, s1 );
+    s0 = _mm_add_ps( s0, _mm_movehl_ps( s0, s0 ) );
+    s0 = _mm_add_ss( s0, _mm_shuffle_ps( s0, s0, 1 ) );
+    return _mm_cvtss_f32( s0 );
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__((__target__("avx")))
+static float DotAVX( const float *a, const float *b, unsigned n )
+{
+    __m256 s = _mm256_setzero_ps();
+
+    for( unsigned i = 0; i < n; i += 8 )
+        s = _mm256_add_ps( s, _mm256_mul_ps( _mm256_loadu_ps( a + i ),
+                                             _mm256_load_ps( b + i ) ) );
+
+    __m128 h = _mm_add_ps( _mm256_castps256_ps128( s ),
+                           _mm256_extractf128_ps( s, 1 ) );
+    h = _mm_add_ps( h, _mm_movehl_ps( h, h ) );
+    h = _mm_add_ss( h, _mm_shuffle_ps( h, h, 1 ) );
+    return _mm_cvtss_f32( h );
+}
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+static float DotNEON( const float *a, const float *b, unsigned n )
+{
+    float32x4_t s0 = vdupq_n_f32( 0.f ), s1 = vdupq_n_f32( 0.f );
+
+    for( unsigned i = 0; i < n; i += 8 )
+    {
+        s0 = vmlaq_f32( s0, vld1q_f32( a + i ), vld1q_f32( b + i ) );
+        s1 = vmlaq_f32( s1, vld1q_f32( a + i + 4 ), vld1q_f32( b + i + 4 ) );
+    }
+    return vaddvq_f32( vaddq_f32( s0, s1 ) );
+}
+#endif
+
+static dot_t GetDot( void )
+{
+#ifdef HAVE_AVX2_INTRINSICS
+    if( vlc_CPU_AVX() )
+        return DotAVX;
+#endif
+#ifdef HAVE_SSE2_INTRINSICS
+    if( vlc_CPU_SSE2() )
+        return DotSSE;
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    return DotNEON;
+#endif
+    return DotC;
+}
+
+/*****************************************************************************
+ * Filter bank
+ *****************************************************************************/
+static double BesselI0( double x )
+{
+    double sum = 1., term = 1.;
+    const double q = x * x / 4.;
+
+    for( unsigned k = 1; k < 100 && term > sum * 1e-12; k++ )
+    {
+        term *= q / ((double)k * k);
+        sum += term;
+    }
+    return sum;
+}
+
+static void BuildBank( float *coeffs, unsigned phases, unsigned taps,
+                       double cutoff, double beta )
+{
+    const double half = taps / 2.;
+    const double norm = BesselI0( beta );
+
+    for( unsigned p = 0; p <= phases; p++ )
+    {
+        float *row = coeffs + p * taps;
+        double sum = 0.;
+
+        for( unsigned k = 0; k < taps; k++ )
+        {
+            /* Distance from the output point, in input samples */
+            const double t = k - (half - 1.) - (double)p / phases;
+            const double x = t / half;
+            double v = 0.;
+
+            if( fabs( x ) < 1. )
+            {
+                v = (t == 0.) ? cutoff : sin( M_PI * cutoff * t ) / (M_PI * t);
+                v *= BesselI0( beta * sqrt( 1. - x * x ) ) / norm;
+            }
+            row[k] = v;
+            sum += v;
+        }
+
+        /* Unity gain at DC for every phase */
+        for( unsigned k = 0; k < taps; k++ )
+            row[k] /= sum;
+    }
+}
+
+static int Setup( filter_t *p_filter, unsigned in_rate )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned out_rate = p_filter->fmt_out.audio.i_rate;
+    const unsigned gcd = GCD( in_rate, out_rate );
+    const unsigned l = out_rate / gcd, m = in_rate / gcd;
+
+    const bool exact = l <= PHASES_EXACT_MAX;
+    const unsigned phases = exact ? l : PHASES_INTERP;
+    const double cutoff = p_sys->rolloff
+                        * (out_rate < in_rate ? (double)out_rate / in_rate : 1.);
+
+    /* Small rate changes, as for drift compensation, keep the same bank */
+    if( p_sys->coeffs == NULL || phases != p_sys->phases
+     || exact != p_sys->exact || fabs( cutoff - p_sys->cutoff ) > cutoff / 200. )
+    {
+        float *coeffs = aligned_alloc( 64, (phases + 1) * p_sys->taps
+                                           * sizeof (float) );
+        if( unlikely(coeffs == NULL) )
+            return VLC_ENOMEM;
+
+        BuildBank( coeffs, phases, p_sys->taps, cutoff, p_sys->beta );
+        aligned_free( p_sys->coeffs );
+        p_sys->coeffs = coeffs;
+        p_sys->phases = phases;
+        p_sys->exact = exact;
+        p_sys->cutoff = cutoff;
+
+        msg_Dbg( p_filter, "%u -> %u Hz: %u taps, %u %s phases", in_rate,
+                 out_rate, p_sys->taps, phases,
+                 exact ? "exact" : "interpolated" );
+    }
+
+    /* Keep the current position across the rate change */
+    const uint64_t den = exact ? l : UINT64_C(1) << 32;
+    if( p_sys->den != den && p_sys->den != 0 )
+    {
+        p_sys->frac = (double)p_sys->frac * den / p_sys->den;
+        if( p_sys->frac >= den )
+            p_sys->frac = den - 1;
+    }
+    p_sys->den = den;
+
+    if( exact )
+    {
+        p_sys->step_int = m / l;
+        p_sys->step_frac = m % l;
+    }
+    else
+    {
+        const uint64_t step = ((uint64_t)in_rate << 32) / out_rate;
+        p_sys->step_int = step >> 32;
+        p_sys->step_frac = (uint32_t)step;
+    }
+    p_sys->in_rate = in_rate;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Processing
+ *****************************************************************************/
+static void Reset( filter_sys_t *p_sys )
+{
+    /* Prime with half a window of silence, so that the first output sample
+     * is centered on the first input sample. */
+    p_sys->avail = p_sys->taps / 2 - 1;
+    for( unsigned c = 0; c < p_sys->channels; c++ )
+        memset( p_sys->buf + c * p_sys->stride, 0,
+                p_sys->avail * sizeof (float) );
+    p_sys->start = 0;
+    p_sys->frac = 0;
+    p_sys->active = false;
+    p_sys->next_pts = VLC_TICK_INVALID;
+}
+
+static int Reserve( filter_sys_t *p_sys, size_t size )
+{
+    if( size <= p_sys->stride )
+        return VLC_SUCCESS;
+
+    const size_t stride = (size + 1023) & ~(size_t)1023;
+    float *buf = vlc_alloc( p_sys->channels, stride * sizeof (float) );
+    if( unlikely(buf == NULL) )
+        return VLC_ENOMEM;
+
+    if( p_sys->buf != NULL )
+    {
+        for( unsigned c = 0; c < p_sys->channels; c++ )
+            memcpy( buf + c * stride, p_sys->buf + c * p_sys->stride,
+                    p_sys->avail * sizeof (float) );
+        free( p_sys->buf );
+    }
+    p_sys->buf = buf;
+    p_sys->stride = stride;
+    return VLC_SUCCESS;
+}
+
+/* Appends count interleaved frames (or silence if src is NULL), and returns
+ * all the output frames that can be computed. */
+static block_t *Process( filter_t *p_filter, const float *src, size_t count )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned channels = p_sys->channels;
+    const unsigned taps = p_sys->taps;
+
+    if( Reserve( p_sys, p_sys->avail + count ) )
+        return NULL;
+
+    for( unsigned c = 0; c < channels; c++ )
+    {
+        float *dst = p_sys->buf + c * p_sys->stride + p_sys->avail;
+
+        if( src != NULL )
+            for( size_t i = 0; i < count; i++ )
+                dst[i] = src[i * channels + c];
+        else
+            memset( dst, 0, count * sizeof (float) );
+    }
+    p_sys->avail += count;
+
+    const size_t pending = p_sys->avail > p_sys->start
+                         ? p_sys->avail - p_sys->start : 0;
+    const size_t max = (uint64_t)pending * p_filter->fmt_out.audio.i_rate
+                     / p_sys->in_rate + 1;
+
+    block_t *p_out = block_Alloc( max * channels * sizeof (float) );
+    if( unlikely(p_out == NULL) )
+        return NULL;
+
+    float *dst = (float *)p_out->p_buffer;
+    size_t n = 0;
+
+    while( n < max && p_sys->start + taps <= p_sys->avail )
+    {
+        const float *in = p_sys->buf + p_sys->start;
+
+        if( p_sys->exact )
+        {
+            const float *row = p_sys->coeffs + p_sys->frac * taps;
+
+            for( unsigned c = 0; c < channels; c++ )
+                *(dst++) = p_sys->dot( in + c * p_sys->stride, row, taps );
+        }
+        else
+        {
+            const uint64_t pos = p_sys->frac * p_sys->phases;
+            const float *row = p_sys->coeffs + (pos >> 32) * taps;
+            const float w = (uint32_t)pos * 0x1.p-32f;
+
+            for( unsigned c = 0; c < channels; c++ )
+            {
+                const float *s = in + c * p_sys->stride;
+                const float v0 = p_sys->dot( s, row, taps );
+                const float v1 = p_sys->dot( s, row + taps, taps );
+
+                *(dst++) = v0 + (v1 - v0) * w;
+            }
+        }
+        n++;
+
+        p_sys->start += p_sys->step_int;
+        p_sys->frac += p_sys->step_frac;
+        if( p_sys->frac >= p_sys->den )
+        {
+            p_sys->frac -= p_sys->den;
+            p_sys->start++;
+        }
+    }
+
+    /* Drop the samples that no window will use anymore */
+    const size_t drop = __MIN( p_sys->start, p_sys->avail );
+    if( drop > 0 )
+    {
+        for( unsigned c = 0; c < channels; c++ )
+        {
+            float *row = p_sys->buf + c * p_sys->stride;
+            memmove( row, row + drop, (p_sys->avail - drop) * sizeof (float) );
+        }
+        p_sys->avail -= drop;
+        p_sys->start -= drop;
+    }
+
+    p_out->i_buffer = n * channels * sizeof (float);
+    p_out->i_nb_samples = n;
+    p_out->i_length = vlc_tick_from_samples( n, p_filter->fmt_out.audio.i_rate );
+    return p_out;
+}
+
+static block_t *Drain( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    if( !p_sys->active )
+        return NULL;
+
+    /* Flush the last input samples out of the windows with silence */
+    block_t *p_out = Process( p_filter, NULL, p_sys->taps / 2 );
+    if( p_out != NULL )
+    {
+        if( p_out->i_nb_samples == 0 || p_sys->next_pts == VLC_TICK_INVALID )
+        {
+            block_Release( p_out );
+            p_out = NULL;
+        }
+        else
+            p_out->i_pts = p_sys->next_pts;
+    }
+    Reset( p_sys );
+    return p_out;
+}
+
+static void Flush( filter_t *p_filter )
+{
+    Reset( p_filter->p_sys );
+}
+
+static block_t *Resample( filter_t *p_filter, block_t *p_in )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned in_rate = p_filter->fmt_in.audio.i_rate;
+    vlc_tick_t i_pts = p_in->i_pts;
+    block_t *p_out;
+
+    if( in_rate == p_filter->fmt_out.audio.i_rate )
+    {
+        /* "audio resampler" back to the nominal rate: output what is left in
+         * the windows, then pass through */
+        block_t *p_tail = Drain( p_filter );
+        if( p_tail == NULL )
+            return p_in;
+
+        i_pts = p_tail->i_pts;
+        const unsigned i_nb_samples = p_tail->i_nb_samples
+                                    + p_in->i_nb_samples;
+        block_ChainAppend( &p_tail, p_in );
+        p_out = block_ChainGather( p_tail );
+        if( unlikely(p_out == NULL) )
+            return NULL;
+        p_out->i_nb_samples = i_nb_samples;
+    }
+    else
+    {
+        if( in_rate != p_sys->in_rate && Setup( p_filter, in_rate ) )
+        {
+            block_Release( p_in );
+            return NULL;
+        }
+
+        p_sys->active = true;
+        p_out = Process( p_filter, (const float *)p_in->p_buffer,
+                         p_in->i_nb_samples );
+        block_Release( p_in );
+        if( unlikely(p_out == NULL) )
+            return NULL;
+    }
+
+    p_out->i_pts = i_pts;
+    p_out->i_length = vlc_tick_from_samples( p_out->i_nb_samples,
+                                             p_filter->fmt_out.audio.i_rate );
+    if( p_sys->active && i_pts != VLC_TICK_INVALID )
+        p_sys->next_pts = i_pts + p_out->i_length;
+    return p_out;
+}
+
+/*****************************************************************************
+ * Open/Close
+ *****************************************************************************/
+static void Close( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    aligned_free( p_sys->coeffs );
+    free( p_sys->buf );
+    free( p_sys );
+}
+
+static int Open( vlc_object_t *p_obj )
+{
+    filter_t *p_filter = (filter_t *)p_obj;
+
+    /* Cannot convert format nor remix */
+    if( p_filter->fmt_in.audio.i_format != VLC_CODEC_FL32
+     || p_filter->fmt_out.audio.i_format != VLC_CODEC_FL32
+     || p_filter->fmt_in.audio.i_channels != p_filter->fmt_out.audio.i_channels
+     || p_filter->fmt_in.audio.i_channels == 0
+     || p_filter->fmt_in.audio.i_rate == 0
+     || p_filter->fmt_out.audio.i_rate == 0 )
+        return VLC_EGENERIC;
+
+    filter_sys_t *p_sys = calloc( 1, sizeof (*p_sys) );
+    if( unlikely(p_sys == NULL) )
+        return VLC_ENOMEM;
+
+    if( var_InheritBool( p_obj, "polyphase-low-latency" ) )
+    {   /* ~-55 dB stop-band, 8 samples of delay */
+        p_sys->taps = 16;
+        p_sys->rolloff = .85;
+        p_sys->beta = 5.;
+    }
+    else
+    {   /* ~-90 dB stop-band, 32 samples of delay */
+        p_sys->taps = 64;
+        p_sys->rolloff = .945;
+        p_sys->beta = 8.6;
+    }
+    p_sys->dot = GetDot();
+    p_sys->channels = p_filter->fmt_in.audio.i_channels;
+    p_filter->p_sys = p_sys;
+
+    if( Reserve( p_sys, 4096 )
+     || Setup( p_filter, p_filter->fmt_in.audio.i_rate ) )
+    {
+        Close( p_filter );
+        return VLC_ENOMEM;
+    }
+    Reset( p_sys );
+
+    static const struct vlc_filter_operations filter_ops =
+    {
+        .filter_audio = Resample,
+        .drain_audio = Drain,
+        .flush = Flush,
+        .close = Close,
+    };
+    p_filter->ops = &filter_ops;
+    return VLC_SUCCESS;
+}
+
+static int OpenConverter( vlc_object_t *p_obj )
+{
+    filter_t *p_filter = (filter_t *)p_obj;
+
+    /* Will change rate */
+    if( p_filter->fmt_in.audio.i_rate == p_filter->fmt_out.audio.i_rate )
+        return VLC_EGENERIC;
+    return Open( p_obj );
+}
+
+static int OpenResampler( vlc_object_t *p_obj )
+{
+    return Open( p_obj );
+}
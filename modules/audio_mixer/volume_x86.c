@@ -0,0 +1,310 @@
+/*****************************************************************************
+ * volume_x86.c : x86 SSE/AVX/AVX-512 audio volume
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+#include <immintrin.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_cpu.h>
+#include <vlc_aout.h>
+#include <vlc_aout_volume.h>
+
+/*
+ * All the variants produce the very same samples as the float and integer
+ * mixers: only the loop width changes.
+ */
+
+/*** FL32 ***/
+__attribute__((__target__("sse")))
+static void AmplifyFloatSSE(audio_volume_t *volume, block_t *block, float amp)
+{
+    float *buf = (float *)block->p_buffer;
+    size_t count = block->i_buffer / sizeof (*buf);
+
+    if (amp == 1.f)
+        return;
+
+    const __m128 mult = _mm_set1_ps(amp);
+    for (; count >= 8; count -= 8, buf += 8)
+    {
+        _mm_storeu_ps(buf, _mm_mul_ps(_mm_loadu_ps(buf), mult));
+        _mm_storeu_ps(buf + 4, _mm_mul_ps(_mm_loadu_ps(buf + 4), mult));
+    }
+    while (count--)
+        *(buf++) *= amp;
+
+    (void) volume;
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__((__target__("avx")))
+static void AmplifyFloatAVX(audio_volume_t *volume, block_t *block, float amp)
+{
+    float *buf = (float *)block->p_buffer;
+    size_t count = block->i_buffer / sizeof (*buf);
+
+    if (amp == 1.f)
+        return;
+
+    const __m256 mult = _mm256_set1_ps(amp);
+    for (; count >= 16; count -= 16, buf += 16)
+    {
+        _mm256_storeu_ps(buf, _mm256_mul_ps(_mm256_loadu_ps(buf), mult));
+        _mm256_storeu_ps(buf + 8, _mm256_mul_ps(_mm256_loadu_ps(buf + 8), mult));
+    }
+    while (count--)
+        *(buf++) *= amp;
+
+    (void) volume;
+}
+#endif
+
+#ifdef CAN_COMPILE_AVX512
+__attribute__((__target__("avx512f")))
+static void AmplifyFloatAVX512(audio_volume_t *volume, block_t *block, float amp)
+{
+    float *buf = (float *)block->p_buffer;
+    size_t count = block->i_buffer / sizeof (*buf);
+
+    if (amp == 1.f)
+        return;
+
+    const __m512 mult = _mm512_set1_ps(amp);
+    for (; count >= 16; count -= 16, buf += 16)
+        _mm512_storeu_ps(buf, _mm512_mul_ps(_mm512_loadu_ps(buf), mult));
+
+    if (count > 0)
+    {   /* masked tail, no scalar loop needed */
+        __mmask16 mask = (1U << count) - 1;
+        __m512 v = _mm512_maskz_loadu_ps(mask, buf);
+        _mm512_mask_storeu_ps(buf, mask, _mm512_mul_ps(v, mult));
+    }
+
+    (void) volume;
+}
+#endif
+
+/*** FL64 ***/
+__attribute__((__target__("sse2")))
+static void AmplifyDoubleSSE2(audio_volume_t *volume, block_t *block, float amp)
+{
+    double *buf = (double *)block->p_buffer;
+    size_t count = block->i_buffer / sizeof (*buf);
+    double mult = amp;
+
+    if (mult == 1.)
+        return;
+
+    const __m128d vmult = _mm_set1_pd(mult);
+    for (; count >= 4; count -= 4, buf += 4)
+    {
+        _mm_storeu_pd(buf, _mm_mul_pd(_mm_loadu_pd(buf), vmult));
+        _mm_storeu_pd(buf + 2, _mm_mul_pd(_mm_loadu_pd(buf + 2), vmult));
+    }
+    while (count--)
+        *(buf++) *= mult;
+
+    (void) volume;
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__((__target__("avx")))
+static void AmplifyDoubleAVX(audio_volume_t *volume, block_t *block, float amp)
+{
+    double *buf = (double *)block->p_buffer;
+    size_t count = block->i_buffer / sizeof (*buf);
+    double mult = amp;
+
+    if (mult == 1.)
+        return;
+
+    const __m256d vmult = _mm256_set1_pd(mult);
+    for (; count >= 8; count -= 8, buf += 8)
+    {
+        _mm256_storeu_pd(buf, _mm256_mul_pd(_mm256_loadu_pd(buf), vmult));
+        _mm256_storeu_pd(buf + 4, _mm256_mul_pd(_mm256_loadu_pd(buf + 4), vmult));
+    }
+    while (count--)
+        *(buf++) *= mult;
+
+    (void) volume;
+}
+#endif
+
+#ifdef CAN_COMPILE_AVX512
+__attribute__((__target__("avx512f")))
+static void AmplifyDoubleAVX512(audio_volume_t *volume, block_t *block, float amp)
+{
+    double *buf = (double *)block->p_buffer;
+    size_t count = block->i_buffer / sizeof (*buf);
+    double mult = amp;
+
+    if (mult == 1.)
+        return;
+
+    const __m512d vmult = _mm512_set1_pd(mult);
+    for (; count >= 8; count -= 8, buf += 8)
+        _mm512_storeu_pd(buf, _mm512_mul_pd(_mm512_loadu_pd(buf), vmult));
+
+    if (count > 0)
+    {
+        __mmask8 mask = (1U << count) - 1;
+        __m512d v = _mm512_maskz_loadu_pd(mask, buf);
+        _mm512_mask_storeu_pd(buf, mask, _mm512_mul_pd(v, vmult));
+    }
+
+    (void) volume;
+}
+#endif
+
+/*** S16N ***/
+/* Same 8 bits fixed point scale as the integer mixer */
+static inline int16_t AmplifyShortSample(int16_t s, int_fast16_t mult)
+{
+    int_fast32_t v = (s * (int_fast32_t)mult) >> 8;
+    if (v > INT16_MAX)
+        v = INT16_MAX;
+    else
+    if (v < INT16_MIN)
+        v = INT16_MIN;
+    return v;
+}
+
+__attribute__((__target__("sse2")))
+static void AmplifyShortSSE2(audio_volume_t *volume, block_t *block, float amp)
+{
+    int16_t *buf = (int16_t *)block->p_buffer;
+    size_t count = block->i_buffer / sizeof (*buf);
+
+    int_fast16_t mult = lroundf(amp * 0x1.p8f);
+    if (mult == (1 << 8))
+        return;
+
+    if (mult <= INT16_MAX)
+    {
+        const __m128i vmult = _mm_set1_epi16(mult);
+        for (; count >= 8; count -= 8, buf += 8)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)buf);
+            __m128i lo = _mm_mullo_epi16(v, vmult);
+            __m128i hi = _mm_mulhi_epi16(v, vmult);
+            /* full 32-bits products, scaled back and saturated */
+            __m128i p0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 8);
+            __m128i p1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 8);
+            _mm_storeu_si128((__m128i *)buf, _mm_packs_epi32(p0, p1));
+        }
+    }
+    for (; count > 0; count--, buf++)
+        *buf = AmplifyShortSample(*buf, mult);
+
+    (void) volume;
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__((__target__("avx2")))
+static void AmplifyShortAVX2(audio_volume_t *volume, block_t *block, float amp)
+{
+    int16_t *buf = (int16_t *)block->p_buffer;
+    size_t count = block->i_buffer / sizeof (*buf);
+
+    int_fast16_t mult = lroundf(amp * 0x1.p8f);
+    if (mult == (1 << 8))
+        return;
+
+    if (mult <= INT16_MAX)
+    {
+        const __m256i vmult = _mm256_set1_epi16(mult);
+        for (; count >= 16; count -= 16, buf += 16)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i *)buf);
+            __m256i lo = _mm256_mullo_epi16(v, vmult);
+            __m256i hi = _mm256_mulhi_epi16(v, vmult);
+            /* unpack and pack both work per 128-bits lane: order is kept */
+            __m256i p0 = _mm256_srai_epi32(_mm256_unpacklo_epi16(lo, hi), 8);
+            __m256i p1 = _mm256_srai_epi32(_mm256_unpackhi_epi16(lo, hi), 8);
+            _mm256_storeu_si256((__m256i *)buf, _mm256_packs_epi32(p0, p1));
+        }
+    }
+    for (; count > 0; count--, buf++)
+        *buf = AmplifyShortSample(*buf, mult);
+
+    (void) volume;
+}
+#endif
+
+static int Probe(vlc_object_t *obj)
+{
+    audio_volume_t *volume = (audio_volume_t *)obj;
+
+    if (!vlc_CPU_SSE2())
+        return VLC_ENOTSUP;
+
+    switch (volume->format)
+    {
+        case VLC_CODEC_FL32:
+            volume->amplify = AmplifyFloatSSE;
+#ifdef HAVE_AVX2_INTRINSICS
+            if (vlc_CPU_AVX())
+                volume->amplify = AmplifyFloatAVX;
+#endif
+#ifdef CAN_COMPILE_AVX512
+            if (vlc_CPU_AVX512())
+                volume->amplify = AmplifyFloatAVX512;
+#endif
+            break;
+
+        case VLC_CODEC_FL64:
+            volume->amplify = AmplifyDoubleSSE2;
+#ifdef HAVE_AVX2_INTRINSICS
+            if (vlc_CPU_AVX())
+                volume->amplify = AmplifyDoubleAVX;
+#endif
+#ifdef CAN_COMPILE_AVX512
+            if (vlc_CPU_AVX512())
+                volume->amplify = AmplifyDoubleAVX512;
+#endif
+            break;
+
+        case VLC_CODEC_S16N:
+            volume->amplify = AmplifyShortSSE2;
+#ifdef HAVE_AVX2_INTRINSICS
+            if (vlc_CPU_AVX2())
+                volume->amplify = AmplifyShortAVX2;
+#endif
+            break;
+
+        default:
+            return VLC_ENOTSUP;
+    }
+
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_subcategory(SUBCAT_AUDIO_AFILTER)
+    set_description(N_("x86 SIMD audio volume"))
+    set_capability("audio volume", 20)
+    set_callback(Probe)
+vlc_module_end()
@@ -534,6 +534,34 @@ static int OpenVideoCodec( decoder_t *p_dec )
     return 0;
 }
 
+/**
+ * Returns the largest downscaling factor that still decodes a picture as
+ * large as the thumbnail requested by the owner, if any.
+ */
+static int GetThumbnailLowres( decoder_t *p_dec, const AVCodec *p_codec )
+{
+    if( var_Type( p_dec, "thumbnail-width" ) == 0 )
+        return 0;
+
+    const video_format_t *fmt = &p_dec->fmt_in->video;
+    unsigned src_width = fmt->i_visible_width ? fmt->i_visible_width
+                                              : fmt->i_width;
+    unsigned src_height = fmt->i_visible_height ? fmt->i_visible_height
+                                                : fmt->i_height;
+    if( src_width == 0 || src_height == 0 )
+        return 0; /* unknown until the first frame is decoded */
+
+    unsigned width = var_GetInteger( p_dec, "thumbnail-width" );
+    unsigned height = var_GetInteger( p_dec, "thumbnail-height" );
+
+    int lowres = 0;
+    while( lowres < p_codec->max_lowres
+        && ( src_width >> ( lowres + 1 ) ) >= width
+        && ( src_height >> ( lowres + 1 ) ) >= height )
+        lowres++;
+    return lowres;
+}
+
 static int InitVideoDecCommon( decoder_t *p_dec )
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
@@ -592,6 +620,12 @@ static int InitVideoDecCommon( decoder_t *p_dec )
     else if( i_val == -1 ) p_context->skip_idct = AVDISCARD_NONE;
     else p_context->skip_idct = AVDISCARD_DEFAULT;
 
+    /* ***** libavcodec low resolution decoding ***** */
+    p_context->lowres = GetThumbnailLowres( p_dec, p_codec );
+    if( p_context->lowres > 0 )
+        msg_Dbg( p_dec, "decoding at 1/%d of the resolution",
+                 1 << p_context->lowres );
+
     /* ***** libavcodec direct rendering ***** */
     p_sys->b_direct_rendering = false;
     p_sys->b_dr_failure = false;
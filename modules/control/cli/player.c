@@ -902,6 +902,10 @@ static int Statistics(struct cli_client *cl, const char *const *args,
                    (float)(item->p_stats->i_read_bytes) / 1024.f);
         cli_printf(cl, _("| input bitrate    :   %6.0f kb/s"),
                    (float)(item->p_stats->f_input_bitrate) * 8000.f);
+        cli_printf(cl, _("| input buffered   : %8.0f KiB"),
+                   (float)(item->p_stats->i_buffered_bytes) / 1024.f);
+        cli_printf(cl, _("| buffer underruns :    %5"PRIu64),
+                   item->p_stats->i_buffer_underruns);
         cli_printf(cl, _("| demux bytes read : %8.0f KiB"),
                    (float)(item->p_stats->i_demux_read_bytes) / 1024.f);
         cli_printf(cl, _("| demux bitrate    :   %6.0f kb/s"),
@@ -52,6 +52,7 @@ vlc_module_begin ()
     set_description( N_("AIFF demuxer" ) )
     set_capability( "demux", 10 )
     set_callbacks( Open, Close )
+    add_signature( 0, "FORM" )
     add_shortcut( "aiff" )
     add_file_extension("aiff")
 vlc_module_end ()
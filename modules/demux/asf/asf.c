@@ -62,6 +62,9 @@ vlc_module_begin ()
     set_description( N_("ASF/WMV demuxer") )
     set_capability( "demux", 200 )
     set_callbacks( Open, Close )
+    /* Header Object GUID */
+    add_signature( 0, "\x30\x26\xb2\x75\x8e\x66\xcf\x11"
+                   "\xa6\xd9\x00\xaa\x00\x62\xce\x6c" )
     add_shortcut( "asf", "wmv" )
     add_file_extension("asf")
     add_file_extension("wma")
@@ -48,6 +48,7 @@ vlc_module_begin ()
     set_description( N_("AU demuxer") )
     set_capability( "demux", 10 )
     set_callback( Open )
+    add_signature( 0, ".snd" )
     add_shortcut( "au" )
     add_file_extension("au")
 vlc_module_end ()
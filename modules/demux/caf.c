@@ -52,6 +52,7 @@ set_subcategory( SUBCAT_INPUT_DEMUX )
 set_description( N_( "CAF demuxer" ))
 set_capability( "demux", 140 )
 set_callbacks( Open, Close )
+add_signature( 0, "caff" )
 add_shortcut( "caf" )
 vlc_module_end ()
 
@@ -632,6 +632,11 @@ bool matroska_segment_c::Preload( )
                                               SegmentSeeker::Seekpoint::TrustLevel::QUESTIONABLE ) );
                 }
 
+                // without cues, seeking has to parse the clusters up to the target
+                if( !b_cues && sys.b_fastseekable &&
+                    !var_InheritBool( &sys.demuxer, "mkv-preload-clusters" ) )
+                    _seeker.start_indexer( *this, cluster->GetElementPosition() );
+
                 /* stop pre-parsing the stream */
                 break;
             }
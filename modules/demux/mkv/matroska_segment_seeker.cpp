@@ -28,8 +28,15 @@
 #include "util.hpp"
 #include "stream_io_callback.hpp"
 
+#include <vlc_threads.h>
+#include <vlc_fs.h>
+#include <vlc_configuration.h>
+
 #include <sstream>
 #include <limits>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 
 namespace {
     template<class It, class T>
@@ -50,6 +57,436 @@ namespace {
 
 namespace mkv {
 
+// --------------------------------------------------------------------------
+// Background cluster indexer
+//
+// Segments without cues can only be seeked by parsing the clusters up to the
+// target. This thread walks the level 1 elements on a second stream and only
+// reads the Timestamp of each cluster, the blocks are skipped using the
+// element sizes. The clusters found are merged into the seeker on each seek.
+// --------------------------------------------------------------------------
+
+class ClusterIndexer
+{
+    public:
+        typedef SegmentSeeker::fptr_t  fptr_t;
+        typedef SegmentSeeker::Cluster Cluster;
+
+        ClusterIndexer( demux_t & demuxer, stream_t * s, fptr_t start, fptr_t end,
+                        uint64_t timescale, std::string const& cache_path )
+            : demuxer( demuxer ), s( s ), start( start ), end( end )
+            , timescale( timescale ), cache_path( cache_path )
+            , is_running( false ), b_abort( false ), taken( 0 )
+        {
+            vlc_mutex_init( &lock );
+        }
+
+        ~ClusterIndexer()
+        {
+            if( is_running )
+            {
+                {
+                    vlc_mutex_locker guard( &lock );
+                    b_abort = true;
+                }
+                vlc_join( thread, NULL );
+            }
+            vlc_stream_Delete( s );
+        }
+
+        bool Start()
+        {
+            is_running = !vlc_clone( &thread, Thread, this );
+            return is_running;
+        }
+
+        // appends the clusters found since the previous call
+        void TakeClusters( std::vector<Cluster> & out )
+        {
+            vlc_mutex_locker guard( &lock );
+            out.insert( out.end(), clusters.begin() + taken, clusters.end() );
+            taken = clusters.size();
+        }
+
+    private:
+        static const uint32_t ID_CLUSTER   = 0x1F43B675;
+        static const uint32_t ID_TIMESTAMP = 0xE7;
+        static const uint32_t ID_BLOCK_GROUP = 0xA0;
+        static const uint32_t ID_SIMPLE_BLOCK = 0xA3;
+        static const uint32_t ID_ENCRYPTED_BLOCK = 0xAF;
+        static const uint64_t UNKNOWN_SIZE = UINT64_MAX;
+        static const unsigned MAX_CLUSTER_HEADER_ELEMENTS = 8;
+
+        struct Element {
+            fptr_t   fpos;
+            uint32_t id;
+            unsigned header_size;
+            uint64_t size; // UNKNOWN_SIZE for live streams
+        };
+
+        static void *Thread( void *data )
+        {
+            static_cast<ClusterIndexer*>( data )->Run();
+            return NULL;
+        }
+
+        bool Aborted()
+        {
+            vlc_mutex_locker guard( &lock );
+            return b_abort;
+        }
+
+        void AddCluster( Cluster const& cinfo )
+        {
+            vlc_mutex_locker guard( &lock );
+            clusters.push_back( cinfo );
+        }
+
+        bool ReadElement( fptr_t fpos, Element & el );
+        bool ReadClusterTimestamp( Element const& cluster, vlc_tick_t & pts );
+        fptr_t FindClusterEnd( fptr_t fpos );
+        fptr_t LoadCache();
+        void SaveCache( size_t loaded );
+        void Run();
+
+        demux_t  & demuxer;
+        stream_t * s;
+        fptr_t     start;
+        fptr_t     end;
+        uint64_t   timescale;
+        std::string cache_path;
+
+        vlc_thread_t thread;
+        bool         is_running;
+
+        vlc_mutex_t  lock;
+        bool         b_abort;
+        std::vector<Cluster> clusters;
+        size_t       taken;
+};
+
+// reads the EBML ID and size of the element at fpos
+bool
+ClusterIndexer::ReadElement( fptr_t fpos, Element & el )
+{
+    const uint8_t *p;
+
+    if( vlc_stream_Seek( s, fpos ) != VLC_SUCCESS )
+        return false;
+
+    ssize_t i_peek = vlc_stream_Peek( s, &p, 12 );
+    if( i_peek < 2 || p[0] == 0 )
+        return false;
+
+    unsigned id_len = 1;
+    for( uint8_t mask = 0x80; !( p[0] & mask ); mask >>= 1 )
+        id_len++;
+    if( id_len > 4 || (size_t)i_peek <= id_len || p[id_len] == 0 )
+        return false;
+
+    unsigned size_len = 1;
+    for( uint8_t mask = 0x80; !( p[id_len] & mask ); mask >>= 1 )
+        size_len++;
+    if( (size_t)i_peek < id_len + size_len )
+        return false;
+
+    el.id = 0;
+    for( unsigned i = 0; i < id_len; i++ )
+        el.id = ( el.id << 8 ) | p[i];
+
+    uint8_t const value_mask = 0xFF >> size_len;
+    uint64_t size = p[id_len] & value_mask;
+    bool all_ones = size == value_mask;
+    for( unsigned i = 1; i < size_len; i++ )
+    {
+        size = ( size << 8 ) | p[id_len + i];
+        all_ones &= p[id_len + i] == 0xFF;
+    }
+
+    el.fpos        = fpos;
+    el.header_size = id_len + size_len;
+    el.size        = all_ones ? UNKNOWN_SIZE : size;
+    return true;
+}
+
+// the Timestamp comes before the first block of the cluster
+bool
+ClusterIndexer::ReadClusterTimestamp( Element const& cluster, vlc_tick_t & pts )
+{
+    fptr_t fpos = cluster.fpos + cluster.header_size;
+    Element el;
+
+    for( unsigned i = 0; i < MAX_CLUSTER_HEADER_ELEMENTS; i++ )
+    {
+        if( !ReadElement( fpos, el ) || el.size == UNKNOWN_SIZE )
+            return false;
+
+        if( el.id == ID_TIMESTAMP )
+        {
+            uint8_t buf[8];
+            if( el.size > sizeof(buf) ||
+                vlc_stream_Seek( s, fpos + el.header_size ) != VLC_SUCCESS ||
+                vlc_stream_Read( s, buf, el.size ) != (ssize_t)el.size )
+                return false;
+
+            uint64_t timestamp = 0;
+            for( unsigned j = 0; j < el.size; j++ )
+                timestamp = ( timestamp << 8 ) | buf[j];
+
+            pts = VLC_TICK_FROM_NS( timestamp * timescale );
+            return true;
+        }
+
+        if( el.id == ID_SIMPLE_BLOCK || el.id == ID_BLOCK_GROUP ||
+            el.id == ID_ENCRYPTED_BLOCK || el.id > 0xFFFFFF )
+            return false;
+
+        fpos += el.header_size + el.size;
+    }
+    return false;
+}
+
+// the end of a cluster of unknown size is the next level 1 element
+ClusterIndexer::fptr_t
+ClusterIndexer::FindClusterEnd( fptr_t fpos )
+{
+    Element el;
+
+    while( fpos < end && !Aborted() )
+    {
+        if( !ReadElement( fpos, el ) || el.size == UNKNOWN_SIZE )
+            break;
+        if( el.id > 0xFFFFFF )
+            return fpos;
+        fpos += el.header_size + el.size;
+    }
+    return end;
+}
+
+// --------------------------------------------------------------------------
+// The index cache is a "VLCMKVI1" tag, the segment timescale and the number
+// of clusters, followed by the position, timestamp and size of each cluster,
+// all as big endian 64 bits values.
+// --------------------------------------------------------------------------
+
+static const char index_cache_magic[8] = { 'V', 'L', 'C', 'M', 'K', 'V', 'I', '1' };
+
+// returns the position to resume the scan from
+ClusterIndexer::fptr_t
+ClusterIndexer::LoadCache()
+{
+    if( cache_path.empty() )
+        return start;
+
+    FILE *file = vlc_fopen( cache_path.c_str(), "rb" );
+    if( file == NULL )
+        return start;
+
+    std::vector<Cluster> cached;
+    uint8_t buf[24];
+
+    if( fread( buf, 1, 24, file ) == 24 &&
+        !memcmp( buf, index_cache_magic, 8 ) &&
+        GetQWBE( &buf[8] ) == timescale )
+    {
+        uint64_t count = GetQWBE( &buf[16] );
+
+        while( count-- > 0 && fread( buf, 1, 24, file ) == 24 )
+        {
+            Cluster cinfo = {
+                /* fpos     */ GetQWBE( &buf[0] ),
+                /* pts      */ vlc_tick_t( GetQWBE( &buf[8] ) ),
+                /* duration */ vlc_tick_t( -1 ),
+                /* size     */ GetQWBE( &buf[16] )
+            };
+
+            if( cinfo.fpos < start || cinfo.fpos >= end ||
+                ( !cached.empty() && cinfo.fpos <= cached.back().fpos ) )
+            {
+                cached.clear();
+                break;
+            }
+            cached.push_back( cinfo );
+        }
+    }
+    fclose( file );
+
+    if( cached.empty() )
+        return start;
+
+    // the file may have changed since, check that the last cluster is
+    // still where it was
+    Cluster const& last = cached.back();
+    Element el;
+    vlc_tick_t pts;
+
+    if( !ReadElement( last.fpos, el ) || el.id != ID_CLUSTER ||
+        !ReadClusterTimestamp( el, pts ) || pts != last.pts )
+    {
+        msg_Dbg( &demuxer, "discarding outdated cluster index %s", cache_path.c_str() );
+        return start;
+    }
+
+    fptr_t resume = el.size == UNKNOWN_SIZE
+        ? FindClusterEnd( el.fpos + el.header_size )
+        : el.fpos + el.header_size + el.size;
+
+    msg_Dbg( &demuxer, "loaded %zu clusters from %s", cached.size(), cache_path.c_str() );
+
+    vlc_mutex_locker guard( &lock );
+    clusters.swap( cached );
+    return resume;
+}
+
+void
+ClusterIndexer::SaveCache( size_t loaded )
+{
+    if( cache_path.empty() || clusters.size() <= loaded )
+        return;
+
+    std::string dir = cache_path.substr( 0, cache_path.find_last_of( DIR_SEP_CHAR ) );
+    if( vlc_mkdir( dir.c_str(), 0700 ) != 0 && errno != EEXIST )
+        return;
+
+    FILE *file = vlc_fopen( cache_path.c_str(), "wb" );
+    if( file == NULL )
+        return;
+
+    uint8_t buf[24];
+    memcpy( buf, index_cache_magic, 8 );
+    SetQWBE( &buf[8], timescale );
+    SetQWBE( &buf[16], clusters.size() );
+    bool ok = fwrite( buf, 1, 24, file ) == 24;
+
+    // only this thread appends to the clusters, no need to lock
+    for( size_t i = 0; ok && i < clusters.size(); i++ )
+    {
+        SetQWBE( &buf[0], clusters[i].fpos );
+        SetQWBE( &buf[8], clusters[i].pts );
+        SetQWBE( &buf[16], clusters[i].size );
+        ok = fwrite( buf, 1, 24, file ) == 24;
+    }
+
+    if( fclose( file ) != 0 || !ok )
+        vlc_unlink( cache_path.c_str() );
+}
+
+void
+ClusterIndexer::Run()
+{
+    vlc_thread_set_name( "vlc-mkv-index" );
+
+    fptr_t fpos = LoadCache();
+    size_t loaded = clusters.size();
+    Element el;
+
+    while( fpos < end && !Aborted() )
+    {
+        if( !ReadElement( fpos, el ) )
+            break;
+
+        if( el.id == ID_CLUSTER )
+        {
+            vlc_tick_t pts;
+
+            if( ReadClusterTimestamp( el, pts ) )
+            {
+                Cluster cinfo = {
+                    /* fpos     */ el.fpos,
+                    /* pts      */ pts,
+                    /* duration */ vlc_tick_t( -1 ),
+                    /* size     */ el.size == UNKNOWN_SIZE
+                        ? UINT64_MAX
+                        : el.header_size + el.size
+                };
+                AddCluster( cinfo );
+            }
+
+            if( el.size == UNKNOWN_SIZE )
+            {
+                fpos = FindClusterEnd( el.fpos + el.header_size );
+                continue;
+            }
+        }
+        else if( el.size == UNKNOWN_SIZE )
+            break; // cannot be skipped
+
+        fpos += el.header_size + el.size;
+    }
+
+    msg_Dbg( &demuxer, "indexed %zu clusters", clusters.size() );
+    SaveCache( loaded );
+}
+
+static std::string
+IndexCachePath( KaxSegmentUID const& uid )
+{
+    char *psz_dir = config_GetUserDir( VLC_CACHE_DIR );
+    if( psz_dir == NULL )
+        return std::string();
+
+    std::string path( psz_dir );
+    free( psz_dir );
+
+    path += DIR_SEP "mkv-index" DIR_SEP;
+    for( size_t i = 0; i < uid.GetSize(); i++ )
+    {
+        char hex[3];
+        snprintf( hex, sizeof(hex), "%02x", uid.GetBuffer()[i] );
+        path += hex;
+    }
+    return path + ".idx";
+}
+
+SegmentSeeker::SegmentSeeker() = default;
+SegmentSeeker::~SegmentSeeker() = default;
+
+void
+SegmentSeeker::start_indexer( matroska_segment_c& ms, fptr_t first_cluster_pos )
+{
+    demux_t & demuxer = ms.sys.demuxer;
+
+    if( _indexer || demuxer.psz_url == NULL || demuxer.b_preparsing )
+        return;
+
+    stream_t *s = vlc_stream_NewURL( &demuxer, demuxer.psz_url );
+    if( s == NULL )
+        return;
+
+    fptr_t end = ms.segment->IsFiniteSize()
+        ? ms.segment->GetEndPosition()
+        : std::numeric_limits<fptr_t>::max();
+
+    std::string cache_path;
+    if( ms.p_segment_uid && ms.p_segment_uid->GetSize() > 0 &&
+        var_InheritBool( &demuxer, "mkv-index-cache" ) )
+        cache_path = IndexCachePath( *ms.p_segment_uid );
+
+    try {
+        _indexer.reset( new ClusterIndexer( demuxer, s, first_cluster_pos, end,
+                                            ms.i_timescale, cache_path ) );
+    } catch( std::bad_alloc const& ) {
+        vlc_stream_Delete( s );
+        return;
+    }
+
+    if( !_indexer->Start() )
+        _indexer.reset();
+}
+
+void
+SegmentSeeker::add_indexed_clusters()
+{
+    if( !_indexer )
+        return;
+
+    std::vector<Cluster> found;
+    _indexer->TakeClusters( found );
+
+    for( std::vector<Cluster>::const_iterator it = found.begin(); it != found.end(); ++it )
+        add_cluster( *it );
+}
+
 SegmentSeeker::cluster_positions_t::iterator
 SegmentSeeker::add_cluster_position( fptr_t fpos )
 {
@@ -74,6 +511,12 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
             : UINT64_MAX
     };
 
+    return add_cluster( cinfo );
+}
+
+SegmentSeeker::cluster_map_t::iterator
+SegmentSeeker::add_cluster( Cluster const& cinfo )
+{
     add_cluster_position( cinfo.fpos );
 
     cluster_map_t::iterator it = _clusters.lower_bound( cinfo.pts );
@@ -308,6 +751,8 @@ SegmentSeeker::get_seekpoints( matroska_segment_c& ms, vlc_tick_t target_pts,
         }
     };
 
+    add_indexed_clusters();
+
     for( vlc_tick_t needle_pts = target_pts; ; )
     {
         seekpoint_pair_t seekpoints = get_seekpoints_around( needle_pts, priority_tracks );
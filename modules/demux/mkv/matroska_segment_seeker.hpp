@@ -29,10 +29,12 @@
 #include <vector>
 #include <map>
 #include <limits>
+#include <memory>
 
 namespace mkv {
 
 class matroska_segment_c;
+class ClusterIndexer;
 
 class SegmentSeeker
 {
@@ -88,6 +90,9 @@ class SegmentSeeker
         };
 
     public:
+        SegmentSeeker();
+        ~SegmentSeeker();
+
         typedef std::vector<track_id_t> track_ids_t;
         typedef std::vector<Range> ranges_t;
         typedef std::vector<Seekpoint> seekpoints_t;
@@ -110,6 +115,11 @@ class SegmentSeeker
 
         cluster_positions_t::iterator add_cluster_position( fptr_t pos );
         cluster_map_t      ::iterator add_cluster( KaxCluster * const );
+        cluster_map_t      ::iterator add_cluster( Cluster const& );
+
+        // find the clusters in the background, for segments without cues
+        void start_indexer( matroska_segment_c&, fptr_t first_cluster_pos );
+        void add_indexed_clusters();
 
         void mkv_jump_to( matroska_segment_c&, fptr_t );
 
@@ -124,6 +134,7 @@ class SegmentSeeker
         tracks_seekpoints_t _tracks_seekpoints;
         cluster_positions_t _cluster_positions;
         cluster_map_t       _clusters;
+        std::unique_ptr<ClusterIndexer> _indexer;
 };
 
 } // namespace
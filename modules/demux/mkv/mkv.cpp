@@ -56,6 +56,7 @@ vlc_module_begin ()
     set_description( N_("Matroska stream demuxer" ) )
     set_capability( "demux", 50 )
     set_callbacks( Open, Close )
+    add_signature( 0, "\x1a\x45\xdf\xa3" ) /* EBML */
     set_subcategory( SUBCAT_INPUT_DEMUX )
 
     add_bool( "mkv-use-ordered-chapters", true,
@@ -82,6 +83,10 @@ vlc_module_begin ()
             N_("Preload clusters"),
             N_("Find all cluster positions by jumping cluster-to-cluster before playback") )
 
+    add_bool( "mkv-index-cache", false,
+            N_("Cache the cluster index"),
+            N_("Store the cluster positions of files without cues, so that they can be seeked quickly the next time they are played.") )
+
     add_shortcut( "mka", "mkv" )
     add_file_extension("mka")
     add_file_extension("mks")
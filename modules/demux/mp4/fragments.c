@@ -23,6 +23,7 @@
 
 #include "fragments.h"
 #include <limits.h>
+#include <string.h>
 
 void MP4_Fragments_Index_Delete( mp4_fragments_index_t *p_index )
 {
@@ -34,62 +35,154 @@ void MP4_Fragments_Index_Delete( mp4_fragments_index_t *p_index )
     }
 }
 
+static bool MP4_Fragments_Index_Grow( mp4_fragments_index_t *p_index, unsigned i_num )
+{
+    if( SIZE_MAX / i_num < p_index->i_tracks )
+        return false;
+
+    stime_t *p_times = realloc( p_index->p_times,
+                                (size_t)i_num * p_index->i_tracks * sizeof(*p_times) );
+    if( !p_times )
+        return false;
+    p_index->p_times = p_times;
+
+    uint64_t *pi_pos = realloc( p_index->pi_pos, (size_t)i_num * sizeof(*pi_pos) );
+    if( !pi_pos )
+        return false;
+    p_index->pi_pos = pi_pos;
+
+    p_index->i_alloc = i_num;
+    return true;
+}
+
 mp4_fragments_index_t * MP4_Fragments_Index_New( unsigned i_tracks, unsigned i_num )
 {
-    if( !i_tracks || !i_num || SIZE_MAX / i_num < i_tracks )
+    if( !i_tracks || !i_num )
         return NULL;
     mp4_fragments_index_t *p_index = malloc( sizeof(*p_index) );
     if( p_index )
     {
-        p_index->p_times = calloc( (size_t)i_num * i_tracks, sizeof(*p_index->p_times) );
-        p_index->pi_pos = calloc( i_num, sizeof(*p_index->pi_pos) );
-        if( !p_index->p_times || !p_index->pi_pos )
+        vlc_mutex_init( &p_index->lock );
+        vlc_cond_init( &p_index->wait );
+        p_index->b_complete = false;
+        p_index->p_times = NULL;
+        p_index->pi_pos = NULL;
+        p_index->i_entries = 0;
+        p_index->i_last_time = 0;
+        p_index->i_tracks = i_tracks;
+        if( !MP4_Fragments_Index_Grow( p_index, i_num ) )
         {
             MP4_Fragments_Index_Delete( p_index );
             return NULL;
         }
-        p_index->i_entries = i_num;
-        p_index->i_last_time = 0;
-        p_index->i_tracks = i_tracks;
     }
     return p_index;
 }
 
-stime_t MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
-                                              unsigned i_track_index, uint64_t i_moof_pos )
+bool MP4_Fragments_Index_Add( mp4_fragments_index_t *p_index, uint64_t i_pos,
+                              const stime_t *p_times, stime_t i_end_time )
 {
-    for( size_t i=0; i<p_index->i_entries; i++ )
+    bool b_ret = true;
+
+    vlc_mutex_lock( &p_index->lock );
+    if( p_index->i_entries == p_index->i_alloc )
     {
-        if( p_index->pi_pos[i] >= i_moof_pos )
-            return p_index->p_times[i * p_index->i_tracks + i_track_index];
+        if( p_index->i_alloc > UINT_MAX / 2 )
+            b_ret = false;
+        else
+            b_ret = MP4_Fragments_Index_Grow( p_index, p_index->i_alloc * 2 );
     }
-    return 0;
+
+    if( b_ret )
+    {
+        memcpy( &p_index->p_times[(size_t)p_index->i_entries * p_index->i_tracks],
+                p_times, p_index->i_tracks * sizeof(*p_times) );
+        p_index->pi_pos[p_index->i_entries++] = i_pos;
+        if( p_index->i_last_time < i_end_time )
+            p_index->i_last_time = i_end_time;
+        vlc_cond_broadcast( &p_index->wait );
+    }
+    vlc_mutex_unlock( &p_index->lock );
+
+    return b_ret;
 }
 
-stime_t MP4_Fragment_Index_GetTracksDuration( const mp4_fragments_index_t *p_index )
+void MP4_Fragments_Index_Complete( mp4_fragments_index_t *p_index )
 {
-    return p_index->i_last_time;
+    vlc_mutex_lock( &p_index->lock );
+    p_index->b_complete = true;
+    vlc_cond_broadcast( &p_index->wait );
+    vlc_mutex_unlock( &p_index->lock );
+}
+
+void MP4_Fragments_Index_Wait( mp4_fragments_index_t *p_index, stime_t i_time )
+{
+    vlc_mutex_lock( &p_index->lock );
+    while( !p_index->b_complete && p_index->i_last_time <= i_time )
+        vlc_cond_wait( &p_index->wait, &p_index->lock );
+    vlc_mutex_unlock( &p_index->lock );
+}
+
+bool MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
+                                           unsigned i_track_index, uint64_t i_moof_pos,
+                                           stime_t *pi_time )
+{
+    vlc_mutex_lock( &p_index->lock );
+
+    /* first fragment at or after the moof */
+    size_t i_low = 0, i_high = p_index->i_entries;
+    while( i_low < i_high )
+    {
+        size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_index->pi_pos[i_mid] < i_moof_pos )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+
+    bool b_found = i_low < p_index->i_entries;
+    if( b_found )
+        *pi_time = p_index->p_times[i_low * p_index->i_tracks + i_track_index];
+
+    vlc_mutex_unlock( &p_index->lock );
+    return b_found;
+}
+
+stime_t MP4_Fragment_Index_GetTracksDuration( mp4_fragments_index_t *p_index )
+{
+    vlc_mutex_lock( &p_index->lock );
+    stime_t i_last_time = p_index->i_last_time;
+    vlc_mutex_unlock( &p_index->lock );
+    return i_last_time;
 }
 
 bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index, stime_t *pi_time,
                                  uint64_t *pi_pos, unsigned i_track_index )
 {
+    vlc_mutex_lock( &p_index->lock );
+
     if( *pi_time >= p_index->i_last_time || p_index->i_entries < 1 ||
         i_track_index >= p_index->i_tracks )
+    {
+        vlc_mutex_unlock( &p_index->lock );
         return false;
+    }
 
-    for( size_t i=1; i<p_index->i_entries; i++ )
+    /* last fragment starting at or before the time, or the first one */
+    size_t i_low = 1, i_high = p_index->i_entries;
+    while( i_low < i_high )
     {
-        if( p_index->p_times[i * p_index->i_tracks + i_track_index] > *pi_time )
-        {
-            *pi_time = p_index->p_times[(i - 1) * p_index->i_tracks + i_track_index];
-            *pi_pos = p_index->pi_pos[i - 1];
-            return true;
-        }
+        size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_index->p_times[i_mid * p_index->i_tracks + i_track_index] > *pi_time )
+            i_high = i_mid;
+        else
+            i_low = i_mid + 1;
     }
 
-    *pi_time = p_index->p_times[(size_t)(p_index->i_entries - 1) * p_index->i_tracks];
-    *pi_pos = p_index->pi_pos[p_index->i_entries - 1];
+    *pi_time = p_index->p_times[(i_low - 1) * p_index->i_tracks + i_track_index];
+    *pi_pos = p_index->pi_pos[i_low - 1];
+
+    vlc_mutex_unlock( &p_index->lock );
     return true;
 }
 
@@ -108,9 +201,10 @@ static inline int64_t movietime_to_ms(stime_t time, uint32_t i_movie_timescale)
     return q * INT64_C( 1000 ) + r * INT64_C( 1000 ) / i_movie_timescale;
 }
 
-void MP4_Fragments_Index_Dump( vlc_object_t *p_obj, const mp4_fragments_index_t *p_index,
+void MP4_Fragments_Index_Dump( vlc_object_t *p_obj, mp4_fragments_index_t *p_index,
                                uint32_t i_movie_timescale )
 {
+    vlc_mutex_lock( &p_index->lock );
     for( size_t i=0; i<p_index->i_entries; i++ )
     {
         char *psz_starts = NULL;
@@ -139,5 +233,6 @@ void MP4_Fragments_Index_Dump( vlc_object_t *p_obj, const mp4_fragments_index_t
 
         free( psz_starts );
     }
+    vlc_mutex_unlock( &p_index->lock );
 }
 #endif
@@ -21,13 +21,21 @@
 #define VLC_MP4_FRAGMENTS_H_
 
 #include <vlc_common.h>
+#include <vlc_threads.h>
 #include "libmp4.h"
 
+/* Fragments are appended in file order, so that both the positions and the
+ * per track times are sorted. The index can be filled by another thread
+ * while it is being looked up. */
 typedef struct mp4_fragments_index_t
 {
+    vlc_mutex_t lock;
+    vlc_cond_t  wait;
+    bool     b_complete;
     uint64_t *pi_pos;
     stime_t  *p_times; // movie scaled
     unsigned i_entries;
+    unsigned i_alloc;
     stime_t i_last_time; // movie scaled
     unsigned i_tracks;
 } mp4_fragments_index_t;
@@ -35,15 +43,23 @@ typedef struct mp4_fragments_index_t
 void MP4_Fragments_Index_Delete( mp4_fragments_index_t *p_index );
 mp4_fragments_index_t * MP4_Fragments_Index_New( unsigned i_tracks, unsigned i_num );
 
-stime_t MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
-                                              unsigned i_track_index, uint64_t i_moof_pos );
-stime_t MP4_Fragment_Index_GetTracksDuration( const mp4_fragments_index_t *p_index );
+/* p_times are the start times of each track, i_end_time is the fragment end */
+bool MP4_Fragments_Index_Add( mp4_fragments_index_t *p_index, uint64_t i_pos,
+                              const stime_t *p_times, stime_t i_end_time );
+void MP4_Fragments_Index_Complete( mp4_fragments_index_t *p_index );
+/* waits until the time is indexed or the index is complete */
+void MP4_Fragments_Index_Wait( mp4_fragments_index_t *p_index, stime_t i_time );
+
+bool MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
+                                           unsigned i_track_index, uint64_t i_moof_pos,
+                                           stime_t *pi_time );
+stime_t MP4_Fragment_Index_GetTracksDuration( mp4_fragments_index_t *p_index );
 
 bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index,
                                  stime_t *pi_time, uint64_t *pi_pos, unsigned i_track_index );
 
 #ifdef MP4_VERBOSE
-void MP4_Fragments_Index_Dump( vlc_object_t *p_obj, const mp4_fragments_index_t *p_index,
+void MP4_Fragments_Index_Dump( vlc_object_t *p_obj, mp4_fragments_index_t *p_index,
                                 uint32_t i_movie_timescale );
 #endif
 
@@ -4502,7 +4502,7 @@ static int MP4_ReadBox_tfra( stream_t *p_stream, MP4_Box_t *p_box )
         READ_VARIABLE_LENGTH(p_tfra->i_length_size_of_sample_num, p_tfra->p_sample_number);
     }
     if ( i < i_number_of_entries )
-        i_number_of_entries = i;
+        i_number_of_entries = p_tfra->i_number_of_entries = i;
 
     FIX_VARIABLE_LENGTH(p_tfra->i_length_size_of_traf_num);
     FIX_VARIABLE_LENGTH(p_tfra->i_length_size_of_trun_num);
@@ -40,6 +40,7 @@
 #include <assert.h>
 #include <limits.h>
 #include <math.h>
+#include <stdatomic.h>
 #include "meta.h"
 #include "attachments.h"
 #include "heif.h"
@@ -72,6 +73,17 @@ vlc_module_begin ()
     set_shortname( N_("MP4") )
     set_capability( "demux", 240 )
     set_callbacks( Open, Close )
+    add_signature( 4, "ftyp" )
+    add_signature( 4, "moov" )
+    add_signature( 4, "foov" )
+    add_signature( 4, "moof" )
+    add_signature( 4, "mdat" )
+    add_signature( 4, "udta" )
+    add_signature( 4, "free" )
+    add_signature( 4, "skip" )
+    add_signature( 4, "wide" )
+    add_signature( 4, "uuid" )
+    add_signature( 4, "pnot" )
     add_file_extension("m4a")
     add_file_extension("m4v")
     add_file_extension("moov")
@@ -161,6 +173,19 @@ typedef struct
     } hacks;
 
     mp4_fragments_index_t *p_fragsindex;
+    mp4_fragments_index_t *p_sidxindex; /* flattened sidx, movie scaled */
+    bool                   b_sidx_probed;
+
+    /* builds p_fragsindex from a second stream while playing */
+    struct
+    {
+        vlc_thread_t thread;
+        stream_t    *s;
+        stime_t     *pi_track_times;
+        atomic_bool  b_stop;
+        atomic_bool  b_done;
+        bool         b_running;
+    } indexer;
 
     ssize_t i_attachments;
     input_attachment_t **pp_attachments;
@@ -206,6 +231,9 @@ static stime_t GetMoovTrackDuration( demux_sys_t *p_sys, unsigned i_track_ID );
 
 static int  ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented );
 static int  ProbeFragmentsChecked( demux_t *p_demux );
+static void FragIndexerStart( demux_t *p_demux );
+static void FragIndexerJoin( demux_t *p_demux, bool b_abort );
+static void FragIndexerPoll( demux_t *p_demux );
 static int  ProbeIndex( demux_t *p_demux );
 
 static int FragCreateTrunIndex( demux_t *, MP4_Box_t *, MP4_Box_t *, stime_t );
@@ -476,33 +504,6 @@ static es_out_id_t * MP4_CreateES( es_out_t *out, const es_format_t *p_fmt,
     return p_es;
 }
 
-static int MP4_ChunkAllocEntries( size_t entries, uint32_t *smallbuf,
-                                  uint32_t **dst0, uint32_t **dst1 )
-{
-    uint32_t *buf;
-
-    if( entries > MP4_CHUNK_SMALLBUF_ENTRIES )
-    {
-        buf = calloc( entries, sizeof( buf[0] ) * 2 );
-        if( unlikely(buf == NULL) )
-            return VLC_ENOMEM;
-    }
-    else buf = smallbuf;
-
-    *dst0 = buf;
-    *dst1 = &buf[entries];
-
-    return VLC_SUCCESS;
-}
-
-static void MP4_ChunkDestroy( mp4_chunk_t *ck )
-{
-    if( ck->p_sample_count_dts != ck->small_dts_buf )
-        free( ck->p_sample_count_dts );
-    if( ck->p_sample_count_pts != ck->small_pts_buf )
-        free( ck->p_sample_count_pts );
-}
-
 static stime_t MP4_MapTrackTimeIntoTimeline( const mp4_track_t *p_track,
                                              uint32_t i_movie_timescale,
                                              stime_t i_time )
@@ -549,42 +550,51 @@ static stime_t MP4_MapMediaTimelineToTrackTime( const mp4_track_t *p_track,
     return i_time;
 }
 
-static stime_t MP4_ChunkGetSampleDTS( const mp4_chunk_t *p_chunk,
+static stime_t MP4_ChunkGetSampleDTS( const mp4_track_t *p_track,
+                                      const mp4_chunk_t *p_chunk,
                                       uint32_t i_sample )
 {
-    uint32_t i_index = 0;
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
+    uint32_t i_index = p_chunk->i_dts_index;
+    uint32_t i_skip = p_chunk->i_dts_skip;
     stime_t sdts = p_chunk->i_first_dts;
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
+    while( i_sample > 0 && i_index < stts->i_entry_count )
     {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
+        uint32_t i_count = stts->pi_sample_count[i_index] - i_skip;
+        if( i_sample > i_count )
         {
-            sdts += (stime_t)p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index++];
+            sdts += (stime_t)i_count * stts->pi_sample_delta[i_index++];
+            i_sample -= i_count;
+            i_skip = 0;
         }
         else
         {
-            sdts += (stime_t)i_sample * p_chunk->p_sample_delta_dts[i_index];
+            sdts += (stime_t)i_sample * stts->pi_sample_delta[i_index];
             break;
         }
     }
     return sdts;
 }
 
-static bool MP4_ChunkGetSampleCTSDelta( const mp4_chunk_t *p_chunk,
+static bool MP4_ChunkGetSampleCTSDelta( const mp4_track_t *p_track,
+                                        const mp4_chunk_t *p_chunk,
                                         uint32_t i_sample, stime_t *pi_delta )
 {
-    if( p_chunk->p_sample_count_pts && p_chunk->p_sample_offset_pts )
+    const MP4_Box_data_ctts_t *ctts = p_track->p_ctts;
+    if( ctts == NULL )
+        return false;
+
+    i_sample += p_chunk->i_pts_skip;
+    for( uint32_t i_index = p_chunk->i_pts_index;
+         i_index < ctts->i_entry_count; i_index++ )
     {
-        for( uint32_t i_index = 0; i_index < p_chunk->i_entries_pts ; i_index++ )
+        if( i_sample < ctts->pi_sample_count[i_index] )
         {
-            if( i_sample < p_chunk->p_sample_count_pts[i_index] )
-            {
-                *pi_delta = p_chunk->p_sample_offset_pts[i_index];
-                return true;
-            }
-            i_sample -= p_chunk->p_sample_count_pts[i_index];
+            int64_t i_ctsdelta = ctts->pi_sample_offset[i_index] + p_track->i_cts_shift;
+            *pi_delta = i_ctsdelta < 0 ? 0 : i_ctsdelta; /* should not */
+            return true;
         }
+        i_sample -= ctts->pi_sample_count[i_index];
     }
     return false;
 }
@@ -625,44 +635,53 @@ static vlc_tick_t MP4_TrackGetDTSPTS( demux_t *p_demux, const mp4_track_t *p_tra
     return i_dts;
 }
 
-static stime_t MP4_GetChunkSamplesDuration( const mp4_chunk_t *p_chunk,
+static stime_t MP4_GetChunkSamplesDuration( const mp4_track_t *p_track,
+                                            const mp4_chunk_t *p_chunk,
                                             uint32_t i_start_sample,
                                             uint32_t i_nb_samples )
 {
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
     stime_t i_duration = 0;
 
+    /* Only account for the samples of the chunk */
+    uint32_t i_skip = i_start_sample - p_chunk->i_sample_first;
+    if( i_skip >= p_chunk->i_sample_count )
+        return 0;
+    if( i_nb_samples > p_chunk->i_sample_count - i_skip )
+        i_nb_samples = p_chunk->i_sample_count - i_skip;
+
     /* Forward to right index, and set remaining count in that index */
-    uint32_t i_index = 0;
-    uint32_t i_remain = 0;
-    for( uint32_t i = p_chunk->i_sample_first;
-         i<i_start_sample && i_index < p_chunk->i_entries_dts; )
+    uint32_t i_index = p_chunk->i_dts_index;
+    uint32_t i_remain = p_chunk->i_dts_skip;
+    while( i_skip > 0 && i_index < stts->i_entry_count )
     {
-        if( i_start_sample - i >= p_chunk->p_sample_count_dts[i_index] )
+        if( i_skip >= stts->pi_sample_count[i_index] - i_remain )
         {
-            i += p_chunk->p_sample_count_dts[i_index];
+            i_skip -= stts->pi_sample_count[i_index] - i_remain;
             i_index++;
+            i_remain = 0;
         }
         else
         {
-            i_remain = i_start_sample - i;
+            i_remain += i_skip;
             break;
         }
     }
 
     /* Compute total duration from all samples from index */
-    while( i_nb_samples > 0 && i_index < p_chunk->i_entries_dts )
+    while( i_nb_samples > 0 && i_index < stts->i_entry_count )
     {
-        if( i_nb_samples >= p_chunk->p_sample_count_dts[i_index] - i_remain )
+        if( i_nb_samples >= stts->pi_sample_count[i_index] - i_remain )
         {
-            i_duration += (p_chunk->p_sample_count_dts[i_index] - i_remain) *
-                          (int64_t) p_chunk->p_sample_delta_dts[i_index];
-            i_nb_samples -= (p_chunk->p_sample_count_dts[i_index] - i_remain);
+            i_duration += (stts->pi_sample_count[i_index] - i_remain) *
+                          (int64_t) stts->pi_sample_delta[i_index];
+            i_nb_samples -= (stts->pi_sample_count[i_index] - i_remain);
             i_index++;
             i_remain = 0;
         }
         else
         {
-            i_duration += (stime_t)i_nb_samples * p_chunk->p_sample_delta_dts[i_index];
+            i_duration += (stime_t)i_nb_samples * stts->pi_sample_delta[i_index];
             break;
         }
     }
@@ -673,7 +692,8 @@ static stime_t MP4_GetChunkSamplesDuration( const mp4_chunk_t *p_chunk,
 static inline vlc_tick_t MP4_GetSamplesDuration( const mp4_track_t *p_track,
                                                  uint32_t i_nb_samples )
 {
-    stime_t i_duration = MP4_GetChunkSamplesDuration( &p_track->chunk[p_track->i_chunk],
+    const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
+    stime_t i_duration = MP4_GetChunkSamplesDuration( p_track, p_chunk,
                                                       p_track->i_sample,
                                                       i_nb_samples );
     return MP4_rescale_mtime( i_duration, p_track->i_timescale );
@@ -1396,11 +1416,16 @@ static int Open( vlc_object_t * p_this )
 
         if ( p_sys->b_seekable )
         {
+            if( !p_sidx )
+                FragIndexerStart( p_demux );
+
             if( !p_sys->b_fragmented /* as unknown */ )
             {
                 /* Probe remaining to check if there's really fragments
                    or if that file is just ready to append fragments */
                 ProbeFragments( p_demux, (p_sys->i_duration == 0), &p_sys->b_fragmented );
+                if( !p_sys->b_fragmented )
+                    FragIndexerJoin( p_demux, true );
             }
 
             if( vlc_stream_Seek( p_demux->s, p_sys->p_moov->i_pos ) != VLC_SUCCESS )
@@ -2110,8 +2135,13 @@ static int FragSeekToTime( demux_t *p_demux, vlc_tick_t i_nztime, bool b_accurat
     stime_t  i_segment_time = INVALID_SEGMENT_TIME;
     vlc_tick_t i_sync_time = i_nztime;
 
+    FragIndexerPoll( p_demux );
+
+    /* Without a duration, the fragments indexed so far tell whether the
+     * target exists: the lookup below only waits for it to be indexed */
     const uint64_t i_duration = __MAX(p_sys->i_duration, p_sys->i_cumulated_duration);
-    if ( !p_sys->i_timescale || !i_duration || !p_sys->b_seekable )
+    if ( !p_sys->i_timescale || !p_sys->b_seekable ||
+         (!i_duration && !p_sys->indexer.b_running) )
          return VLC_EGENERIC;
 
     uint64_t i_backup_pos = vlc_stream_Tell( p_demux->s );
@@ -2139,10 +2169,18 @@ static int FragSeekToTime( demux_t *p_demux, vlc_tick_t i_nztime, bool b_accurat
     }
     else
     {
+        bool b_sync_point = false;
         if( FragGetMoofByTfraIndex( p_demux, i_nztime, i_seek_track_ID, &i64, &i_sync_time ) == VLC_SUCCESS )
         {
             /* Does only provide segment position and a sync sample time */
             msg_Dbg( p_demux, "seeking to sync point %" PRId64, i_sync_time );
+            b_sync_point = true;
+        }
+        else if( p_sys->indexer.b_running )
+        {
+            /* Only waits for the fragments up to the target */
+            MP4_Fragments_Index_Wait( p_sys->p_fragsindex,
+                                      MP4_rescale_qtime( i_sync_time, p_sys->i_timescale ) );
         }
         else if( !p_sys->b_fragments_probed )
         {
@@ -2151,7 +2189,8 @@ static int FragSeekToTime( demux_t *p_demux, vlc_tick_t i_nztime, bool b_accurat
                 return i_ret;
         }
 
-        if( p_sys->b_fragments_probed && p_sys->p_fragsindex )
+        if( p_sys->p_fragsindex && (p_sys->b_fragments_probed ||
+                                    (p_sys->indexer.b_running && !b_sync_point)) )
         {
             stime_t i_basetime = MP4_rescale_qtime( i_sync_time, p_sys->i_timescale );
             if( !MP4_Fragments_Index_Lookup( p_sys->p_fragsindex, &i_basetime, &i64, i_seek_track_index ) )
@@ -2230,6 +2269,12 @@ static int FragSeekToPos( demux_t *p_demux, double f, bool b_accurate )
         return VLC_EGENERIC;
 
     uint64_t i_duration = __MAX(p_sys->i_duration, p_sys->i_cumulated_duration);
+    if( !i_duration && p_sys->indexer.b_running )
+    {
+        /* A position needs the total duration: index all the fragments */
+        FragIndexerJoin( p_demux, false );
+        i_duration = __MAX(p_sys->i_duration, p_sys->i_cumulated_duration);
+    }
     if( !i_duration && !p_sys->b_fragments_probed )
     {
         int i_ret = ProbeFragmentsChecked( p_demux );
@@ -2488,6 +2533,8 @@ static void Close ( vlc_object_t * p_this )
 
     msg_Dbg( p_demux, "freeing all memory" );
 
+    FragIndexerJoin( p_demux, true );
+
     FragResetContext( p_sys );
 
     MP4_BoxFree( p_sys->p_root );
@@ -2499,6 +2546,7 @@ static void Close ( vlc_object_t * p_this )
         vlc_meta_Delete( p_sys->p_meta );
 
     MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
+    MP4_Fragments_Index_Delete( p_sys->p_sidxindex );
 
     for( i_track = 0; i_track < p_sys->i_tracks; i_track++ )
         MP4_TrackClean( p_demux->out, &p_sys->track[i_track] );
@@ -2700,12 +2748,10 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
 
         ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
+        ck->i_dts_index = 0;
+        ck->i_dts_skip = 0;
+        ck->i_pts_index = 0;
+        ck->i_pts_skip = 0;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2767,52 +2813,32 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
+/* Walk a run-length encoded table (stts or ctts) over i_sample_count samples
+ * from the given entry and count of samples of that entry already seen */
+static uint32_t xTTS_Skip( uint32_t *pi_index, uint32_t *pi_skip,
+                           uint32_t i_sample_count,
+                           const uint32_t *pi_index_sample_count,
+                           uint32_t i_table_count,
+                           const uint32_t *pi_index_sample_delta,
+                           int64_t *pi_duration )
 {
-    uint32_t i_array_offset;
-    while( i_sample_count > 0 )
+    while( i_sample_count > 0 && *pi_index < i_table_count )
     {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
-
-        if ( i_array_offset >= i_table_count )
-        {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_EINVAL;
-        }
+        uint32_t i_left = pi_index_sample_count[*pi_index] - *pi_skip;
+        uint32_t i_count = __MIN( i_left, i_sample_count );
 
-        if ( i_index_samples_left )
+        if( pi_index_sample_delta != NULL )
+            *pi_duration += (int64_t)i_count * pi_index_sample_delta[*pi_index];
+        i_sample_count -= i_count;
+        if( i_count == i_left )
         {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
+            *pi_index += 1;
+            *pi_skip = 0;
         }
         else
-        {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
-        }
+            *pi_skip += i_count;
     }
-
-    return VLC_SUCCESS;
+    return i_sample_count; /* samples beyond the table */
 }
 
 static int TrackCreateSamplesIndex( demux_t *p_demux,
@@ -2852,18 +2878,12 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size, the table is kept
+         *    along with the boxes */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
+        p_demux_track->p_sample_size = stsz->i_entry_size;
         if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+            return VLC_EGENERIC;
     }
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
@@ -2876,122 +2896,52 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
         }
     }
 
-    /* Use stts table to create a sample number -> dts table.
+    /* Use stts table to compute the dts of the first sample of each chunk.
      * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
+     *  the box! so each chunk only records where its samples start in the
+     *  table (problem with raw stream where a sample is sometime just
+     *  channels*bits_per_sample/8) */
 
     int64_t i_next_dts = 0;
     /* Find stts
      *  Gives mapping between sample and decoding time
      */
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "stts" );
-    if( !p_box )
+    if( !p_box || !p_box->data.p_stts )
     {
         msg_Warn( p_demux, "cannot find STTS box" );
         return VLC_EGENERIC;
     }
     else
     {
-        MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        const MP4_Box_data_stts_t *stts = p_box->data.p_stts;
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
+        p_demux_track->p_stts = stts;
 
-        /* Create sample -> dts table per chunk */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
+        bool b_truncated = false;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
 
             /* save first dts */
             ck->i_first_dts = i_next_dts;
+            ck->i_dts_index = i_index;
+            ck->i_dts_skip = i_skip;
 
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            i_ret = MP4_ChunkAllocEntries( ck->i_entries_dts,
-                                           ck->small_dts_buf,
-                                           &ck->p_sample_count_dts,
-                                           &ck->p_sample_delta_dts );
-            if( i_ret )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return i_ret;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
-            }
+            if( xTTS_Skip( &i_index, &i_skip, ck->i_sample_count,
+                           stts->pi_sample_count, stts->i_entry_count,
+                           stts->pi_sample_delta, &i_next_dts ) )
+                b_truncated = true;
+            ck->i_duration = i_next_dts - ck->i_first_dts;
         }
+
+        if( b_truncated )
+            msg_Err( p_demux, "invalid index counting total samples %"PRIu32,
+                     stts->i_entry_count );
     }
 
 
@@ -3001,9 +2951,10 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "ctts" );
     if( p_box && p_box->data.p_ctts )
     {
-        MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
+        const MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
 
         msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
+        p_demux_track->p_ctts = ctts;
 
         int64_t i_cts_shift = 0;
         const MP4_Box_t *p_cslg = MP4_BoxGet( p_demux_track->p_stbl, "cslg" );
@@ -3021,83 +2972,18 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
         }
         p_demux_track->i_cts_shift = i_cts_shift;
 
-        /* Create pts-dts table per chunk */
+        /* Locate the first sample of each chunk in the pts-dts table */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            i_ret = MP4_ChunkAllocEntries( ck->i_entries_pts,
-                                           ck->small_pts_buf,
-                                           &ck->p_sample_count_pts,
-                                           &ck->p_sample_offset_pts );
-            if( i_ret )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return i_ret;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
 
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
-            {
-                int64_t i_ctsdelta = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                if( i_ctsdelta < 0 ) /* should not */
-                    i_ctsdelta = 0;
-                ck->p_sample_offset_pts[i] = i_ctsdelta;
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-            }
+            ck->i_pts_index = i_index;
+            ck->i_pts_skip = i_skip;
+            xTTS_Skip( &i_index, &i_skip, ck->i_sample_count,
+                       ctts->pi_sample_count, ctts->i_entry_count, NULL, NULL );
         }
     }
 
@@ -3496,24 +3382,33 @@ static int STTSToSampleChunk(const mp4_track_t *p_track, uint64_t i_dts,
     }
 
     /* *** find sample in the chunk *** */
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
     uint32_t i_sample = ck->i_sample_first;
     uint64_t i_entrydts = ck->i_first_dts;
+    uint32_t i_skip = ck->i_dts_skip;
 
-    for( uint_fast32_t i = 0;
-         i < ck->i_entries_dts && i_sample < ck->i_sample_count;
+    for( uint_fast32_t i = ck->i_dts_index;
+         i < stts->i_entry_count && i_sample < ck->i_sample_count;
          i++ )
     {
-        uint64_t i_entry_duration = ck->p_sample_count_dts[i] * (uint64_t)
-                                    ck->p_sample_delta_dts[i];
+        /* only the samples of the entry which are in the chunk */
+        uint32_t i_count = stts->pi_sample_count[i] - i_skip;
+        uint32_t i_chunk_left = ck->i_sample_first + ck->i_sample_count - i_sample;
+        if( i_count > i_chunk_left )
+            i_count = i_chunk_left;
+        i_skip = 0;
+
+        uint64_t i_entry_duration = i_count * (uint64_t)
+                                    stts->pi_sample_delta[i];
         if( i_entrydts + i_entry_duration < i_dts )
         {
             i_entrydts += i_entry_duration;
-            i_sample += ck->p_sample_count_dts[i];
+            i_sample += i_count;
         }
         else
         {
-            if( ck->p_sample_delta_dts[i] > 0 )
-                i_sample += ( i_dts - i_entrydts ) / ck->p_sample_delta_dts[i];
+            if( stts->pi_sample_delta[i] > 0 )
+                i_sample += ( i_dts - i_entrydts ) / stts->pi_sample_delta[i];
             break;
         }
     }
@@ -3758,7 +3653,8 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
 
     /* Probe the 16 first B frames */
     uint32_t i_chunk = p_track->i_chunk;
-    if( !p_track->chunk[i_chunk].i_entries_pts )
+    if( !p_track->p_ctts ||
+        p_track->chunk[i_chunk].i_pts_index >= p_track->p_ctts->i_entry_count )
         return;
 
     stime_t lowest = p_track->i_start_dts;
@@ -3781,9 +3677,11 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
             break;
         assert(i_nextsample >= ck->i_sample_first);
         stime_t pts;
-        stime_t dts = pts = MP4_ChunkGetSampleDTS( ck, i_nextsample - ck->i_sample_first );
+        stime_t dts = pts = MP4_ChunkGetSampleDTS( p_track, ck,
+                                                   i_nextsample - ck->i_sample_first );
         stime_t delta = UNKNOWN_DELTA;
-        if( MP4_ChunkGetSampleCTSDelta( ck, i_nextsample - ck->i_sample_first, &delta ) )
+        if( MP4_ChunkGetSampleCTSDelta( p_track, ck,
+                                        i_nextsample - ck->i_sample_first, &delta ) )
             pts += delta;
         if( pts < lowest )
         {
@@ -3799,9 +3697,9 @@ static void TrackUpdateSampleAndTimes( mp4_track_t *p_track )
     uint32_t i_chunk_sample = p_track->i_sample - p_chunk->i_sample_first;
     if( i_chunk_sample > p_chunk->i_sample_count && p_chunk->i_sample_count )
         i_chunk_sample = p_chunk->i_sample_count - 1;
-    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_chunk, i_chunk_sample );
+    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_track, p_chunk, i_chunk_sample );
     stime_t i_next_delta;
-    if( !MP4_ChunkGetSampleCTSDelta( p_chunk, i_chunk_sample, &i_next_delta ) )
+    if( !MP4_ChunkGetSampleCTSDelta( p_track, p_chunk, i_chunk_sample, &i_next_delta ) )
         p_track->i_next_delta = UNKNOWN_DELTA;
     else
         p_track->i_next_delta = i_next_delta;
@@ -4107,16 +4005,8 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            MP4_ChunkDestroy( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
-
     ASFPacketTrackReset( &p_track->asfinfo );
 
     free( p_track->context.runs.p_array );
@@ -4829,6 +4719,166 @@ static bool GetMoofTrackDuration( MP4_Box_t *p_moov, MP4_Box_t *p_moof,
     return false;
 }
 
+/* Adds a moof to the fragments index.
+ * pi_track_times holds the tracks times at the end of the previous moof,
+ * followed by i_tracks scratch entries. */
+static bool FragIndexMoof( demux_sys_t *p_sys, MP4_Box_t *p_moof,
+                           stime_t *pi_track_times, bool b_first )
+{
+    stime_t *pi_start_times = &pi_track_times[p_sys->i_tracks];
+    stime_t i_end_time = 0;
+
+    for( unsigned i=0; i<p_sys->i_tracks; i++ )
+    {
+        MP4_Box_t *p_tfdt = NULL;
+        MP4_Box_t *p_traf = MP4_GetTrafByTrackID( p_moof, p_sys->track[i].i_track_ID );
+        if( p_traf )
+            p_tfdt = MP4_BoxGet( p_traf, "tfdt" );
+
+        if( p_tfdt && BOXDATA(p_tfdt) )
+        {
+            pi_track_times[i] = p_tfdt->data.p_tfdt->i_base_media_decode_time;
+        }
+        else if( b_first ) /* Set first fragment time offset from moov */
+        {
+            stime_t i_duration = GetMoovTrackDuration( p_sys, p_sys->track[i].i_track_ID );
+            pi_track_times[i] = MP4_rescale( i_duration, p_sys->i_timescale, p_sys->track[i].i_timescale );
+        }
+
+        pi_start_times[i] = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
+
+        stime_t i_duration = 0;
+        if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
+            pi_track_times[i] += i_duration;
+
+        stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
+        if( i_end_time < i_movietime )
+            i_end_time = i_movietime;
+    }
+
+    return MP4_Fragments_Index_Add( p_sys->p_fragsindex, p_moof->i_pos,
+                                    pi_start_times, i_end_time );
+}
+
+static void *FragIndexerThread( void *data )
+{
+    demux_t *p_demux = data;
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const uint32_t stoplist[] = { ATOM_moof, 0 };
+    bool b_first = true;
+
+    vlc_thread_set_name( "vlc-mp4-index" );
+
+    while( !atomic_load_explicit( &p_sys->indexer.b_stop, memory_order_relaxed ) )
+    {
+        MP4_Box_t *p_vroot = MP4_BoxNew( ATOM_root );
+        if( !p_vroot )
+            break;
+
+        /* Only reads up to the next moof */
+        MP4_ReadBoxContainerChildren( p_sys->indexer.s, p_vroot, stoplist );
+
+        MP4_Box_t *p_moof = p_vroot->p_last;
+        bool b_continue = p_moof && p_moof->i_type == ATOM_moof &&
+                          FragIndexMoof( p_sys, p_moof, p_sys->indexer.pi_track_times, b_first );
+        b_first = false;
+
+        MP4_BoxFree( p_vroot );
+        if( !b_continue )
+            break;
+    }
+
+    MP4_Fragments_Index_Complete( p_sys->p_fragsindex );
+    atomic_store_explicit( &p_sys->indexer.b_done, true, memory_order_release );
+    return NULL;
+}
+
+static void FragIndexerStart( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->b_fastseekable || p_sys->b_fragments_probed || !p_demux->psz_url ||
+        p_sys->indexer.b_running || p_demux->b_preparsing )
+        return;
+
+    /* The demux stream can't be shared, read the fragments from another one */
+    stream_t *s = vlc_stream_NewURL( p_demux, p_demux->psz_url );
+    if( !s )
+        return;
+
+    if( vlc_stream_Seek( s, p_sys->p_moov->i_pos + p_sys->p_moov->i_size ) != VLC_SUCCESS )
+        goto error;
+
+    p_sys->indexer.pi_track_times = calloc( 2 * p_sys->i_tracks, sizeof(stime_t) );
+    if( !p_sys->indexer.pi_track_times )
+        goto error;
+
+    p_sys->p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, 64 );
+    if( !p_sys->p_fragsindex )
+        goto error;
+
+    p_sys->indexer.s = s;
+    atomic_init( &p_sys->indexer.b_stop, false );
+    atomic_init( &p_sys->indexer.b_done, false );
+    if( vlc_clone( &p_sys->indexer.thread, FragIndexerThread, p_demux ) )
+        goto error;
+
+    p_sys->indexer.b_running = true;
+    msg_Dbg( p_demux, "indexing fragments in background" );
+    return;
+
+error:
+    MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
+    p_sys->p_fragsindex = NULL;
+    free( p_sys->indexer.pi_track_times );
+    p_sys->indexer.pi_track_times = NULL;
+    vlc_stream_Delete( s );
+}
+
+static void FragIndexerJoin( demux_t *p_demux, bool b_abort )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->indexer.b_running )
+        return;
+
+    if( b_abort )
+        atomic_store_explicit( &p_sys->indexer.b_stop, true, memory_order_relaxed );
+    vlc_join( p_sys->indexer.thread, NULL );
+
+    vlc_stream_Delete( p_sys->indexer.s );
+    free( p_sys->indexer.pi_track_times );
+    p_sys->indexer.pi_track_times = NULL;
+    p_sys->indexer.b_running = false;
+
+    if( b_abort || p_sys->p_fragsindex->i_entries == 0 )
+    {
+        MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
+        p_sys->p_fragsindex = NULL;
+        if( b_abort )
+            return;
+    }
+
+    p_sys->b_fragments_probed = true;
+    msg_Dbg( p_demux, "fragments indexed" );
+#ifdef MP4_VERBOSE
+    if( p_sys->p_fragsindex )
+        MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
+#endif
+
+    if( !MP4_BoxGet( p_sys->p_moov, "mvex/mehd" ) )
+        p_sys->i_cumulated_duration = GetCumulatedDuration( p_demux );
+}
+
+static void FragIndexerPoll( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_sys->indexer.b_running &&
+        atomic_load_explicit( &p_sys->indexer.b_done, memory_order_acquire ) )
+        FragIndexerJoin( p_demux, false );
+}
+
 static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -4841,7 +4891,8 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
     if( !p_vroot )
         return VLC_EGENERIC;
 
-    if( p_sys->b_seekable && (p_sys->b_fastseekable || b_force) )
+    /* The background indexer reads the rest of the file */
+    if( p_sys->b_seekable && (p_sys->b_fastseekable || b_force) && !p_sys->indexer.b_running )
     {
         MP4_ReadBoxContainerChildren( p_demux->s, p_vroot, NULL ); /* Get the rest of the file */
         p_sys->b_fragments_probed = true;
@@ -4857,7 +4908,7 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
                 return VLC_EGENERIC;
             }
 
-            stime_t *pi_track_times = calloc( p_sys->i_tracks, sizeof(*pi_track_times) );
+            stime_t *pi_track_times = calloc( 2 * p_sys->i_tracks, sizeof(*pi_track_times) );
             if( !pi_track_times )
             {
                 MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
@@ -4866,46 +4917,15 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
                 return VLC_EGENERIC;
             }
 
-            unsigned index = 0;
+            bool b_first = true;
 
             for( MP4_Box_t *p_moof = p_vroot->p_first; p_moof; p_moof = p_moof->p_next )
             {
                 if( p_moof->i_type != ATOM_moof )
                     continue;
 
-                for( unsigned i=0; i<p_sys->i_tracks; i++ )
-                {
-                    MP4_Box_t *p_tfdt = NULL;
-                    MP4_Box_t *p_traf = MP4_GetTrafByTrackID( p_moof, p_sys->track[i].i_track_ID );
-                    if( p_traf )
-                        p_tfdt = MP4_BoxGet( p_traf, "tfdt" );
-
-                    if( p_tfdt && BOXDATA(p_tfdt) )
-                    {
-                        pi_track_times[i] = p_tfdt->data.p_tfdt->i_base_media_decode_time;
-                    }
-                    else if( index == 0 ) /* Set first fragment time offset from moov */
-                    {
-                        stime_t i_duration = GetMoovTrackDuration( p_sys, p_sys->track[i].i_track_ID );
-                        pi_track_times[i] = MP4_rescale( i_duration, p_sys->i_timescale, p_sys->track[i].i_timescale );
-                    }
-
-                    stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                    p_sys->p_fragsindex->p_times[index * p_sys->i_tracks + i] = i_movietime;
-
-                    stime_t i_duration = 0;
-                    if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
-                        pi_track_times[i] += i_duration;
-                }
-
-                p_sys->p_fragsindex->pi_pos[index++] = p_moof->i_pos;
-            }
-
-            for( unsigned i=0; i<p_sys->i_tracks; i++ )
-            {
-                stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                if( p_sys->p_fragsindex->i_last_time < i_movietime )
-                    p_sys->p_fragsindex->i_last_time = i_movietime;
+                FragIndexMoof( p_sys, p_moof, pi_track_times, b_first );
+                b_first = false;
             }
 
             free( pi_track_times );
@@ -4930,8 +4950,10 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
 
     MP4_BoxFree( p_vroot );
 
+    /* The fragments index is partial while the indexer runs: the duration
+     * is computed once it is joined */
     MP4_Box_t *p_mehd = MP4_BoxGet( p_sys->p_moov, "mvex/mehd");
-    if ( !p_mehd )
+    if ( !p_mehd && !p_sys->indexer.b_running )
            p_sys->i_cumulated_duration = GetCumulatedDuration( p_demux );
 
     return VLC_SUCCESS;
@@ -5303,11 +5325,13 @@ static int FragCreateTrunIndex( demux_t *p_demux, MP4_Box_t *p_moof,
             {
                 unsigned i_track_index = (p_track - p_sys->track);
                 assert(&p_sys->track[i_track_index] == p_track);
-                i_traf_start_time = MP4_Fragment_Index_GetTrackStartTime( p_sys->p_fragsindex,
-                                                                          i_track_index, p_moof->i_pos );
-                i_traf_start_time = MP4_rescale( i_traf_start_time,
-                                                 p_sys->i_timescale, p_track->i_timescale );
-                b_has_base_media_decode_time = true;
+                if( MP4_Fragment_Index_GetTrackStartTime( p_sys->p_fragsindex, i_track_index,
+                                                          p_moof->i_pos, &i_traf_start_time ) )
+                {
+                    i_traf_start_time = MP4_rescale( i_traf_start_time,
+                                                     p_sys->i_timescale, p_track->i_timescale );
+                    b_has_base_media_decode_time = true;
+                }
             }
 
             if( !b_has_base_media_decode_time && p_chunksidx )
@@ -5454,40 +5478,123 @@ static int FragCreateTrunIndex( demux_t *p_demux, MP4_Box_t *p_moof,
     return VLC_SUCCESS;
 }
 
-static int FragGetMoofBySidxIndex( demux_t *p_demux, vlc_tick_t target_time,
-                                   uint64_t *pi_moof_pos, vlc_tick_t *pi_sampletime )
+#define SIDX_MAX_DEPTH 8
+
+/* Adds the subsegments to the index, reading the sidx of the hierarchical
+ * references from the stream. i_base_time is the sidx start (movie scaled) */
+static int FragIndexSidx( demux_t *p_demux, mp4_fragments_index_t *p_index,
+                          const MP4_Box_t *p_sidx, stime_t i_base_time, unsigned i_depth )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const MP4_Box_data_sidx_t *p_data = BOXDATA(p_sidx);
+    if( !p_data || !p_data->i_timescale )
+        return VLC_EGENERIC;
+
+    /* sidx refers to offsets from end of sidx pos in the file + first offset */
+    uint64_t i_pos = p_data->i_first_offset + p_sidx->i_pos + p_sidx->i_size;
+    stime_t i_time = 0;
+    for( uint16_t i=0; i<p_data->i_reference_count; i++ )
+    {
+        const MP4_Box_sidx_item_t *p_item = &p_data->p_items[i];
+        stime_t i_start = i_base_time + MP4_rescale( i_time, p_data->i_timescale,
+                                                     p_sys->i_timescale );
+        i_time += p_item->i_subsegment_duration;
+
+        if( p_item->b_reference_type == 0 )
+        {
+            stime_t i_end = i_base_time + MP4_rescale( i_time, p_data->i_timescale,
+                                                       p_sys->i_timescale );
+            if( !MP4_Fragments_Index_Add( p_index, i_pos, &i_start, i_end ) )
+                return VLC_ENOMEM;
+        }
+        else if( i_depth < SIDX_MAX_DEPTH )
+        {
+            /* The subsegment is indexed by another sidx */
+            const uint32_t stoplist[] = { ATOM_sidx, ATOM_moof, ATOM_mdat, 0 };
+            MP4_Box_t *p_vroot = MP4_BoxNew( ATOM_root );
+            if( !p_vroot )
+                return VLC_ENOMEM;
+
+            if( vlc_stream_Seek( p_demux->s, i_pos ) == VLC_SUCCESS )
+                MP4_ReadBoxContainerChildren( p_demux->s, p_vroot, stoplist );
+
+            const MP4_Box_t *p_child = MP4_BoxGet( p_vroot, "sidx" );
+            int i_ret = VLC_EGENERIC;
+            if( p_child )
+                i_ret = FragIndexSidx( p_demux, p_index, p_child, i_start, i_depth + 1 );
+            MP4_BoxFree( p_vroot );
+            if( i_ret != VLC_SUCCESS )
+                return i_ret;
+        }
+
+        i_pos += p_item->i_referenced_size;
+    }
+    return VLC_SUCCESS;
+}
+
+static mp4_fragments_index_t * FragCreateSidxIndex( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
     const MP4_Box_t *p_sidx = MP4_BoxGet( p_sys->p_root, "sidx" );
+    const MP4_Box_data_sidx_t *p_first_data = p_sidx ? BOXDATA(p_sidx) : NULL;
+    if( !p_first_data || !p_first_data->i_timescale )
+        return NULL;
+
+    mp4_fragments_index_t *p_index =
+        MP4_Fragments_Index_New( 1, __MAX(p_first_data->i_reference_count, 1) );
+    if( !p_index )
+        return NULL;
+
     for( ; p_sidx ; p_sidx = p_sidx->p_next )
     {
         if( p_sidx->i_type != ATOM_sidx )
             continue;
 
+        /* Other tracks may have their own index */
         const MP4_Box_data_sidx_t *p_data = BOXDATA(p_sidx);
-        if( !p_data || !p_data->i_timescale )
+        if( !p_data || !p_data->i_timescale ||
+            p_data->i_reference_ID != p_first_data->i_reference_ID ||
+            p_data->i_earliest_presentation_time < p_first_data->i_earliest_presentation_time )
+            continue;
+
+        stime_t i_base_time = MP4_rescale( p_data->i_earliest_presentation_time -
+                                           p_first_data->i_earliest_presentation_time,
+                                           p_data->i_timescale, p_sys->i_timescale );
+        if( FragIndexSidx( p_demux, p_index, p_sidx, i_base_time, 0 ) != VLC_SUCCESS )
             break;
+    }
 
-        stime_t i_target_time = MP4_rescale_qtime( target_time, p_data->i_timescale );
+    if( p_index->i_entries == 0 )
+    {
+        MP4_Fragments_Index_Delete( p_index );
+        return NULL;
+    }
+#ifdef MP4_VERBOSE
+    MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_index, p_sys->i_timescale );
+#endif
+    return p_index;
+}
 
-        /* sidx refers to offsets from end of sidx pos in the file + first offset */
-        uint64_t i_pos = p_data->i_first_offset + p_sidx->i_pos + p_sidx->i_size;
-        stime_t i_time = 0;
-        for( uint16_t i=0; i<p_data->i_reference_count; i++ )
-        {
-            if(p_data->p_items[i].b_reference_type != 0)
-                continue;
-            if( i_time + p_data->p_items[i].i_subsegment_duration > i_target_time )
-            {
-                *pi_sampletime = MP4_rescale_mtime( i_time, p_data->i_timescale );
-                *pi_moof_pos = i_pos;
-                return VLC_SUCCESS;
-            }
-            i_pos += p_data->p_items[i].i_referenced_size;
-            i_time += p_data->p_items[i].i_subsegment_duration;
-        }
+static int FragGetMoofBySidxIndex( demux_t *p_demux, vlc_tick_t target_time,
+                                   uint64_t *pi_moof_pos, vlc_tick_t *pi_sampletime )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->b_sidx_probed )
+    {
+        p_sys->p_sidxindex = FragCreateSidxIndex( p_demux );
+        p_sys->b_sidx_probed = true;
     }
-    return VLC_EGENERIC;
+
+    if( !p_sys->p_sidxindex )
+        return VLC_EGENERIC;
+
+    stime_t i_time = MP4_rescale_qtime( target_time, p_sys->i_timescale );
+    if( !MP4_Fragments_Index_Lookup( p_sys->p_sidxindex, &i_time, pi_moof_pos, 0 ) )
+        return VLC_EGENERIC;
+
+    *pi_sampletime = MP4_rescale_mtime( i_time, p_sys->i_timescale );
+    return VLC_SUCCESS;
 }
 
 static int FragGetMoofByTfraIndex( demux_t *p_demux, const vlc_tick_t i_target_time, unsigned i_track_ID,
@@ -5503,28 +5610,28 @@ static int FragGetMoofByTfraIndex( demux_t *p_demux, const vlc_tick_t i_target_t
             if( !p_data || p_data->i_track_ID != i_track_ID )
                 continue;
 
-            uint64_t i_pos = 0;
             mp4_track_t *p_track = MP4_GetTrackByTrackID( p_demux, p_data->i_track_ID );
             if ( p_track )
             {
                 stime_t i_track_target_time = MP4_rescale_qtime( i_target_time, p_track->i_timescale );
-                for ( uint32_t i = 0; i<p_data->i_number_of_entries; i += ( p_data->i_version == 1 ) ? 2 : 1 )
-                {
-                    stime_t i_time = p_data->p_time[i];
-                    uint64_t i_offset = p_data->p_moof_offset[i];
-
-                    if ( i_time >= i_track_target_time )
-                    {
-                        if ( i_pos == 0 ) /* Not in this traf */
-                            break;
 
-                        *pi_moof_pos = i_pos;
-                        *pi_sampletime = MP4_rescale_mtime( i_time, p_track->i_timescale );
-                        return VLC_SUCCESS;
-                    }
+                /* Entries are sorted by time: find the last sync point before the target */
+                uint32_t i_low = 0, i_high = p_data->i_number_of_entries;
+                while( i_low < i_high )
+                {
+                    uint32_t i_mid = i_low + (i_high - i_low) / 2;
+                    if( (stime_t) p_data->p_time[i_mid] > i_track_target_time )
+                        i_high = i_mid;
                     else
-                        i_pos = i_offset;
+                        i_low = i_mid + 1;
                 }
+
+                if ( i_low == 0 ) /* Not in this traf */
+                    continue;
+
+                *pi_moof_pos = p_data->p_moof_offset[i_low - 1];
+                *pi_sampletime = MP4_rescale_mtime( p_data->p_time[i_low - 1], p_track->i_timescale );
+                return VLC_SUCCESS;
             }
         }
     }
@@ -5568,6 +5675,8 @@ static int DemuxFrag( demux_t *p_demux )
         goto end;
     }
 
+    FragIndexerPoll( p_demux );
+
     /* check for newly selected/unselected track */
     for( unsigned i_track = 0; i_track < p_sys->i_tracks; i_track++ )
     {
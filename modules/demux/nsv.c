@@ -51,6 +51,8 @@ vlc_module_begin ()
     set_capability( "demux", 10 )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_callbacks( Open, Close )
+    add_signature( 0, "NSVf" )
+    add_signature( 0, "NSVs" )
     add_shortcut( "nsv" )
     add_file_extension("nsv")
 vlc_module_end ()
@@ -287,6 +287,8 @@ static void Close( vlc_object_t *p_this )
     demux_t *p_demux = (demux_t *)p_this;
     demux_sys_t *p_sys = p_demux->p_sys  ;
 
+    Oggseek_StopScan( p_demux );
+
     /* Cleanup the bitstream parser */
     ogg_sync_clear( &p_sys->oy );
 
@@ -449,6 +451,9 @@ static int Demux( demux_t * p_demux )
             vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &b_canseek );
             if ( b_canseek )
                 Oggseek_ProbeEnd( p_demux );
+
+            /* Index all the pages in the background, for seeking */
+            Oggseek_StartScan( p_demux );
         }
         else
         {
@@ -2401,6 +2406,7 @@ static void Ogg_LogicalStreamDelete( demux_t *p_demux, logical_stream_t *p_strea
     {
         oggseek_index_entries_free( p_stream->idx );
     }
+    vlc_vector_destroy( &p_stream->pages );
 
     Ogg_FreeSkeleton( p_stream->p_skel );
     p_stream->p_skel = NULL;
@@ -27,6 +27,7 @@
  *****************************************************************************/
 
 #include <vlc_tick.h>
+#include <vlc_vector.h>
 
 //#define OGG_DEMUX_DEBUG 1
 #ifdef OGG_DEMUX_DEBUG
@@ -102,6 +103,10 @@ typedef struct logical_stream_s
     /* keyframe index for seeking, created as we discover keyframes */
     demux_index_entry_t *idx;
 
+    /* every page of the stream, from the background scan */
+    struct VLC_VECTOR(struct oggseek_page_entry) pages;
+    size_t i_pages_scanned; /* scanned pages already looked at */
+
     /* Skeleton data */
     ogg_skeleton_t *p_skel;
 
@@ -198,6 +203,9 @@ typedef struct
     /* length of file in bytes */
     int64_t i_total_bytes;
 
+    /* background scan of the pages, NULL if not running */
+    struct oggseek_scan *p_scan;
+
     /* offset position in file (for reading) */
     int64_t i_input_position;
 
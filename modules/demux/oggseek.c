@@ -36,11 +36,13 @@
 
 #include <vlc_common.h>
 #include <vlc_demux.h>
+#include <vlc_vector.h>
 
 #include <ogg/ogg.h>
 #include <limits.h>
 #include <math.h>
 #include <assert.h>
+#include <stdatomic.h>
 
 #include "ogg.h"
 #include "oggseek.h"
@@ -151,6 +153,270 @@ static bool OggSeekIndexFind ( logical_stream_t *p_stream, vlc_tick_t i_timestam
     return false;
 }
 
+/************************************************************
+* background page scan
+*************************************************************/
+
+/* The scan reads the page headers of the whole file on a second stream, the
+   page bodies are skipped. The pages are converted into a per-stream index
+   by the demux thread, as the granule conversion depends on the stream
+   headers, so that seeking in the scanned part does not need to bisect. */
+
+struct oggseek_scan_page
+{
+    int64_t i_pos;
+    int64_t i_granule;
+    int i_serial_no;
+};
+
+struct oggseek_scan
+{
+    stream_t *s;
+    vlc_thread_t thread;
+    atomic_bool b_stop;
+
+    vlc_mutex_t lock;
+    struct VLC_VECTOR(struct oggseek_scan_page) pages; /* with a granule */
+    struct VLC_VECTOR(int64_t) links; /* first BOS page of each chain link */
+    bool b_eof;
+};
+
+/* look for the next capture pattern */
+static bool oggseek_scan_Resync( stream_t *s )
+{
+    const uint8_t *p_peek;
+
+    for( ;; )
+    {
+        ssize_t i_peek = vlc_stream_Peek( s, &p_peek, OGGSEEK_BYTES_TO_READ );
+        if( i_peek < 4 )
+            return false;
+
+        for( ssize_t i = 0; i + 4 <= i_peek; i++ )
+        {
+            if( !memcmp( &p_peek[i], "OggS", 4 ) )
+                return vlc_stream_Read( s, NULL, i ) == i;
+        }
+
+        if( vlc_stream_Read( s, NULL, i_peek - 3 ) != i_peek - 3 )
+            return false;
+    }
+}
+
+static void *oggseek_scan_Thread( void *data )
+{
+    struct oggseek_scan *p_scan = data;
+    uint8_t header[PAGE_HEADER_BYTES + 255];
+    bool b_prev_bos = false;
+
+    vlc_thread_set_name( "vlc-ogg-scan" );
+
+    while( !atomic_load_explicit( &p_scan->b_stop, memory_order_relaxed ) )
+    {
+        int64_t i_pos = vlc_stream_Tell( p_scan->s );
+
+        if( vlc_stream_Read( p_scan->s, header, PAGE_HEADER_BYTES ) < PAGE_HEADER_BYTES )
+        {
+            vlc_mutex_lock( &p_scan->lock );
+            p_scan->b_eof = true;
+            vlc_mutex_unlock( &p_scan->lock );
+            break;
+        }
+
+        if( memcmp( header, "OggS", 4 ) || header[4] != 0 )
+        {
+            if( vlc_stream_Seek( p_scan->s, i_pos + 1 ) ||
+                !oggseek_scan_Resync( p_scan->s ) )
+                break;
+            continue;
+        }
+
+        int i_nsegs = header[PAGE_HEADER_BYTES - 1];
+        if( vlc_stream_Read( p_scan->s, &header[PAGE_HEADER_BYTES], i_nsegs ) < i_nsegs )
+            break;
+
+        int64_t i_page_size = PAGE_HEADER_BYTES + i_nsegs;
+        for( int i = 0; i < i_nsegs; i++ )
+            i_page_size += header[PAGE_HEADER_BYTES + i];
+
+        bool b_bos = header[5] & 0x02;
+        const struct oggseek_scan_page page = {
+            .i_pos = i_pos,
+            .i_granule = GetQWLE( &header[6] ),
+            .i_serial_no = (int) GetDWLE( &header[14] ),
+        };
+
+        bool b_ok = true;
+        vlc_mutex_lock( &p_scan->lock );
+        if( b_bos && !b_prev_bos )
+            b_ok = vlc_vector_push( &p_scan->links, i_pos );
+        if( b_ok && page.i_granule != -1 )
+            b_ok = vlc_vector_push( &p_scan->pages, page );
+        vlc_mutex_unlock( &p_scan->lock );
+
+        if( !b_ok || vlc_stream_Seek( p_scan->s, i_pos + i_page_size ) )
+            break;
+        b_prev_bos = b_bos;
+    }
+
+    return NULL;
+}
+
+void Oggseek_StartScan( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    bool b_fastseek = false;
+
+    if( p_sys->p_scan || p_demux->b_preparsing || !p_demux->psz_url )
+        return;
+
+    vlc_stream_Control( p_demux->s, STREAM_CAN_FASTSEEK, &b_fastseek );
+    if( !b_fastseek )
+        return;
+
+    struct oggseek_scan *p_scan = malloc( sizeof(*p_scan) );
+    if( !p_scan )
+        return;
+
+    p_scan->s = vlc_stream_NewURL( p_demux, p_demux->psz_url );
+    if( !p_scan->s )
+    {
+        free( p_scan );
+        return;
+    }
+
+    atomic_init( &p_scan->b_stop, false );
+    vlc_mutex_init( &p_scan->lock );
+    vlc_vector_init( &p_scan->pages );
+    vlc_vector_init( &p_scan->links );
+    p_scan->b_eof = false;
+
+    if( vlc_clone( &p_scan->thread, oggseek_scan_Thread, p_scan ) )
+    {
+        vlc_stream_Delete( p_scan->s );
+        free( p_scan );
+        return;
+    }
+
+    p_sys->p_scan = p_scan;
+}
+
+void Oggseek_StopScan( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    struct oggseek_scan *p_scan = p_sys->p_scan;
+
+    if( !p_scan )
+        return;
+
+    atomic_store_explicit( &p_scan->b_stop, true, memory_order_relaxed );
+    vlc_join( p_scan->thread, NULL );
+    vlc_stream_Delete( p_scan->s );
+    vlc_vector_destroy( &p_scan->pages );
+    vlc_vector_destroy( &p_scan->links );
+    free( p_scan );
+    p_sys->p_scan = NULL;
+}
+
+/* Appends the newly scanned pages to the stream index. Only the audio
+   streams are indexed, as every page is a valid starting point for them.
+   Returns true if all the pages of the stream chain link are known. */
+static bool OggSeek_PagesUpdate( demux_t *p_demux, logical_stream_t *p_stream )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    struct oggseek_scan *p_scan = p_sys->p_scan;
+
+    if( !p_scan || p_stream->b_initializing || p_stream->b_oggds ||
+        p_stream->fmt.i_cat != AUDIO_ES )
+        return false;
+
+    vlc_mutex_lock( &p_scan->lock );
+
+    /* the pages of the following chain links are not for this stream, even
+       if they reuse the serial number */
+    int64_t i_link_end = INT64_MAX;
+    bool b_complete = p_scan->b_eof;
+    for( size_t i = 0; i < p_scan->links.size; i++ )
+    {
+        if( p_scan->links.data[i] > p_stream->i_data_start )
+        {
+            i_link_end = p_scan->links.data[i];
+            b_complete = true;
+            break;
+        }
+    }
+
+    for( ; p_stream->i_pages_scanned < p_scan->pages.size; p_stream->i_pages_scanned++ )
+    {
+        const struct oggseek_scan_page *p_page =
+            &p_scan->pages.data[p_stream->i_pages_scanned];
+
+        if( p_page->i_pos >= i_link_end )
+        {
+            p_stream->i_pages_scanned = p_scan->pages.size;
+            break;
+        }
+        if( p_page->i_serial_no != p_stream->i_serial_no ||
+            p_page->i_pos < p_stream->i_data_start )
+            continue;
+
+        const struct oggseek_page_entry entry = {
+            .i_time = Ogg_GranuleToTime( p_stream, p_page->i_granule,
+                                         !p_stream->b_contiguous, false ),
+            .i_pagepos = p_page->i_pos,
+        };
+        if( entry.i_time == VLC_TICK_INVALID )
+            continue;
+
+        /* the lookups need increasing timestamps */
+        if( ( p_stream->pages.size > 0 &&
+              entry.i_time < p_stream->pages.data[p_stream->pages.size - 1].i_time ) ||
+            !vlc_vector_push( &p_stream->pages, entry ) )
+        {
+            msg_Warn( p_demux, "cannot index the pages of stream %d",
+                      p_stream->i_serial_no );
+            vlc_vector_clear( &p_stream->pages );
+            p_stream->i_pages_scanned = SIZE_MAX;
+            b_complete = false;
+            break;
+        }
+    }
+
+    vlc_mutex_unlock( &p_scan->lock );
+
+    return b_complete;
+}
+
+/* Finds the page to start from to reach i_time, in the scanned pages */
+static bool OggSeek_PagesFind( demux_t *p_demux, logical_stream_t *p_stream,
+                               vlc_tick_t i_time, int64_t *pi_pagepos )
+{
+    bool b_complete = OggSeek_PagesUpdate( p_demux, p_stream );
+    size_t i_count = p_stream->pages.size;
+
+    if( i_count == 0 )
+        return false;
+
+    /* number of pages ending before i_time */
+    size_t lo = 0, hi = i_count;
+    while( lo < hi )
+    {
+        size_t mid = lo + ( hi - lo ) / 2;
+        if( p_stream->pages.data[mid].i_time <= i_time )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    /* the page containing i_time has not been scanned yet */
+    if( lo == i_count && !b_complete )
+        return false;
+
+    *pi_pagepos = lo > 0 ? p_stream->pages.data[lo - 1].i_pagepos
+                         : p_stream->i_data_start;
+    return true;
+}
+
 /*********************************************************************
  * private functions
  **********************************************************************/
@@ -805,6 +1071,10 @@ int Oggseek_BlindSeektoAbsoluteTime( demux_t *p_demux, logical_stream_t *p_strea
     Ogg_GetBoundsUsingSkeletonIndex( p_stream, i_time, &i_lowerpos, &i_upperpos );
     if ( i_lowerpos != -1 ) b_found = true;
 
+    /* Then in the scanned pages */
+    if ( !b_found && OggSeek_PagesFind( p_demux, p_stream, i_time, &i_lowerpos ) )
+        b_found = true;
+
     /* And also search in our own index */
     vlc_tick_t foo;
     if ( !b_found && OggSeekIndexFind( p_stream, i_time, &i_lowerpos, &i_upperpos, &foo ) )
@@ -906,6 +1176,16 @@ int Oggseek_SeektoAbsolutetime( demux_t *p_demux, logical_stream_t *p_stream,
     }
     OggDebug( msg_Dbg( p_demux, "Search bounds set to %"PRId64" %"PRId64" using skeleton index", i_offset_lower, i_offset_upper ) );
 
+    int64_t i_pagepos;
+    if ( OggSeek_PagesFind( p_demux, p_stream, i_time, &i_pagepos ) )
+    {
+        OggDebug( msg_Dbg( p_demux, "Found page at %"PRId64" using scanned pages", i_pagepos ) );
+        p_sys->i_input_position = i_pagepos;
+        seek_byte( p_demux, p_sys->i_input_position );
+        ogg_stream_reset( &p_stream->os );
+        return i_pagepos;
+    }
+
 
     vlc_tick_t i_lower_index;
     if(!OggSeekIndexFind( p_stream, i_time, &i_offset_lower, &i_offset_upper, &i_lower_index ))
@@ -915,7 +1195,7 @@ int Oggseek_SeektoAbsolutetime( demux_t *p_demux, logical_stream_t *p_stream,
     i_offset_upper = __MIN( i_offset_upper, p_sys->i_total_bytes );
 
     int64_t i_sync_time;
-    int64_t i_pagepos = OggBisectSearchByTime( p_demux, p_stream, i_time,
+    i_pagepos = OggBisectSearchByTime( p_demux, p_stream, i_time,
                                        i_offset_lower, i_offset_upper, &i_sync_time );
     if ( i_pagepos >= 0 )
     {
@@ -49,6 +49,17 @@ struct oggseek_index_entry
     int64_t i_pagepos;
 };
 
+/* page of a logical stream, found by the background scan */
+struct oggseek_page_entry
+{
+    /* end time of the last packet finishing in the page */
+    vlc_tick_t i_time;
+    int64_t i_pagepos;
+};
+
+void    Oggseek_StartScan( demux_t * );
+void    Oggseek_StopScan( demux_t * );
+
 int     Oggseek_BlindSeektoAbsoluteTime ( demux_t *, logical_stream_t *, vlc_tick_t, bool );
 int     Oggseek_BlindSeektoPosition ( demux_t *, logical_stream_t *, double f, bool );
 int     Oggseek_SeektoAbsolutetime ( demux_t *, logical_stream_t *, vlc_tick_t );
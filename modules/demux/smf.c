@@ -736,6 +736,8 @@ vlc_module_begin ()
     set_subcategory (SUBCAT_INPUT_DEMUX)
     set_capability ("demux", 20)
     set_callbacks (Open, Close)
+    add_signature (0, "MThd\x00\x00\x00\x06")
+    add_signature (0, "RIFF") /* RIFF MIDI */
     add_file_extension("kar")
     add_file_extension("mid")
     add_file_extension("rmi")
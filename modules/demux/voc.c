@@ -44,6 +44,7 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 10 )
     set_callback( Open )
+    add_signature( 0, "Creative Voice File\x1a" )
     add_file_extension("voc")
 vlc_module_end ()
 
@@ -43,6 +43,9 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 10 )
     set_callback( Open )
+    add_signature( 0, "XAI\0" )
+    add_signature( 0, "XAJ\0" )
+    add_signature( 0, "XA\0\0" )
 vlc_module_end ()
 
 /*****************************************************************************
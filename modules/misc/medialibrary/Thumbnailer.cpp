@@ -93,7 +93,7 @@ bool Thumbnailer::generate( const medialibrary::IMedia&, const std::string& mrl,
             .seek = {
                 .type = vlc_thumbnailer_arg::seek::VLC_THUMBNAILER_SEEK_POS,
                 .pos = position,
-                .speed = vlc_thumbnailer_arg::seek::VLC_THUMBNAILER_SEEK_FAST,
+                .speed = vlc_thumbnailer_arg::seek::VLC_THUMBNAILER_SEEK_KEYFRAME,
             },
             .hw_dec = false,
         };
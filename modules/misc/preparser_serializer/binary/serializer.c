@@ -0,0 +1,1355 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+/*****************************************************************************
+ * serializer.c: preparser binary serializer module
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *****************************************************************************/
+
+/*
+ * Compact binary encoding of the preparser messages, used between the
+ * preparser and the vlc-preparser processes.
+ *
+ * Each message is sent as a frame: the size of the payload on 32 bits (little
+ * endian), then the payload. The payload starts with the format version and
+ * contains the fields in a fixed order:
+ *  - integers are LEB128 varints, zigzag encoded if signed,
+ *  - fourccs are 4 bytes, floating point numbers are IEEE 754 little endian,
+ *  - strings are prefixed by their length + 1 (0 for NULL), binary data by
+ *    their size,
+ *  - arrays are prefixed by their number of elements, optional structures by
+ *    a boolean.
+ *
+ * A frame is read exactly, without read-ahead, so the requests can be
+ * pipelined on the same stream.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_preparser_ipc.h>
+#include <vlc_input_item.h>
+#include <vlc_input.h>
+#include <vlc_meta.h>
+#include <vlc_picture.h>
+#include <vlc_vector.h>
+
+#define BIN_VERSION 1
+
+/* Maximum size of a frame payload */
+#define BIN_FRAME_MAX (1 << 30)
+
+/* The buffer is kept between the messages, unless a picture or an attachment
+ * made it grow above this size */
+#define BIN_BUFFER_KEEP (1 << 20)
+
+/* Maximum depth of a deserialized item tree */
+#define BIN_NODE_DEPTH_MAX 256
+
+struct serdes_sys {
+    struct VLC_VECTOR(uint8_t) buf;
+};
+
+/****************************************************************************
+ * Writer
+ *****************************************************************************/
+
+struct bin_writer {
+    struct serdes_sys *sys;
+    bool error;
+};
+
+static void
+bin_PutBytes(struct bin_writer *w, const void *data, size_t size)
+{
+    if (size == 0 || w->error) {
+        return;
+    }
+    if (!vlc_vector_push_all(&w->sys->buf, (const uint8_t *)data, size)) {
+        w->error = true;
+    }
+}
+
+static void
+bin_PutUint(struct bin_writer *w, uint64_t value)
+{
+    uint8_t data[10];
+    size_t size = 0;
+    do {
+        data[size] = value & 0x7f;
+        value >>= 7;
+        if (value != 0) {
+            data[size] |= 0x80;
+        }
+        size++;
+    } while (value != 0);
+    bin_PutBytes(w, data, size);
+}
+
+static void
+bin_PutInt(struct bin_writer *w, int64_t value)
+{
+    /* zigzag: small negative values are encoded as small varints */
+    uint64_t u = value < 0 ? ~((uint64_t)value << 1) : (uint64_t)value << 1;
+    bin_PutUint(w, u);
+}
+
+static void
+bin_PutBool(struct bin_writer *w, bool value)
+{
+    uint8_t data = value;
+    bin_PutBytes(w, &data, 1);
+}
+
+static void
+bin_PutFourcc(struct bin_writer *w, vlc_fourcc_t fourcc)
+{
+    uint8_t data[4];
+    SetDWLE(data, fourcc);
+    bin_PutBytes(w, data, sizeof(data));
+}
+
+static void
+bin_PutFloat(struct bin_writer *w, float value)
+{
+    uint32_t u;
+    memcpy(&u, &value, sizeof(u));
+    uint8_t data[4];
+    SetDWLE(data, u);
+    bin_PutBytes(w, data, sizeof(data));
+}
+
+static void
+bin_PutDouble(struct bin_writer *w, double value)
+{
+    uint64_t u;
+    memcpy(&u, &value, sizeof(u));
+    uint8_t data[8];
+    SetQWLE(data, u);
+    bin_PutBytes(w, data, sizeof(data));
+}
+
+static void
+bin_PutString(struct bin_writer *w, const char *str)
+{
+    if (str == NULL) {
+        bin_PutUint(w, 0);
+        return;
+    }
+    size_t len = strlen(str);
+    bin_PutUint(w, (uint64_t)len + 1);
+    bin_PutBytes(w, str, len);
+}
+
+static void
+bin_PutData(struct bin_writer *w, const void *data, size_t size)
+{
+    bin_PutUint(w, size);
+    bin_PutBytes(w, data, size);
+}
+
+/****************************************************************************
+ * Reader
+ *****************************************************************************/
+
+struct bin_reader {
+    const uint8_t *ptr;
+    const uint8_t *end;
+    bool error;
+};
+
+static const uint8_t *
+bin_GetBytes(struct bin_reader *r, size_t size)
+{
+    if (r->error || (size_t)(r->end - r->ptr) < size) {
+        r->error = true;
+        return NULL;
+    }
+    const uint8_t *data = r->ptr;
+    r->ptr += size;
+    return data;
+}
+
+static uint64_t
+bin_GetUint(struct bin_reader *r)
+{
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        const uint8_t *data = bin_GetBytes(r, 1);
+        if (data == NULL) {
+            return 0;
+        }
+        value |= (uint64_t)(*data & 0x7f) << shift;
+        if (!(*data & 0x80)) {
+            return value;
+        }
+    }
+    r->error = true;
+    return 0;
+}
+
+/* Read an unsigned integer which must not be greater than max. */
+static uint64_t
+bin_GetUintMax(struct bin_reader *r, uint64_t max)
+{
+    uint64_t value = bin_GetUint(r);
+    if (value > max) {
+        r->error = true;
+        return 0;
+    }
+    return value;
+}
+
+/* Read a signed integer which must be in the [min, max] range. */
+static int64_t
+bin_GetIntRange(struct bin_reader *r, int64_t min, int64_t max)
+{
+    uint64_t u = bin_GetUint(r);
+    int64_t value = (u & 1) ? -(int64_t)(u >> 1) - 1 : (int64_t)(u >> 1);
+    if (value < min || value > max) {
+        r->error = true;
+        return 0;
+    }
+    return value;
+}
+
+/* Read a number of elements: each one takes at least a byte, so it can't be
+ * greater than the remaining size (and a corrupted frame can't trigger a big
+ * allocation). */
+static size_t
+bin_GetCount(struct bin_reader *r)
+{
+    return bin_GetUintMax(r, r->end - r->ptr);
+}
+
+static bool
+bin_GetBool(struct bin_reader *r)
+{
+    const uint8_t *data = bin_GetBytes(r, 1);
+    if (data == NULL) {
+        return false;
+    }
+    if (*data > 1) {
+        r->error = true;
+        return false;
+    }
+    return *data;
+}
+
+static vlc_fourcc_t
+bin_GetFourcc(struct bin_reader *r)
+{
+    const uint8_t *data = bin_GetBytes(r, 4);
+    return data != NULL ? GetDWLE(data) : 0;
+}
+
+static float
+bin_GetFloat(struct bin_reader *r)
+{
+    const uint8_t *data = bin_GetBytes(r, 4);
+    if (data == NULL) {
+        return 0.f;
+    }
+    uint32_t u = GetDWLE(data);
+    float value;
+    memcpy(&value, &u, sizeof(value));
+    return value;
+}
+
+static double
+bin_GetDouble(struct bin_reader *r)
+{
+    const uint8_t *data = bin_GetBytes(r, 8);
+    if (data == NULL) {
+        return 0.;
+    }
+    uint64_t u = GetQWLE(data);
+    double value;
+    memcpy(&value, &u, sizeof(value));
+    return value;
+}
+
+/* Read a heap allocated string, or NULL. */
+static char *
+bin_GetString(struct bin_reader *r)
+{
+    uint64_t len = bin_GetUint(r);
+    if (len == 0) {
+        return NULL;
+    }
+    len--;
+    const uint8_t *data = bin_GetBytes(r, len);
+    if (data == NULL) {
+        return NULL;
+    }
+    if (memchr(data, '\0', len) != NULL) {
+        r->error = true;
+        return NULL;
+    }
+    char *str = strndup((const char *)data, len);
+    if (str == NULL) {
+        r->error = true;
+    }
+    return str;
+}
+
+/* Read binary data, the returned pointer is valid until the end of the
+ * deserialization. */
+static const uint8_t *
+bin_GetData(struct bin_reader *r, size_t *size)
+{
+    *size = bin_GetUintMax(r, r->end - r->ptr);
+    return bin_GetBytes(r, *size);
+}
+
+/****************************************************************************
+ * ES formats
+ *****************************************************************************/
+
+static void
+bin_PutAudioFormat(struct bin_writer *w, const audio_format_t *a)
+{
+    bin_PutFourcc(w, a->i_format);
+    bin_PutUint(w, a->i_rate);
+    bin_PutUint(w, a->i_physical_channels);
+    bin_PutUint(w, a->i_chan_mode);
+    bin_PutUint(w, a->channel_type);
+    bin_PutUint(w, a->i_bytes_per_frame);
+    bin_PutUint(w, a->i_frame_length);
+    bin_PutUint(w, a->i_bitspersample);
+    bin_PutUint(w, a->i_blockalign);
+    bin_PutUint(w, a->i_channels);
+}
+
+static void
+bin_GetAudioFormat(struct bin_reader *r, audio_format_t *a)
+{
+    a->i_format = bin_GetFourcc(r);
+    a->i_rate = bin_GetUintMax(r, UINT_MAX);
+    a->i_physical_channels = bin_GetUintMax(r, UINT16_MAX);
+    a->i_chan_mode = bin_GetUintMax(r, UINT16_MAX);
+    a->channel_type = bin_GetUintMax(r, AUDIO_CHANNEL_TYPE_AMBISONICS);
+    a->i_bytes_per_frame = bin_GetUintMax(r, UINT_MAX);
+    a->i_frame_length = bin_GetUintMax(r, UINT_MAX);
+    a->i_bitspersample = bin_GetUintMax(r, UINT_MAX);
+    a->i_blockalign = bin_GetUintMax(r, UINT_MAX);
+    a->i_channels = bin_GetUintMax(r, UINT8_MAX);
+}
+
+static void
+bin_PutReplayGain(struct bin_writer *w, const audio_replay_gain_t *rg)
+{
+    bin_PutBool(w, rg->pb_reference_loudness);
+    bin_PutFloat(w, rg->pf_reference_loudness);
+    for (size_t i = 0; i < AUDIO_REPLAY_GAIN_MAX; i++) {
+        bin_PutBool(w, rg->pb_gain[i]);
+        bin_PutFloat(w, rg->pf_gain[i]);
+        bin_PutBool(w, rg->pb_peak[i]);
+        bin_PutFloat(w, rg->pf_peak[i]);
+    }
+}
+
+static void
+bin_GetReplayGain(struct bin_reader *r, audio_replay_gain_t *rg)
+{
+    rg->pb_reference_loudness = bin_GetBool(r);
+    rg->pf_reference_loudness = bin_GetFloat(r);
+    for (size_t i = 0; i < AUDIO_REPLAY_GAIN_MAX; i++) {
+        rg->pb_gain[i] = bin_GetBool(r);
+        rg->pf_gain[i] = bin_GetFloat(r);
+        rg->pb_peak[i] = bin_GetBool(r);
+        rg->pf_peak[i] = bin_GetFloat(r);
+    }
+}
+
+static void
+bin_PutVideoFormat(struct bin_writer *w, const video_format_t *v)
+{
+    bin_PutFourcc(w, v->i_chroma);
+    bin_PutUint(w, v->i_width);
+    bin_PutUint(w, v->i_height);
+    bin_PutUint(w, v->i_x_offset);
+    bin_PutUint(w, v->i_y_offset);
+    bin_PutUint(w, v->i_visible_width);
+    bin_PutUint(w, v->i_visible_height);
+    bin_PutUint(w, v->i_sar_num);
+    bin_PutUint(w, v->i_sar_den);
+    bin_PutUint(w, v->i_frame_rate);
+    bin_PutUint(w, v->i_frame_rate_base);
+
+    bin_PutBool(w, v->p_palette != NULL);
+    if (v->p_palette != NULL) {
+        int entries = v->p_palette->i_entries;
+        if (entries < 0 || entries > VIDEO_PALETTE_COLORS_MAX) {
+            entries = 0;
+        }
+        bin_PutUint(w, entries);
+        bin_PutBytes(w, v->p_palette->palette, entries * 4);
+    }
+
+    bin_PutUint(w, v->orientation);
+    bin_PutUint(w, v->primaries);
+    bin_PutUint(w, v->transfer);
+    bin_PutUint(w, v->space);
+    bin_PutUint(w, v->color_range);
+    bin_PutUint(w, v->chroma_location);
+    bin_PutUint(w, v->multiview_mode);
+    bin_PutBool(w, v->b_multiview_right_eye_first);
+    bin_PutUint(w, v->projection_mode);
+
+    bin_PutFloat(w, v->pose.yaw);
+    bin_PutFloat(w, v->pose.pitch);
+    bin_PutFloat(w, v->pose.roll);
+    bin_PutFloat(w, v->pose.fov);
+
+    for (size_t i = 0; i < ARRAY_SIZE(v->mastering.primaries); i++) {
+        bin_PutUint(w, v->mastering.primaries[i]);
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(v->mastering.white_point); i++) {
+        bin_PutUint(w, v->mastering.white_point[i]);
+    }
+    bin_PutUint(w, v->mastering.max_luminance);
+    bin_PutUint(w, v->mastering.min_luminance);
+
+    bin_PutUint(w, v->lighting.MaxCLL);
+    bin_PutUint(w, v->lighting.MaxFALL);
+
+    bin_PutUint(w, v->dovi.version_major);
+    bin_PutUint(w, v->dovi.version_minor);
+    bin_PutUint(w, v->dovi.profile);
+    bin_PutUint(w, v->dovi.level);
+    bin_PutBool(w, v->dovi.rpu_present);
+    bin_PutBool(w, v->dovi.el_present);
+    bin_PutBool(w, v->dovi.bl_present);
+
+    bin_PutUint(w, v->i_cubemap_padding);
+}
+
+/* The format must be cleaned by the caller, even on error. */
+static void
+bin_GetVideoFormat(struct bin_reader *r, video_format_t *v)
+{
+    video_format_Init(v, bin_GetFourcc(r));
+    v->i_width = bin_GetUintMax(r, UINT_MAX);
+    v->i_height = bin_GetUintMax(r, UINT_MAX);
+    v->i_x_offset = bin_GetUintMax(r, UINT_MAX);
+    v->i_y_offset = bin_GetUintMax(r, UINT_MAX);
+    v->i_visible_width = bin_GetUintMax(r, UINT_MAX);
+    v->i_visible_height = bin_GetUintMax(r, UINT_MAX);
+    v->i_sar_num = bin_GetUintMax(r, UINT_MAX);
+    v->i_sar_den = bin_GetUintMax(r, UINT_MAX);
+    v->i_frame_rate = bin_GetUintMax(r, UINT_MAX);
+    v->i_frame_rate_base = bin_GetUintMax(r, UINT_MAX);
+
+    if (bin_GetBool(r)) {
+        int entries = bin_GetUintMax(r, VIDEO_PALETTE_COLORS_MAX);
+        const uint8_t *data = bin_GetBytes(r, entries * 4);
+        if (data != NULL) {
+            v->p_palette = calloc(1, sizeof(*v->p_palette));
+            if (v->p_palette != NULL) {
+                v->p_palette->i_entries = entries;
+                memcpy(v->p_palette->palette, data, entries * 4);
+            } else {
+                r->error = true;
+            }
+        }
+    }
+
+    v->orientation = bin_GetUintMax(r, ORIENT_MAX);
+    v->primaries = bin_GetUintMax(r, COLOR_PRIMARIES_MAX);
+    v->transfer = bin_GetUintMax(r, TRANSFER_FUNC_MAX);
+    v->space = bin_GetUintMax(r, COLOR_SPACE_MAX);
+    v->color_range = bin_GetUintMax(r, COLOR_RANGE_MAX);
+    v->chroma_location = bin_GetUintMax(r, CHROMA_LOCATION_MAX);
+    v->multiview_mode = bin_GetUintMax(r, MULTIVIEW_STEREO_MAX);
+    v->b_multiview_right_eye_first = bin_GetBool(r);
+    v->projection_mode =
+        bin_GetUintMax(r, PROJECTION_MODE_CUBEMAP_LAYOUT_STANDARD);
+
+    v->pose.yaw = bin_GetFloat(r);
+    v->pose.pitch = bin_GetFloat(r);
+    v->pose.roll = bin_GetFloat(r);
+    v->pose.fov = bin_GetFloat(r);
+
+    for (size_t i = 0; i < ARRAY_SIZE(v->mastering.primaries); i++) {
+        v->mastering.primaries[i] = bin_GetUintMax(r, UINT16_MAX);
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(v->mastering.white_point); i++) {
+        v->mastering.white_point[i] = bin_GetUintMax(r, UINT16_MAX);
+    }
+    v->mastering.max_luminance = bin_GetUintMax(r, UINT32_MAX);
+    v->mastering.min_luminance = bin_GetUintMax(r, UINT32_MAX);
+
+    v->lighting.MaxCLL = bin_GetUintMax(r, UINT16_MAX);
+    v->lighting.MaxFALL = bin_GetUintMax(r, UINT16_MAX);
+
+    v->dovi.version_major = bin_GetUintMax(r, UINT8_MAX);
+    v->dovi.version_minor = bin_GetUintMax(r, UINT8_MAX);
+    v->dovi.profile = bin_GetUintMax(r, (1 << 7) - 1);
+    v->dovi.level = bin_GetUintMax(r, (1 << 6) - 1);
+    v->dovi.rpu_present = bin_GetBool(r);
+    v->dovi.el_present = bin_GetBool(r);
+    v->dovi.bl_present = bin_GetBool(r);
+
+    v->i_cubemap_padding = bin_GetUintMax(r, UINT32_MAX);
+}
+
+static void
+bin_PutSubsFormat(struct bin_writer *w, const subs_format_t *s)
+{
+    bin_PutString(w, s->psz_encoding);
+    bin_PutInt(w, s->i_x_origin);
+    bin_PutInt(w, s->i_y_origin);
+
+    bin_PutUint(w, s->spu.i_original_frame_width);
+    bin_PutUint(w, s->spu.i_original_frame_height);
+    for (size_t i = 0; i < VIDEO_PALETTE_CLUT_COUNT; i++) {
+        bin_PutUint(w, s->spu.palette[i]);
+    }
+    bin_PutBool(w, s->spu.b_palette);
+
+    bin_PutInt(w, s->dvb.i_id);
+
+    bin_PutUint(w, s->teletext.i_magazine);
+    bin_PutUint(w, s->teletext.i_page);
+
+    bin_PutUint(w, s->cc.i_channel);
+    bin_PutInt(w, s->cc.i_reorder_depth);
+}
+
+static void
+bin_GetSubsFormat(struct bin_reader *r, subs_format_t *s)
+{
+    s->psz_encoding = bin_GetString(r);
+    s->i_x_origin = bin_GetIntRange(r, INT_MIN, INT_MAX);
+    s->i_y_origin = bin_GetIntRange(r, INT_MIN, INT_MAX);
+
+    s->spu.i_original_frame_width = bin_GetUintMax(r, UINT_MAX);
+    s->spu.i_original_frame_height = bin_GetUintMax(r, UINT_MAX);
+    for (size_t i = 0; i < VIDEO_PALETTE_CLUT_COUNT; i++) {
+        s->spu.palette[i] = bin_GetUintMax(r, UINT32_MAX);
+    }
+    s->spu.b_palette = bin_GetBool(r);
+
+    s->dvb.i_id = bin_GetIntRange(r, INT_MIN, INT_MAX);
+
+    s->teletext.i_magazine = bin_GetUintMax(r, UINT8_MAX);
+    s->teletext.i_page = bin_GetUintMax(r, UINT8_MAX);
+
+    s->cc.i_channel = bin_GetUintMax(r, UINT8_MAX);
+    s->cc.i_reorder_depth = bin_GetIntRange(r, INT_MIN, INT_MAX);
+}
+
+static void
+bin_PutEsFormat(struct bin_writer *w, const es_format_t *es)
+{
+    bin_PutUint(w, es->i_cat);
+    bin_PutFourcc(w, es->i_codec);
+    bin_PutFourcc(w, es->i_original_fourcc);
+    bin_PutInt(w, es->i_id);
+    bin_PutInt(w, es->i_group);
+    bin_PutInt(w, es->i_priority);
+    bin_PutString(w, es->psz_language);
+    bin_PutString(w, es->psz_description);
+
+    bin_PutUint(w, es->i_extra_languages);
+    for (unsigned i = 0; i < es->i_extra_languages; i++) {
+        bin_PutString(w, es->p_extra_languages[i].psz_language);
+        bin_PutString(w, es->p_extra_languages[i].psz_description);
+    }
+
+    switch (es->i_cat) {
+        case AUDIO_ES:
+            bin_PutAudioFormat(w, &es->audio);
+            bin_PutReplayGain(w, &es->audio_replay_gain);
+            break;
+        case VIDEO_ES:
+            bin_PutVideoFormat(w, &es->video);
+            break;
+        case SPU_ES:
+            bin_PutSubsFormat(w, &es->subs);
+            break;
+        default:
+            break;
+    }
+
+    bin_PutUint(w, es->i_bitrate);
+    bin_PutInt(w, es->i_profile);
+    bin_PutInt(w, es->i_level);
+    bin_PutBool(w, es->b_packetized);
+    /* p_extra not sent */
+}
+
+/* The format must be cleaned by the caller, even on error. */
+static void
+bin_GetEsFormat(struct bin_reader *r, es_format_t *es)
+{
+    int cat = bin_GetUintMax(r, DATA_ES);
+    es_format_Init(es, cat, bin_GetFourcc(r));
+    es->i_original_fourcc = bin_GetFourcc(r);
+    es->i_id = bin_GetIntRange(r, -1, INT_MAX);
+    es->i_group = bin_GetIntRange(r, -1, INT_MAX);
+    es->i_priority = bin_GetIntRange(r, -2, INT_MAX);
+    es->psz_language = bin_GetString(r);
+    es->psz_description = bin_GetString(r);
+
+    size_t count = bin_GetCount(r);
+    if (count != 0) {
+        es->p_extra_languages = vlc_alloc(count,
+                                          sizeof(*es->p_extra_languages));
+        if (es->p_extra_languages == NULL) {
+            r->error = true;
+            return;
+        }
+        es->i_extra_languages = count;
+        for (size_t i = 0; i < count; i++) {
+            extra_languages_t *el = &es->p_extra_languages[i];
+            el->psz_language = bin_GetString(r);
+            el->psz_description = bin_GetString(r);
+        }
+    }
+
+    switch (es->i_cat) {
+        case AUDIO_ES:
+            bin_GetAudioFormat(r, &es->audio);
+            bin_GetReplayGain(r, &es->audio_replay_gain);
+            break;
+        case VIDEO_ES:
+            bin_GetVideoFormat(r, &es->video);
+            break;
+        case SPU_ES:
+            bin_GetSubsFormat(r, &es->subs);
+            break;
+        default:
+            break;
+    }
+
+    es->i_bitrate = bin_GetUintMax(r, UINT_MAX);
+    es->i_profile = bin_GetIntRange(r, INT_MIN, INT_MAX);
+    es->i_level = bin_GetIntRange(r, INT_MIN, INT_MAX);
+    es->b_packetized = bin_GetBool(r);
+}
+
+/****************************************************************************
+ * Input items
+ *****************************************************************************/
+
+static void
+bin_PutMeta(struct bin_writer *w, const vlc_meta_t *meta)
+{
+    bin_PutBool(w, meta != NULL);
+    if (meta == NULL) {
+        return;
+    }
+
+    size_t count = 0;
+    for (int i = 0; i < VLC_META_TYPE_COUNT; i++) {
+        count += vlc_meta_Get(meta, i) != NULL;
+    }
+    bin_PutUint(w, count);
+    for (int i = 0; i < VLC_META_TYPE_COUNT; i++) {
+        vlc_meta_priority_t priority;
+        const char *value = vlc_meta_GetWithPriority(meta, i, &priority);
+        if (value != NULL) {
+            bin_PutUint(w, i);
+            bin_PutUint(w, priority);
+            bin_PutString(w, value);
+        }
+    }
+
+    char **keys = vlc_meta_CopyExtraNames(meta);
+    count = keys != NULL ? vlc_meta_GetExtraCount(meta) : 0;
+    bin_PutUint(w, count);
+    for (size_t i = 0; i < count; i++) {
+        vlc_meta_priority_t priority = VLC_META_PRIORITY_BASIC;
+        const char *value = vlc_meta_GetExtraWithPriority(meta, keys[i],
+                                                          &priority);
+        bin_PutString(w, keys[i]);
+        bin_PutString(w, value);
+        bin_PutUint(w, priority);
+        free(keys[i]);
+    }
+    free(keys);
+
+    bin_PutInt(w, vlc_meta_GetStatus(meta));
+}
+
+static void
+bin_GetMeta(struct bin_reader *r, vlc_meta_t *meta)
+{
+    size_t count = bin_GetCount(r);
+    for (size_t i = 0; i < count && !r->error; i++) {
+        vlc_meta_type_t type = bin_GetUintMax(r, VLC_META_TYPE_COUNT - 1);
+        vlc_meta_priority_t priority =
+            bin_GetUintMax(r, VLC_META_PRIORITY_INBAND);
+        char *value = bin_GetString(r);
+        if (!r->error) {
+            vlc_meta_SetWithPriority(meta, type, value, priority);
+        }
+        free(value);
+    }
+
+    count = bin_GetCount(r);
+    for (size_t i = 0; i < count && !r->error; i++) {
+        char *key = bin_GetString(r);
+        char *value = bin_GetString(r);
+        vlc_meta_priority_t priority =
+            bin_GetUintMax(r, VLC_META_PRIORITY_INBAND);
+        if (key == NULL) {
+            r->error = true;
+        }
+        if (!r->error) {
+            vlc_meta_SetExtraWithPriority(meta, key, value, priority);
+        }
+        free(key);
+        free(value);
+    }
+
+    vlc_meta_SetStatus(meta, bin_GetIntRange(r, INT_MIN, INT_MAX));
+}
+
+static void
+bin_PutInputItem(struct bin_writer *w, const input_item_t *item)
+{
+    bin_PutBool(w, item != NULL);
+    if (item == NULL) {
+        return;
+    }
+
+    bin_PutString(w, item->psz_name);
+    bin_PutString(w, item->psz_uri);
+    bin_PutInt(w, item->i_duration);
+
+    bin_PutUint(w, item->es_vec.size);
+    const struct input_item_es *item_es;
+    vlc_vector_foreach_ref(item_es, &item->es_vec) {
+        bin_PutEsFormat(w, &item_es->es);
+        bin_PutString(w, item_es->id);
+        bin_PutBool(w, item_es->id_stable);
+    }
+
+    bin_PutMeta(w, item->p_meta);
+
+    bin_PutUint(w, item->i_slaves);
+    for (int i = 0; i < item->i_slaves; i++) {
+        const struct input_item_slave *slave = item->pp_slaves[i];
+        bin_PutUint(w, slave->i_type);
+        bin_PutUint(w, slave->i_priority);
+        bin_PutBool(w, slave->b_forced);
+        bin_PutString(w, slave->psz_uri);
+    }
+
+    bin_PutUint(w, item->i_type);
+    bin_PutBool(w, item->b_net);
+}
+
+static input_item_t *
+bin_GetInputItem(struct bin_reader *r)
+{
+    if (!bin_GetBool(r)) {
+        return NULL;
+    }
+
+    input_item_t *item = input_item_New(NULL, NULL);
+    if (item == NULL) {
+        r->error = true;
+        return NULL;
+    }
+
+    free(item->psz_name);
+    item->psz_name = bin_GetString(r);
+    free(item->psz_uri);
+    item->psz_uri = bin_GetString(r);
+    item->i_duration = bin_GetIntRange(r, INT64_MIN, INT64_MAX);
+
+    vlc_vector_clear(&item->es_vec);
+    size_t count = bin_GetCount(r);
+    for (size_t i = 0; i < count && !r->error; i++) {
+        struct input_item_es item_es;
+        bin_GetEsFormat(r, &item_es.es);
+        item_es.id = bin_GetString(r);
+        item_es.id_stable = bin_GetBool(r);
+        if (r->error || !vlc_vector_push(&item->es_vec, item_es)) {
+            r->error = true;
+            es_format_Clean(&item_es.es);
+            free(item_es.id);
+        }
+    }
+
+    if (bin_GetBool(r)) {
+        if (item->p_meta == NULL) {
+            item->p_meta = vlc_meta_New();
+        }
+        if (item->p_meta != NULL) {
+            bin_GetMeta(r, item->p_meta);
+        } else {
+            r->error = true;
+        }
+    }
+
+    count = bin_GetCount(r);
+    for (size_t i = 0; i < count && !r->error; i++) {
+        enum slave_type type = bin_GetUintMax(r, SLAVE_TYPE_GENERIC);
+        enum slave_priority priority = bin_GetUintMax(r, SLAVE_PRIORITY_USER);
+        bool forced = bin_GetBool(r);
+        char *uri = bin_GetString(r);
+        if (uri == NULL || priority < SLAVE_PRIORITY_MATCH_NONE) {
+            r->error = true;
+        }
+        if (!r->error) {
+            struct input_item_slave *slave =
+                input_item_slave_New(uri, type, priority);
+            if (slave != NULL) {
+                slave->b_forced = forced;
+                if (input_item_AddSlave(item, slave) != VLC_SUCCESS) {
+                    input_item_slave_Delete(slave);
+                    r->error = true;
+                }
+            } else {
+                r->error = true;
+            }
+        }
+        free(uri);
+    }
+
+    item->i_type = bin_GetUintMax(r, ITEM_TYPE_NUMBER - 1);
+    item->b_net = bin_GetBool(r);
+
+    if (r->error) {
+        input_item_Release(item);
+        return NULL;
+    }
+    return item;
+}
+
+static void
+bin_PutInputItemNode(struct bin_writer *w, const input_item_node_t *node)
+{
+    bin_PutBool(w, node != NULL);
+    if (node == NULL) {
+        return;
+    }
+
+    bin_PutInputItem(w, node->p_item);
+    bin_PutUint(w, node->i_children);
+    for (int i = 0; i < node->i_children; i++) {
+        bin_PutInputItemNode(w, node->pp_children[i]);
+    }
+}
+
+static input_item_node_t *
+bin_GetInputItemNode(struct bin_reader *r, unsigned depth)
+{
+    if (!bin_GetBool(r)) {
+        return NULL;
+    }
+    if (depth >= BIN_NODE_DEPTH_MAX) {
+        r->error = true;
+        return NULL;
+    }
+
+    input_item_t *item = bin_GetInputItem(r);
+    if (item == NULL) {
+        r->error = true;
+        return NULL;
+    }
+    input_item_node_t *node = input_item_node_Create(item);
+    input_item_Release(item);
+    if (node == NULL) {
+        r->error = true;
+        return NULL;
+    }
+
+    size_t count = bin_GetCount(r);
+    for (size_t i = 0; i < count && !r->error; i++) {
+        input_item_node_t *child = bin_GetInputItemNode(r, depth + 1);
+        if (child == NULL) {
+            r->error = true;
+            break;
+        }
+        input_item_node_AppendNode(node, child);
+    }
+
+    if (r->error) {
+        input_item_node_Delete(node);
+        return NULL;
+    }
+    return node;
+}
+
+/****************************************************************************
+ * Attachments and pictures
+ *****************************************************************************/
+
+static void
+bin_PutAttachment(struct bin_writer *w, const input_attachment_t *a)
+{
+    bin_PutString(w, a->psz_name);
+    bin_PutString(w, a->psz_mime);
+    bin_PutString(w, a->psz_description);
+    bin_PutData(w, a->p_data, a->i_data);
+}
+
+static input_attachment_t *
+bin_GetAttachment(struct bin_reader *r)
+{
+    char *name = bin_GetString(r);
+    char *mime = bin_GetString(r);
+    char *description = bin_GetString(r);
+    size_t size;
+    const uint8_t *data = bin_GetData(r, &size);
+
+    input_attachment_t *a = NULL;
+    if (!r->error) {
+        a = vlc_input_attachment_New(name, mime, description, data, size);
+        if (a == NULL) {
+            r->error = true;
+        }
+    }
+    free(name);
+    free(mime);
+    free(description);
+    return a;
+}
+
+static void
+bin_PutPicture(struct bin_writer *w, const picture_t *pic)
+{
+    bin_PutBool(w, pic != NULL);
+    if (pic == NULL) {
+        return;
+    }
+
+    bin_PutVideoFormat(w, &pic->format);
+
+    /* Only the visible pixels are sent, without the margins */
+    bin_PutUint(w, pic->i_planes);
+    for (int i = 0; i < pic->i_planes; i++) {
+        const plane_t *p = &pic->p[i];
+        bin_PutUint(w, p->i_visible_lines);
+        bin_PutUint(w, p->i_visible_pitch);
+        for (int y = 0; y < p->i_visible_lines; y++) {
+            bin_PutBytes(w, p->p_pixels + (size_t)y * p->i_pitch,
+                         p->i_visible_pitch);
+        }
+    }
+
+    bin_PutInt(w, pic->date);
+    bin_PutBool(w, pic->b_force);
+    bin_PutBool(w, pic->b_still);
+    bin_PutBool(w, pic->b_progressive);
+    bin_PutBool(w, pic->b_top_field_first);
+    bin_PutBool(w, pic->b_multiview_left_eye);
+    bin_PutUint(w, pic->i_nb_fields);
+}
+
+static picture_t *
+bin_GetPicture(struct bin_reader *r)
+{
+    if (!bin_GetBool(r)) {
+        return NULL;
+    }
+
+    video_format_t fmt;
+    bin_GetVideoFormat(r, &fmt);
+    if (r->error) {
+        video_format_Clean(&fmt);
+        return NULL;
+    }
+
+    picture_t *pic = picture_NewFromFormat(&fmt);
+    video_format_Clean(&fmt);
+    if (pic == NULL) {
+        r->error = true;
+        return NULL;
+    }
+
+    /* The geometry must match the one of the allocated picture */
+    if (bin_GetUint(r) != (uint64_t)pic->i_planes) {
+        r->error = true;
+    }
+    for (int i = 0; i < pic->i_planes && !r->error; i++) {
+        plane_t *p = &pic->p[i];
+        if (bin_GetUint(r) != (uint64_t)p->i_visible_lines ||
+            bin_GetUint(r) != (uint64_t)p->i_visible_pitch) {
+            r->error = true;
+            break;
+        }
+        for (int y = 0; y < p->i_visible_lines; y++) {
+            const uint8_t *data = bin_GetBytes(r, p->i_visible_pitch);
+            if (data == NULL) {
+                break;
+            }
+            memcpy(p->p_pixels + (size_t)y * p->i_pitch, data,
+                   p->i_visible_pitch);
+        }
+    }
+
+    pic->date = bin_GetIntRange(r, INT64_MIN, INT64_MAX);
+    pic->b_force = bin_GetBool(r);
+    pic->b_still = bin_GetBool(r);
+    pic->b_progressive = bin_GetBool(r);
+    pic->b_top_field_first = bin_GetBool(r);
+    pic->b_multiview_left_eye = bin_GetBool(r);
+    pic->i_nb_fields = bin_GetUintMax(r, UINT_MAX);
+
+    if (r->error) {
+        picture_Release(pic);
+        return NULL;
+    }
+    return pic;
+}
+
+/****************************************************************************
+ * Messages
+ *****************************************************************************/
+
+static void
+bin_PutRequest(struct bin_writer *w, const struct vlc_preparser_msg_req *req)
+{
+    switch (req->type) {
+        case VLC_PREPARSER_MSG_REQ_TYPE_PARSE:
+            bin_PutInt(w, req->options);
+            break;
+        case VLC_PREPARSER_MSG_REQ_TYPE_THUMBNAIL_TO_FILES:
+            bin_PutUint(w, req->outputs.size);
+            const struct vlc_thumbnailer_output *out;
+            vlc_vector_foreach_ref(out, &req->outputs) {
+                bin_PutUint(w, out->format);
+                bin_PutInt(w, out->width);
+                bin_PutInt(w, out->height);
+                bin_PutBool(w, out->crop);
+                bin_PutString(w, out->file_path);
+                bin_PutUint(w, out->creat_mode);
+            }
+            /* fall through */
+        case VLC_PREPARSER_MSG_REQ_TYPE_THUMBNAIL:
+            bin_PutUint(w, req->arg.seek.type);
+            if (req->arg.seek.type == VLC_THUMBNAILER_SEEK_TIME) {
+                bin_PutInt(w, req->arg.seek.time);
+            } else if (req->arg.seek.type == VLC_THUMBNAILER_SEEK_POS) {
+                bin_PutDouble(w, req->arg.seek.pos);
+            }
+            bin_PutUint(w, req->arg.seek.speed);
+            bin_PutBool(w, req->arg.hw_dec);
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+
+    bin_PutString(w, req->uri);
+}
+
+static void
+bin_GetRequest(struct bin_reader *r, struct vlc_preparser_msg_req *req)
+{
+    switch (req->type) {
+        case VLC_PREPARSER_MSG_REQ_TYPE_PARSE:
+            req->options = bin_GetIntRange(r, INT_MIN, INT_MAX);
+            break;
+        case VLC_PREPARSER_MSG_REQ_TYPE_THUMBNAIL_TO_FILES: {
+            size_t count = bin_GetCount(r);
+            for (size_t i = 0; i < count && !r->error; i++) {
+                struct vlc_thumbnailer_output out;
+                out.format = bin_GetUintMax(r, VLC_THUMBNAILER_FORMAT_JPEG);
+                out.width = bin_GetIntRange(r, INT_MIN, INT_MAX);
+                out.height = bin_GetIntRange(r, INT_MIN, INT_MAX);
+                out.crop = bin_GetBool(r);
+                char *path = bin_GetString(r);
+                out.creat_mode = bin_GetUintMax(r, UINT_MAX);
+                if (path == NULL) {
+                    r->error = true;
+                }
+                if (r->error || !vlc_vector_push(&req->outputs_path, path)) {
+                    r->error = true;
+                    free(path);
+                    break;
+                }
+                out.file_path = path;
+                if (!vlc_vector_push(&req->outputs, out)) {
+                    r->error = true;
+                }
+            }
+        }
+            /* fall through */
+        case VLC_PREPARSER_MSG_REQ_TYPE_THUMBNAIL:
+            req->arg.seek.type = bin_GetUintMax(r, VLC_THUMBNAILER_SEEK_POS);
+            if (req->arg.seek.type == VLC_THUMBNAILER_SEEK_TIME) {
+                req->arg.seek.time = bin_GetIntRange(r, INT64_MIN, INT64_MAX);
+            } else if (req->arg.seek.type == VLC_THUMBNAILER_SEEK_POS) {
+                req->arg.seek.pos = bin_GetDouble(r);
+            }
+            req->arg.seek.speed =
+                bin_GetUintMax(r, VLC_THUMBNAILER_SEEK_KEYFRAME);
+            req->arg.hw_dec = bin_GetBool(r);
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+
+    req->uri = bin_GetString(r);
+}
+
+static void
+bin_PutResponse(struct bin_writer *w, const struct vlc_preparser_msg_res *res)
+{
+    switch (res->type) {
+        case VLC_PREPARSER_MSG_REQ_TYPE_PARSE:
+            bin_PutUint(w, res->attachments.size);
+            input_attachment_t *a;
+            vlc_vector_foreach(a, &res->attachments) {
+                bin_PutAttachment(w, a);
+            }
+            bin_PutInputItemNode(w, res->subtree);
+            break;
+        case VLC_PREPARSER_MSG_REQ_TYPE_THUMBNAIL:
+            bin_PutPicture(w, res->pic);
+            break;
+        case VLC_PREPARSER_MSG_REQ_TYPE_THUMBNAIL_TO_FILES:
+            bin_PutUint(w, res->result.size);
+            bool result;
+            vlc_vector_foreach(result, &res->result) {
+                bin_PutBool(w, result);
+            }
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+
+    bin_PutInt(w, res->status);
+    bin_PutInputItem(w, res->item);
+}
+
+static void
+bin_GetResponse(struct bin_reader *r, struct vlc_preparser_msg_res *res)
+{
+    size_t count;
+    switch (res->type) {
+        case VLC_PREPARSER_MSG_REQ_TYPE_PARSE:
+            count = bin_GetCount(r);
+            for (size_t i = 0; i < count && !r->error; i++) {
+                input_attachment_t *a = bin_GetAttachment(r);
+                if (a != NULL && !vlc_vector_push(&res->attachments, a)) {
+                    vlc_input_attachment_Release(a);
+                    r->error = true;
+                }
+            }
+            res->subtree = bin_GetInputItemNode(r, 0);
+            break;
+        case VLC_PREPARSER_MSG_REQ_TYPE_THUMBNAIL:
+            res->pic = bin_GetPicture(r);
+            break;
+        case VLC_PREPARSER_MSG_REQ_TYPE_THUMBNAIL_TO_FILES:
+            count = bin_GetCount(r);
+            for (size_t i = 0; i < count && !r->error; i++) {
+                bool result = bin_GetBool(r);
+                if (!vlc_vector_push(&res->result, result)) {
+                    r->error = true;
+                }
+            }
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+
+    res->status = bin_GetIntRange(r, INT_MIN, INT_MAX);
+    res->item = bin_GetInputItem(r);
+}
+
+/****************************************************************************
+ * Stream
+ *****************************************************************************/
+
+static int
+serdes_WriteAll(struct vlc_preparser_msg_serdes *serdes, const uint8_t *data,
+                size_t size, void *userdata)
+{
+    while (size != 0) {
+        ssize_t ret = serdes->owner.cbs->write(data, size, userdata);
+        if (ret < 0) {
+            return -errno;
+        } else if (ret == 0) {
+            return -EPIPE;
+        }
+        data += ret;
+        size -= ret;
+    }
+    return VLC_SUCCESS;
+}
+
+/* An interruption is not retried: it cancels the request. */
+static int
+serdes_ReadAll(struct vlc_preparser_msg_serdes *serdes, uint8_t *data,
+               size_t size, void *userdata)
+{
+    while (size != 0) {
+        ssize_t ret = serdes->owner.cbs->read(data, size, userdata);
+        if (ret < 0) {
+            return -errno;
+        } else if (ret == 0) {
+            return -EPIPE;
+        }
+        data += ret;
+        size -= ret;
+    }
+    return VLC_SUCCESS;
+}
+
+/****************************************************************************
+ * serdes Operations
+ *****************************************************************************/
+
+static int
+serdes_Serialize(struct vlc_preparser_msg_serdes *serdes,
+                 const struct vlc_preparser_msg *msg, void *userdata)
+{
+    assert(serdes != NULL);
+    struct serdes_sys *sys = serdes->owner.sys;
+
+    if (msg == NULL) {
+        return VLC_SUCCESS;
+    }
+
+    struct bin_writer w = { .sys = sys, .error = false };
+    sys->buf.size = 0;
+
+    /* Size of the payload, written once known */
+    const uint8_t header[5] = { 0, 0, 0, 0, BIN_VERSION };
+    bin_PutBytes(&w, header, sizeof(header));
+    bin_PutUint(&w, msg->type);
+    bin_PutUint(&w, msg->req_type);
+
+    if (msg->type == VLC_PREPARSER_MSG_TYPE_REQ) {
+        assert(msg->req.type == msg->req_type);
+        bin_PutRequest(&w, &msg->req);
+    } else {
+        assert(msg->res.type == msg->req_type);
+        bin_PutResponse(&w, &msg->res);
+    }
+
+    int ret = VLC_ENOMEM;
+    if (!w.error && sys->buf.size - 4 <= BIN_FRAME_MAX) {
+        SetDWLE(sys->buf.data, sys->buf.size - 4);
+        ret = serdes_WriteAll(serdes, sys->buf.data, sys->buf.size, userdata);
+    }
+
+    if (sys->buf.cap > BIN_BUFFER_KEEP) {
+        vlc_vector_clear(&sys->buf);
+    }
+    return ret;
+}
+
+static int
+serdes_Deserialize(struct vlc_preparser_msg_serdes *serdes,
+                   struct vlc_preparser_msg *msg, void *userdata)
+{
+    assert(serdes != NULL);
+    assert(msg != NULL);
+    struct serdes_sys *sys = serdes->owner.sys;
+
+    uint8_t header[4];
+    int ret = serdes_ReadAll(serdes, header, sizeof(header), userdata);
+    if (ret != VLC_SUCCESS) {
+        return ret;
+    }
+
+    uint32_t size = GetDWLE(header);
+    if (size == 0 || size > BIN_FRAME_MAX) {
+        return VLC_EGENERIC;
+    }
+    sys->buf.size = 0;
+    if (!vlc_vector_reserve(&sys->buf, size)) {
+        return VLC_ENOMEM;
+    }
+    ret = serdes_ReadAll(serdes, sys->buf.data, size, userdata);
+    if (ret != VLC_SUCCESS) {
+        return ret;
+    }
+
+    struct bin_reader r = {
+        .ptr = sys->buf.data,
+        .end = sys->buf.data + size,
+        .error = false,
+    };
+
+    const uint8_t *version = bin_GetBytes(&r, 1);
+    if (version == NULL || *version != BIN_VERSION) {
+        return VLC_EGENERIC;
+    }
+    int msg_type = bin_GetUintMax(&r, VLC_PREPARSER_MSG_TYPE_RES);
+    int req_type = bin_GetUintMax(&r,
+                                  VLC_PREPARSER_MSG_REQ_TYPE_THUMBNAIL_TO_FILES);
+    if (r.error) {
+        return VLC_EGENERIC;
+    }
+
+    vlc_preparser_msg_Init(msg, msg_type, req_type);
+    if (msg_type == VLC_PREPARSER_MSG_TYPE_REQ) {
+        bin_GetRequest(&r, &msg->req);
+    } else {
+        bin_GetResponse(&r, &msg->res);
+    }
+
+    if (sys->buf.cap > BIN_BUFFER_KEEP) {
+        vlc_vector_clear(&sys->buf);
+    }
+
+    if (r.error || r.ptr != r.end) {
+        vlc_preparser_msg_Clean(msg);
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static void
+serdes_Close(struct vlc_preparser_msg_serdes *serdes)
+{
+    assert(serdes != NULL);
+    struct serdes_sys *sys = serdes->owner.sys;
+    assert(sys != NULL);
+    serdes->owner.sys = NULL;
+
+    vlc_vector_clear(&sys->buf);
+    free(sys);
+}
+
+/**
+ * Create a new de/serializer.
+ */
+static int
+serdes_Open(struct vlc_preparser_msg_serdes *serdes, bool bin_data)
+{
+    assert(serdes != NULL);
+
+    /* The text output of the command line is left to the JSON serializer */
+    if (!bin_data) {
+        return VLC_EGENERIC;
+    }
+
+    struct serdes_sys *sys = malloc(sizeof(*sys));
+    if (sys == NULL) {
+        return VLC_ENOMEM;
+    }
+    vlc_vector_init(&sys->buf);
+
+    static const struct vlc_preparser_msg_serdes_operations ops = {
+        .serialize = serdes_Serialize,
+        .deserialize = serdes_Deserialize,
+        .close = serdes_Close,
+    };
+    serdes->ops = &ops;
+    serdes->owner.sys = sys;
+
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_description(N_("Preparser Message Binary Serializer/Deserializer"))
+    set_callback_preparser_msg_serdes(serdes_Open, 100)
+vlc_module_end()
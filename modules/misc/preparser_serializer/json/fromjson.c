@@ -1381,7 +1381,7 @@ fromJSON_vlc_preparser_msg_req(struct serdes_sys *sys,
         }
         json_object_to_enum(obj, "seek.speed", &req->arg.seek.speed,
                             &err, VLC_THUMBNAILER_SEEK_PRECISE,
-                            VLC_THUMBNAILER_SEEK_FAST);
+                            VLC_THUMBNAILER_SEEK_KEYFRAME);
         json_object_to_boolean(obj, "hw_dec", &req->arg.hw_dec, &err);
     }
     json_object_to_string(obj, "uri", &req->uri, &err);
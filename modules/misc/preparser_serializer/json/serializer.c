@@ -197,30 +197,30 @@ serdes_buf_read(struct serdes_sys *sys, void *_data, size_t size, bool eod)
     int ret = 0;
     if (eod) {
         while (1) {
-            uint8_t *zero = memchr(sys->buffer, '\0', sys->size);
+            uint8_t *zero = memchr(sys->rbuffer, '\0', sys->rsize);
             if (zero != NULL) {
                 sys->current_type = VLC_PREPARSER_MSG_SERDES_TYPE_END_DATA;
-                size_t used = zero - sys->buffer;
-                memcpy(ptr, sys->buffer, used);
+                size_t used = zero - sys->rbuffer;
+                memcpy(ptr, sys->rbuffer, used);
                 ptr += used;
-                size_t left = sys->size - (used + 1);
-                memmove(sys->buffer, zero + 1, left);
-                sys->size = left;
+                size_t left = sys->rsize - (used + 1);
+                memmove(sys->rbuffer, zero + 1, left);
+                sys->rsize = left;
                 return ptr - data;
             }
-            if (sys->size > size) {
-                memcpy(ptr, sys->buffer, size);
-                memmove(sys->buffer, sys->buffer + size, sys->size - size);
-                sys->size -= size;
+            if (sys->rsize > size) {
+                memcpy(ptr, sys->rbuffer, size);
+                memmove(sys->rbuffer, sys->rbuffer + size, sys->rsize - size);
+                sys->rsize -= size;
                 ptr += size;
                 return ptr - data;
-            } else if (sys->size != 0) {
-                memcpy(ptr, sys->buffer, sys->size);
-                ptr += sys->size;
-                size -= sys->size;
-                sys->size = 0;
+            } else if (sys->rsize != 0) {
+                memcpy(ptr, sys->rbuffer, sys->rsize);
+                ptr += sys->rsize;
+                size -= sys->rsize;
+                sys->rsize = 0;
             }
-            ret = sys->parent->owner.cbs->read(sys->buffer, sys->cap,
+            ret = sys->parent->owner.cbs->read(sys->rbuffer, sys->cap,
                                                sys->userdata);
             if (ret < 0) {
                 if (errno == EINTR) {
@@ -231,17 +231,17 @@ serdes_buf_read(struct serdes_sys *sys, void *_data, size_t size, bool eod)
             } else if (ret == 0) {
                 return ptr - data;
             }
-            sys->size = ret;
+            sys->rsize = ret;
         }
     } else {
-        if (sys->size != 0) {
-            size_t max = sys->size < size ? sys->size : size;
-            memcpy(ptr, sys->buffer, max);
+        if (sys->rsize != 0) {
+            size_t max = sys->rsize < size ? sys->rsize : size;
+            memcpy(ptr, sys->rbuffer, max);
             ptr += max;
             size -= max;
-            sys->size -= max;
-            if (sys->size != 0) {
-                memmove(sys->buffer, sys->buffer + max, sys->size);
+            sys->rsize -= max;
+            if (sys->rsize != 0) {
+                memmove(sys->rbuffer, sys->rbuffer + max, sys->rsize);
                 return max;
             }
         }
@@ -357,7 +357,6 @@ serdes_Deserialize(struct vlc_preparser_msg_serdes *serdes,
     sys->current_type = VLC_PREPARSER_MSG_SERDES_TYPE_DATA;
     sys->error = VLC_SUCCESS;
     sys->attach_data.size = 0;
-    sys->size = 0;
     sys->parent = serdes;
 
     struct json_object obj;
@@ -400,7 +399,7 @@ serdes_Open(struct vlc_preparser_msg_serdes *serdes, bool bin_data)
 {
     assert(serdes != NULL);
     
-    struct serdes_sys *sys = malloc(sizeof(*sys) + SERDES_BUFFER_SIZE);
+    struct serdes_sys *sys = malloc(sizeof(*sys) + 2 * SERDES_BUFFER_SIZE);
     if (sys == NULL) {
         return VLC_ENOMEM;
     }
@@ -410,6 +409,8 @@ serdes_Open(struct vlc_preparser_msg_serdes *serdes, bool bin_data)
     sys->cap = SERDES_BUFFER_SIZE;
     sys->bin_data = bin_data;
     memset(sys->buffer, 0, sys->cap);
+    sys->rbuffer = sys->buffer + sys->cap;
+    sys->rsize = 0;
     vlc_vector_init(&sys->attach_data);
     sys->parent = serdes;
 
@@ -28,6 +28,11 @@ struct serdes_sys {
 
     struct VLC_VECTOR(uint8_t) attach_data;
 
+    /* The data read ahead of the current message are kept in rbuffer for the
+     * next one, so that the messages can be pipelined. */
+    uint8_t *rbuffer;
+    size_t rsize;
+
     size_t cap;
     size_t size;
     uint8_t buffer[];
@@ -126,6 +126,8 @@ static int Open( vlc_object_t *p_this )
         p_dec->pf_packetize = Packetize;
     p_dec->pf_flush = Flush;
     p_dec->pf_get_cc = NULL;
+    /* Frames only get their length, unless a parser flags their type */
+    p_dec->b_passthrough = p_sys->pf_parse == NULL;
 
     return VLC_SUCCESS;
 }
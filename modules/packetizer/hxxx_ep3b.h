@@ -20,10 +20,42 @@
  *****************************************************************************/
 #include <vlc_bits.h>
 
+/* Returns the length, rounded down to 8 bytes, of the run of non zero bytes
+ * starting at p, looking at most at i_max bytes.
+ * Tests 8 bytes at once using the same trick as startcode_FindAnnexB_Bits */
+static inline size_t hxxx_ep3b_nonzero_run( const uint8_t *p, size_t i_max )
+{
+    size_t i = 0;
+    for( ; i + 8 <= i_max; i += 8 )
+    {
+        uint64_t x;
+        memcpy( &x, &p[i], sizeof(x) );
+        if( (x - UINT64_C(0x0101010101010101)) & ~x & UINT64_C(0x8080808080808080) )
+            break;
+    }
+    return i;
+}
+
 static inline uint8_t *hxxx_ep3b_to_rbsp( uint8_t *p, uint8_t *end, unsigned *pi_prev, size_t i_count )
 {
-    for( size_t i=0; i<i_count; i++ )
+    size_t i = 0;
+    while( i < i_count )
     {
+        /* No escape sequence can start or end inside a run of non zero
+         * bytes that doesn't follow a zero: forward it at once */
+        if( i_count - i >= 8 && !(*pi_prev & 1) && p < end )
+        {
+            size_t i_max = __MIN( i_count - i, (size_t)(end - p - 1) );
+            size_t i_run = hxxx_ep3b_nonzero_run( p + 1, i_max );
+            if( i_run )
+            {
+                p += i_run;
+                i += i_run;
+                *pi_prev = 0;
+                continue;
+            }
+        }
+
         if( ++p >= end )
             return p;
 
@@ -38,6 +70,7 @@ static inline uint8_t *hxxx_ep3b_to_rbsp( uint8_t *p, uint8_t *end, unsigned *pi
                 *pi_prev = !*p;
             }
         }
+        i++;
     }
     return p;
 }
@@ -34,6 +34,10 @@
 #  endif
 #endif
 
+#if defined(__ARM_NEON)
+#  include <arm_neon.h>
+#endif
+
 /* Looks up efficiently for an AnnexB startcode 0x00 0x00 0x01
  * by using a 4 times faster trick than single byte lookup. */
 
@@ -119,6 +123,132 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
 
 #endif
 
+#ifdef CAN_COMPILE_AVX2
+
+__attribute__ ((__target__ ("avx2")))
+static inline const uint8_t * startcode_FindAnnexB_AVX2( const uint8_t *p, const uint8_t *end )
+{
+    /* First align to 32 */
+    const uint8_t *alignedend = p + 32 - ((intptr_t)p & 31);
+    for (end -= 3; p < alignedend && p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    alignedend = end - ((intptr_t) end & 31);
+    for( ; p < alignedend; p += 32)
+    {
+        uint32_t match;
+        asm volatile(
+            "vpxor      %%ymm1,   %%ymm1,   %%ymm1\n"
+            "vpcmpeqb  0(%[v]),   %%ymm1,   %%ymm0\n"
+            "vpmovmskb  %%ymm0,   %[match]\n" /* mask will be in reversed match order */
+            "vzeroupper\n"
+            : [match]"=r"(match)
+            : [v]"r"(p)
+            : "xmm0", "xmm1"
+        );
+        if( match == 0 )
+            continue;
+        for( unsigned i = 0; i < 32; i += 4 )
+        {
+            if( match & (0xFU << i) )
+                TRY_MATCH(p, i);
+        }
+    }
+
+    for (; p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
+#if defined(CAN_COMPILE_AVX512) && defined(__x86_64__)
+
+__attribute__ ((__target__ ("avx512bw")))
+static inline const uint8_t * startcode_FindAnnexB_AVX512( const uint8_t *p, const uint8_t *end )
+{
+    /* First align to 64 */
+    const uint8_t *alignedend = p + 64 - ((intptr_t)p & 63);
+    for (end -= 3; p < alignedend && p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    alignedend = end - ((intptr_t) end & 63);
+    for( ; p < alignedend; p += 64)
+    {
+        uint64_t match;
+        asm volatile(
+            "vmovdqa64 0(%[v]),   %%zmm0\n"
+            "vptestnmb  %%zmm0,   %%zmm0,   %%k1\n" /* set for each zero byte */
+            "kmovq        %%k1,   %[match]\n"
+            "vzeroupper\n"
+            : [match]"=r"(match)
+            : [v]"r"(p)
+            : "xmm0", "k1"
+        );
+        if( match == 0 )
+            continue;
+        for( unsigned i = 0; i < 64; i += 4 )
+        {
+            if( match & (UINT64_C(0xF) << i) )
+                TRY_MATCH(p, i);
+        }
+    }
+
+    for (; p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
+#if defined(__ARM_NEON)
+
+static inline const uint8_t * startcode_FindAnnexB_NEON( const uint8_t *p, const uint8_t *end )
+{
+    /* First align to 16 */
+    const uint8_t *alignedend = p + 16 - ((intptr_t)p & 15);
+    for (end -= 3; p < alignedend && p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    alignedend = end - ((intptr_t) end & 15);
+    const uint8x16_t zeros = vdupq_n_u8( 0 );
+    for( ; p < alignedend; p += 16)
+    {
+        /* Narrow the 0x00/0xFF comparison result to one nibble per byte */
+        uint8x16_t cmp = vceqq_u8( vld1q_u8( p ), zeros );
+        uint8x8_t nibbles = vshrn_n_u16( vreinterpretq_u16_u8( cmp ), 4 );
+        uint64_t match = vget_lane_u64( vreinterpret_u64_u8( nibbles ), 0 );
+        if( match == 0 )
+            continue;
+        for( unsigned i = 0; i < 16; i += 4 )
+        {
+            if( match & (UINT64_C(0xFFFF) << (i * 4)) )
+                TRY_MATCH(p, i);
+        }
+    }
+
+    for (; p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
 /* That code is adapted from libav's ff_avc_find_startcode_internal
  * and i believe the trick originated from
  * https://graphics.stanford.edu/~seander/bithacks.html#ZeroInWord
@@ -151,13 +281,27 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
 }
 #undef TRY_MATCH
 
-#ifdef CAN_COMPILE_SSE2
+#if defined(CAN_COMPILE_SSE2) || defined(CAN_COMPILE_AVX2) || defined(__ARM_NEON)
 static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
 {
+    /* Wider vectors only pay off once the unaligned head is amortized */
+#  if defined(CAN_COMPILE_AVX512) && defined(__x86_64__)
+    if (end - p >= 512 && vlc_CPU_AVX512())
+        return startcode_FindAnnexB_AVX512(p, end);
+#  endif
+#  ifdef CAN_COMPILE_AVX2
+    if (end - p >= 256 && vlc_CPU_AVX2())
+        return startcode_FindAnnexB_AVX2(p, end);
+#  endif
+#  ifdef CAN_COMPILE_SSE2
     if (vlc_CPU_SSE2())
         return startcode_FindAnnexB_SSE2(p, end);
-    else
-        return startcode_FindAnnexB_Bits(p, end);
+#  endif
+#  if defined(__ARM_NEON)
+    return startcode_FindAnnexB_NEON(p, end);
+#  else
+    return startcode_FindAnnexB_Bits(p, end);
+#  endif
 }
 #else
     #define startcode_FindAnnexB startcode_FindAnnexB_Bits
@@ -32,22 +32,20 @@
 #include <vlc_plugin.h>
 #include <vlc_stream.h>
 #include <vlc_interrupt.h>
+#include <vlc_list.h>
 
 // #define STREAM_DEBUG 1
 
 /*
- * Complex scheme using multiple track to avoid seeking
+ * Block cache retaining several byte ranges of the stream
  */
 
-/* How many tracks we have, currently only used for stream mode */
 #ifdef OPTIMIZE_MEMORY
-#   define STREAM_CACHE_TRACK 1
-    /* Max size of our cache 128Ko per track */
-#   define STREAM_CACHE_SIZE  (STREAM_CACHE_TRACK*1024*128)
+    /* Max size of our cache 384Ko */
+#   define STREAM_CACHE_SIZE  (1024*384)
 #else
-#   define STREAM_CACHE_TRACK 3
-    /* Max size of our cache 4Mo per track */
-#   define STREAM_CACHE_SIZE  (4*STREAM_CACHE_TRACK*1024*1024)
+    /* Max size of our cache 12Mo */
+#   define STREAM_CACHE_SIZE  (12*1024*1024)
 #endif
 
 /* How many data we try to prebuffer
@@ -56,45 +54,49 @@
 #define STREAM_CACHE_PREBUFFER_SIZE (128)
 
 /* Method:
- *  - We use ring buffers, only one if unseekable, all if seekable
- *  - Upon seek date current ring, then search if one ring match the pos,
- *      yes: switch to it, seek the access to match the end of the ring
- *      no: search the ring with i_end the closer to i_pos,
- *          if close enough, read data and use this ring
- *          else use the oldest ring, seek and use it.
+ *  - The stream is split in aligned blocks, each block caches the data from
+ *    its start, possibly not up to its end.
+ *  - The blocks are looked up by offset through a hash table, and recycled
+ *    in least recently used order once the cache is full. Hence, the header
+ *    and index of a file stay cached while its media data is read, and
+ *    reading them again does not cost a seek of the access.
+ *  - The access is seeked only when reading uncached data out of sequence.
+ *    Data to skip is read (and cached) instead if there is not much of it.
  *
- *  TODO: - with access non seekable: use all space available for only one ring, but
- *          we have to support seekable/non-seekable switch on the fly.
- *        - compute a good value for i_read_size
+ *  TODO: - compute a good value for i_read_size
  *        - ?
  */
 #define STREAM_READ_ATONCE 1024
-#define STREAM_CACHE_TRACK_SIZE (STREAM_CACHE_SIZE/STREAM_CACHE_TRACK)
+#define STREAM_CACHE_BLOCK_SIZE (32*1024)
+#define STREAM_CACHE_BLOCKS (STREAM_CACHE_SIZE/STREAM_CACHE_BLOCK_SIZE)
+#define STREAM_CACHE_BUCKETS 256
 
-typedef struct
+typedef struct stream_block_t
 {
-    vlc_tick_t date;
+    struct stream_block_t *p_next; /* hash chain */
+    struct vlc_list node; /* LRU or free list */
 
-    uint64_t i_start;
-    uint64_t i_end;
+    uint64_t i_index; /* Block offset / STREAM_CACHE_BLOCK_SIZE */
+    size_t   i_length; /* Cached bytes from the block start */
 
     uint8_t *p_buffer;
 
-} stream_track_t;
+} stream_block_t;
 
 typedef struct
 {
     uint64_t     i_pos;      /* Current reading offset */
+    uint64_t     i_access_pos; /* Current access offset */
 
-    unsigned     i_offset;   /* Buffer offset in the current track */
-    int          i_tk;       /* Current track */
-    stream_track_t tk[STREAM_CACHE_TRACK];
+    stream_block_t blocks[STREAM_CACHE_BLOCKS];
+    stream_block_t *hash[STREAM_CACHE_BUCKETS];
+    struct vlc_list lru; /* most recently used first */
+    struct vlc_list free;
 
     /* Global buffer */
     uint8_t     *p_buffer;
 
     /* */
-    unsigned     i_used; /* Used since last read */
     unsigned     i_read_size;
 
     struct
@@ -106,115 +108,203 @@ typedef struct
     } stat;
 } stream_sys_t;
 
-static int AStreamRefillStream(stream_t *s)
+static stream_block_t **AStreamBucket(stream_sys_t *sys, uint64_t i_index)
 {
-    stream_sys_t *sys = s->p_sys;
-    stream_track_t *tk = &sys->tk[sys->i_tk];
+    return &sys->hash[i_index % STREAM_CACHE_BUCKETS];
+}
 
-    /* We read but won't increase i_start after initial start + offset */
-    int i_toread =
-        __MIN(sys->i_used, STREAM_CACHE_TRACK_SIZE -
-               (tk->i_end - tk->i_start - sys->i_offset));
+static stream_block_t *AStreamBlockLookup(stream_sys_t *sys, uint64_t i_index)
+{
+    stream_block_t *blk = *AStreamBucket(sys, i_index);
 
-    if (i_toread <= 0) return VLC_SUCCESS; /* EOF */
+    while (blk != NULL && blk->i_index != i_index)
+        blk = blk->p_next;
+    return blk;
+}
 
-#ifdef STREAM_DEBUG
-    msg_Dbg(s, "AStreamRefillStream: used=%d toread=%d",
-                 sys->i_used, i_toread);
-#endif
+static stream_block_t *AStreamBlockNew(stream_sys_t *sys, uint64_t i_index)
+{
+    stream_block_t *blk =
+        vlc_list_first_entry_or_null(&sys->free, stream_block_t, node);
+
+    if (blk == NULL)
+    {   /* Recycle the least recently used block */
+        blk = vlc_list_last_entry_or_null(&sys->lru, stream_block_t, node);
+        assert(blk != NULL);
+
+        stream_block_t **pp = AStreamBucket(sys, blk->i_index);
+        while (*pp != blk)
+            pp = &(*pp)->p_next;
+        *pp = blk->p_next;
+    }
+    vlc_list_remove(&blk->node);
+
+    blk->i_index = i_index;
+    blk->i_length = 0;
+    blk->p_next = *AStreamBucket(sys, i_index);
+    *AStreamBucket(sys, i_index) = blk;
+    vlc_list_prepend(&blk->node, &sys->lru);
+    return blk;
+}
+
+static void AStreamBlockTouch(stream_sys_t *sys, stream_block_t *blk)
+{
+    vlc_list_remove(&blk->node);
+    vlc_list_prepend(&blk->node, &sys->lru);
+}
+
+static void AStreamBlocksReset(stream_sys_t *sys)
+{
+    vlc_list_init(&sys->lru);
+    vlc_list_init(&sys->free);
+    for (unsigned i = 0; i < STREAM_CACHE_BUCKETS; i++)
+        sys->hash[i] = NULL;
+    for (unsigned i = 0; i < STREAM_CACHE_BLOCKS; i++)
+        vlc_list_append(&sys->blocks[i].node, &sys->free);
+}
+
+/* End of the cached data of the block containing i_pos, the data at i_pos is
+ * cached if it is beyond i_pos, otherwise this is where to read from */
+static uint64_t AStreamCachedEnd(stream_sys_t *sys, uint64_t i_pos)
+{
+    uint64_t i_index = i_pos / STREAM_CACHE_BLOCK_SIZE;
+    stream_block_t *blk = AStreamBlockLookup(sys, i_index);
+    uint64_t i_end = i_index * STREAM_CACHE_BLOCK_SIZE;
+
+    if (blk != NULL)
+        i_end += blk->i_length;
+    return i_end;
+}
+
+/* Read up to i_toread bytes from the access, without crossing a block
+ * boundary, and cache them if they extend a block */
+static ssize_t AStreamReadAccess(stream_t *s, size_t i_toread)
+{
+    stream_sys_t *sys = s->p_sys;
+    uint64_t i_index = sys->i_access_pos / STREAM_CACHE_BLOCK_SIZE;
+    size_t i_off = sys->i_access_pos % STREAM_CACHE_BLOCK_SIZE;
+    stream_block_t *blk = AStreamBlockLookup(sys, i_index);
+    uint8_t *p_dst = NULL;
+
+    if (i_toread > STREAM_CACHE_BLOCK_SIZE - i_off)
+        i_toread = STREAM_CACHE_BLOCK_SIZE - i_off;
+
+    if (blk == NULL && i_off == 0)
+        blk = AStreamBlockNew(sys, i_index);
+    if (blk != NULL && blk->i_length == i_off)
+        p_dst = &blk->p_buffer[i_off];
+    /* Otherwise the data is either already cached or not at the start of a
+     * block: skip it */
 
     vlc_tick_t start = vlc_tick_now();
-    while (i_toread > 0)
-    {
-        int i_off = tk->i_end % STREAM_CACHE_TRACK_SIZE;
-        int i_read;
+    ssize_t i_read = vlc_stream_Read(s->s, p_dst, i_toread);
 
-        if (vlc_killed())
-            return VLC_EGENERIC;
+    if (p_dst != NULL)
+        blk->i_length += i_read;
+    sys->i_access_pos += i_read;
 
-        i_read = __MIN(i_toread, STREAM_CACHE_TRACK_SIZE - i_off);
-        i_read = vlc_stream_Read(s->s, &tk->p_buffer[i_off], i_read);
+    sys->stat.i_bytes += i_read;
+    sys->stat.i_read_count++;
+    sys->stat.i_read_time += vlc_tick_now() - start;
+    return i_read;
+}
 
-        /* msg_Dbg(s, "AStreamRefillStream: read=%d", i_read); */
-        if (i_read <  0)
-        {
-            continue;
-        }
-        else if (i_read == 0)
-            return VLC_SUCCESS;
+/* Move the access to the given offset, unless it can just read up to it */
+static int AStreamSeekAccess(stream_t *s, uint64_t i_pos)
+{
+    stream_sys_t *sys = s->p_sys;
 
-        /* Update end */
-        tk->i_end += i_read;
+    if (sys->i_access_pos == i_pos)
+        return VLC_SUCCESS;
 
-        /* Windows of STREAM_CACHE_TRACK_SIZE */
-        if (tk->i_start + STREAM_CACHE_TRACK_SIZE < tk->i_end)
-        {
-            unsigned i_invalid = tk->i_end - tk->i_start - STREAM_CACHE_TRACK_SIZE;
+    bool   b_aseek;
+    vlc_stream_Control(s->s, STREAM_CAN_SEEK, &b_aseek);
 
-            tk->i_start += i_invalid;
-            sys->i_offset -= i_invalid;
-        }
+    bool   b_afastseek;
+    vlc_stream_Control(s->s, STREAM_CAN_FASTSEEK, &b_afastseek);
+
+    /* FIXME compute seek cost (instead of static 'stupid' value) */
+    uint64_t i_skip_threshold;
+    if (b_aseek)
+        i_skip_threshold = b_afastseek ? 128 : 3 * sys->i_read_size;
+    else
+        i_skip_threshold = UINT64_MAX;
 
-        i_toread -= i_read;
-        sys->i_used -= i_read;
+    if (sys->i_access_pos < i_pos
+     && i_pos - sys->i_access_pos <= i_skip_threshold)
+        return VLC_SUCCESS; /* skip by reading */
 
-        sys->stat.i_bytes += i_read;
-        sys->stat.i_read_count++;
+    if (!b_aseek)
+    {
+        msg_Warn(s, "AStreamSeekStream: can't seek");
+        return VLC_EGENERIC;
     }
 
-    sys->stat.i_read_time += vlc_tick_now() - start;
+#ifdef STREAM_DEBUG
+    msg_Dbg(s, "AStreamSeekAccess: hard seek to %"PRIu64" from %"PRIu64,
+            i_pos, sys->i_access_pos);
+#endif
+    if (vlc_stream_Seek(s->s, i_pos))
+    {
+        msg_Err(s, "AStreamSeekStream: hard seek failed");
+        return VLC_EGENERIC;
+    }
+    sys->i_access_pos = i_pos;
     return VLC_SUCCESS;
 }
 
-static void AStreamPrebufferStream(stream_t *s)
+/* Make sure that the data at the current offset is cached */
+static int AStreamFill(stream_t *s, size_t len)
 {
     stream_sys_t *sys = s->p_sys;
-    vlc_tick_t start = vlc_tick_now();
-    bool first = true;
 
-    msg_Dbg(s, "starting pre-buffering");
     for (;;)
     {
-        stream_track_t *tk = &sys->tk[sys->i_tk];
-        vlc_tick_t now = vlc_tick_now();
+        uint64_t i_fill = AStreamCachedEnd(sys, sys->i_pos);
 
-        int i_read;
-        int i_buffered = tk->i_end - tk->i_start;
+        if (i_fill > sys->i_pos)
+            return VLC_SUCCESS;
+        if (vlc_killed())
+            return VLC_EGENERIC;
 
-        if (vlc_killed() || i_buffered >= STREAM_CACHE_PREBUFFER_SIZE)
-        {
-            int64_t i_byterate;
+        /* Extend the block from the end of its cached data */
+        if (AStreamSeekAccess(s, i_fill))
+            return VLC_EGENERIC;
 
-            /* Update stat */
-            sys->stat.i_bytes = i_buffered;
-            sys->stat.i_read_time = now - start;
-            i_byterate = (CLOCK_FREQ * sys->stat.i_bytes) /
-                         (sys->stat.i_read_time+1);
+        size_t i_toread = sys->i_pos - sys->i_access_pos
+                        + VLC_CLIP(len, STREAM_READ_ATONCE / 2,
+                                   STREAM_READ_ATONCE * 10);
+        if (AStreamReadAccess(s, i_toread) <= 0)
+            return VLC_EGENERIC;
+    }
+}
 
-            msg_Dbg(s, "pre-buffering done %"PRId64" bytes in %"PRId64"s - "
-                    "%"PRId64" KiB/s", sys->stat.i_bytes,
-                    SEC_FROM_VLC_TICK(sys->stat.i_read_time), i_byterate / 1024);
-            break;
-        }
+static void AStreamPrebufferStream(stream_t *s)
+{
+    stream_sys_t *sys = s->p_sys;
+    vlc_tick_t start = vlc_tick_now();
+
+    msg_Dbg(s, "starting pre-buffering");
 
-        i_read = STREAM_CACHE_TRACK_SIZE - i_buffered;
-        i_read = __MIN((int)sys->i_read_size, i_read);
-        i_read = vlc_stream_Read(s->s, &tk->p_buffer[i_buffered], i_read);
-        if (i_read <  0)
-            continue;
-        else if (i_read == 0)
+    while (!vlc_killed() && sys->i_access_pos < STREAM_CACHE_PREBUFFER_SIZE)
+    {
+        ssize_t i_read = AStreamReadAccess(s, sys->i_read_size);
+        if (i_read <= 0)
             break;  /* EOF */
 
-        if (first)
-        {
+        if (sys->i_access_pos == (uint64_t)i_read)
             msg_Dbg(s, "received first data after %"PRId64" ms",
                     MS_FROM_VLC_TICK(vlc_tick_now() - start));
-            first = false;
-        }
-
-        tk->i_end += i_read;
-        sys->stat.i_read_count++;
     }
+
+    /* Update stat */
+    sys->stat.i_read_time = vlc_tick_now() - start;
+    int64_t i_byterate = (CLOCK_FREQ * sys->stat.i_bytes) /
+                         (sys->stat.i_read_time+1);
+
+    msg_Dbg(s, "pre-buffering done %"PRId64" bytes in %"PRId64"s - "
+            "%"PRId64" KiB/s", sys->stat.i_bytes,
+            SEC_FROM_VLC_TICK(sys->stat.i_read_time), i_byterate / 1024);
 }
 
 /****************************************************************************
@@ -225,18 +315,10 @@ static void AStreamControlReset(stream_t *s)
     stream_sys_t *sys = s->p_sys;
 
     sys->i_pos = 0;
+    sys->i_access_pos = 0;
 
-    /* Setup our tracks */
-    sys->i_offset = 0;
-    sys->i_tk     = 0;
-    sys->i_used   = 0;
-
-    for (unsigned i = 0; i < STREAM_CACHE_TRACK; i++)
-    {
-        sys->tk[i].date  = 0;
-        sys->tk[i].i_start = sys->i_pos;
-        sys->tk[i].i_end   = sys->i_pos;
-    }
+    /* Drop our blocks */
+    AStreamBlocksReset(sys);
 
     /* Do the prebuffering */
     AStreamPrebufferStream(s);
@@ -245,201 +327,49 @@ static void AStreamControlReset(stream_t *s)
 static ssize_t AStreamReadStream(stream_t *s, void *buf, size_t len)
 {
     stream_sys_t *sys = s->p_sys;
-    stream_track_t *tk = &sys->tk[sys->i_tk];
-
-    if (tk->i_start >= tk->i_end)
-        return 0; /* EOF */
 
 #ifdef STREAM_DEBUG
-    msg_Dbg(s, "AStreamReadStream: %zd pos=%"PRId64" tk=%d start=%"PRId64
-            " offset=%d end=%"PRId64, len, sys->i_pos, sys->i_tk,
-            tk->i_start, sys->i_offset, tk->i_end);
+    msg_Dbg(s, "AStreamReadStream: %zd pos=%"PRId64" access=%"PRId64,
+            len, sys->i_pos, sys->i_access_pos);
 #endif
 
-    unsigned i_off = (tk->i_start + sys->i_offset) % STREAM_CACHE_TRACK_SIZE;
-    size_t i_current = __MIN(tk->i_end - tk->i_start - sys->i_offset,
-                             STREAM_CACHE_TRACK_SIZE - i_off);
-    ssize_t i_copy = __MIN(i_current, len);
-    if (i_copy <= 0)
+    if (len == 0 || AStreamFill(s, len))
         return 0; /* EOF */
 
+    stream_block_t *blk =
+        AStreamBlockLookup(sys, sys->i_pos / STREAM_CACHE_BLOCK_SIZE);
+    size_t i_off = sys->i_pos % STREAM_CACHE_BLOCK_SIZE;
+    size_t i_copy = __MIN(blk->i_length - i_off, len);
+
+    assert(blk->i_length > i_off);
+
     /* Copy data */
-    /* msg_Dbg(s, "AStreamReadStream: copy %zd", i_copy); */
     if (buf != NULL)
-        memcpy(buf, &tk->p_buffer[i_off], i_copy);
-    sys->i_offset += i_copy;
+        memcpy(buf, &blk->p_buffer[i_off], i_copy);
+    AStreamBlockTouch(sys, blk);
 
     /* Update pos now */
     sys->i_pos += i_copy;
 
-    /* */
-    sys->i_used += i_copy;
-
-    if (tk->i_end + i_copy <= tk->i_start + sys->i_offset + len)
-    {
-        const size_t i_read_requested = VLC_CLIP(len - i_copy,
-                                                 STREAM_READ_ATONCE / 2,
-                                                 STREAM_READ_ATONCE * 10);
-        if (sys->i_used < i_read_requested)
-            sys->i_used = i_read_requested;
-
-        AStreamRefillStream(s);
-    }
-
     return i_copy;
 }
 
 static int AStreamSeekStream(stream_t *s, uint64_t i_pos)
 {
     stream_sys_t *sys = s->p_sys;
-    stream_track_t *p_current = &sys->tk[sys->i_tk];
-
-    if (p_current->i_start >= p_current->i_end  && i_pos >= p_current->i_end)
-        return 0; /* EOF */
 
 #ifdef STREAM_DEBUG
     msg_Dbg(s, "AStreamSeekStream: to %"PRId64" pos=%"PRId64
-             " tk=%d start=%"PRId64" offset=%d end=%"PRId64,
-             i_pos, sys->i_pos, sys->i_tk, p_current->i_start,
-             sys->i_offset, p_current->i_end);
+             " access=%"PRId64, i_pos, sys->i_pos, sys->i_access_pos);
 #endif
 
-    bool   b_aseek;
-    vlc_stream_Control(s->s, STREAM_CAN_SEEK, &b_aseek);
-    if (!b_aseek && i_pos < p_current->i_start)
-    {
-        msg_Warn(s, "AStreamSeekStream: can't seek");
+    /* Seek the access now, if needed, so that failures are reported here,
+     * but do not read anything until requested */
+    uint64_t i_fill = AStreamCachedEnd(sys, i_pos);
+    if (i_fill <= i_pos && AStreamSeekAccess(s, i_fill))
         return VLC_EGENERIC;
-    }
-
-    bool   b_afastseek;
-    vlc_stream_Control(s->s, STREAM_CAN_FASTSEEK, &b_afastseek);
 
-    /* FIXME compute seek cost (instead of static 'stupid' value) */
-    uint64_t i_skip_threshold;
-    if (b_aseek)
-        i_skip_threshold = b_afastseek ? 128 : 3 * sys->i_read_size;
-    else
-        i_skip_threshold = INT64_MAX;
-
-    /* Date the current track */
-    p_current->date = vlc_tick_now();
-
-    /* Search a new track slot */
-    stream_track_t *tk = NULL;
-    int i_tk_idx = -1;
-
-    /* Prefer the current track */
-    if (p_current->i_start <= i_pos && i_pos <= p_current->i_end + i_skip_threshold)
-    {
-        tk = p_current;
-        i_tk_idx = sys->i_tk;
-    }
-    if (!tk)
-    {
-        /* Try to maximize already read data */
-        for (int i = 0; i < STREAM_CACHE_TRACK; i++)
-        {
-            stream_track_t *t = &sys->tk[i];
-
-            if (t->i_start > i_pos || i_pos > t->i_end)
-                continue;
-
-            if (!tk || tk->i_end < t->i_end)
-            {
-                tk = t;
-                i_tk_idx = i;
-            }
-        }
-    }
-    if (!tk)
-    {
-        /* Use the oldest unused */
-        for (int i = 0; i < STREAM_CACHE_TRACK; i++)
-        {
-            stream_track_t *t = &sys->tk[i];
-
-            if (!tk || tk->date > t->date)
-            {
-                tk = t;
-                i_tk_idx = i;
-            }
-        }
-    }
-    assert(i_tk_idx >= 0 && i_tk_idx < STREAM_CACHE_TRACK);
-
-    if (tk != p_current)
-        i_skip_threshold = 0;
-    if (tk->i_start <= i_pos && i_pos <= tk->i_end + i_skip_threshold)
-    {
-#ifdef STREAM_DEBUG
-        msg_Err(s, "AStreamSeekStream: reusing %d start=%"PRId64
-                 " end=%"PRId64"(%s)",
-                 i_tk_idx, tk->i_start, tk->i_end,
-                 tk != p_current ? "seek" : i_pos > tk->i_end ? "skip" : "noseek");
-#endif
-        if (tk != p_current)
-        {
-            assert(b_aseek);
-
-            /* Seek at the end of the buffer
-             * TODO it is stupid to seek now, it would be better to delay it
-             */
-            if (vlc_stream_Seek(s->s, tk->i_end))
-            {
-                msg_Err(s, "AStreamSeekStream: hard seek failed");
-                return VLC_EGENERIC;
-            }
-        }
-        else if (i_pos > tk->i_end)
-        {
-            uint64_t i_skip = i_pos - tk->i_end;
-            while (i_skip > 0)
-            {
-                const int i_read_max = __MIN(10 * STREAM_READ_ATONCE, i_skip);
-                int i_read = 0;
-                if ((i_read = AStreamReadStream(s, NULL, i_read_max)) < 0)
-                {
-                    msg_Err(s, "AStreamSeekStream: skip failed");
-                    return VLC_EGENERIC;
-                } else if (i_read == 0)
-                    return VLC_SUCCESS; /* EOF */
-                i_skip -= i_read_max;
-            }
-        }
-    }
-    else
-    {
-#ifdef STREAM_DEBUG
-        msg_Err(s, "AStreamSeekStream: hard seek");
-#endif
-        /* Nothing good, seek and choose oldest segment */
-        if (vlc_stream_Seek(s->s, i_pos))
-        {
-            msg_Err(s, "AStreamSeekStream: hard seek failed");
-            return VLC_EGENERIC;
-        }
-
-        tk->i_start = i_pos;
-        tk->i_end   = i_pos;
-    }
-    sys->i_offset = i_pos - tk->i_start;
-    sys->i_tk = i_tk_idx;
     sys->i_pos = i_pos;
-
-    /* If there is not enough data left in the track, refill  */
-    /* TODO How to get a correct value for
-     *    - refilling threshold
-     *    - how much to refill
-     */
-    if (tk->i_end < tk->i_start + sys->i_offset + sys->i_read_size)
-    {
-        if (sys->i_used < STREAM_READ_ATONCE / 2)
-            sys->i_used = STREAM_READ_ATONCE / 2;
-
-        if (AStreamRefillStream(s))
-            return VLC_EGENERIC;
-    }
     return VLC_SUCCESS;
 }
 
@@ -469,6 +399,7 @@ static int AStreamControl(stream_t *s, int i_query, va_list args)
         case STREAM_SET_PRIVATE_ID_CA:
         case STREAM_GET_PRIVATE_ID_STATE:
         case STREAM_GET_MTIME:
+        case STREAM_GET_BUFFERING:
             return vlc_stream_vaControl(s->s, i_query, args);
 
         case STREAM_SET_TITLE:
@@ -501,6 +432,7 @@ static int Open(vlc_object_t *obj)
 
     /* Common field */
     sys->i_pos = 0;
+    sys->i_access_pos = 0;
 
     /* Stats */
     sys->stat.i_bytes = 0;
@@ -509,9 +441,7 @@ static int Open(vlc_object_t *obj)
 
     msg_Dbg(s, "Using stream method for AStream*");
 
-    /* Allocate/Setup our tracks */
-    sys->i_offset = 0;
-    sys->i_tk     = 0;
+    /* Allocate/Setup our blocks */
     sys->p_buffer = malloc(STREAM_CACHE_SIZE);
     if (sys->p_buffer == NULL)
     {
@@ -519,25 +449,21 @@ static int Open(vlc_object_t *obj)
         return VLC_ENOMEM;
     }
 
-    sys->i_used   = 0;
     sys->i_read_size = STREAM_READ_ATONCE;
     static_assert (STREAM_READ_ATONCE >= 256,
                    "Invalid STREAM_READ_ATONCE value");
 
-    for (unsigned i = 0; i < STREAM_CACHE_TRACK; i++)
-    {
-        sys->tk[i].date  = 0;
-        sys->tk[i].i_start = sys->i_pos;
-        sys->tk[i].i_end   = sys->i_pos;
-        sys->tk[i].p_buffer = &sys->p_buffer[i * STREAM_CACHE_TRACK_SIZE];
-    }
+    for (unsigned i = 0; i < STREAM_CACHE_BLOCKS; i++)
+        sys->blocks[i].p_buffer =
+            &sys->p_buffer[i * STREAM_CACHE_BLOCK_SIZE];
+    AStreamBlocksReset(sys);
 
     s->p_sys = sys;
 
     /* Do the prebuffering */
     AStreamPrebufferStream(s);
 
-    if (sys->tk[sys->i_tk].i_end <= 0)
+    if (sys->i_access_pos == 0)
     {
         msg_Err(s, "cannot pre fill buffer");
         free(sys->p_buffer);
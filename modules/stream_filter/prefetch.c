@@ -24,6 +24,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <stdbit.h>
 #include <string.h>
 
 #include <sys/types.h>
@@ -34,6 +35,16 @@
 #include <vlc_stream.h>
 #include <vlc_fs.h>
 #include <vlc_interrupt.h>
+#include <vlc_tick.h>
+
+/* Smallest adaptive buffer size */
+#define PREFETCH_MIN_SIZE (1 << 18)
+/* Consumption rate sampling period */
+#define PREFETCH_RATE_PERIOD VLC_TICK_FROM_MS(500)
+/* Largest window boost after repeated underruns (as a power of two) */
+#define PREFETCH_MAX_BOOST 3
+/* Delay without underrun before the window boost is halved */
+#define PREFETCH_BOOST_DECAY VLC_TICK_FROM_SEC(30)
 
 struct stream_ctrl
 {
@@ -76,6 +87,18 @@ typedef struct
     char        *buffer;
     size_t       seek_threshold;
 
+    /* Adaptive buffer sizing, the size is kept in between PREFETCH_MIN_SIZE
+     * and buffer_max, and is only changed by the thread. */
+    size_t       buffer_max;
+    vlc_tick_t   buffer_duration; /* 0 if the size is fixed */
+    uint64_t     read_bytes; /* consumed since rate_date */
+    vlc_tick_t   rate_date;
+    uint64_t     rate; /* bytes per second, 0 if unknown */
+    unsigned     boost;
+    vlc_tick_t   boost_date;
+    uint64_t     underruns;
+    bool         primed; /* data was read since the last seek */
+
     struct stream_ctrl *controls;
 } stream_sys_t;
 
@@ -124,6 +147,97 @@ static int ThreadControl(stream_t *stream, int query, ...)
     return ret;
 }
 
+/* Move the buffered data to a circular buffer of a different size */
+static int Resize(stream_t *stream, size_t size)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    if (sys->buffer_length > size)
+    {   /* Discard the oldest historical data */
+        size_t drop = sys->buffer_length - size;
+
+        assert(sys->stream_offset - sys->buffer_offset >= drop);
+        sys->buffer_offset += drop;
+        sys->buffer_length -= drop;
+    }
+
+    char *buffer = malloc(size);
+    if (unlikely(buffer == NULL))
+        return -1;
+
+    for (uint64_t pos = sys->buffer_offset,
+                  end = sys->buffer_offset + sys->buffer_length; pos < end;)
+    {
+        size_t from = pos % sys->buffer_size;
+        size_t to = pos % size;
+        size_t len = end - pos;
+
+        if (len > sys->buffer_size - from)
+            len = sys->buffer_size - from;
+        if (len > size - to)
+            len = size - to;
+        memcpy(buffer + to, sys->buffer + from, len);
+        pos += len;
+    }
+
+    free(sys->buffer);
+    sys->buffer = buffer;
+    sys->buffer_size = size;
+    return 0;
+}
+
+/* Size the buffer to hold buffer_duration of data at the consumption rate */
+static void UpdateSize(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+    vlc_tick_t now = vlc_tick_now();
+
+    if (sys->rate_date == VLC_TICK_INVALID)
+    {
+        sys->read_bytes = 0;
+        sys->rate_date = now;
+        return;
+    }
+    if (now - sys->rate_date < PREFETCH_RATE_PERIOD)
+        return;
+
+    uint64_t rate = sys->read_bytes * CLOCK_FREQ / (now - sys->rate_date);
+    sys->rate = sys->rate ? (3 * sys->rate + rate) / 4 : rate;
+    sys->read_bytes = 0;
+    sys->rate_date = now;
+
+    if (sys->boost > 0 && now - sys->boost_date >= PREFETCH_BOOST_DECAY)
+    {
+        sys->boost--;
+        sys->boost_date = now;
+    }
+
+    uint64_t target = (sys->rate << sys->boost) * sys->buffer_duration
+                      / CLOCK_FREQ;
+    if (target < PREFETCH_MIN_SIZE)
+        target = PREFETCH_MIN_SIZE;
+    /* Round up to a power of two, so that the buffer is seldom resized */
+    target = stdc_bit_ceil(target);
+    if (target > sys->buffer_max)
+        target = sys->buffer_max;
+
+    /* Resizing drops nothing but history, and only when the read offset lies
+     * within the buffer. Shrink lazily so as not to oscillate. */
+    if (sys->stream_offset < sys->buffer_offset
+     || sys->stream_offset > sys->buffer_offset + sys->buffer_length)
+        return;
+    if (target < sys->buffer_size
+     && (target > sys->buffer_size / 4
+      || sys->buffer_offset + sys->buffer_length - sys->stream_offset > target))
+        return;
+    if (target == sys->buffer_size)
+        return;
+
+    if (Resize(stream, target) == 0)
+        msg_Dbg(stream, "resized buffer to %zu bytes (%"PRIu64" bytes/s)",
+                sys->buffer_size, sys->rate);
+}
+
 static void *Thread(void *data)
 {
     vlc_thread_set_name("vlc-prefetch");
@@ -153,6 +267,7 @@ static void *Thread(void *data)
             msg_Dbg(stream, paused ? "resuming" : "pausing");
             paused = sys->paused;
             ThreadControl(stream, STREAM_SET_PAUSE_STATE, paused);
+            sys->rate_date = VLC_TICK_INVALID;
             continue;
         }
 
@@ -189,6 +304,10 @@ static void *Thread(void *data)
 
         assert(stream_offset >= sys->buffer_offset);
 
+        /* Resize first, as shrinking the buffer drops historical data */
+        if (sys->buffer_duration > 0)
+            UpdateSize(stream);
+
         /* As long as there is space, the buffer will retain already read
          * ("historical") data. The data can be used if/when seeking backward.
          * Unread data is however given precedence if the buffer is full. */
@@ -276,6 +395,8 @@ static int Seek(stream_t *stream, uint64_t offset)
     vlc_mutex_lock(&sys->lock);
     sys->stream_offset = offset;
     sys->error = false;
+    sys->primed = false;
+    sys->rate_date = VLC_TICK_INVALID;
     vlc_cond_signal(&sys->wait_space);
     vlc_mutex_unlock(&sys->lock);
     return 0;
@@ -324,6 +445,15 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
             return 0;
         }
 
+        if (sys->primed)
+        {   /* The consumer caught up with the source: read further ahead */
+            sys->primed = false;
+            sys->underruns++;
+            if (sys->boost < PREFETCH_MAX_BOOST)
+                sys->boost++;
+            sys->boost_date = vlc_tick_now();
+        }
+
         vlc_interrupt_forward_start(sys->interrupt, data);
         vlc_cond_wait(&sys->wait_data, &sys->lock);
         vlc_interrupt_forward_stop(data);
@@ -338,6 +468,8 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 
     memcpy(buf, sys->buffer + offset, copy);
     sys->stream_offset += copy;
+    sys->read_bytes += copy;
+    sys->primed = true;
     vlc_cond_signal(&sys->wait_space);
     vlc_mutex_unlock(&sys->lock);
     return copy;
@@ -388,6 +520,18 @@ static int Control(stream_t *stream, int query, va_list args)
         case STREAM_GET_TAGS:
         case STREAM_GET_TYPE:
             return VLC_EGENERIC;
+        case STREAM_GET_BUFFERING:
+        {
+            uint64_t *buffered = va_arg(args, uint64_t *);
+            uint64_t *underruns = va_arg(args, uint64_t *);
+            bool eof;
+
+            vlc_mutex_lock(&sys->lock);
+            *buffered = BufferLevel(stream, &eof);
+            *underruns = sys->underruns;
+            vlc_mutex_unlock(&sys->lock);
+            break;
+        }
         case STREAM_SET_PAUSE_STATE:
         {
             bool paused = va_arg(args, unsigned);
@@ -470,17 +614,31 @@ static int Open(vlc_object_t *obj)
     sys->buffer_offset = 0;
     sys->stream_offset = 0;
     sys->buffer_length = 0;
-    sys->buffer_size = var_InheritInteger(obj, "prefetch-buffer-size") << 10u;
+    sys->buffer_max = var_InheritInteger(obj, "prefetch-buffer-size") << 10u;
+    sys->buffer_duration = vlc_tick_from_sec(
+        var_InheritInteger(obj, "prefetch-buffer-duration"));
     sys->seek_threshold = var_InheritInteger(obj, "prefetch-seek-threshold");
     sys->controls = NULL;
+    sys->read_bytes = 0;
+    sys->rate_date = VLC_TICK_INVALID;
+    sys->rate = 0;
+    sys->boost = 0;
+    sys->boost_date = VLC_TICK_INVALID;
+    sys->underruns = 0;
+    sys->primed = false;
 
     uint64_t size = stream_Size(stream->s);
     if (size > 0)
     {   /* No point allocating a buffer larger than the source stream */
-        if (sys->buffer_size > size)
-            sys->buffer_size = size;
+        if (sys->buffer_max > size)
+            sys->buffer_max = size;
     }
 
+    /* Start small and grow as the consumption rate gets known */
+    sys->buffer_size = sys->buffer_max;
+    if (sys->buffer_duration > 0 && sys->buffer_size > PREFETCH_MIN_SIZE)
+        sys->buffer_size = PREFETCH_MIN_SIZE;
+
     sys->buffer = malloc(sys->buffer_size);
     if (sys->buffer == NULL)
         goto error;
@@ -501,7 +659,8 @@ static int Open(vlc_object_t *obj)
         goto error;
     }
 
-    msg_Dbg(stream, "using %zu bytes buffer", sys->buffer_size);
+    msg_Dbg(stream, "using %zu bytes buffer (up to %zu bytes)",
+            sys->buffer_size, sys->buffer_max);
     stream->pf_read = Read;
     stream->pf_seek = Seek;
     stream->pf_control = Control;
@@ -550,8 +709,12 @@ vlc_module_begin()
     set_callbacks(Open, Close)
 
     add_integer("prefetch-buffer-size", 1 << 14, N_("Buffer size"),
-                N_("Prefetch buffer size (KiB)"))
+                N_("Maximum prefetch buffer size (KiB)"))
         change_integer_range(4, 1 << 20)
+    add_integer("prefetch-buffer-duration", 10, N_("Buffer duration"),
+                N_("Duration of data to prefetch at the current consumption "
+                   "rate (seconds). The buffer size is fixed if zero."))
+        change_integer_range(0, 3600)
     add_obsolete_integer("prefetch-read-size") /* since 4.0.0 */
     add_integer("prefetch-seek-threshold", 1 << 14, N_("Seek threshold"),
                 N_("Prefetch forward seek threshold (bytes)"))
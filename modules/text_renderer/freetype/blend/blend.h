@@ -83,6 +83,91 @@ static inline void Blend##name##PixelKnockout( uint8_t **dst, int a, int x, int
     }\
 }
 
+#ifdef CAN_COMPILE_SSE2
+# include <emmintrin.h>
+# define VLC_SSE2 __attribute__ ((__target__ ("sse2")))
+
+/* The SSE2 blenders compute the same values as the pixel blenders above,
+ * on 16-bit lanes holding 8-bit values:
+ * - the divisions by 255 of products of 8-bit values are exact,
+ * - the truncated float divisions by the new alpha are exact too, as the
+ *   numerators fit the mantissa and non-integer quotients are at least
+ *   1/255 away from the next integer. */
+
+VLC_SSE2
+static inline __m128i Div255_SSE2( __m128i v )
+{
+    v = _mm_add_epi16( v, _mm_add_epi16( _mm_srli_epi16( v, 8 ),
+                                         _mm_set1_epi16( 1 ) ) );
+    return _mm_srli_epi16( v, 8 );
+}
+
+VLC_SSE2
+static inline __m128i Select_SSE2( __m128i mask, __m128i a, __m128i b )
+{
+    return _mm_or_si128( _mm_and_si128( mask, a ), _mm_andnot_si128( mask, b ) );
+}
+
+/* Returns the new alpha, and the alpha weights of the source and former
+ * components, of lanes with former alpha ao and glyph coverage g */
+VLC_SSE2
+static inline __m128i BlendAlpha_SSE2( __m128i ao, __m128i g, __m128i a,
+                                       __m128i *an, __m128i *aoni )
+{
+    const __m128i max = _mm_set1_epi16( 255 );
+    *an = Div255_SSE2( _mm_mullo_epi16( a, g ) );
+    const __m128i ani = _mm_sub_epi16( max, *an );
+    *aoni = Div255_SSE2( _mm_mullo_epi16( ao, ani ) );
+    return _mm_sub_epi16( max, Div255_SSE2( _mm_mullo_epi16( _mm_sub_epi16( max, ao ),
+                                                             ani ) ) );
+}
+
+VLC_SSE2
+static inline __m128 DivLanes_SSE2( __m128i num, __m128i den )
+{
+    return _mm_div_ps( _mm_cvtepi32_ps( num ), _mm_cvtepi32_ps( den ) );
+}
+
+/* Blends the components d with s, given the BlendAlpha_SSE2() results */
+VLC_SSE2
+static inline __m128i BlendColor_SSE2( __m128i d, __m128i s, __m128i ao, __m128i g,
+                                       __m128i an, __m128i aoni, __m128i af )
+{
+    const __m128i zero = _mm_setzero_si128();
+    /* af is only null where ao is, and those lanes take the source value */
+    const __m128i den = _mm_max_epi16( af, _mm_set1_epi16( 1 ) );
+
+    __m128i lo = _mm_madd_epi16( _mm_unpacklo_epi16( d, s ),
+                                 _mm_unpacklo_epi16( aoni, an ) );
+    __m128i hi = _mm_madd_epi16( _mm_unpackhi_epi16( d, s ),
+                                 _mm_unpackhi_epi16( aoni, an ) );
+    lo = _mm_cvttps_epi32( DivLanes_SSE2( lo, _mm_unpacklo_epi16( den, zero ) ) );
+    hi = _mm_cvttps_epi32( DivLanes_SSE2( hi, _mm_unpackhi_epi16( den, zero ) ) );
+
+    __m128i c = _mm_packs_epi32( lo, hi );
+    c = Select_SSE2( _mm_cmpeq_epi16( ao, zero ), s, c );
+    return Select_SSE2( _mm_cmpeq_epi16( g, zero ), d, c );
+}
+
+VLC_SSE2
+static inline __m128i KnockoutAlpha_SSE2( __m128i ao, __m128i g, __m128i a )
+{
+    const __m128i gi = _mm_sub_epi16( _mm_set1_epi16( 255 ), g );
+    return Div255_SSE2( _mm_add_epi16( _mm_mullo_epi16( ao, gi ),
+                                       _mm_mullo_epi16( a, g ) ) );
+}
+
+VLC_SSE2
+static inline __m128i KnockoutColor_SSE2( __m128i d, __m128i s, __m128i g,
+                                          __m128i an )
+{
+    const __m128i gi = _mm_sub_epi16( _mm_set1_epi16( 255 ), g );
+    const __m128i c = Div255_SSE2( _mm_add_epi16( _mm_mullo_epi16( d, gi ),
+                                                  _mm_mullo_epi16( s, g ) ) );
+    return Select_SSE2( _mm_cmpeq_epi16( an, _mm_setzero_si128() ), d, c );
+}
+#endif
+
 static void BlendAXYZLine( picture_t *p_picture,
                            int i_picture_x, int i_picture_y,
                            int i_a, int i_x, int i_y, int i_z,
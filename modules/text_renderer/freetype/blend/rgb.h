@@ -92,4 +92,99 @@ static void BlendGlyphTo##name( picture_t *p_picture, \
 DECL_BLEND_GLYPH_TO_RGB(RGBA, BlendRGBAPixel);
 DECL_BLEND_GLYPH_TO_RGB(ARGB, BlendARGBPixel);
 DECL_BLEND_GLYPH_TO_RGB(RGBAKnockout, BlendRGBAPixelKnockout);
-DECL_BLEND_GLYPH_TO_RGB(ARGBKnockout, BlendARGBPixelKnockout);
\ No newline at end of file
+DECL_BLEND_GLYPH_TO_RGB(ARGBKnockout, BlendARGBPixelKnockout);
+#ifdef CAN_COMPILE_SSE2
+/* Blends 2 pixels in 16-bit lanes, of glyph coverage g */
+#define DECL_RGB_LANES_BLENDER_SSE2( name, APOS ) \
+VLC_SSE2 \
+static inline __m128i Blend##name##Lanes_SSE2( __m128i d, __m128i a, __m128i s,\
+                                               __m128i amask, __m128i g )\
+{\
+    const __m128i ao = _mm_shufflehi_epi16( _mm_shufflelo_epi16( d,\
+                            _MM_SHUFFLE(APOS, APOS, APOS, APOS) ),\
+                            _MM_SHUFFLE(APOS, APOS, APOS, APOS) );\
+    __m128i an, aoni;\
+    const __m128i af = BlendAlpha_SSE2( ao, g, a, &an, &aoni );\
+    return Select_SSE2( amask, af, BlendColor_SSE2( d, s, ao, g, an, aoni, af ) );\
+}\
+\
+VLC_SSE2 \
+static inline __m128i Blend##name##LanesKnockout_SSE2( __m128i d, __m128i a, __m128i s,\
+                                                       __m128i amask, __m128i g )\
+{\
+    const __m128i ao = _mm_shufflehi_epi16( _mm_shufflelo_epi16( d,\
+                            _MM_SHUFFLE(APOS, APOS, APOS, APOS) ),\
+                            _MM_SHUFFLE(APOS, APOS, APOS, APOS) );\
+    const __m128i an = KnockoutAlpha_SSE2( ao, g, a );\
+    return Select_SSE2( amask, an, KnockoutColor_SSE2( d, s, g, an ) );\
+}
+
+DECL_RGB_LANES_BLENDER_SSE2( RGBA, 3 )
+DECL_RGB_LANES_BLENDER_SSE2( ARGB, 0 )
+
+#define DECL_BLEND_GLYPH_TO_RGB_SSE2(name, APOS, XPOS, YPOS, ZPOS, LanesFunc, BlendFunc) \
+VLC_SSE2 \
+static void BlendGlyphTo##name##_SSE2( picture_t *p_picture, \
+                                       int i_picture_x, int i_picture_y, \
+                                       int i_a, int i_x, int i_y, int i_z, \
+                                       FT_BitmapGlyph p_glyph ) \
+{\
+    const uint8_t *srcrow = p_glyph->bitmap.buffer;\
+    int i_pitch_src = p_glyph->bitmap.pitch;\
+    int i_pitch_dst = p_picture->p[0].i_pitch;\
+    uint8_t *dstrow = &p_picture->p[0].p_pixels[i_picture_y * i_pitch_dst + 4 * i_picture_x];\
+\
+    const __m128i zero = _mm_setzero_si128();\
+    const __m128i a = _mm_set1_epi16( i_a );\
+    int16_t lanes[4], amask[4] = { 0 };\
+    lanes[APOS] = 0;\
+    lanes[XPOS] = i_x;\
+    lanes[YPOS] = i_y;\
+    lanes[ZPOS] = i_z;\
+    amask[APOS] = -1;\
+    const __m128i s = _mm_setr_epi16( lanes[0], lanes[1], lanes[2], lanes[3],\
+                                      lanes[0], lanes[1], lanes[2], lanes[3] );\
+    const __m128i am = _mm_setr_epi16( amask[0], amask[1], amask[2], amask[3],\
+                                       amask[0], amask[1], amask[2], amask[3] );\
+\
+    for( unsigned int dy = 0; dy < p_glyph->bitmap.rows; dy++ )\
+    {\
+        const uint8_t *src = srcrow;\
+        uint8_t *dst = dstrow;\
+        unsigned int dx = 0;\
+        for( ; dx + 4 <= p_glyph->bitmap.width; dx += 4 )\
+        {\
+            uint32_t cov;\
+            memcpy( &cov, src, 4 );\
+            src += 4;\
+            if( cov != 0 )\
+            {\
+                /* one coverage value per pixel component */\
+                __m128i g = _mm_unpacklo_epi8( _mm_cvtsi32_si128( cov ), zero );\
+                g = _mm_unpacklo_epi16( g, g );\
+                __m128i px = _mm_loadu_si128( (const __m128i *)dst );\
+                __m128i lo = LanesFunc( _mm_unpacklo_epi8( px, zero ), a, s, am,\
+                                        _mm_unpacklo_epi32( g, g ) );\
+                __m128i hi = LanesFunc( _mm_unpackhi_epi8( px, zero ), a, s, am,\
+                                        _mm_unpackhi_epi32( g, g ) );\
+                _mm_storeu_si128( (__m128i *)dst, _mm_packus_epi16( lo, hi ) );\
+            }\
+            dst += 16;\
+        }\
+        for( ; dx < p_glyph->bitmap.width; dx++ )\
+        {\
+            BlendFunc( &dst, i_a, i_x, i_y, i_z, *src++ );\
+            dst += 4;\
+        }\
+        srcrow += i_pitch_src;\
+        dstrow += i_pitch_dst;\
+    }\
+}
+
+DECL_BLEND_GLYPH_TO_RGB_SSE2(RGBA, 3, 0, 1, 2, BlendRGBALanes_SSE2, BlendRGBAPixel)
+DECL_BLEND_GLYPH_TO_RGB_SSE2(ARGB, 0, 1, 2, 3, BlendARGBLanes_SSE2, BlendARGBPixel)
+DECL_BLEND_GLYPH_TO_RGB_SSE2(RGBAKnockout, 3, 0, 1, 2, BlendRGBALanesKnockout_SSE2,
+                             BlendRGBAPixelKnockout)
+DECL_BLEND_GLYPH_TO_RGB_SSE2(ARGBKnockout, 0, 1, 2, 3, BlendARGBLanesKnockout_SSE2,
+                             BlendARGBPixelKnockout)
+#endif
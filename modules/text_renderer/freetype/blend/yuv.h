@@ -105,3 +105,94 @@ static void BlendGlyphTo##name( picture_t *p_picture, \
 }
 DECL_BLEND_GLYPH_TO_YUVA(YUVA, BlendYUVAPixel)
 DECL_BLEND_GLYPH_TO_YUVA(YUVAKnockout, BlendYUVAPixelKnockout)
+
+
+#ifdef CAN_COMPILE_SSE2
+/* Blends 8 pixels of glyph coverage g */
+VLC_SSE2
+static inline void BlendYUVA8_SSE2( uint8_t **dst, __m128i a, const __m128i *s,
+                                    __m128i g )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ao = _mm_unpacklo_epi8(
+                _mm_loadl_epi64( (const __m128i *)dst[A_PLANE] ), zero );
+    __m128i an, aoni;
+    const __m128i af = BlendAlpha_SSE2( ao, g, a, &an, &aoni );
+
+    for( int i = 0; i < 3; i++ )
+    {
+        __m128i d = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i *)dst[i] ), zero );
+        d = BlendColor_SSE2( d, s[i], ao, g, an, aoni, af );
+        _mm_storel_epi64( (__m128i *)dst[i], _mm_packus_epi16( d, d ) );
+    }
+    _mm_storel_epi64( (__m128i *)dst[A_PLANE], _mm_packus_epi16( af, af ) );
+}
+
+VLC_SSE2
+static inline void BlendYUVA8Knockout_SSE2( uint8_t **dst, __m128i a,
+                                            const __m128i *s, __m128i g )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ao = _mm_unpacklo_epi8(
+                _mm_loadl_epi64( (const __m128i *)dst[A_PLANE] ), zero );
+    const __m128i an = KnockoutAlpha_SSE2( ao, g, a );
+
+    for( int i = 0; i < 3; i++ )
+    {
+        __m128i d = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i *)dst[i] ), zero );
+        d = KnockoutColor_SSE2( d, s[i], g, an );
+        _mm_storel_epi64( (__m128i *)dst[i], _mm_packus_epi16( d, d ) );
+    }
+    _mm_storel_epi64( (__m128i *)dst[A_PLANE], _mm_packus_epi16( an, an ) );
+}
+
+#define DECL_BLEND_GLYPH_TO_YUVA_SSE2(name, Blend8Func, BlendFunc) \
+VLC_SSE2 \
+static void BlendGlyphTo##name##_SSE2( picture_t *p_picture, \
+                                       int i_picture_x, int i_picture_y, \
+                                       int i_a, int i_x, int i_y, int i_z, \
+                                       FT_BitmapGlyph p_glyph ) \
+{\
+    const uint8_t *srcrow = p_glyph->bitmap.buffer;\
+    const __m128i zero = _mm_setzero_si128();\
+    const __m128i a = _mm_set1_epi16( i_a );\
+    const __m128i s[3] = { _mm_set1_epi16( i_x ), _mm_set1_epi16( i_y ),\
+                           _mm_set1_epi16( i_z ) };\
+\
+    /* YUVA pixels are single bytes in each plane */\
+    uint8_t *dstrows[4];\
+    for( int i = 0; i < 4; i++ )\
+        dstrows[i] = &p_picture->p[i].p_pixels[i_picture_y * p_picture->p[i].i_pitch +\
+                                               i_picture_x];\
+\
+    for( unsigned int dy = 0; dy < p_glyph->bitmap.rows; dy++ )\
+    {\
+        uint8_t *dst[4];\
+        memcpy(dst, dstrows, 4 * sizeof(dst[0]));\
+\
+        unsigned int dx = 0;\
+        for( ; dx + 8 <= p_glyph->bitmap.width; dx += 8 )\
+        {\
+            const __m128i g = _mm_unpacklo_epi8(\
+                        _mm_loadl_epi64( (const __m128i *)&srcrow[dx] ), zero );\
+            /* skip blank spans */\
+            if( _mm_movemask_epi8( _mm_cmpeq_epi16( g, zero ) ) != 0xffff )\
+                Blend8Func( dst, a, s, g );\
+            for( int i = 0; i < 4; i++ )\
+                dst[i] += 8;\
+        }\
+        for( ; dx < p_glyph->bitmap.width; dx++ )\
+        {\
+            BlendFunc( dst, i_a, i_x, i_y, i_z, srcrow[dx] );\
+            for( int i = 0; i < 4; i++ )\
+                dst[i]++;\
+        }\
+\
+        srcrow += p_glyph->bitmap.pitch;\
+        for( int i = 0; i < 4; i++ )\
+            dstrows[i] += p_picture->p[i].i_pitch;\
+    }\
+}
+DECL_BLEND_GLYPH_TO_YUVA_SSE2(YUVA, BlendYUVA8_SSE2, BlendYUVAPixel)
+DECL_BLEND_GLYPH_TO_YUVA_SSE2(YUVAKnockout, BlendYUVA8Knockout_SSE2, BlendYUVAPixelKnockout)
+#endif
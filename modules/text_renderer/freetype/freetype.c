@@ -41,6 +41,7 @@
 #include <vlc_subpicture.h>
 #include <vlc_text_style.h>                                   /* text_style_t*/
 #include <vlc_charset.h>
+#include <vlc_cpu.h>
 
 #include <assert.h>
 
@@ -984,6 +985,23 @@ static const ft_drawing_functions *GetDrawingFunctions( vlc_fourcc_t chroma,
               .fill =    FillYUVAPicture,
               .blend =   BlendGlyphToYUVAKnockout };
 
+#ifdef CAN_COMPILE_SSE2
+        static const ft_drawing_functions DRAW_YUVA_SSE2 =
+            { .extract = YUVFromXRGB,
+              .fill =    FillYUVAPicture,
+              .blend =   BlendGlyphToYUVA_SSE2 };
+        static const ft_drawing_functions DRAW_YUVA_KNOCKOUT_SSE2 =
+            { .extract = YUVFromXRGB,
+              .fill =    FillYUVAPicture,
+              .blend =   BlendGlyphToYUVAKnockout_SSE2 };
+
+        if( vlc_CPU_SSE2() )
+        {
+            if( i_blending_mode == STYLE_BLENDING_TRANSPARENT )
+                return &DRAW_YUVA_KNOCKOUT_SSE2;
+            return &DRAW_YUVA_SSE2;
+        }
+#endif
         if( i_blending_mode == STYLE_BLENDING_TRANSPARENT )
             return &DRAW_YUVA_KNOCKOUT;
         return &DRAW_YUVA;
@@ -1000,6 +1018,23 @@ static const ft_drawing_functions *GetDrawingFunctions( vlc_fourcc_t chroma,
               .fill =    FillRGBAPicture,
               .blend =   BlendGlyphToRGBAKnockout };
 
+#ifdef CAN_COMPILE_SSE2
+        static const ft_drawing_functions DRAW_RGBA_SSE2 =
+            { .extract = RGBFromXRGB,
+              .fill =    FillRGBAPicture,
+              .blend =   BlendGlyphToRGBA_SSE2 };
+        static const ft_drawing_functions DRAW_RGBA_KNOCKOUT_SSE2 =
+            { .extract = RGBFromXRGB,
+              .fill =    FillRGBAPicture,
+              .blend =   BlendGlyphToRGBAKnockout_SSE2 };
+
+        if( vlc_CPU_SSE2() )
+        {
+            if( i_blending_mode == STYLE_BLENDING_TRANSPARENT )
+                return &DRAW_RGBA_KNOCKOUT_SSE2;
+            return &DRAW_RGBA_SSE2;
+        }
+#endif
         if( i_blending_mode == STYLE_BLENDING_TRANSPARENT )
             return &DRAW_RGBA_KNOCKOUT;
         return &DRAW_RGBA;
@@ -1016,6 +1051,23 @@ static const ft_drawing_functions *GetDrawingFunctions( vlc_fourcc_t chroma,
               .fill =    FillARGBPicture,
               .blend =   BlendGlyphToARGBKnockout };
 
+#ifdef CAN_COMPILE_SSE2
+        static const ft_drawing_functions DRAW_ARGB_SSE2 =
+            { .extract = RGBFromXRGB,
+              .fill =    FillARGBPicture,
+              .blend =   BlendGlyphToARGB_SSE2 };
+        static const ft_drawing_functions DRAW_ARGB_KNOCKOUT_SSE2 =
+            { .extract = RGBFromXRGB,
+              .fill =    FillARGBPicture,
+              .blend =   BlendGlyphToARGBKnockout_SSE2 };
+
+        if( vlc_CPU_SSE2() )
+        {
+            if( i_blending_mode == STYLE_BLENDING_TRANSPARENT )
+                return &DRAW_ARGB_KNOCKOUT_SSE2;
+            return &DRAW_ARGB_SSE2;
+        }
+#endif
         if( i_blending_mode == STYLE_BLENDING_TRANSPARENT )
             return &DRAW_ARGB_KNOCKOUT;
         return &DRAW_ARGB;
@@ -50,12 +50,31 @@ struct vlc_ftcache_t
     FT_Long           style_flags;
 };
 
+/* Kinds of custom glyphs derived from a source glyph */
+enum
+{
+    CUSTOM_GLYPH_OUTLINE,
+    CUSTOM_GLYPH_BITMAP,
+    CUSTOM_GLYPH_OUTLINE_BITMAP,
+};
+
+typedef struct
+{
+    vlc_ftcache_glyph_key_t glyph;
+    int kind;
+    int phase_x; /* subpixel position of bitmaps, 26.6 */
+    int phase_y;
+} custom_glyph_key_t;
+
 struct vlc_ftcache_custom_glyph_ref_Rec_
 {
     FT_Glyph glyph;
     unsigned refcount;
+    custom_glyph_key_t key;
 };
 
+#define GLYPHS_LRU_SIZE 2048
+
 vlc_face_id_t * vlc_ftcache_GetFaceID( vlc_ftcache_t *ftcache,
                                        const char *psz_fontfile, int i_idx )
 {
@@ -221,7 +240,7 @@ vlc_ftcache_t * vlc_ftcache_New( vlc_object_t *obj, FT_Library p_library,
     /* Dictionaries for fonts */
     vlc_dictionary_init( &ftcache->face_ids, 50 );
 
-    ftcache->glyphs_lrucache = vlc_lru_New( 128, LRUGlyphRefRelease, ftcache );
+    ftcache->glyphs_lrucache = vlc_lru_New( GLYPHS_LRU_SIZE, LRUGlyphRefRelease, ftcache );
 
     if(!ftcache->glyphs_lrucache ||
        FTC_Manager_New( p_library, 4, 8, maxkb << 10,
@@ -261,25 +280,67 @@ void vlc_ftcache_Glyph_Init( vlc_ftcache_glyph_t *g )
     g->ref = NULL;
 }
 
+static bool CustomGlyphKeyEquals( const custom_glyph_key_t *a,
+                                  const custom_glyph_key_t *b )
+{
+    return a->glyph.faceid == b->glyph.faceid &&
+           a->glyph.index == b->glyph.index &&
+           a->glyph.metrics.width_px == b->glyph.metrics.width_px &&
+           a->glyph.metrics.height_px == b->glyph.metrics.height_px &&
+           a->glyph.style == b->glyph.style &&
+           a->glyph.radius == b->glyph.radius &&
+           a->kind == b->kind &&
+           a->phase_x == b->phase_x &&
+           a->phase_y == b->phase_y;
+}
+
+static uint64_t HashCustomGlyphKey( const custom_glyph_key_t *key )
+{
+    const uint64_t values[] = {
+        (uintptr_t) key->glyph.faceid, key->glyph.index,
+        key->glyph.metrics.width_px, key->glyph.metrics.height_px,
+        key->glyph.style, key->glyph.radius,
+        key->kind, key->phase_x, key->phase_y,
+    };
+    /* FNV-1a over the fields */
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    for( size_t i = 0; i < ARRAY_SIZE(values); i++ )
+        hash = (hash ^ values[i]) * UINT64_C(0x100000001b3);
+    return hash;
+}
+
 static vlc_ftcache_custom_glyph_ref_t
-vlc_ftcache_GetCustomGlyph( vlc_ftcache_t *ftcache, const char *psz_key )
+vlc_ftcache_GetCustomGlyph( vlc_ftcache_t *ftcache, const custom_glyph_key_t *key )
 {
-    vlc_ftcache_custom_glyph_ref_t ref = vlc_lru_Get( ftcache->glyphs_lrucache, psz_key );
-    if( ref )
-        ref->refcount++;
+    vlc_ftcache_custom_glyph_ref_t ref =
+            vlc_lru_GetInt( ftcache->glyphs_lrucache, HashCustomGlyphKey( key ) );
+    /* hash collisions are misses */
+    if( !ref || !CustomGlyphKeyEquals( &ref->key, key ) )
+        return NULL;
+    ref->refcount++;
     return ref;
 }
 
 static vlc_ftcache_custom_glyph_ref_t
-vlc_ftcache_AddCustomGlyph( vlc_ftcache_t *ftcache, const char *psz_key, FT_Glyph glyph )
+vlc_ftcache_AddCustomGlyph( vlc_ftcache_t *ftcache, const custom_glyph_key_t *key,
+                            FT_Glyph glyph )
 {
-    assert(!vlc_lru_Get( ftcache->glyphs_lrucache, psz_key ));
     vlc_ftcache_custom_glyph_ref_t ref = malloc( sizeof(*ref) );
     if( ref )
     {
-        ref->refcount = 2;
+        const uint64_t hash = HashCustomGlyphKey( key );
         ref->glyph = glyph;
-        vlc_lru_Insert( ftcache->glyphs_lrucache, psz_key, ref );
+        ref->key = *key;
+        if( vlc_lru_HasIntKey( ftcache->glyphs_lrucache, hash ) )
+        {
+            /* colliding with another glyph: leave uncached */
+            ref->refcount = 1;
+        }
+        else
+        {
+            ref->refcount = 2;
+            vlc_lru_InsertInt( ftcache->glyphs_lrucache, hash, ref );
+        }
     }
     return ref;
 }
@@ -304,39 +365,87 @@ void vlc_ftcache_Custom_Glyph_Init( vlc_ftcache_custom_glyph_t *g )
     g->ref = NULL;
 }
 
-FT_Glyph vlc_ftcache_GetOutlinedGlyph( vlc_ftcache_t *ftcache, const vlc_face_id_t *faceid,
-                                       FT_UInt index, const vlc_ftcache_metrics_t *metrics,
-                                       FT_Long style, int radius, const FT_Glyph sourceglyph,
+FT_Glyph vlc_ftcache_GetOutlinedGlyph( vlc_ftcache_t *ftcache,
+                                       const vlc_ftcache_glyph_key_t *glyphkey,
+                                       const FT_Glyph sourceglyph,
                                        int(*createOutline)(FT_Glyph, FT_Glyph *, void *),
                                        void *priv,
                                        vlc_ftcache_custom_glyph_ref_t *p_ref )
 {
-    char *psz_key;
-    if( asprintf( &psz_key, "%s#%d#%d#%d,%d,%d,%lx,%d",
-                  faceid->psz_filename, faceid->idx,
-                  faceid->charmap_index, index,
-                  metrics->width_px, metrics->height_px, style, radius ) < 0 )
-    {
-        *p_ref = NULL;
-        return NULL;
-    }
+    const custom_glyph_key_t key = {
+        .glyph = *glyphkey,
+        .kind = CUSTOM_GLYPH_OUTLINE,
+    };
 
     FT_Glyph glyph = NULL;
-    *p_ref = vlc_ftcache_GetCustomGlyph( ftcache, psz_key );
+    *p_ref = vlc_ftcache_GetCustomGlyph( ftcache, &key );
     if( *p_ref )
     {
         glyph = (*p_ref)->glyph;
     }
     else
     {
-        if( !createOutline( sourceglyph, &glyph, priv ) )
-            *p_ref = vlc_ftcache_AddCustomGlyph( ftcache, psz_key, glyph );
+        if( createOutline( sourceglyph, &glyph, priv ) )
+            return NULL;
+        *p_ref = vlc_ftcache_AddCustomGlyph( ftcache, &key, glyph );
         if( !*p_ref )
         {
             FT_Done_Glyph( glyph );
             return NULL;
         }
     }
-    free( psz_key );
+    return glyph;
+}
+
+FT_Glyph vlc_ftcache_GetGlyphBitmap( vlc_ftcache_t *ftcache,
+                                     const vlc_ftcache_glyph_key_t *glyphkey, bool b_outline,
+                                     const FT_Glyph sourceglyph, const FT_Vector *origin )
+{
+    FT_Glyph glyph = sourceglyph;
+    FT_Vector phase = *origin;
+
+    if( !glyphkey || sourceglyph->format != FT_GLYPH_FORMAT_OUTLINE )
+    {
+        if( FT_Glyph_To_Bitmap( &glyph, FT_RENDER_MODE_NORMAL, &phase, 0 ) )
+            return NULL;
+        /* already a bitmap: return a copy as well */
+        if( glyph == sourceglyph && FT_Glyph_Copy( sourceglyph, &glyph ) )
+            return NULL;
+        return glyph;
+    }
+
+    /* Translating by whole pixels only moves the rendered bitmap */
+    phase.x &= 63;
+    phase.y &= 63;
+
+    const custom_glyph_key_t key = {
+        .glyph = *glyphkey,
+        .kind = b_outline ? CUSTOM_GLYPH_OUTLINE_BITMAP : CUSTOM_GLYPH_BITMAP,
+        .phase_x = phase.x,
+        .phase_y = phase.y,
+    };
+
+    vlc_ftcache_custom_glyph_ref_t ref = vlc_ftcache_GetCustomGlyph( ftcache, &key );
+    if( !ref )
+    {
+        if( FT_Glyph_To_Bitmap( &glyph, FT_RENDER_MODE_NORMAL, &phase, 0 ) )
+            return NULL;
+        ref = vlc_ftcache_AddCustomGlyph( ftcache, &key, glyph );
+        if( !ref )
+        {
+            FT_Done_Glyph( glyph );
+            return NULL;
+        }
+    }
+
+    if( FT_Glyph_Copy( ref->glyph, &glyph ) )
+        glyph = NULL;
+    else
+    {
+        FT_BitmapGlyph bitmap = (FT_BitmapGlyph) glyph;
+        bitmap->left += (origin->x - phase.x) / 64;
+        bitmap->top += (origin->y - phase.y) / 64;
+    }
+    LRUGlyphRefRelease( NULL, ref );
     return glyph;
 }
@@ -67,6 +67,16 @@ FT_Face vlc_ftcache_LoadFaceByID( vlc_ftcache_t *, vlc_face_id_t *faceid,
                                   const vlc_ftcache_metrics_t * );
 int vlc_ftcache_LoadFaceByIDNoSize( vlc_ftcache_t *ftcache, vlc_face_id_t *faceid );
 
+/* Identifies a glyph of a scaled face, with its synthesized styles */
+typedef struct
+{
+    const vlc_face_id_t *faceid;
+    FT_UInt index;
+    vlc_ftcache_metrics_t metrics;
+    FT_Long style;  /* synthesized FT_STYLE_FLAG_* */
+    int radius;     /* outline radius */
+} vlc_ftcache_glyph_key_t;
+
 /* Custom modified glyphs cache. Similar to native caching.
  * Stores and returns a refcounted copy of the original glyph. */
 typedef struct vlc_ftcache_custom_glyph_ref_Rec_ * vlc_ftcache_custom_glyph_ref_t;
@@ -76,12 +86,19 @@ typedef struct
     vlc_ftcache_custom_glyph_ref_t ref;
 } vlc_ftcache_custom_glyph_t;
 
-FT_Glyph vlc_ftcache_GetOutlinedGlyph( vlc_ftcache_t *ftcache, const vlc_face_id_t *faceid,
-                                       FT_UInt index, const vlc_ftcache_metrics_t *,
-                                       FT_Long style, int radius, const FT_Glyph sourceglyph,
+FT_Glyph vlc_ftcache_GetOutlinedGlyph( vlc_ftcache_t *ftcache,
+                                       const vlc_ftcache_glyph_key_t *,
+                                       const FT_Glyph sourceglyph,
                                        int(*createOutline)(FT_Glyph, FT_Glyph *, void *), void *,
                                        vlc_ftcache_custom_glyph_ref_t * );
 
+/* Renders the glyph, or its outline, to a bitmap translated by origin.
+ * Bitmaps are cached per subpixel position, and returned as a new glyph
+ * owned by the caller. A NULL key disables caching. */
+FT_Glyph vlc_ftcache_GetGlyphBitmap( vlc_ftcache_t *ftcache,
+                                     const vlc_ftcache_glyph_key_t *, bool b_outline,
+                                     const FT_Glyph sourceglyph, const FT_Vector *origin );
+
 void vlc_ftcache_Custom_Glyph_Init( vlc_ftcache_custom_glyph_t * );
 void vlc_ftcache_Custom_Glyph_Release( vlc_ftcache_custom_glyph_t * );
 
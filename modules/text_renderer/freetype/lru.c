@@ -22,14 +22,17 @@
 #endif
 
 #include <vlc_common.h>
-#include <vlc_arrays.h>
 #include <vlc_list.h>
 #include "lru.h"
 
+#include <assert.h>
+
 struct vlc_lru_entry
 {
-    char *psz_key;
+    uint64_t key;
+    char *psz_key; /* NULL for integer keys */
     void *value;
+    struct vlc_lru_entry *hash_next;
     struct vlc_list node;
 };
 
@@ -38,15 +41,29 @@ struct vlc_lru
     void (*releaseValue)(void *, void *);
     void *priv;
     unsigned max;
-    vlc_dictionary_t dict;
+    unsigned count;
+    unsigned bits;
+    struct vlc_lru_entry **buckets;
     struct vlc_list list;
-    struct vlc_lru_entry *last;
 };
 
-static void vlc_lru_releaseentry( void *value, void *priv )
+static uint64_t vlc_lru_hashstring( const char *psz_key )
+{
+    /* FNV-1a */
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    for( ; *psz_key; psz_key++ )
+        hash = (hash ^ (unsigned char) *psz_key) * UINT64_C(0x100000001b3);
+    return hash;
+}
+
+static inline struct vlc_lru_entry ** vlc_lru_bucket( vlc_lru *lru, uint64_t key )
+{
+    /* Fibonacci hashing, as integer keys need not be well distributed */
+    return &lru->buckets[(key * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - lru->bits)];
+}
+
+static void vlc_lru_releaseentry( vlc_lru *lru, struct vlc_lru_entry *entry )
 {
-    struct vlc_lru_entry *entry = value;
-    struct vlc_lru *lru = priv;
     free(entry->psz_key);
     if( lru->releaseValue )
         lru->releaseValue( lru->priv, entry->value );
@@ -61,77 +78,143 @@ vlc_lru * vlc_lru_New( unsigned max,
     {
         lru->priv = priv;
         lru->max = max;
-        vlc_dictionary_init( &lru->dict, max );
+        lru->count = 0;
+        /* about one entry per bucket */
+        lru->bits = 1;
+        while( (1U << lru->bits) < max )
+            lru->bits++;
+        lru->buckets = calloc( 1U << lru->bits, sizeof(*lru->buckets) );
+        if( !lru->buckets )
+        {
+            free( lru );
+            return NULL;
+        }
         vlc_list_init( &lru->list );
         lru->releaseValue = releaseValue;
-        lru->last = NULL;
     }
     return lru;
 }
 
 void vlc_lru_Release( vlc_lru *lru )
 {
-    vlc_dictionary_clear( &lru->dict, vlc_lru_releaseentry, lru );
+    struct vlc_lru_entry *entry;
+    vlc_list_foreach( entry, &lru->list, node )
+        vlc_lru_releaseentry( lru, entry );
+    free( lru->buckets );
     free( lru );
 }
 
-bool vlc_lru_HasKey( vlc_lru *lru, const char *psz_key )
+static struct vlc_lru_entry * vlc_lru_lookup( vlc_lru *lru, uint64_t key,
+                                              const char *psz_key )
 {
-    return vlc_dictionary_has_key( &lru->dict, psz_key );
+    struct vlc_lru_entry *entry = *vlc_lru_bucket( lru, key );
+    for( ; entry; entry = entry->hash_next )
+    {
+        if( entry->key != key )
+            continue;
+        if( psz_key ? entry->psz_key && !strcmp( entry->psz_key, psz_key )
+                    : !entry->psz_key )
+            break;
+    }
+    return entry;
 }
 
-void * vlc_lru_Get( vlc_lru *lru, const char *psz_key )
+static void * vlc_lru_get( vlc_lru *lru, uint64_t key, const char *psz_key )
 {
-    struct vlc_lru_entry *entry = vlc_dictionary_value_for_key( &lru->dict, psz_key );
+    struct vlc_lru_entry *entry = vlc_lru_lookup( lru, key, psz_key );
     if( entry )
     {
         if( !vlc_list_is_first( &entry->node, &lru->list ) )
         {
-            if( vlc_list_is_last( &entry->node, &lru->list ) )
-            {
-                lru->last = vlc_list_entry(entry->node.prev, struct vlc_lru_entry, node);
-            }
             vlc_list_remove( &entry->node );
-            vlc_list_add_after( &entry->node, &lru->list );
+            vlc_list_prepend( &entry->node, &lru->list );
         }
         return entry->value;
     }
     return NULL;
 }
 
-void vlc_lru_Insert( vlc_lru *lru, const char *psz_key, void *value )
+static void vlc_lru_remove( vlc_lru *lru, struct vlc_lru_entry *entry )
 {
-    struct vlc_lru_entry *entry = calloc(1, sizeof(*entry));
+    struct vlc_lru_entry **pp = vlc_lru_bucket( lru, entry->key );
+    while( *pp != entry )
+        pp = &(*pp)->hash_next;
+    *pp = entry->hash_next;
+    vlc_list_remove( &entry->node );
+    lru->count--;
+}
+
+static void vlc_lru_insert( vlc_lru *lru, uint64_t key, const char *psz_key,
+                            void *value )
+{
+    assert( !vlc_lru_lookup( lru, key, psz_key ) );
+
+    struct vlc_lru_entry *entry = malloc(sizeof(*entry));
     if(!entry)
     {
-        lru->releaseValue(lru->priv, value);
+        if( lru->releaseValue )
+            lru->releaseValue(lru->priv, value);
         return;
     }
-    entry->psz_key = strdup( psz_key );
-    if(!entry->psz_key)
+    entry->psz_key = NULL;
+    if( psz_key )
     {
-        lru->releaseValue(lru->priv, value);
-        free(entry);
-        return;
+        entry->psz_key = strdup( psz_key );
+        if(!entry->psz_key)
+        {
+            if( lru->releaseValue )
+                lru->releaseValue(lru->priv, value);
+            free(entry);
+            return;
+        }
     }
+    entry->key = key;
     entry->value = value;
-    vlc_list_init( &entry->node );
 
-    if( vlc_list_is_empty( &lru->list ) )
-        lru->last = entry;
-    vlc_dictionary_insert( &lru->dict, psz_key, entry );
-    vlc_list_add_after( &entry->node, &lru->list );
+    struct vlc_lru_entry **bucket = vlc_lru_bucket( lru, key );
+    entry->hash_next = *bucket;
+    *bucket = entry;
+    vlc_list_prepend( &entry->node, &lru->list );
 
-    if( (unsigned)vlc_dictionary_keys_count(&lru->dict) >= lru->max )
+    if( ++lru->count >= lru->max )
     {
-        struct vlc_lru_entry *toremove = lru->last;
-        lru->last = vlc_list_entry(toremove->node.prev, struct vlc_lru_entry, node);
-        vlc_list_remove(&toremove->node);
-        vlc_dictionary_remove_value_for_key(&lru->dict, toremove->psz_key, NULL, NULL);
-        vlc_lru_releaseentry(toremove, lru);
+        struct vlc_lru_entry *toremove =
+            vlc_list_last_entry_or_null( &lru->list, struct vlc_lru_entry, node );
+        vlc_lru_remove( lru, toremove );
+        vlc_lru_releaseentry( lru, toremove );
     }
 }
 
+bool vlc_lru_HasKey( vlc_lru *lru, const char *psz_key )
+{
+    return vlc_lru_lookup( lru, vlc_lru_hashstring( psz_key ), psz_key ) != NULL;
+}
+
+void * vlc_lru_Get( vlc_lru *lru, const char *psz_key )
+{
+    return vlc_lru_get( lru, vlc_lru_hashstring( psz_key ), psz_key );
+}
+
+void vlc_lru_Insert( vlc_lru *lru, const char *psz_key, void *value )
+{
+    vlc_lru_insert( lru, vlc_lru_hashstring( psz_key ), psz_key, value );
+}
+
+bool vlc_lru_HasIntKey( vlc_lru *lru, uint64_t key )
+{
+    return vlc_lru_lookup( lru, key, NULL ) != NULL;
+}
+
+void * vlc_lru_GetInt( vlc_lru *lru, uint64_t key )
+{
+    return vlc_lru_get( lru, key, NULL );
+}
+
+void vlc_lru_InsertInt( vlc_lru *lru, uint64_t key, void *value )
+{
+    vlc_lru_insert( lru, key, NULL, value );
+}
+
 void vlc_lru_Apply( vlc_lru *lru,
                     void(*func)(void *, const char *, void *),
                     void *priv )
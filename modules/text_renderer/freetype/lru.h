@@ -34,6 +34,12 @@ bool   vlc_lru_HasKey( vlc_lru *lru, const char *psz_key );
 void * vlc_lru_Get( vlc_lru *lru, const char *psz_key );
 void   vlc_lru_Insert( vlc_lru *lru, const char *psz_key, void *value );
 
+/* Integer keys, which never match string keys */
+bool   vlc_lru_HasIntKey( vlc_lru *lru, uint64_t key );
+void * vlc_lru_GetInt( vlc_lru *lru, uint64_t key );
+void   vlc_lru_InsertInt( vlc_lru *lru, uint64_t key, void *value );
+
+/* Integer keyed entries are passed a NULL key */
 void   vlc_lru_Apply( vlc_lru *lru,
                       void(*func)(void *, const char *, void *),
                       void * );
@@ -120,6 +120,7 @@ typedef struct glyph_bitmaps_t
     vlc_ftcache_glyph_t cglyph;
     vlc_ftcache_custom_glyph_t coutline;
     FT_Glyph p_shadow;
+    vlc_ftcache_glyph_key_t key; /**< Cache key of the glyph and outline */
     FT_BBox  glyph_bbox;
     FT_BBox  outline_bbox;
     FT_BBox  shadow_bbox;
@@ -1056,6 +1057,7 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
         vlc_ftcache_Glyph_Init( &p_bitmaps->cglyph );\
         vlc_ftcache_Custom_Glyph_Init( &p_bitmaps->coutline ); \
         p_bitmaps->p_shadow = 0; \
+        p_bitmaps->key.faceid = NULL; \
         p_bitmaps->i_x_advance = 0; \
         p_bitmaps->i_y_advance = 0; \
         continue; \
@@ -1100,6 +1102,14 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
 
 #undef SKIP_GLYPH
 
+            p_bitmaps->key = (vlc_ftcache_glyph_key_t) {
+                .faceid = p_run->p_faceid,
+                .index = i_glyph_index,
+                .metrics = metrics,
+                .style = 0,
+                .radius = i_stroker_radius,
+            };
+
             const bool b_embolden = ( p_style->i_style_flags & STYLE_BOLD ) &&
                                    !( style_flags & FT_STYLE_FLAG_BOLD );
             const bool b_oblique = ( p_style->i_style_flags & STYLE_ITALIC ) &&
@@ -1122,6 +1132,10 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
                         FT_Outline_Embolden( &((FT_OutlineGlyph)transformed)->outline, 1<<6 );
                     vlc_ftcache_Glyph_Release( p_sys->ftcache, &p_bitmaps->cglyph );
                     p_bitmaps->cglyph.p_glyph = transformed;
+                    if( b_embolden )
+                        p_bitmaps->key.style |= FT_STYLE_FLAG_BOLD;
+                    if( b_oblique )
+                        p_bitmaps->key.style |= FT_STYLE_FLAG_ITALIC;
                 }
             }
 
@@ -1129,8 +1143,7 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
             if( p_sys->p_stroker && (p_style->i_style_flags & STYLE_OUTLINE) )
             {
                 p_bitmaps->coutline.p_glyph =
-                    vlc_ftcache_GetOutlinedGlyph( p_sys->ftcache, p_run->p_faceid, i_glyph_index,
-                                                  &metrics, style_flags, i_stroker_radius,
+                    vlc_ftcache_GetOutlinedGlyph( p_sys->ftcache, &p_bitmaps->key,
                                                   p_bitmaps->cglyph.p_glyph,
                                                   CreateOutlinedGlyph, p_filter,
                                                   &p_bitmaps->coutline.ref );
@@ -1245,19 +1258,21 @@ static int LayoutLine( filter_t *p_filter,
             .y = pen_new.y + p_sys->f_shadow_vector_y * ( metrics.height_px << 6 )
         };
 
+        const vlc_ftcache_glyph_key_t *p_key =
+                p_bitmaps->key.faceid ? &p_bitmaps->key : NULL;
+
         /* Shadow being a reference to main glyph, it must be processed first */
-        if( p_bitmaps->p_shadow &&
-            FT_Glyph_To_Bitmap( &p_bitmaps->p_shadow, FT_RENDER_MODE_NORMAL,
-                                &pen_shadow, 0 ) )
-        {
-            p_bitmaps->p_shadow = 0;
-        }
+        if( p_bitmaps->p_shadow )
+            p_bitmaps->p_shadow =
+                vlc_ftcache_GetGlyphBitmap( p_sys->ftcache, p_key,
+                                            p_bitmaps->p_shadow == p_bitmaps->coutline.p_glyph,
+                                            p_bitmaps->p_shadow, &pen_shadow );
 
         /* Ensure we don't release reference */
-        FT_Glyph bitmapglyph = p_bitmaps->cglyph.p_glyph;
-        if( FT_Glyph_To_Bitmap( &bitmapglyph,
-                                FT_RENDER_MODE_NORMAL,
-                                &pen_new, 0 ) )
+        FT_Glyph bitmapglyph =
+                vlc_ftcache_GetGlyphBitmap( p_sys->ftcache, p_key, false,
+                                            p_bitmaps->cglyph.p_glyph, &pen_new );
+        if( !bitmapglyph )
         {
             ReleaseGlyphBitMaps( p_filter, p_bitmaps );
             continue;
@@ -1269,11 +1284,9 @@ static int LayoutLine( filter_t *p_filter,
 
         if( p_bitmaps->coutline.p_glyph )
         {
-            bitmapglyph = p_bitmaps->coutline.p_glyph;
-            if( FT_Glyph_To_Bitmap( &bitmapglyph,
-                                    FT_RENDER_MODE_NORMAL,
-                                    &pen_new, 0 ) )
-                bitmapglyph = NULL;
+            bitmapglyph = vlc_ftcache_GetGlyphBitmap( p_sys->ftcache, p_key, true,
+                                                      p_bitmaps->coutline.p_glyph,
+                                                      &pen_new );
             vlc_ftcache_Custom_Glyph_Release( &p_bitmaps->coutline );
             p_bitmaps->coutline.p_glyph = bitmapglyph;
         }
@@ -97,17 +97,55 @@ vlc_module_begin ()
         set_callback_chroma_conv_probe(ProbeChroma)
 vlc_module_end ()
 
+/*****************************************************************************
+ * Convert: convert a picture, in parallel slices when it is not scaled
+ *****************************************************************************/
+static void Convert( filter_t *p_filter, chroma_slice_cb pf_convert,
+                     picture_t *p_src, picture_t *p_dest )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const video_format_t *p_in = &p_filter->fmt_in.video;
+    const video_format_t *p_out = &p_filter->fmt_out.video;
+    unsigned i_lines = p_in->i_y_offset + p_in->i_visible_height;
+
+    /* The scaling state is per picture, not per slice */
+    if( p_in->i_x_offset + p_in->i_visible_width
+            == p_out->i_x_offset + p_out->i_visible_width
+     && i_lines == p_out->i_y_offset + p_out->i_visible_height )
+        chroma_slices_Convert( p_sys->p_slices, pf_convert, p_filter,
+                               p_src, p_dest, i_lines );
+    else
+        pf_convert( p_filter, p_src, p_dest, i_lines );
+}
+
+#define I420_RGB_WRAPPER( name )                                        \
+    static picture_t *name ## _Filter( filter_t *p_filter,              \
+                                       picture_t *p_pic )               \
+    {                                                                   \
+        picture_t *p_outpic = filter_NewPicture( p_filter );            \
+        if( p_outpic )                                                  \
+        {                                                               \
+            Convert( p_filter, name, p_pic, p_outpic );                 \
+            picture_CopyProperties( p_outpic, p_pic );                  \
+        }                                                               \
+        picture_Release( p_pic );                                       \
+        return p_outpic;                                                \
+    }                                                                   \
+    static const struct vlc_filter_operations name ## _ops = {          \
+        .filter_video = name ## _Filter, .close = Deactivate,           \
+    };
+
 #ifndef PLUGIN_PLAIN
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_R5G5B5, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_R5G6B5, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_A8R8G8B8, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_R8G8B8A8, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_B8G8R8A8, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_A8B8G8R8, Deactivate )
+I420_RGB_WRAPPER( I420_R5G5B5 )
+I420_RGB_WRAPPER( I420_R5G6B5 )
+I420_RGB_WRAPPER( I420_A8R8G8B8 )
+I420_RGB_WRAPPER( I420_R8G8B8A8 )
+I420_RGB_WRAPPER( I420_B8G8R8A8 )
+I420_RGB_WRAPPER( I420_A8B8G8R8 )
 #else
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_RGB8, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_RGB16, Deactivate )
-VIDEO_FILTER_WRAPPER_CLOSE_EXT( I420_RGB32, Deactivate )
+I420_RGB_WRAPPER( I420_RGB8 )
+I420_RGB_WRAPPER( I420_RGB16 )
+I420_RGB_WRAPPER( I420_RGB32 )
 #endif
 
 /*****************************************************************************
@@ -231,7 +269,7 @@ static int Activate( filter_t *p_filter )
     }
 
 #ifdef PLUGIN_PLAIN
-    p_sys->p_base = malloc( p_sys->i_bytespp * RGB_TABLE_SIZE );
+    p_sys->p_base = calloc( RGB_TABLE_SIZE, p_sys->i_bytespp );
     if( p_sys->p_base == NULL )
     {
         free( p_sys->p_offset );
@@ -242,6 +280,8 @@ static int Activate( filter_t *p_filter )
     SetYUV( p_filter );
 #endif
 
+    /* Slices start on multiples of 4 lines to keep the 8 bpp dithering */
+    p_sys->p_slices = chroma_slices_New( VLC_OBJECT(p_filter), 4 );
     return 0;
 }
 
@@ -254,6 +294,7 @@ static void Deactivate( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
+    chroma_slices_Delete( p_sys->p_slices );
 #ifdef PLUGIN_PLAIN
     free( p_sys->p_base );
 #endif
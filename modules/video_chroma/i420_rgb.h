@@ -21,6 +21,8 @@
  *****************************************************************************/
 #include <limits.h>
 
+#include "slices.h"
+
 #if !defined (PLUGIN_SSE2)
 # define PLUGIN_PLAIN
 #endif
@@ -40,6 +42,7 @@ typedef struct
     size_t    i_buffer_size;
     uint8_t   i_bytespp;
     int *p_offset;
+    chroma_slices_t *p_slices;          /**< Slice-parallel conversion */
 
 #ifdef PLUGIN_PLAIN
     /**< Pre-calculated conversion tables */
@@ -81,16 +84,16 @@ static inline int AllocateOrGrow( uint8_t **pp_buffer, size_t *pi_buffer,
  * Prototypes
  *****************************************************************************/
 #ifdef PLUGIN_PLAIN
-void I420_RGB8         ( filter_t *, picture_t *, picture_t * );
-void I420_RGB16        ( filter_t *, picture_t *, picture_t * );
-void I420_RGB32        ( filter_t *, picture_t *, picture_t * );
+void I420_RGB8         ( filter_t *, picture_t *, picture_t *, unsigned );
+void I420_RGB16        ( filter_t *, picture_t *, picture_t *, unsigned );
+void I420_RGB32        ( filter_t *, picture_t *, picture_t *, unsigned );
 #else
-void I420_R5G5B5       ( filter_t *, picture_t *, picture_t * );
-void I420_R5G6B5       ( filter_t *, picture_t *, picture_t * );
-void I420_A8R8G8B8     ( filter_t *, picture_t *, picture_t * );
-void I420_R8G8B8A8     ( filter_t *, picture_t *, picture_t * );
-void I420_B8G8R8A8     ( filter_t *, picture_t *, picture_t * );
-void I420_A8B8G8R8     ( filter_t *, picture_t *, picture_t * );
+void I420_R5G5B5       ( filter_t *, picture_t *, picture_t *, unsigned );
+void I420_R5G6B5       ( filter_t *, picture_t *, picture_t *, unsigned );
+void I420_A8R8G8B8     ( filter_t *, picture_t *, picture_t *, unsigned );
+void I420_R8G8B8A8     ( filter_t *, picture_t *, picture_t *, unsigned );
+void I420_B8G8R8A8     ( filter_t *, picture_t *, picture_t *, unsigned );
+void I420_A8B8G8R8     ( filter_t *, picture_t *, picture_t *, unsigned );
 #endif
 
 /*****************************************************************************
@@ -104,7 +104,8 @@ static void SetOffset( int i_width, int i_height, int i_pic_width,
  *  - output: 1 line
  *****************************************************************************/
 
-void I420_RGB16( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_RGB16( filter_t *p_filter, picture_t *p_src, picture_t *p_dest,
+                 unsigned i_lines )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -169,7 +170,7 @@ void I420_RGB16( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     i_scale_count = ( i_vscale == 1 ) ?
                     (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) :
                     (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);
-    for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+    for( i_y = 0; i_y < i_lines; i_y++ )
     {
         p_pic_start = p_pic;
         p_buffer = b_hscale ? p_buffer_start : p_pic;
@@ -219,7 +220,8 @@ void I420_RGB16( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
  *  - output: 1 line
  *****************************************************************************/
 
-void I420_RGB32( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_RGB32( filter_t *p_filter, picture_t *p_src, picture_t *p_dest,
+                 unsigned i_lines )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -284,7 +286,7 @@ void I420_RGB32( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     i_scale_count = ( i_vscale == 1 ) ?
                     (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) :
                     (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);
-    for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+    for( i_y = 0; i_y < i_lines; i_y++ )
     {
         p_pic_start = p_pic;
         p_buffer = b_hscale ? p_buffer_start : p_pic;
@@ -97,7 +97,8 @@ static void SetOffset( int i_width, int i_height, int i_pic_width,
 }
 
 VLC_TARGET
-void I420_R5G5B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_R5G5B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest,
+                  unsigned i_lines )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -175,7 +176,7 @@ void I420_R5G5B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
                     ((intptr_t)p_buffer))) )
     {
         /* use faster SSE2 aligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_lines; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -226,7 +227,7 @@ void I420_R5G5B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     else
     {
         /* use slower SSE2 unaligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_lines; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -281,7 +282,8 @@ void I420_R5G5B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
 }
 
 VLC_TARGET
-void I420_R5G6B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_R5G6B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest,
+                  unsigned i_lines )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -359,7 +361,7 @@ void I420_R5G6B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
                     ((intptr_t)p_buffer))) )
     {
         /* use faster SSE2 aligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_lines; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -410,7 +412,7 @@ void I420_R5G6B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     else
     {
         /* use slower SSE2 unaligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_lines; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -465,8 +467,8 @@ void I420_R5G6B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
 }
 
 VLC_TARGET
-void I420_A8R8G8B8( filter_t *p_filter, picture_t *p_src,
-                                            picture_t *p_dest )
+void I420_A8R8G8B8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest,
+                    unsigned i_lines )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -543,7 +545,7 @@ void I420_A8R8G8B8( filter_t *p_filter, picture_t *p_src,
                     ((intptr_t)p_buffer))) )
     {
         /* use faster SSE2 aligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_lines; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -594,7 +596,7 @@ void I420_A8R8G8B8( filter_t *p_filter, picture_t *p_src,
     else
     {
         /* use slower SSE2 unaligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_lines; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -649,7 +651,8 @@ void I420_A8R8G8B8( filter_t *p_filter, picture_t *p_src,
 }
 
 VLC_TARGET
-void I420_R8G8B8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_R8G8B8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest,
+                    unsigned i_lines )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -726,7 +729,7 @@ void I420_R8G8B8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
                     ((intptr_t)p_buffer))) )
     {
         /* use faster SSE2 aligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_lines; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -777,7 +780,7 @@ void I420_R8G8B8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     else
     {
         /* use slower SSE2 unaligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_lines; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -832,7 +835,8 @@ void I420_R8G8B8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
 }
 
 VLC_TARGET
-void I420_B8G8R8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_B8G8R8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest,
+                    unsigned i_lines )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -909,7 +913,7 @@ void I420_B8G8R8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
                     ((intptr_t)p_buffer))) )
     {
         /* use faster SSE2 aligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_lines; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -960,7 +964,7 @@ void I420_B8G8R8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     else
     {
         /* use slower SSE2 unaligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_lines; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -1015,7 +1019,8 @@ void I420_B8G8R8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
 }
 
 VLC_TARGET
-void I420_A8B8G8R8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_A8B8G8R8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest,
+                    unsigned i_lines )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -1092,7 +1097,7 @@ void I420_A8B8G8R8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
                     ((intptr_t)p_buffer))) )
     {
         /* use faster SSE2 aligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_lines; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -1143,7 +1148,7 @@ void I420_A8B8G8R8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     else
     {
         /* use slower SSE2 unaligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_lines; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -40,7 +40,8 @@ static void SetOffset( int, int, int, int, bool *, int *, int * );
 /*****************************************************************************
  * I420_RGB8: color YUV 4:2:0 to RGB 8 bpp
  *****************************************************************************/
-void I420_RGB8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_RGB8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest,
+                unsigned i_lines )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -97,7 +98,7 @@ void I420_RGB8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     i_scale_count = ( i_vscale == 1 ) ?
                     (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) :
                     (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);
-    for( i_y = 0, i_real_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+    for( i_y = 0, i_real_y = 0; i_y < i_lines; i_y++ )
     {
         /* Do horizontal and vertical scaling */
         SCALE_WIDTH_DITHER( 420 );
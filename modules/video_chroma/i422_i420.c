@@ -35,6 +35,8 @@
 #include <vlc_picture.h>
 #include <vlc_chroma_probe.h>
 
+#include "slices.h"
+
 #define SRC_FOURCC  "I422,J422"
 #define DEST_FOURCC "I420,IYUV,J420,YV12,YUVA"
 
@@ -59,9 +61,9 @@ vlc_module_begin ()
         set_callback_chroma_conv_probe(ProbeChroma)
 vlc_module_end ()
 
-VIDEO_FILTER_WRAPPER( I422_I420 )
-VIDEO_FILTER_WRAPPER( I422_YV12 )
-VIDEO_FILTER_WRAPPER( I422_YUVA )
+VIDEO_FILTER_WRAPPER_CLOSE( I422_I420, Deactivate )
+VIDEO_FILTER_WRAPPER_CLOSE( I422_YV12, Deactivate )
+VIDEO_FILTER_WRAPPER_CLOSE( I422_YUVA, Deactivate )
 
 /*****************************************************************************
  * Activate: allocate a chroma function
@@ -106,23 +108,31 @@ static int Activate( filter_t *p_filter )
         default:
             return -1;
     }
+
+    /* Slices start on even lines, as the chroma is vertically subsampled */
+    p_filter->p_sys = chroma_slices_New( VLC_OBJECT(p_filter), 2 );
     return 0;
 }
 
+static void Deactivate( filter_t *p_filter )
+{
+    chroma_slices_Delete( p_filter->p_sys );
+}
+
 /* Following functions are local */
 
 /*****************************************************************************
  * I422_I420: planar YUV 4:2:2 to planar I420 4:2:0 Y:U:V
  *****************************************************************************/
-static void I422_I420( filter_t *p_filter, picture_t *p_source,
-                                           picture_t *p_dest )
+static void I422_I420_Slice( filter_t *p_filter, picture_t *p_source,
+                             picture_t *p_dest, unsigned i_lines )
 {
     uint16_t i_dpy = p_dest->p[Y_PLANE].i_pitch;
     uint16_t i_spy = p_source->p[Y_PLANE].i_pitch;
     uint16_t i_dpuv = p_dest->p[U_PLANE].i_pitch;
     uint16_t i_spuv = p_source->p[U_PLANE].i_pitch;
     uint16_t i_width = p_filter->fmt_in.video.i_width;
-    uint16_t i_y = p_filter->fmt_in.video.i_height;
+    uint16_t i_y = i_lines;
     uint8_t *p_dy = p_dest->Y_PIXELS + (i_y-1)*i_dpy;
     uint8_t *p_y = p_source->Y_PIXELS + (i_y-1)*i_spy;
     uint8_t *p_du = p_dest->U_PIXELS + (i_y/2-1)*i_dpuv;
@@ -140,18 +150,25 @@ static void I422_I420( filter_t *p_filter, picture_t *p_source,
     }
 }
 
+static void I422_I420( filter_t *p_filter, picture_t *p_source,
+                                           picture_t *p_dest )
+{
+    chroma_slices_Convert( p_filter->p_sys, I422_I420_Slice, p_filter,
+                           p_source, p_dest, p_filter->fmt_in.video.i_height );
+}
+
 /*****************************************************************************
  * I422_YV12: planar YUV 4:2:2 to planar YV12 4:2:0 Y:V:U
  *****************************************************************************/
-static void I422_YV12( filter_t *p_filter, picture_t *p_source,
-                                           picture_t *p_dest )
+static void I422_YV12_Slice( filter_t *p_filter, picture_t *p_source,
+                             picture_t *p_dest, unsigned i_lines )
 {
     uint16_t i_dpy = p_dest->p[Y_PLANE].i_pitch;
     uint16_t i_spy = p_source->p[Y_PLANE].i_pitch;
     uint16_t i_dpuv = p_dest->p[U_PLANE].i_pitch;
     uint16_t i_spuv = p_source->p[U_PLANE].i_pitch;
     uint16_t i_width = p_filter->fmt_in.video.i_width;
-    uint16_t i_y = p_filter->fmt_in.video.i_height;
+    uint16_t i_y = i_lines;
     uint8_t *p_dy = p_dest->Y_PIXELS + (i_y-1)*i_dpy;
     uint8_t *p_y = p_source->Y_PIXELS + (i_y-1)*i_spy;
     uint8_t *p_du = p_dest->V_PIXELS + (i_y/2-1)*i_dpuv; /* U and V are swapped */
@@ -169,6 +186,13 @@ static void I422_YV12( filter_t *p_filter, picture_t *p_source,
     }
 }
 
+static void I422_YV12( filter_t *p_filter, picture_t *p_source,
+                                           picture_t *p_dest )
+{
+    chroma_slices_Convert( p_filter->p_sys, I422_YV12_Slice, p_filter,
+                           p_source, p_dest, p_filter->fmt_in.video.i_height );
+}
+
 /*****************************************************************************
  * I422_YUVA: planar YUV 4:2:2 to planar YUVA 4:2:0:4 Y:U:V:A
  *****************************************************************************/
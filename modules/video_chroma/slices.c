@@ -0,0 +1,143 @@
+/*****************************************************************************
+ * slices.c: slice-parallel picture conversion
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_fourcc.h>
+#include <vlc_picture.h>
+#include <vlc_slices.h>
+
+#include "slices.h"
+
+/* Smaller slices cost more in synchronization than they save */
+#define SLICE_MIN_LINES 64
+
+struct chroma_slices
+{
+    vlc_slices_t *slices;
+    unsigned align;
+
+    chroma_slice_cb cb;
+    filter_t *filter;
+    struct
+    {
+        picture_t src;
+        picture_t dst;
+        unsigned lines;
+    } slice[VLC_SLICES_MAX];
+};
+
+chroma_slices_t *chroma_slices_New(vlc_object_t *obj, unsigned align)
+{
+    vlc_slices_t *vs = vlc_slices_New(obj);
+    if (vs == NULL)
+        return NULL;
+
+    chroma_slices_t *slices = malloc(sizeof (*slices));
+    if (unlikely(slices == NULL))
+    {
+        vlc_slices_Delete(vs);
+        return NULL;
+    }
+
+    slices->slices = vs;
+    slices->align = align > 0 ? align : 1;
+    return slices;
+}
+
+void chroma_slices_Delete(chroma_slices_t *slices)
+{
+    if (slices == NULL)
+        return;
+    vlc_slices_Delete(slices->slices);
+    free(slices);
+}
+
+/**
+ * Describes the lines [first, first + lines) of a picture.
+ */
+static void SliceView(picture_t *view, const picture_t *pic,
+                      unsigned first, unsigned lines)
+{
+    const vlc_chroma_description_t *desc =
+        vlc_fourcc_GetChromaDescription(pic->format.i_chroma);
+
+    view->format = pic->format;
+    view->i_planes = pic->i_planes;
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        unsigned num = 1, den = 1;
+        if (desc != NULL && (unsigned)i < desc->plane_count)
+        {
+            num = desc->p[i].h.num;
+            den = desc->p[i].h.den;
+        }
+
+        view->p[i] = pic->p[i];
+        view->p[i].p_pixels += (size_t)(first * num / den)
+                               * pic->p[i].i_pitch;
+        view->p[i].i_lines = lines * num / den;
+        view->p[i].i_visible_lines = view->p[i].i_lines;
+    }
+}
+
+static void SliceRun(void *opaque, unsigned index, unsigned count)
+{
+    chroma_slices_t *slices = opaque;
+    VLC_UNUSED(count);
+
+    slices->cb(slices->filter, &slices->slice[index].src,
+               &slices->slice[index].dst, slices->slice[index].lines);
+}
+
+void chroma_slices_Convert(chroma_slices_t *slices, chroma_slice_cb cb,
+                           filter_t *filter, picture_t *src, picture_t *dst,
+                           unsigned lines)
+{
+    unsigned count = slices != NULL ? vlc_slices_Count(slices->slices) : 1;
+    if (count > lines / SLICE_MIN_LINES)
+        count = lines / SLICE_MIN_LINES;
+    if (count <= 1)
+    {
+        cb(filter, src, dst, lines);
+        return;
+    }
+
+    unsigned step = (lines + count - 1) / count;
+    step = (step + slices->align - 1) / slices->align * slices->align;
+    count = (lines + step - 1) / step;
+
+    slices->cb = cb;
+    slices->filter = filter;
+    for (unsigned i = 0; i < count; i++)
+    {
+        const unsigned first = i * step;
+
+        slices->slice[i].lines = __MIN(step, lines - first);
+        SliceView(&slices->slice[i].src, src, first, slices->slice[i].lines);
+        SliceView(&slices->slice[i].dst, dst, first, slices->slice[i].lines);
+    }
+
+    vlc_slices_Run(slices->slices, count, SliceRun, slices);
+}
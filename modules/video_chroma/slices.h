@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * slices.h: slice-parallel picture conversion
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_VIDEOCHROMA_SLICES_H_
+#define VLC_VIDEOCHROMA_SLICES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct chroma_slices chroma_slices_t;
+
+/**
+ * Converts the first lines of a source picture into a destination picture.
+ *
+ * When called for a slice, the pictures only describe the planes: they start
+ * at the first line of the slice.
+ */
+typedef void (*chroma_slice_cb)(filter_t *, picture_t *src, picture_t *dst,
+                                unsigned lines);
+
+/**
+ * Creates a slice-parallel converter, on top of vlc_slices_New().
+ *
+ * \param align alignment of the slice boundaries, in lines, so that the
+ *              subsampled chroma lines are not split
+ * \return the converter, or NULL if the conversion should not be split
+ */
+chroma_slices_t *chroma_slices_New(vlc_object_t *obj, unsigned align);
+void chroma_slices_Delete(chroma_slices_t *);
+
+/**
+ * Converts lines of the source picture into the destination picture, in
+ * parallel slices, and waits for completion.
+ *
+ * If slices is NULL, or if the pictures are too small to be worth splitting,
+ * the callback converts the whole pictures from the calling thread.
+ */
+void chroma_slices_Convert(chroma_slices_t *slices, chroma_slice_cb cb,
+                           filter_t *filter, picture_t *src, picture_t *dst,
+                           unsigned lines);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
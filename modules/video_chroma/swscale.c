@@ -39,6 +39,13 @@
 #include <libswscale/swscale.h>
 #include <libswscale/version.h>
 
+/* Slice threading is available since FFmpeg 5.0 */
+#if LIBSWSCALE_VERSION_INT >= ((6<<16)+(4<<8)+100)
+# define SWSCALE_THREADS 1
+# include <libavutil/frame.h>
+# include <libavutil/opt.h>
+#endif
+
 #ifdef __APPLE__
 # include <TargetConditionals.h>
 #endif
@@ -135,6 +142,7 @@ typedef struct
 {
     SwsFilter *p_filter;
     int i_sws_flags;
+    int i_threads;
 
     video_format_t fmt_in;
     video_format_t fmt_out;
@@ -275,6 +283,8 @@ static int OpenScaler( filter_t *p_filter )
     case 10: p_sys->i_sws_flags = SWS_SPLINE; break;
     default: p_sys->i_sws_flags = SWS_BICUBIC; i_sws_mode = 2; break;
     }
+    /* 0 lets swscale use as many threads as there are CPUs */
+    p_sys->i_threads = var_InheritInteger( p_filter, "slice-threads" );
 
     /* Misc init */
     memset( &p_sys->fmt_in,  0, sizeof(p_sys->fmt_in) );
@@ -420,6 +430,37 @@ static int GetParameters( ScalerConfiguration *p_cfg,
     return VLC_SUCCESS;
 }
 
+static struct SwsContext *CreateContext( filter_sys_t *p_sys,
+                                         int i_srcw, int i_srch, int i_fmti,
+                                         int i_dstw, int i_dsth, int i_fmto,
+                                         int i_flags )
+{
+#ifdef SWSCALE_THREADS
+    struct SwsContext *ctx = sws_alloc_context();
+    if( !ctx )
+        return NULL;
+
+    av_opt_set_int( ctx, "srcw", i_srcw, 0 );
+    av_opt_set_int( ctx, "srch", i_srch, 0 );
+    av_opt_set_int( ctx, "src_format", i_fmti, 0 );
+    av_opt_set_int( ctx, "dstw", i_dstw, 0 );
+    av_opt_set_int( ctx, "dsth", i_dsth, 0 );
+    av_opt_set_int( ctx, "dst_format", i_fmto, 0 );
+    av_opt_set_int( ctx, "sws_flags", i_flags, 0 );
+    av_opt_set_int( ctx, "threads", p_sys->i_threads, 0 );
+
+    if( sws_init_context( ctx, p_sys->p_filter, NULL ) < 0 )
+    {
+        sws_freeContext( ctx );
+        return NULL;
+    }
+    return ctx;
+#else
+    return sws_getContext( i_srcw, i_srch, i_fmti, i_dstw, i_dsth, i_fmto,
+                           i_flags, p_sys->p_filter, NULL, 0 );
+#endif
+}
+
 static int Init( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
@@ -477,10 +518,9 @@ static int Init( filter_t *p_filter )
         const int i_fmto = n == 0 ? cfg.i_fmto : AV_PIX_FMT_GRAY8;
         struct SwsContext *ctx;
 
-        ctx = sws_getContext( i_fmti_visible_width, p_fmti->i_visible_height, i_fmti,
-                              i_fmto_visible_width, p_fmto->i_visible_height, i_fmto,
-                              cfg.i_sws_flags,
-                              p_sys->p_filter, NULL, 0 );
+        ctx = CreateContext( p_sys, i_fmti_visible_width, p_fmti->i_visible_height, i_fmti,
+                             i_fmto_visible_width, p_fmto->i_visible_height, i_fmto,
+                             cfg.i_sws_flags );
         if( n == 0 )
             p_sys->ctx = ctx;
         else
@@ -659,6 +699,58 @@ static void SwapUV( picture_t *p_dst, const picture_t *p_src )
     picture_CopyPixels( p_dst, &tmp );
 }
 
+#ifdef SWSCALE_THREADS
+static void NoFree( void *opaque, uint8_t *data )
+{
+    VLC_UNUSED(opaque); VLC_UNUSED(data);
+}
+
+/* Describes pixels owned by a picture, so that swscale references them
+ * rather than copying them */
+static int WrapFrame( AVFrame *frame, struct SwsContext *ctx, bool b_src,
+                      const uint8_t *const pixels[4], const int pitch[4],
+                      int i_height )
+{
+    int64_t i_width, i_format;
+
+    av_opt_get_int( ctx, b_src ? "srcw" : "dstw", 0, &i_width );
+    av_opt_get_int( ctx, b_src ? "src_format" : "dst_format", 0, &i_format );
+    frame->width = i_width;
+    frame->height = i_height;
+    frame->format = i_format;
+    for( int i = 0; i < 4; i++ )
+    {
+        frame->data[i] = (uint8_t *)pixels[i];
+        frame->linesize[i] = pitch[i];
+    }
+
+    frame->buf[0] = av_buffer_create( frame->data[0], 1, NoFree, NULL, 0 );
+    return frame->buf[0] ? 0 : -1;
+}
+
+static int ScaleFrame( struct SwsContext *ctx,
+                       const uint8_t *const src[4], const int src_stride[4],
+                       int i_height, uint8_t *const dst[4],
+                       const int dst_stride[4] )
+{
+    AVFrame *in = av_frame_alloc();
+    AVFrame *out = av_frame_alloc();
+    int64_t i_dst_height;
+    int i_ret = -1;
+
+    av_opt_get_int( ctx, "dsth", 0, &i_dst_height );
+    if( in && out
+     && !WrapFrame( in, ctx, true, src, src_stride, i_height )
+     && !WrapFrame( out, ctx, false, (const uint8_t *const *)dst,
+                    dst_stride, i_dst_height ) )
+        i_ret = sws_scale_frame( ctx, out, in ) < 0 ? -1 : 0;
+
+    av_frame_free( &in );
+    av_frame_free( &out );
+    return i_ret;
+}
+#endif
+
 static void Convert( filter_t *p_filter, struct SwsContext *ctx,
                      picture_t *p_dst, picture_t *p_src, int i_height,
                      int i_plane_count, bool b_swap_uvi, bool b_swap_uvo )
@@ -710,6 +802,12 @@ static void Convert( filter_t *p_filter, struct SwsContext *ctx,
     for (size_t i = 0; i < ARRAY_SIZE(src); i++)
         csrc[i] = src[i];
 
+#ifdef SWSCALE_THREADS
+    /* Only the frame API spreads the picture over the threads */
+    if( p_sys->i_threads != 1
+     && ScaleFrame( ctx, csrc, src_stride, i_height, dst, dst_stride ) == 0 )
+        return;
+#endif
 #if LIBSWSCALE_VERSION_INT  >= ((0<<16)+(5<<8)+0)
     sws_scale( ctx, csrc, src_stride, 0, i_height,
                dst, dst_stride );
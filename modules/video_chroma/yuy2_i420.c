@@ -34,6 +34,8 @@
 #include <vlc_picture.h>
 #include <vlc_chroma_probe.h>
 
+#include "slices.h"
+
 #define SRC_FOURCC "YUY2,YUNV,YVYU,UYVY,UYNV,Y422"
 #define DEST_FOURCC  "I420"
 
@@ -60,9 +62,9 @@ vlc_module_begin ()
         set_callback_chroma_conv_probe(ProbeChroma)
 vlc_module_end ()
 
-VIDEO_FILTER_WRAPPER( YUY2_I420 )
-VIDEO_FILTER_WRAPPER( YVYU_I420 )
-VIDEO_FILTER_WRAPPER( UYVY_I420 )
+VIDEO_FILTER_WRAPPER_CLOSE( YUY2_I420, Deactivate )
+VIDEO_FILTER_WRAPPER_CLOSE( YVYU_I420, Deactivate )
+VIDEO_FILTER_WRAPPER_CLOSE( UYVY_I420, Deactivate )
 
 /*****************************************************************************
  * Activate: allocate a chroma function
@@ -107,16 +109,24 @@ static int Activate( filter_t *p_filter )
         default:
             return -1;
     }
+
+    /* Slices start on even lines, as the chroma is vertically subsampled */
+    p_filter->p_sys = chroma_slices_New( VLC_OBJECT(p_filter), 2 );
     return 0;
 }
 
+static void Deactivate( filter_t *p_filter )
+{
+    chroma_slices_Delete( p_filter->p_sys );
+}
+
 /* Following functions are local */
 
 /*****************************************************************************
  * YUY2_I420: packed YUY2 4:2:2 to planar YUV 4:2:0
  *****************************************************************************/
-static void YUY2_I420( filter_t *p_filter, picture_t *p_source,
-                                           picture_t *p_dest )
+static void YUY2_I420_Slice( filter_t *p_filter, picture_t *p_source,
+                             picture_t *p_dest, unsigned i_lines )
 {
     uint8_t *p_line = p_source->p->p_pixels;
 
@@ -138,7 +148,7 @@ static void YUY2_I420( filter_t *p_filter, picture_t *p_source,
 
     bool b_skip = false;
 
-    for( i_y = (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) ; i_y-- ; )
+    for( i_y = i_lines ; i_y-- ; )
     {
         if( b_skip )
         {
@@ -183,11 +193,20 @@ static void YUY2_I420( filter_t *p_filter, picture_t *p_source,
     }
 }
 
+static void YUY2_I420( filter_t *p_filter, picture_t *p_source,
+                                           picture_t *p_dest )
+{
+    chroma_slices_Convert( p_filter->p_sys, YUY2_I420_Slice, p_filter,
+                           p_source, p_dest,
+                           p_filter->fmt_out.video.i_y_offset
+                         + p_filter->fmt_out.video.i_visible_height );
+}
+
 /*****************************************************************************
  * YVYU_I420: packed YVYU 4:2:2 to planar YUV 4:2:0
  *****************************************************************************/
-static void YVYU_I420( filter_t *p_filter, picture_t *p_source,
-                                           picture_t *p_dest )
+static void YVYU_I420_Slice( filter_t *p_filter, picture_t *p_source,
+                             picture_t *p_dest, unsigned i_lines )
 {
     uint8_t *p_line = p_source->p->p_pixels;
 
@@ -209,7 +228,7 @@ static void YVYU_I420( filter_t *p_filter, picture_t *p_source,
 
     bool b_skip = false;
 
-    for( i_y = (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) ; i_y-- ; )
+    for( i_y = i_lines ; i_y-- ; )
     {
         if( b_skip )
         {
@@ -254,11 +273,20 @@ static void YVYU_I420( filter_t *p_filter, picture_t *p_source,
     }
 }
 
+static void YVYU_I420( filter_t *p_filter, picture_t *p_source,
+                                           picture_t *p_dest )
+{
+    chroma_slices_Convert( p_filter->p_sys, YVYU_I420_Slice, p_filter,
+                           p_source, p_dest,
+                           p_filter->fmt_out.video.i_y_offset
+                         + p_filter->fmt_out.video.i_visible_height );
+}
+
 /*****************************************************************************
  * UYVY_I420: packed UYVY 4:2:2 to planar YUV 4:2:0
  *****************************************************************************/
-static void UYVY_I420( filter_t *p_filter, picture_t *p_source,
-                                           picture_t *p_dest )
+static void UYVY_I420_Slice( filter_t *p_filter, picture_t *p_source,
+                             picture_t *p_dest, unsigned i_lines )
 {
     uint8_t *p_line = p_source->p->p_pixels;
 
@@ -280,7 +308,7 @@ static void UYVY_I420( filter_t *p_filter, picture_t *p_source,
 
     bool b_skip = false;
 
-    for( i_y = (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) ; i_y-- ; )
+    for( i_y = i_lines ; i_y-- ; )
     {
         if( b_skip )
         {
@@ -324,3 +352,12 @@ static void UYVY_I420( filter_t *p_filter, picture_t *p_source,
         b_skip = !b_skip;
     }
 }
+
+static void UYVY_I420( filter_t *p_filter, picture_t *p_source,
+                                           picture_t *p_dest )
+{
+    chroma_slices_Convert( p_filter->p_sys, UYVY_I420_Slice, p_filter,
+                           p_source, p_dest,
+                           p_filter->fmt_out.video.i_y_offset
+                         + p_filter->fmt_out.video.i_visible_height );
+}
@@ -31,17 +31,36 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
 
+#ifdef CAN_COMPILE_SSE2
+# include <cassert>
+# include <cstring>
+# include <emmintrin.h>
+# ifdef __SSE2__
+#  define VLC_SSE2
+# else
+#  define VLC_SSE2 __attribute__ ((__target__ ("sse2")))
+# endif
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
 static int  Open (filter_t *);
 static void Close(filter_t *);
 
+#define SIMD_TEXT N_("Use SIMD blending routines")
+#define SIMD_LONGTEXT N_("Use the vectorized blending routines when the CPU " \
+    "supports them. Disabling them is only useful for benchmarking.")
+
 vlc_module_begin()
     set_description(N_("Video pictures blending"))
+    set_subcategory(SUBCAT_VIDEO_VFILTER)
     set_callback_video_blending(Open, 100)
+    add_bool("blend-simd", true, SIMD_TEXT, SIMD_LONGTEXT)
+        change_volatile()
 vlc_module_end()
 
 static inline unsigned div255(unsigned v)
@@ -58,6 +77,55 @@ void merge(T *dst, unsigned src, unsigned f)
     *dst = div255((255 - f) * (*dst) + src * f);
 }
 
+#ifdef CAN_COMPILE_SSE2
+/* The SSE2 helpers work on 8 bits values held in 16 bits lanes and give the
+ * exact same results as div255() and merge() */
+VLC_SSE2
+static inline __m128i div255_sse2(__m128i v)
+{
+    v = _mm_add_epi16(v, _mm_srli_epi16(v, 8));
+    v = _mm_add_epi16(v, _mm_set1_epi16(1));
+    return _mm_srli_epi16(v, 8);
+}
+
+VLC_SSE2
+static inline __m128i merge_sse2(__m128i dst, __m128i src, __m128i f)
+{
+    /* (255 - f) * dst + src * f <= 255 * 255 does not overflow */
+    __m128i v = _mm_mullo_epi16(_mm_sub_epi16(_mm_set1_epi16(255), f), dst);
+    return div255_sse2(_mm_add_epi16(v, _mm_mullo_epi16(src, f)));
+}
+
+/* Interleaves the even lanes of u and v: u0 v0 u2 v2 u4 v4 u6 v6 */
+VLC_SSE2
+static inline __m128i interleave_even_sse2(__m128i u, __m128i v)
+{
+    return _mm_or_si128(_mm_and_si128(u, _mm_set1_epi32(0xffff)),
+                        _mm_slli_epi32(v, 16));
+}
+
+/* Packs the even (shift = 0) or odd (shift = 16) lanes into 4 bytes */
+VLC_SSE2
+static inline uint32_t pack_lanes_sse2(__m128i v, int shift)
+{
+    v = _mm_and_si128(_mm_srli_epi32(v, shift), _mm_set1_epi32(0xffff));
+    v = _mm_packs_epi32(v, v);
+    return _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+}
+
+static inline uint32_t load32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store32(uint8_t *p, uint32_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+#endif
+
 namespace {
 
 struct CPixel {
@@ -79,6 +147,10 @@ public:
     {
         return fmt;
     }
+    unsigned getX() const
+    {
+        return x;
+    }
     bool isFull(unsigned) const
     {
         return true;
@@ -125,6 +197,43 @@ public:
             ::merge(getPointer(2, dx), spx.k, a);
         }
     }
+#ifdef CAN_COMPILE_SSE2
+    /* 8 bits 4:4:4 only */
+    VLC_SSE2 void get8(__m128i *i, __m128i *j, __m128i *k, __m128i *a,
+                       unsigned dx) const
+    {
+        const __m128i zero = _mm_setzero_si128();
+        *i = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)getPointer(0, dx)), zero);
+        *j = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)getPointer(1, dx)), zero);
+        *k = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)getPointer(2, dx)), zero);
+        if (has_alpha)
+            *a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)getPointer(3, dx)), zero);
+        else
+            *a = zero;
+    }
+    /* 8 bits 4:2:0 only, x + dx must be even */
+    VLC_SSE2 void merge8(unsigned dx, __m128i i, __m128i j, __m128i k,
+                         __m128i a, bool full)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        uint8_t *luma = getPointer(0, dx);
+        __m128i d = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)luma), zero);
+        d = merge_sse2(d, i, a);
+        _mm_storel_epi64((__m128i *)luma, _mm_packus_epi16(d, d));
+        if (full) {
+            /* Only the even pixels are merged into the chroma planes */
+            uint8_t *u = getPointer(1, dx);
+            uint8_t *v = getPointer(2, dx);
+            d = _mm_unpacklo_epi8(_mm_cvtsi32_si128(load32(u)),
+                                  _mm_cvtsi32_si128(load32(v)));
+            d = _mm_unpacklo_epi8(d, zero);
+            d = merge_sse2(d, interleave_even_sse2(j, k),
+                           interleave_even_sse2(a, a));
+            store32(u, pack_lanes_sse2(d, 0));
+            store32(v, pack_lanes_sse2(d, 16));
+        }
+    }
+#endif
     bool isFull(unsigned dx) const
     {
         return (y % ry) == 0 && ((x + dx) % rx) == 0;
@@ -175,6 +284,27 @@ public:
             ::merge(&getPointer(1, dx)[!swap_uv], spx.k, a);
         }
     }
+#ifdef CAN_COMPILE_SSE2
+    /* x + dx must be even */
+    VLC_SSE2 void merge8(unsigned dx, __m128i i, __m128i j, __m128i k,
+                         __m128i a, bool full)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        uint8_t *luma = getPointer(0, dx);
+        __m128i d = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)luma), zero);
+        d = merge_sse2(d, i, a);
+        _mm_storel_epi64((__m128i *)luma, _mm_packus_epi16(d, d));
+        if (full) {
+            /* Only the even pixels are merged into the chroma plane */
+            uint8_t *uv = getPointer(1, dx);
+            d = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)uv), zero);
+            d = merge_sse2(d, swap_uv ? interleave_even_sse2(k, j)
+                                      : interleave_even_sse2(j, k),
+                           interleave_even_sse2(a, a));
+            _mm_storel_epi64((__m128i *)uv, _mm_packus_epi16(d, d));
+        }
+    }
+#endif
     bool isFull(unsigned dx) const
     {
         return (y % 2) == 0 && ((x + dx) % 2) == 0;
@@ -285,6 +415,20 @@ public:
         if (offset_a != -1)
             px->a = src[offset_a];
     }
+#ifdef CAN_COMPILE_SSE2
+    /* 4 bytes pixels only */
+    VLC_SSE2 void get8(__m128i *i, __m128i *j, __m128i *k, __m128i *a,
+                       unsigned dx) const
+    {
+        const uint8_t *src = getPointer(dx);
+        const __m128i lo = _mm_loadu_si128((const __m128i *)src);
+        const __m128i hi = _mm_loadu_si128((const __m128i *)(src + 16));
+        *i = getChannel(lo, hi, offset_r);
+        *j = getChannel(lo, hi, offset_g);
+        *k = getChannel(lo, hi, offset_b);
+        *a = offset_a != -1 ? getChannel(lo, hi, offset_a) : _mm_setzero_si128();
+    }
+#endif
     void merge(unsigned dx, const CPixel &spx, unsigned a, bool)
     {
         uint8_t *dst = getPointer(dx);
@@ -312,6 +456,41 @@ public:
             ::merge(&dst[offset_b], spx.k, a);
         }
     }
+#ifdef CAN_COMPILE_SSE2
+    /* 4 bytes pixels without alpha only */
+    VLC_SSE2 void merge8(unsigned dx, __m128i i, __m128i j, __m128i k,
+                         __m128i a, bool)
+    {
+        assert(offset_a == -1);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i sr = _mm_cvtsi32_si128(8 * offset_r);
+        const __m128i sg = _mm_cvtsi32_si128(8 * offset_g);
+        const __m128i sb = _mm_cvtsi32_si128(8 * offset_b);
+        uint8_t *dst = getPointer(dx);
+
+        for (unsigned n = 0; n < 2; n++) {
+            const __m128i i32 = n ? _mm_unpackhi_epi16(i, zero) : _mm_unpacklo_epi16(i, zero);
+            const __m128i j32 = n ? _mm_unpackhi_epi16(j, zero) : _mm_unpacklo_epi16(j, zero);
+            const __m128i k32 = n ? _mm_unpackhi_epi16(k, zero) : _mm_unpacklo_epi16(k, zero);
+            const __m128i a32 = n ? _mm_unpackhi_epi16(a, zero) : _mm_unpacklo_epi16(a, zero);
+            /* The padding byte has a null factor and is left untouched */
+            const __m128i s = _mm_or_si128(_mm_sll_epi32(i32, sr),
+                              _mm_or_si128(_mm_sll_epi32(j32, sg),
+                                           _mm_sll_epi32(k32, sb)));
+            const __m128i f = _mm_or_si128(_mm_sll_epi32(a32, sr),
+                              _mm_or_si128(_mm_sll_epi32(a32, sg),
+                                           _mm_sll_epi32(a32, sb)));
+            const __m128i d = _mm_loadu_si128((const __m128i *)&dst[16 * n]);
+            const __m128i lo = merge_sse2(_mm_unpacklo_epi8(d, zero),
+                                          _mm_unpacklo_epi8(s, zero),
+                                          _mm_unpacklo_epi8(f, zero));
+            const __m128i hi = merge_sse2(_mm_unpackhi_epi8(d, zero),
+                                          _mm_unpackhi_epi8(s, zero),
+                                          _mm_unpackhi_epi8(f, zero));
+            _mm_storeu_si128((__m128i *)&dst[16 * n], _mm_packus_epi16(lo, hi));
+        }
+    }
+#endif
     void nextLine()
     {
         y++;
@@ -322,6 +501,16 @@ private:
     {
         return &data[(x + dx) * bytes];
     }
+#ifdef CAN_COMPILE_SSE2
+    /* Extracts one component of 8 pixels into 16 bits lanes */
+    VLC_SSE2 static __m128i getChannel(__m128i lo, __m128i hi, int offset)
+    {
+        const __m128i count = _mm_cvtsi32_si128(8 * offset);
+        const __m128i mask = _mm_set1_epi32(0xff);
+        return _mm_packs_epi32(_mm_and_si128(_mm_srl_epi32(lo, count), mask),
+                               _mm_and_si128(_mm_srl_epi32(hi, count), mask));
+    }
+#endif
     int offset_r;
     int offset_g;
     int offset_b;
@@ -433,6 +622,11 @@ struct convertNone {
     void operator()(CPixel &)
     {
     }
+#ifdef CAN_COMPILE_SSE2
+    VLC_SSE2 void operator()(__m128i &, __m128i &, __m128i &, __m128i &)
+    {
+    }
+#endif
 };
 
 struct convertAddOpaque {
@@ -441,6 +635,12 @@ struct convertAddOpaque {
     {
         p.a = 0xFF;
     }
+#ifdef CAN_COMPILE_SSE2
+    VLC_SSE2 void operator()(__m128i &, __m128i &, __m128i &, __m128i &a)
+    {
+        a = _mm_set1_epi16(0xFF);
+    }
+#endif
 };
 
 template <unsigned dst, unsigned src>
@@ -467,6 +667,31 @@ struct convertRgbToYuv8 {
         p.j = u;
         p.k = v;
     }
+#ifdef CAN_COMPILE_SSE2
+    /* Same as rgb_to_yuv(), the sums fit in 16 bits */
+    VLC_SSE2 void operator()(__m128i &r, __m128i &g, __m128i &b, __m128i &)
+    {
+        const __m128i round = _mm_set1_epi16(128);
+        __m128i y = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(66)),
+                                  _mm_mullo_epi16(g, _mm_set1_epi16(129)));
+        y = _mm_add_epi16(y, _mm_mullo_epi16(b, _mm_set1_epi16(25)));
+        y = _mm_srli_epi16(_mm_add_epi16(y, round), 8);
+
+        __m128i u = _mm_sub_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(112)),
+                                  _mm_mullo_epi16(r, _mm_set1_epi16(38)));
+        u = _mm_sub_epi16(u, _mm_mullo_epi16(g, _mm_set1_epi16(74)));
+        u = _mm_srai_epi16(_mm_add_epi16(u, round), 8);
+
+        __m128i v = _mm_sub_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(112)),
+                                  _mm_mullo_epi16(g, _mm_set1_epi16(94)));
+        v = _mm_sub_epi16(v, _mm_mullo_epi16(b, _mm_set1_epi16(18)));
+        v = _mm_srai_epi16(_mm_add_epi16(v, round), 8);
+
+        r = _mm_add_epi16(y, _mm_set1_epi16(16));
+        g = _mm_add_epi16(u, round);
+        b = _mm_add_epi16(v, round);
+    }
+#endif
 };
 
 struct convertYuv8ToRgb {
@@ -568,6 +793,13 @@ struct compose {
         f(p);
         g(p);
     }
+#ifdef CAN_COMPILE_SSE2
+    VLC_SSE2 void operator()(__m128i &i, __m128i &j, __m128i &k, __m128i &a)
+    {
+        f(i, j, k, a);
+        g(i, j, k, a);
+    }
+#endif
 private:
     F f;
     G g;
@@ -575,6 +807,25 @@ private:
 
 } // namespace
 
+template <class TDst, class TSrc, class TConvert>
+static inline void BlendPixel(TDst &dst, const TSrc &src, TConvert &convert,
+                              unsigned x, int alpha)
+{
+    CPixel spx {};
+
+    src.get(&spx, x);
+    convert(spx);
+
+    unsigned a = div255(alpha * spx.a);
+    if (a <= 0)
+        return;
+
+    if (dst.isFull(x))
+        dst.merge(x, spx, a, true);
+    else
+        dst.merge(x, spx, a, false);
+}
+
 template <class TDst, class TSrc, class TConvert>
 void Blend(const CPicture &dst_data, const CPicture &src_data,
            unsigned width, unsigned height, int alpha)
@@ -584,25 +835,57 @@ void Blend(const CPicture &dst_data, const CPicture &src_data,
     TConvert convert(dst_data.getFormat(), src_data.getFormat());
 
     for (unsigned y = 0; y < height; y++) {
-        for (unsigned x = 0; x < width; x++) {
-            CPixel spx {};
+        for (unsigned x = 0; x < width; x++)
+            BlendPixel(dst, src, convert, x, alpha);
+        src.nextLine();
+        dst.nextLine();
+    }
+}
 
-            src.get(&spx, x);
-            convert(spx);
+#ifdef CAN_COMPILE_SSE2
+/**
+ * Same as Blend() but processing 8 pixels at a time. The destination must
+ * implement merge8() and the source get8().
+ */
+template <class TDst, class TSrc, class TConvert>
+VLC_SSE2
+void BlendSSE2(const CPicture &dst_data, const CPicture &src_data,
+               unsigned width, unsigned height, int alpha)
+{
+    TSrc src(src_data);
+    TDst dst(dst_data);
+    TConvert convert(dst_data.getFormat(), src_data.getFormat());
+    const __m128i global_alpha = _mm_set1_epi16(alpha);
 
-            unsigned a = div255(alpha * spx.a);
-            if (a <= 0)
-                continue;
+    /* Start the vectors on an even destination pixel, so that the subsampled
+     * chroma is merged from their even lanes */
+    const unsigned head = __MIN(dst_data.getX() % 2, width);
 
-            if (dst.isFull(x))
-                dst.merge(x, spx, a, true);
-            else
-                dst.merge(x, spx, a, false);
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+        for (; x < head; x++)
+            BlendPixel(dst, src, convert, x, alpha);
+
+        if (x + 8 <= width) {
+            const bool full = dst.isFull(x);
+            for (; x + 8 <= width; x += 8) {
+                __m128i i, j, k, a;
+
+                src.get8(&i, &j, &k, &a, x);
+                convert(i, j, k, a);
+                /* A null alpha leaves the destination as is */
+                a = div255_sse2(_mm_mullo_epi16(a, global_alpha));
+                dst.merge8(x, i, j, k, a, full);
+            }
         }
+
+        for (; x < width; x++)
+            BlendPixel(dst, src, convert, x, alpha);
         src.nextLine();
         dst.nextLine();
     }
 }
+#endif
 
 typedef void (*blend_function_t)(const CPicture &dst_data, const CPicture &src_data,
                                  unsigned width, unsigned height, int alpha);
@@ -687,6 +970,33 @@ static const struct {
 #undef YUV
 };
 
+#ifdef CAN_COMPILE_SSE2
+static const struct {
+    vlc_fourcc_t     dst;
+    vlc_fourcc_t     src;
+    blend_function_t blend;
+} blends_sse2[] = {
+#define RGB(csp, picture, cvt) \
+    { csp, VLC_CODEC_RGBA, BlendSSE2<picture, CPictureRGBA, compose<cvt, convertNone> > }
+#define YUV(csp, picture, cvt) \
+    { csp, VLC_CODEC_YUVA, BlendSSE2<picture, CPictureYUVA, compose<cvt, convertNone> > }, \
+    { csp, VLC_CODEC_RGBA, BlendSSE2<picture, CPictureRGBA, compose<cvt, convertRgbToYuv8> > }
+
+    RGB(VLC_CODEC_RGBX,     CPictureRGB32,    convertAddOpaque),
+    RGB(VLC_CODEC_XRGB,     CPictureRGB32,    convertAddOpaque),
+    RGB(VLC_CODEC_BGRX,     CPictureRGB32,    convertAddOpaque),
+    RGB(VLC_CODEC_XBGR,     CPictureRGB32,    convertAddOpaque),
+
+    YUV(VLC_CODEC_YV12,     CPictureYV12,     convertNone),
+    YUV(VLC_CODEC_NV12,     CPictureNV12,     convertNone),
+    YUV(VLC_CODEC_NV21,     CPictureNV21,     convertNone),
+    YUV(VLC_CODEC_I420,     CPictureI420_8,   convertNone),
+
+#undef RGB
+#undef YUV
+};
+#endif
+
 struct filter_sys_t {
     filter_sys_t() : blend(NULL)
     {
@@ -742,9 +1052,19 @@ static int Open(filter_t *filter)
     const vlc_fourcc_t dst = filter->fmt_out.video.i_chroma;
 
     filter_sys_t *sys = new filter_sys_t();
-    for (size_t i = 0; i < sizeof(blends) / sizeof(*blends); i++) {
-        if (blends[i].src == src && blends[i].dst == dst)
-            sys->blend = blends[i].blend;
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2() && var_InheritBool(filter, "blend-simd")) {
+        for (size_t i = 0; i < sizeof(blends_sse2) / sizeof(*blends_sse2); i++) {
+            if (blends_sse2[i].src == src && blends_sse2[i].dst == dst)
+                sys->blend = blends_sse2[i].blend;
+        }
+    }
+#endif
+    if (!sys->blend) {
+        for (size_t i = 0; i < sizeof(blends) / sizeof(*blends); i++) {
+            if (blends[i].src == src && blends[i].dst == dst)
+                sys->blend = blends[i].blend;
+        }
     }
 
     if (!sys->blend) {
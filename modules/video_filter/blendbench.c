@@ -224,30 +224,27 @@ static void Destroy( filter_t *p_filter )
 }
 
 /*****************************************************************************
- * Render: displays previously rendered output
+ * blendbench_Run: times the blending routine, with or without SIMD
  *****************************************************************************/
-static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+static vlc_tick_t blendbench_Run( filter_t *p_filter, bool b_simd )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
     filter_t *p_blend;
 
-    if( p_sys->b_done )
-        return p_pic;
-
     p_blend = vlc_object_create( p_filter, sizeof(filter_t) );
     if( !p_blend )
-    {
-        picture_Release( p_pic );
-        return NULL;
-    }
+        return VLC_TICK_INVALID;
+
+    var_Create( p_blend, "blend-simd", VLC_VAR_BOOL );
+    var_SetBool( p_blend, "blend-simd", b_simd );
+
     p_blend->fmt_out.video = p_sys->p_base_image->format;
     p_blend->fmt_in.video = p_sys->p_blend_image->format;
     p_blend->p_module = vlc_filter_LoadModule( p_blend, "video blending", NULL, false );
     if( !p_blend->p_module )
     {
-        picture_Release( p_pic );
         vlc_object_delete(p_blend);
-        return NULL;
+        return VLC_TICK_INVALID;
     }
     assert( p_blend->ops != NULL );
 
@@ -259,6 +256,27 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
     }
     time = vlc_tick_now() - time;
 
+    vlc_filter_Delete( p_blend );
+    return time;
+}
+
+/*****************************************************************************
+ * Render: displays previously rendered output
+ *****************************************************************************/
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    if( p_sys->b_done )
+        return p_pic;
+
+    vlc_tick_t time = blendbench_Run( p_filter, true );
+    if( time == VLC_TICK_INVALID )
+    {
+        picture_Release( p_pic );
+        return NULL;
+    }
+
     msg_Info( p_filter, "Blended %d images in %f sec", p_sys->i_loops,
               secf_from_vlc_tick(time) );
     msg_Info( p_filter, "Speed is: %f images/second, %f pixels/second",
@@ -267,7 +285,11 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
                   p_sys->p_blend_image->p[Y_PLANE].i_visible_pitch *
                   p_sys->p_blend_image->p[Y_PLANE].i_visible_lines );
 
-    vlc_filter_Delete( p_blend );
+    /* Compare with the generic C routine */
+    vlc_tick_t time_c = blendbench_Run( p_filter, false );
+    if( time_c != VLC_TICK_INVALID && time > 0 )
+        msg_Info( p_filter, "Generic routine: %f sec, SIMD speedup is %.2fx",
+                  secf_from_vlc_tick(time_c), (float) time_c / time );
 
     p_sys->b_done = true;
     return p_pic;
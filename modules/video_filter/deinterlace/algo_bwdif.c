@@ -0,0 +1,197 @@
+/*****************************************************************************
+ * algo_bwdif.c : Wrapper for FFmpeg's Bwdif algorithm
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#include <stdint.h>
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+#include <vlc_filter.h>
+#include <vlc_slices.h>
+
+#include "deinterlace.h" /* filter_sys_t  */
+#include "common.h"      /* FFMIN3 et al. */
+
+#include "algo_bwdif.h"
+
+/*****************************************************************************
+ * Bwdif (BobWeaver Deinterlacing Filter).
+ *****************************************************************************/
+
+/* bwdif.h comes from bwdif.c of FFmpeg project.
+   Necessary preprocessor macros are defined in common.h. */
+#include "bwdif.h"
+
+/* Smaller slices cost more in synchronization than they save */
+#define SLICE_MIN_LINES 32
+
+/**
+ * Renders the lines of the given slice, in all planes.
+ *
+ * The lines next to the picture edges use the shorter edge filter,
+ * so that the whole picture is interpolated without reading out of bounds.
+ */
+static void RenderSlice( void *opaque, unsigned i_slice, unsigned i_count )
+{
+    bwdif_sys_t *sys = opaque;
+
+    for( int n = 0; n < sys->p_dst->i_planes; n++ )
+    {
+        const plane_t *prevp = &sys->p_prev->p[n];
+        const plane_t *curp  = &sys->p_cur->p[n];
+        const plane_t *nextp = &sys->p_next->p[n];
+        plane_t *dstp        = &sys->p_dst->p[n];
+
+        const int h = dstp->i_visible_lines;
+        const int w = dstp->i_visible_pitch / sys->i_pixel_size;
+        const int refs = curp->i_pitch;
+        const int y_start = h * i_slice / i_count;
+        const int y_end = h * (i_slice + 1) / i_count;
+
+        assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
+
+        for( int y = y_start; y < y_end; y++ )
+        {
+            uint8_t *dst = &dstp->p_pixels[y * dstp->i_pitch];
+            const uint8_t *prev = &prevp->p_pixels[y * refs];
+            const uint8_t *cur  = &curp->p_pixels[y * refs];
+            const uint8_t *next = &nextp->p_pixels[y * refs];
+
+            if( (y % 2) == sys->i_field || sys->i_parity == 2 )
+                memcpy( dst, cur, dstp->i_visible_pitch );
+            else if( y < 4 || y + 5 > h )
+            {
+                const int prefs = y + 1 < h ? refs : -refs;
+                const int mrefs = y > 0 ? -refs : refs;
+                const int spat = y >= 2 && y + 3 <= h;
+
+                if( sys->i_pixel_size == 2 )
+                    bwdif_filter_edge_c_16bit( dst, prev, cur, next, w,
+                                               prefs, mrefs, sys->i_parity,
+                                               sys->i_clip_max, spat );
+                else
+                    bwdif_filter_edge_c( dst, prev, cur, next, w,
+                                         prefs, mrefs, sys->i_parity,
+                                         sys->i_clip_max, spat );
+            }
+            else if( sys->i_pixel_size == 2 )
+                bwdif_filter_line_c_16bit( dst, prev, cur, next, w,
+                                           refs, -refs, sys->i_parity,
+                                           sys->i_clip_max );
+            else
+                bwdif_filter_line_c( dst, prev, cur, next, w,
+                                     refs, -refs, sys->i_parity,
+                                     sys->i_clip_max );
+        }
+    }
+}
+
+/*****************************************************************************
+ * Public functions
+ *****************************************************************************/
+
+void BwdifOpen( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    p_sys->bwdif.slices = vlc_slices_New( VLC_OBJECT(p_filter) );
+}
+
+void BwdifClose( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    vlc_slices_Delete( p_sys->bwdif.slices );
+    p_sys->bwdif.slices = NULL;
+}
+
+int RenderBwdifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
+{
+    return RenderBwdif( p_filter, p_dst, p_src, 0, 0 );
+}
+
+int RenderBwdif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
+                 int i_order, int i_field )
+{
+    VLC_UNUSED(p_src);
+
+    filter_sys_t *p_sys = p_filter->p_sys;
+    bwdif_sys_t *sys = &p_sys->bwdif;
+
+    /* */
+    assert( i_order >= 0 && i_order <= 2 ); /* 2 = soft field repeat */
+    assert( i_field == 0 || i_field == 1 );
+
+    /* As the pitches must match, use ONLY pictures coming from picture_New()! */
+    picture_t *p_prev = p_sys->context.pp_history[0];
+    picture_t *p_cur  = p_sys->context.pp_history[1];
+    picture_t *p_next = p_sys->context.pp_history[2];
+
+    /* Account for soft field repeat, as in RenderYadif(): parity 2 means
+       that the repeated field is copied without filtering. */
+    int bwdif_parity;
+    if( p_cur  &&  p_cur->i_nb_fields > 2 )
+        bwdif_parity = (i_order + 1) % 3; /* 1, *2*, 0 */
+    else
+        bwdif_parity = (i_order + 1) % 2; /* 1, 0 */
+
+    /* Filter if we have all the pictures we need */
+    if( p_prev && p_cur && p_next )
+    {
+        unsigned i_count = vlc_slices_Count( sys->slices );
+        const unsigned i_lines = p_dst->p[Y_PLANE].i_visible_lines;
+        if( i_count > i_lines / SLICE_MIN_LINES )
+            i_count = __MAX( i_lines / SLICE_MIN_LINES, 1 );
+
+        sys->p_dst = p_dst;
+        sys->p_prev = p_prev;
+        sys->p_cur = p_cur;
+        sys->p_next = p_next;
+        sys->i_field = i_field;
+        sys->i_parity = bwdif_parity;
+        sys->i_pixel_size = p_sys->chroma->pixel_size;
+        sys->i_clip_max = (1 << p_sys->chroma->pixel_bits) - 1;
+
+        vlc_slices_Run( sys->slices, i_count, RenderSlice, sys );
+
+        p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame, too */
+
+        return VLC_SUCCESS;
+    }
+    else if( !p_prev && !p_cur && p_next )
+    {
+        /* NOTE: For the first frame, we use the default frame offset
+                 as set by Open() or SetFilterMethod(). It is always 0. */
+
+        /* FIXME not good as it does not use i_order/i_field */
+        RenderX( p_filter, p_dst, p_next );
+        return VLC_SUCCESS;
+    }
+    else
+    {
+        p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame */
+
+        return VLC_EGENERIC;
+    }
+}
@@ -0,0 +1,107 @@
+/*****************************************************************************
+ * algo_bwdif.h : Wrapper for FFmpeg's Bwdif algorithm
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_DEINTERLACE_ALGO_BWDIF_H
+#define VLC_DEINTERLACE_ALGO_BWDIF_H 1
+
+/**
+ * \file
+ * Adapter to fit the Bwdif (BobWeaver) algorithm from FFmpeg into VLC.
+ * The algorithm itself is implemented in bwdif.h.
+ */
+
+#include <vlc_slices.h>
+
+/* Forward declarations */
+struct filter_t;
+struct picture_t;
+
+/*****************************************************************************
+ * Data structures
+ *****************************************************************************/
+
+/**
+ * Algorithm-specific state for Bwdif.
+ *
+ * This is not part of the algorithm union of filter_sys_t,
+ * as the slices outlive flushes.
+ */
+typedef struct bwdif_sys_t
+{
+    vlc_slices_t *slices;     /**< Horizontal bands, NULL if single-threaded */
+
+    /* Picture being rendered */
+    picture_t *p_dst;
+    const picture_t *p_prev, *p_cur, *p_next;
+    int i_field;
+    int i_parity;
+    int i_clip_max;
+    unsigned i_pixel_size;
+} bwdif_sys_t;
+
+/*****************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/**
+ * Sets up the slices of Bwdif, as many as the "slice-threads" option asks.
+ *
+ * @param p_filter The filter instance. Must be non-NULL.
+ */
+void BwdifOpen( filter_t *p_filter );
+
+/**
+ * Releases the slices of Bwdif, if any.
+ *
+ * @param p_filter The filter instance. Must be non-NULL.
+ */
+void BwdifClose( filter_t *p_filter );
+
+/**
+ * Bwdif (BobWeaver Deinterlacing Filter) from FFmpeg.
+ * One field is copied as-is (i_field), the other is interpolated.
+ *
+ * Bwdif uses the same motion adaptation as Yadif, but interpolates with the
+ * longer edge-preserving filters of the Weston 3 field deinterlacer. The
+ * picture is split into horizontal slices, that are rendered in parallel.
+ *
+ * The history and the frame offset are the same as with RenderYadif(),
+ * and so is the usage, including the framerate doubling.
+ *
+ * @param p_filter The filter instance. Must be non-NULL.
+ * @param p_dst Output frame. Must be allocated by caller.
+ * @param p_src Input frame. Must exist.
+ * @param i_order Temporal field number: 0 = first, 1 = second, 2 = rep. first.
+ * @param i_field Keep which field? 0 = top field, 1 = bottom field.
+ * @return VLC error code (int).
+ * @retval VLC_SUCCESS The requested field was rendered into p_dst.
+ * @retval VLC_EGENERIC Frame dropped; only occurs at the second frame after start.
+ * @see RenderYadif()
+ * @see Deinterlace()
+ */
+int RenderBwdif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
+                 int i_order, int i_field );
+
+/**
+ * Same as RenderBwdif() but without framerate doubling
+ */
+int RenderBwdifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src );
+
+#endif
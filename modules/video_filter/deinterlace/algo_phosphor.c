@@ -34,6 +34,7 @@
 
 #include "deinterlace.h" /* filter_sys_t */
 #include "helpers.h"     /* ComposeFrame() */
+#include "merge.h"       /* deinterlace_functions */
 
 #include "algo_phosphor.h"
 
@@ -41,6 +42,52 @@
  * Internal functions
  *****************************************************************************/
 
+/**
+ * Internal helper function: dims (darkens) a luma line.
+ *
+ * For luma, the operation is just a shift + bitwise AND, so we vectorize
+ * even in the C version.
+ *
+ * @see darken_cb
+ */
+static void DarkenLumaLine( uint8_t *p_out, size_t w, unsigned i_strength )
+{
+    /* Bitwise ANDing with this clears the i_strength highest bits
+       of each byte */
+    const uint8_t  remove_high_u8 = 0xFF >> i_strength;
+    const uint64_t remove_high_u64 = remove_high_u8 *
+                                            INT64_C(0x0101010101010101);
+
+    size_t wm8 = w % 8;   /* remainder */
+    size_t w8  = w - wm8; /* part of width that is divisible by 8 */
+    uint64_t *po = (uint64_t *)p_out;
+    size_t x = 0;
+
+    for( ; x < w8; x += 8, ++po )
+        (*po) = ( ((*po) >> i_strength) & remove_high_u64 );
+
+    /* handle the width remainder */
+    uint8_t *po_temp = (uint8_t *)po;
+    for( ; x < w; ++x, ++po_temp )
+        (*po_temp) = ( ((*po_temp) >> i_strength) & remove_high_u8 );
+}
+
+/**
+ * Internal helper function: dims (darkens) a chroma line.
+ *
+ * The origin (black) is at YUV = (0, 128, 128) in the uint8 format.
+ * The chroma processing is a bit more complicated than luma,
+ * and needs SIMD for vectorization.
+ *
+ * @see darken_cb
+ */
+static void DarkenChromaLine( uint8_t *p_out, size_t w, unsigned i_strength )
+{
+    uint8_t *po = p_out;
+    for( size_t x = 0; x < w; ++x, ++po )
+        (*po) = 128 + ( ((*po) - 128) / (1 << i_strength) );
+}
+
 /**
  * Internal helper function: dims (darkens) the given field
  * of the given picture.
@@ -57,13 +104,15 @@
  *     filter strengths, especially for pixels whose U and/or V values are
  *     far away from the origin (which is at 128 in uint8 format).
  *
+ * @param funcs Optimised line dimmers, if any.
  * @param p_dst Input/output picture. Will be modified in-place.
  * @param i_field Darken which field? 0 = top, 1 = bottom.
  * @param i_strength Strength of effect: 1, 2 or 3 (division by 2, 4 or 8).
  * @see RenderPhosphor()
  * @see ComposeFrame()
  */
-static void DarkenField( picture_t *p_dst,
+static void DarkenField( const struct deinterlace_functions *funcs,
+                         picture_t *p_dst,
                          const int i_field, const int i_strength,
                          bool process_chroma )
 {
@@ -71,76 +120,27 @@ static void DarkenField( picture_t *p_dst,
     assert( i_field == 0 || i_field == 1 );
     assert( i_strength >= 1 && i_strength <= 3 );
 
-    /* Bitwise ANDing with this clears the i_strength highest bits
-       of each byte */
-    const uint8_t  remove_high_u8 = 0xFF >> i_strength;
-    const uint64_t remove_high_u64 = remove_high_u8 *
-                                            INT64_C(0x0101010101010101);
+    darken_cb darken_luma = funcs->darken_luma != NULL ? funcs->darken_luma
+                                                       : DarkenLumaLine;
+    darken_cb darken_chroma = funcs->darken_chroma != NULL
+                            ? funcs->darken_chroma : DarkenChromaLine;
 
-    /* Process luma.
-
-       For luma, the operation is just a shift + bitwise AND, so we vectorize
-       even in the C version.
-
-       There are SIMD versions too, which perform significantly faster.
-    */
-    int i_plane = Y_PLANE;
-    uint8_t *p_out, *p_out_end;
-    int w = p_dst->p[i_plane].i_visible_pitch;
-    p_out = p_dst->p[i_plane].p_pixels;
-    p_out_end = p_out + p_dst->p[i_plane].i_pitch
-                      * p_dst->p[i_plane].i_visible_lines;
-
-    /* skip first line for bottom field */
-    if( i_field == 1 )
-        p_out += p_dst->p[i_plane].i_pitch;
-
-    int wm8 = w % 8;   /* remainder */
-    int w8  = w - wm8; /* part of width that is divisible by 8 */
-    for( ; p_out < p_out_end ; p_out += 2*p_dst->p[i_plane].i_pitch )
+    /* Process luma, and chroma if the field chromas are independent. */
+    const int i_planes = process_chroma ? p_dst->i_planes : Y_PLANE + 1;
+    for( int i_plane = Y_PLANE; i_plane < i_planes; i_plane++ )
     {
-        uint64_t *po = (uint64_t *)p_out;
-        int x = 0;
+        const plane_t *p = &p_dst->p[i_plane];
+        darken_cb darken = i_plane == Y_PLANE ? darken_luma : darken_chroma;
+        uint8_t *p_out = p->p_pixels;
+        uint8_t *p_out_end = p_out + p->i_pitch * p->i_visible_lines;
 
-        for( ; x < w8; x += 8, ++po )
-            (*po) = ( ((*po) >> i_strength) & remove_high_u64 );
+        /* skip first line for bottom field */
+        if( i_field == 1 )
+            p_out += p->i_pitch;
 
-        /* handle the width remainder */
-        uint8_t *po_temp = (uint8_t *)po;
-        for( ; x < w; ++x, ++po_temp )
-            (*po_temp) = ( ((*po_temp) >> i_strength) & remove_high_u8 );
+        for( ; p_out < p_out_end ; p_out += 2*p->i_pitch )
+            darken( p_out, p->i_visible_pitch, i_strength );
     }
-
-    /* Process chroma if the field chromas are independent.
-
-       The origin (black) is at YUV = (0, 128, 128) in the uint8 format.
-       The chroma processing is a bit more complicated than luma,
-       and needs SIMD for vectorization.
-    */
-    if( process_chroma )
-    {
-        for( i_plane++ /* luma already handled*/;
-             i_plane < p_dst->i_planes;
-             i_plane++ )
-        {
-            w = p_dst->p[i_plane].i_visible_pitch;
-            p_out = p_dst->p[i_plane].p_pixels;
-            p_out_end = p_out + p_dst->p[i_plane].i_pitch
-                              * p_dst->p[i_plane].i_visible_lines;
-
-            /* skip first line for bottom field */
-            if( i_field == 1 )
-                p_out += p_dst->p[i_plane].i_pitch;
-
-            for( ; p_out < p_out_end ; p_out += 2*p_dst->p[i_plane].i_pitch )
-            {
-                /* Handle the width remainder */
-                uint8_t *po = p_out;
-                for( int x = 0; x < w; ++x, ++po )
-                    (*po) = 128 + ( ((*po) - 128) / (1 << i_strength) );
-            } /* for p_out... */
-        } /* for i_plane... */
-    } /* if process_chroma */
 }
 
 /*****************************************************************************
@@ -229,7 +229,8 @@ int RenderPhosphor( filter_t *p_filter,
     */
     if( p_sys->phosphor.i_dimmer_strength > 0 )
     {
-            DarkenField( p_dst, !i_field, p_sys->phosphor.i_dimmer_strength,
+            DarkenField( p_sys->funcs, p_dst, !i_field,
+                p_sys->phosphor.i_dimmer_strength,
                 p_sys->chroma->p[1].h.num == p_sys->chroma->p[1].h.den &&
                 p_sys->chroma->p[2].h.num == p_sys->chroma->p[2].h.den );
     }
@@ -31,6 +31,7 @@
 #include <vlc_picture.h>
 
 #include "deinterlace.h" /* filter_sys_t */
+#include "merge.h"       /* deinterlace_functions */
 
 #include "algo_x.h"
 
@@ -46,7 +47,7 @@
  * but it's not really a problem because they don't have much details anyway
  */
 static inline int ssd( int a ) { return a*a; }
-static inline int XDeint8x8DetectC( uint8_t *src, int i_src )
+static inline int XDeint8x8DetectC( const uint8_t *src, ptrdiff_t i_src )
 {
     int y, x;
     int ff, fr;
@@ -73,9 +74,9 @@ static inline int XDeint8x8DetectC( uint8_t *src, int i_src )
     return fc < 1 ? false : true;
 }
 
-static inline void XDeint8x8MergeC( uint8_t *dst,  int i_dst,
-                                    uint8_t *src1, int i_src1,
-                                    uint8_t *src2, int i_src2 )
+static inline void XDeint8x8MergeC( uint8_t *dst, ptrdiff_t i_dst,
+                                    const uint8_t *src1, ptrdiff_t i_src1,
+                                    const uint8_t *src2, ptrdiff_t i_src2 )
 {
     int y, x;
 
@@ -99,8 +100,8 @@ static inline void XDeint8x8MergeC( uint8_t *dst,  int i_dst,
  * (Use 8x9 pixels)
  * TODO: a better one for the inner part.
  */
-static inline void XDeint8x8FieldEC( uint8_t *dst, int i_dst,
-                                     uint8_t *src, int i_src )
+static inline void XDeint8x8FieldEC( uint8_t *dst, ptrdiff_t i_dst,
+                                     const uint8_t *src, ptrdiff_t i_src )
 {
     int y, x;
 
@@ -120,8 +121,8 @@ static inline void XDeint8x8FieldEC( uint8_t *dst, int i_dst,
 /* XDeint8x8Field: Edge oriented interpolation
  * (Need -4 and +5 pixels H, +1 line)
  */
-static inline void XDeint8x8FieldC( uint8_t *dst, int i_dst,
-                                    uint8_t *src, int i_src )
+static inline void XDeint8x8FieldC( uint8_t *dst, ptrdiff_t i_dst,
+                                    const uint8_t *src, ptrdiff_t i_src )
 {
     int y, x;
 
@@ -133,7 +134,7 @@ static inline void XDeint8x8FieldC( uint8_t *dst, int i_dst,
 
         for( x = 0; x < 8; x++ )
         {
-            uint8_t *src2 = &src[2*i_src];
+            const uint8_t *src2 = &src[2*i_src];
             /* I use 8 pixels just to match the SIMD version, but it's overkill
              * 5 would be enough (less isn't good) */
             const int c0 = abs(src[x-4]-src2[x-2]) + abs(src[x-3]-src2[x-1]) +
@@ -260,13 +261,11 @@ static inline void XDeintNxN( uint8_t *dst, int i_dst, uint8_t *src, int i_src,
 
 /* XDeintBand8x8:
  */
-static inline void XDeintBand8x8C( uint8_t *dst, int i_dst,
-                                   uint8_t *src, int i_src,
-                                   const int i_mbx, int i_modx )
+static void XDeintBand8x8C( uint8_t *dst, ptrdiff_t i_dst,
+                            const uint8_t *src, ptrdiff_t i_src,
+                            unsigned i_mbx )
 {
-    int x;
-
-    for( x = 0; x < i_mbx; x++ )
+    for( unsigned x = 0; x < i_mbx; x++ )
     {
         int s;
         if( ( s = XDeint8x8DetectC( src, i_src ) ) )
@@ -286,9 +285,6 @@ static inline void XDeintBand8x8C( uint8_t *dst, int i_dst,
         dst += 8;
         src += 8;
     }
-
-    if( i_modx )
-        XDeintNxN( dst, i_dst, src, i_src, i_modx, 8 );
 }
 
 /*****************************************************************************
@@ -297,7 +293,9 @@ static inline void XDeintBand8x8C( uint8_t *dst, int i_dst,
 
 int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
 {
-    VLC_UNUSED(p_filter);
+    filter_sys_t *p_sys = p_filter->p_sys;
+    xdeint_band_cb band = p_sys->funcs->xdeint_band != NULL
+                        ? p_sys->funcs->xdeint_band : XDeintBand8x8C;
     int i_plane;
 
     /* Copy image and skip lines */
@@ -319,7 +317,10 @@ int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
             uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*y*i_dst];
             uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
 
-            XDeintBand8x8C( dst, i_dst, src, i_src, i_mbx, i_modx );
+            band( dst, i_dst, src, i_src, i_mbx );
+            if( i_modx )
+                XDeintNxN( &dst[8*i_mbx], i_dst, &src[8*i_mbx], i_src,
+                           i_modx, 8 );
         }
 
         /* Last line (C only)*/
@@ -35,6 +35,7 @@
 
 #include "deinterlace.h" /* filter_sys_t  */
 #include "common.h"      /* FFMIN3 et al. */
+#include "merge.h"       /* deinterlace_functions */
 
 #include "algo_yadif.h"
 
@@ -109,9 +110,11 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
     if( p_prev && p_cur && p_next )
     {
         /* */
-        void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
-                       int w, int prefs, int mrefs, int parity, int mode);
+        yadif_line_cb filter;
 
+        if( p_sys->funcs->yadif != NULL )
+            filter = p_sys->funcs->yadif;
+        else
 #if defined(HAVE_X86ASM)
         if( vlc_CPU_SSSE3() )
             filter = vlcpriv_yadif_filter_line_ssse3;
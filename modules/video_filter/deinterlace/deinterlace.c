@@ -307,6 +307,11 @@ vlc_module_begin ()
         change_integer_list( phosphor_dimmer_list, phosphor_dimmer_list_text )
         change_safe ()
     set_deinterlace_callback( Open )
+#if defined(CAN_COMPILE_SSE2)
+    add_submodule ()
+        set_description( N_("x86 SIMD optimisation for deinterlacing") )
+        set_cpu_funcs( "deinterlace functions", ProbeX86, 10 )
+#endif
 vlc_module_end ()
 
 /*****************************************************************************
@@ -357,6 +362,10 @@ static struct filter_mode_t filter_mode [] = {
                  { false, true, false, false }, false, true },
     { "yadif2x", .pf_render_ordered = RenderYadif,
                  { true, true, false, false }, false, true },
+    { "bwdif", .pf_render_single_pic = RenderBwdifSingle,
+                 { false, true, false, false }, false, true },
+    { "bwdif2x", .pf_render_ordered = RenderBwdif,
+                 { true, true, false, false }, false, true },
     { "x", .pf_render_single_pic = RenderX,
                  { false, false, false, false }, false, false },
     { "phosphor", .pf_render_ordered = RenderPhosphor,
@@ -480,6 +489,7 @@ int Mouse( filter_t *p_filter,
 static void Close( filter_t *p_filter )
 {
     Flush( p_filter );
+    BwdifClose( p_filter );
     free( p_filter->p_sys );
 }
 
@@ -491,7 +501,7 @@ static const struct vlc_filter_operations filter_ops = {
 };
 
 static struct deinterlace_functions funcs = {
-    { Merge8BitGeneric, Merge16BitGeneric, },
+    .merges = { Merge8BitGeneric, Merge16BitGeneric, },
 };
 
 /*****************************************************************************
@@ -554,6 +564,14 @@ notsupp:
 
     IVTCClearState( p_filter );
 
+    p_sys->bwdif.slices = NULL;
+    if( p_sys->context.pf_render_ordered == RenderBwdif ||
+        p_sys->context.pf_render_single_pic == RenderBwdifSingle )
+        BwdifOpen( p_filter );
+
+    vlc_CPU_functions_init_once("deinterlace functions", &funcs);
+    p_sys->funcs = &funcs;
+
 #if defined(CAN_COMPILE_C_ALTIVEC)
     if( pixel_size == 1 && vlc_CPU_ALTIVEC() )
         p_sys->pf_merge = MergeAltivec;
@@ -568,7 +586,6 @@ notsupp:
     else
 #endif
     {
-        vlc_CPU_functions_init_once("deinterlace functions", &funcs);
         p_sys->pf_merge = funcs.merges[stdc_trailing_zeros(pixel_size)];
 #if defined(__i386__) || defined(__x86_64__)
         p_sys->pf_end_merge = NULL;
@@ -31,6 +31,7 @@
 struct filter_t;
 struct picture_t;
 struct vlc_object_t;
+struct deinterlace_functions;
 
 #include <vlc_common.h>
 #include <vlc_mouse.h>
@@ -39,6 +40,7 @@ struct vlc_object_t;
 #include "algo_basic.h"
 #include "algo_x.h"
 #include "algo_yadif.h"
+#include "algo_bwdif.h"
 #include "algo_phosphor.h"
 #include "algo_ivtc.h"
 #include "common.h"
@@ -50,12 +52,13 @@ struct vlc_object_t;
 /** Available deinterlace modes. */
 static const char *const mode_list[] = {
     "discard", "blend", "mean", "bob", "linear", "x",
-    "yadif", "yadif2x", "phosphor", "ivtc" };
+    "yadif", "yadif2x", "bwdif", "bwdif2x", "phosphor", "ivtc" };
 
 /** User labels for the available deinterlace modes. */
 static const char *const mode_list_text[] = {
     N_("Discard"), N_("Blend"), N_("Mean"), N_("Bob"), N_("Linear"), "X",
-    "Yadif", "Yadif (2x)", N_("Phosphor"), N_("Film NTSC (IVTC)") };
+    "Yadif", "Yadif (2x)", "Bwdif", "Bwdif (2x)", N_("Phosphor"),
+    N_("Film NTSC (IVTC)") };
 
 /*****************************************************************************
  * Data structures
@@ -74,6 +77,8 @@ typedef struct
     /** Merge finalization routine for SSE */
     void (*pf_end_merge) ( void );
 #endif
+    /** Algorithm kernels: C, AVX2, ... */
+    const struct deinterlace_functions *funcs;
 
     struct deinterlace_ctx   context;
 
@@ -82,6 +87,7 @@ typedef struct
         phosphor_sys_t phosphor; /**< Phosphor algorithm state. */
         ivtc_sys_t ivtc;         /**< IVTC algorithm state. */
     };
+    bwdif_sys_t bwdif;           /**< Bwdif algorithm state. */
 } filter_sys_t;
 
 #endif
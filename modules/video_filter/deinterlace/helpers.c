@@ -111,8 +111,9 @@ static void FieldFromPlane( plane_t *p_dst, const plane_t *p_src, int i_field )
  * @return 1 if the block had motion, 0 if no
  * @see EstimateNumBlocksWithMotion()
  */
-static int TestForMotionInBlock( uint8_t *p_pix_p, uint8_t *p_pix_c,
-                                 int i_pitch_prev, int i_pitch_curr,
+static int TestForMotionInBlock( const uint8_t *p_pix_p,
+                                 const uint8_t *p_pix_c,
+                                 ptrdiff_t i_pitch_prev, ptrdiff_t i_pitch_curr,
                                  int* pi_top, int* pi_bot )
 {
 /* Pixel luma/chroma difference threshold to detect motion. */
@@ -123,8 +124,8 @@ static int TestForMotionInBlock( uint8_t *p_pix_p, uint8_t *p_pix_c,
 
     for( int y = 0; y < 8; ++y )
     {
-        uint8_t *pc = p_pix_c;
-        uint8_t *pp = p_pix_p;
+        const uint8_t *pc = p_pix_c;
+        const uint8_t *pp = p_pix_p;
         int score = 0;
         for( int x = 0; x < 8; ++x )
         {
@@ -300,7 +301,8 @@ void ComposeFrame( filter_t *p_filter,
 }
 
 /* See header for function doc. */
-int EstimateNumBlocksWithMotion( const picture_t* p_prev,
+int EstimateNumBlocksWithMotion( filter_t *p_filter,
+                                 const picture_t* p_prev,
                                  const picture_t* p_curr,
                                  int *pi_top, int *pi_bot)
 {
@@ -313,8 +315,10 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
     if( p_prev->i_planes != p_curr->i_planes )
         return -1;
 
-    int (*motion_in_block)(uint8_t *, uint8_t *, int , int, int *, int *) =
-        TestForMotionInBlock;
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const struct deinterlace_functions *funcs = p_sys->funcs;
+    motion_cb motion_in_block = funcs->motion != NULL ? funcs->motion
+                                                      : TestForMotionInBlock;
 
     int i_score = 0;
     for( int i_plane = 0 ; i_plane < p_prev->i_planes ; i_plane++ )
@@ -365,8 +369,48 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
 /* Threshold (value from Transcode 1.1.5) */
 #define T 100
 
+/**
+ * Internal helper function for CalculateInterlaceScore():
+ * counts the combed pixels of one line.
+ *
+ * @see comb_cb
+ */
+static unsigned CombLine( const uint8_t *p_c, const uint8_t *p_p,
+                          const uint8_t *p_n, size_t w )
+{
+    unsigned i_score = 0;
+
+    for( size_t x = 0; x < w; ++x )
+    {
+        /* Worst case: need 17 bits for "comb". */
+        int_fast32_t C = *p_c;
+        int_fast32_t P = *p_p;
+        int_fast32_t N = *p_n;
+
+        /* Comments in Transcode's filter_ivtc.c attribute this
+           combing metric to Gunnar Thalin.
+
+            The idea is that if the picture is interlaced, both
+            expressions will have the same sign, and this comes
+            up positive. The value T = 100 has been chosen such
+            that a pixel difference of 10 (on average) will
+            trigger the detector.
+        */
+        int_fast32_t comb = (P - C) * (N - C);
+        if( comb > T )
+            ++i_score;
+
+        ++p_c;
+        ++p_p;
+        ++p_n;
+    }
+
+    return i_score;
+}
+
 /* See header for function doc. */
-int CalculateInterlaceScore( const picture_t* p_pic_top,
+int CalculateInterlaceScore( filter_t *p_filter,
+                             const picture_t* p_pic_top,
                              const picture_t* p_pic_bot )
 {
     /*
@@ -385,6 +429,8 @@ int CalculateInterlaceScore( const picture_t* p_pic_top,
     if( p_pic_top->i_planes != p_pic_bot->i_planes )
         return -1;
 
+    filter_sys_t *p_sys = p_filter->p_sys;
+    comb_cb comb = p_sys->funcs->comb != NULL ? p_sys->funcs->comb : CombLine;
     int32_t i_score = 0;
 
     for( int i_plane = 0 ; i_plane < p_pic_top->i_planes ; ++i_plane )
@@ -414,30 +460,7 @@ int CalculateInterlaceScore( const picture_t* p_pic_top,
             uint8_t *p_p = &ngh->p[i_plane].p_pixels[(y-1)*wn]; /* prev line */
             uint8_t *p_n = &ngh->p[i_plane].p_pixels[(y+1)*wn]; /* next line */
 
-            for( int x = 0; x < w; ++x )
-            {
-                /* Worst case: need 17 bits for "comb". */
-                int_fast32_t C = *p_c;
-                int_fast32_t P = *p_p;
-                int_fast32_t N = *p_n;
-
-                /* Comments in Transcode's filter_ivtc.c attribute this
-                   combing metric to Gunnar Thalin.
-
-                    The idea is that if the picture is interlaced, both
-                    expressions will have the same sign, and this comes
-                    up positive. The value T = 100 has been chosen such
-                    that a pixel difference of 10 (on average) will
-                    trigger the detector.
-                */
-                int_fast32_t comb = (P - C) * (N - C);
-                if( comb > T )
-                    ++i_score;
-
-                ++p_c;
-                ++p_p;
-                ++p_n;
-            }
+            i_score += comb( p_c, p_p, p_n, w );
 
             /* Now the other field - swap current and neighbour pictures */
             const picture_t *tmp = cur;
@@ -0,0 +1,494 @@
+/*****************************************************************************
+ * kernels_x86.c : x86 SIMD kernels for the vlc deinterlacer algorithms
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "common.h" /* FFMIN3 et al. */
+#include "merge.h"
+#include "yadif.h"
+
+/*****************************************************************************
+ * X: SSE2
+ *
+ * The algorithm works on 8x8 blocks, that is to say 8 pixels at a time,
+ * which is no more than a 128-bit vector of 16-bit elements.
+ *****************************************************************************/
+
+/* Rounded down average of unsigned bytes */
+__attribute__((__target__("sse2")))
+static inline __m128i AvgFloorSSE2( __m128i a, __m128i b )
+{
+    return _mm_sub_epi8( _mm_avg_epu8( a, b ),
+                         _mm_and_si128( _mm_xor_si128( a, b ),
+                                        _mm_set1_epi8( 1 ) ) );
+}
+
+__attribute__((__target__("sse2")))
+static inline __m128i Load8SSE2( const uint8_t *p )
+{
+    return _mm_loadl_epi64( (const __m128i *)p );
+}
+
+__attribute__((__target__("sse2")))
+static inline __m128i Load8x16SSE2( const uint8_t *p )
+{
+    return _mm_unpacklo_epi8( Load8SSE2( p ), _mm_setzero_si128() );
+}
+
+__attribute__((__target__("sse2")))
+static inline int SumEpi32SSE2( __m128i v )
+{
+    v = _mm_add_epi32( v, _mm_shuffle_epi32( v, _MM_SHUFFLE(1, 0, 3, 2) ) );
+    v = _mm_add_epi32( v, _mm_shuffle_epi32( v, _MM_SHUFFLE(2, 3, 0, 1) ) );
+    return _mm_cvtsi128_si32( v );
+}
+
+/* Sum of the squared differences of two 8-pixel lines, in 4 lanes */
+__attribute__((__target__("sse2")))
+static inline __m128i SsdSSE2( const uint8_t *a, const uint8_t *b )
+{
+    __m128i d = _mm_sub_epi16( Load8x16SSE2( a ), Load8x16SSE2( b ) );
+    return _mm_madd_epi16( d, d );
+}
+
+__attribute__((__target__("sse2")))
+static bool XDeint8x8DetectSSE2( const uint8_t *src, ptrdiff_t i_src )
+{
+    for( int y = 0; y < 7; y += 2 )
+    {
+        const int fr = SumEpi32SSE2( _mm_add_epi32(
+                            SsdSSE2( src, src + i_src ),
+                            SsdSSE2( src + i_src, src + 2 * i_src ) ) );
+        const int ff = SumEpi32SSE2( _mm_add_epi32(
+                            SsdSSE2( src, src + 2 * i_src ),
+                            SsdSSE2( src + i_src, src + 3 * i_src ) ) );
+        if( ff < 6*fr/8 && fr > 32 )
+            return true;
+
+        src += 2*i_src;
+    }
+    return false;
+}
+
+__attribute__((__target__("sse2")))
+static void XDeint8x8MergeSSE2( uint8_t *dst, ptrdiff_t i_dst,
+                                const uint8_t *src, ptrdiff_t i_src )
+{
+    const __m128i four = _mm_set1_epi16( 4 );
+
+    for( int y = 0; y < 8; y += 2 )
+    {
+        memcpy( dst, src, 8 );
+        dst += i_dst;
+
+        __m128i a = Load8x16SSE2( src );
+        __m128i b = Load8x16SSE2( src + i_src );
+        __m128i c = Load8x16SSE2( src + 2 * i_src );
+        __m128i sum = _mm_add_epi16( _mm_add_epi16( a, c ), four );
+        sum = _mm_add_epi16( sum, _mm_mullo_epi16( b, _mm_set1_epi16( 6 ) ) );
+        sum = _mm_srli_epi16( sum, 3 );
+        _mm_storel_epi64( (__m128i *)dst,
+                          _mm_packus_epi16( sum, sum ) );
+        dst += i_dst;
+        src += 2*i_src;
+    }
+}
+
+__attribute__((__target__("sse2")))
+static void XDeint8x8FieldESSE2( uint8_t *dst, ptrdiff_t i_dst,
+                                 const uint8_t *src, ptrdiff_t i_src )
+{
+    for( int y = 0; y < 8; y += 2 )
+    {
+        memcpy( dst, src, 8 );
+        dst += i_dst;
+
+        _mm_storel_epi64( (__m128i *)dst,
+                          AvgFloorSSE2( Load8SSE2( src ),
+                                        Load8SSE2( src + 2 * i_src ) ) );
+        dst += i_dst;
+        src += 2*i_src;
+    }
+}
+
+/* Absolute differences of 16 byte pairs, as two vectors of 16-bit elements */
+__attribute__((__target__("sse2")))
+static inline void AbsDiffSSE2( const uint8_t *a, const uint8_t *b,
+                                __m128i *lo, __m128i *hi )
+{
+    __m128i va = _mm_loadu_si128( (const __m128i *)a );
+    __m128i vb = _mm_loadu_si128( (const __m128i *)b );
+    __m128i d = _mm_or_si128( _mm_subs_epu8( va, vb ),
+                              _mm_subs_epu8( vb, va ) );
+    *lo = _mm_unpacklo_epi8( d, _mm_setzero_si128() );
+    *hi = _mm_unpackhi_epi8( d, _mm_setzero_si128() );
+}
+
+/* Sums of 8 consecutive elements, for each of the first 8 elements */
+#define WINDOW(lo, hi, k) \
+    _mm_or_si128( _mm_srli_si128( lo, 2*(k) ), _mm_slli_si128( hi, 16-2*(k) ) )
+
+__attribute__((__target__("sse2")))
+static inline __m128i SlidingSumSSE2( __m128i lo, __m128i hi )
+{
+    __m128i sum = _mm_add_epi16( lo, WINDOW(lo, hi, 1) );
+    sum = _mm_add_epi16( sum, WINDOW(lo, hi, 2) );
+    sum = _mm_add_epi16( sum, WINDOW(lo, hi, 3) );
+    sum = _mm_add_epi16( sum, WINDOW(lo, hi, 4) );
+    sum = _mm_add_epi16( sum, WINDOW(lo, hi, 5) );
+    sum = _mm_add_epi16( sum, WINDOW(lo, hi, 6) );
+    return _mm_add_epi16( sum, WINDOW(lo, hi, 7) );
+}
+#undef WINDOW
+
+__attribute__((__target__("sse2")))
+static void XDeint8x8FieldSSE2( uint8_t *dst, ptrdiff_t i_dst,
+                                const uint8_t *src, ptrdiff_t i_src )
+{
+    for( int y = 0; y < 8; y += 2 )
+    {
+        const uint8_t *src2 = &src[2*i_src];
+        __m128i lo, hi;
+
+        memcpy( dst, src, 8 );
+        dst += i_dst;
+
+        /* Edge scores of the 3 directions, as in XDeint8x8FieldC() */
+        AbsDiffSSE2( src - 4, src2 - 2, &lo, &hi );
+        const __m128i c0 = SlidingSumSSE2( lo, hi );
+        AbsDiffSSE2( src - 3, src2 - 3, &lo, &hi );
+        const __m128i c1 = SlidingSumSSE2( lo, hi );
+        AbsDiffSSE2( src - 2, src2 - 4, &lo, &hi );
+        const __m128i c2 = SlidingSumSSE2( lo, hi );
+
+        __m128i m0 = _mm_andnot_si128( _mm_cmpgt_epi16( c1, c2 ),
+                                       _mm_cmplt_epi16( c0, c1 ) );
+        __m128i m2 = _mm_andnot_si128( _mm_cmpgt_epi16( c1, c0 ),
+                                       _mm_cmplt_epi16( c2, c1 ) );
+        m0 = _mm_packs_epi16( m0, m0 );
+        m2 = _mm_packs_epi16( m2, m2 );
+
+        __m128i out = AvgFloorSSE2( Load8SSE2( src ), Load8SSE2( src2 ) );
+        __m128i p0 = AvgFloorSSE2( Load8SSE2( src - 1 ), Load8SSE2( src2 + 1 ) );
+        __m128i p2 = AvgFloorSSE2( Load8SSE2( src + 1 ), Load8SSE2( src2 - 1 ) );
+        out = _mm_or_si128( _mm_andnot_si128( _mm_or_si128( m0, m2 ), out ),
+                            _mm_or_si128( _mm_and_si128( m0, p0 ),
+                                          _mm_and_si128( m2, p2 ) ) );
+        _mm_storel_epi64( (__m128i *)dst, out );
+
+        dst += i_dst;
+        src += 2*i_src;
+    }
+}
+
+__attribute__((__target__("sse2")))
+static void XDeintBand8x8SSE2( uint8_t *dst, ptrdiff_t i_dst,
+                               const uint8_t *src, ptrdiff_t i_src,
+                               unsigned i_mbx )
+{
+    for( unsigned x = 0; x < i_mbx; x++ )
+    {
+        if( XDeint8x8DetectSSE2( src, i_src ) )
+        {
+            if( x == 0 || x == i_mbx - 1 )
+                XDeint8x8FieldESSE2( dst, i_dst, src, i_src );
+            else
+                XDeint8x8FieldSSE2( dst, i_dst, src, i_src );
+        }
+        else
+            XDeint8x8MergeSSE2( dst, i_dst, src, i_src );
+
+        dst += 8;
+        src += 8;
+    }
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+/*****************************************************************************
+ * Yadif: AVX2
+ *****************************************************************************/
+
+/* 16 pixels as 16-bit elements */
+#define LOAD(p) \
+    _mm256_cvtepu8_epi16( _mm_loadu_si128( (const __m128i *)(p) ) )
+#define ABSDIFF(a, b) _mm256_abs_epi16( _mm256_sub_epi16( a, b ) )
+#define AVG(a, b) _mm256_srli_epi16( _mm256_add_epi16( a, b ), 1 )
+
+/* Spatial check in the direction j, as in yadif.h CHECK() */
+#define SPATIAL_CHECK(j, valid) \
+    do { \
+        __m256i score = _mm256_add_epi16( _mm256_add_epi16( \
+            ABSDIFF( LOAD(cur + mrefs - 1 + (j)), LOAD(cur + prefs - 1 - (j)) ), \
+            ABSDIFF( LOAD(cur + mrefs + (j)), LOAD(cur + prefs - (j)) ) ), \
+            ABSDIFF( LOAD(cur + mrefs + 1 + (j)), LOAD(cur + prefs + 1 - (j)) ) ); \
+        valid = _mm256_and_si256( valid, \
+                                  _mm256_cmpgt_epi16( spatial_score, score ) ); \
+        spatial_score = _mm256_blendv_epi8( spatial_score, score, valid ); \
+        spatial_pred = _mm256_blendv_epi8( spatial_pred, \
+            AVG( LOAD(cur + mrefs + (j)), LOAD(cur + prefs - (j)) ), valid ); \
+    } while (0)
+
+__attribute__((__target__("avx2")))
+static void YadifLineAVX2( uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                           uint8_t *next, int w, int prefs, int mrefs,
+                           int parity, int mode )
+{
+    uint8_t *prev2 = parity ? prev : cur ;
+    uint8_t *next2 = parity ? cur  : next;
+    const __m256i one = _mm256_set1_epi16( 1 );
+    int x = 0;
+
+    for( ; x + 16 <= w; x += 16 )
+    {
+        __m256i c = LOAD(cur + mrefs);
+        __m256i d = AVG( LOAD(prev2), LOAD(next2) );
+        __m256i e = LOAD(cur + prefs);
+        __m256i temporal_diff0 = ABSDIFF( LOAD(prev2), LOAD(next2) );
+        __m256i temporal_diff1 = _mm256_srli_epi16( _mm256_add_epi16(
+                ABSDIFF( LOAD(prev + mrefs), c ),
+                ABSDIFF( LOAD(prev + prefs), e ) ), 1 );
+        __m256i temporal_diff2 = _mm256_srli_epi16( _mm256_add_epi16(
+                ABSDIFF( LOAD(next + mrefs), c ),
+                ABSDIFF( LOAD(next + prefs), e ) ), 1 );
+        __m256i diff = _mm256_max_epi16( _mm256_max_epi16(
+                _mm256_srli_epi16( temporal_diff0, 1 ), temporal_diff1 ),
+                temporal_diff2 );
+        __m256i spatial_pred = AVG( c, e );
+        __m256i spatial_score = _mm256_sub_epi16( _mm256_add_epi16(
+                _mm256_add_epi16(
+                    ABSDIFF( LOAD(cur + mrefs - 1), LOAD(cur + prefs - 1) ),
+                    ABSDIFF( c, e ) ),
+                ABSDIFF( LOAD(cur + mrefs + 1), LOAD(cur + prefs + 1) ) ),
+                one );
+        __m256i valid;
+
+        valid = _mm256_cmpeq_epi16( one, one );
+        SPATIAL_CHECK(-1, valid);
+        SPATIAL_CHECK(-2, valid);
+        valid = _mm256_cmpeq_epi16( one, one );
+        SPATIAL_CHECK( 1, valid);
+        SPATIAL_CHECK( 2, valid);
+
+        if( mode < 2 )
+        {
+            __m256i b = AVG( LOAD(prev2 + 2*mrefs), LOAD(next2 + 2*mrefs) );
+            __m256i f = AVG( LOAD(prev2 + 2*prefs), LOAD(next2 + 2*prefs) );
+            __m256i de = _mm256_sub_epi16( d, e );
+            __m256i dc = _mm256_sub_epi16( d, c );
+            __m256i bc = _mm256_sub_epi16( b, c );
+            __m256i fe = _mm256_sub_epi16( f, e );
+            __m256i max = _mm256_max_epi16( _mm256_max_epi16( de, dc ),
+                                            _mm256_min_epi16( bc, fe ) );
+            __m256i min = _mm256_min_epi16( _mm256_min_epi16( de, dc ),
+                                            _mm256_max_epi16( bc, fe ) );
+
+            diff = _mm256_max_epi16( _mm256_max_epi16( diff, min ),
+                        _mm256_sub_epi16( _mm256_setzero_si256(), max ) );
+        }
+
+        /* diff is never negative */
+        spatial_pred = _mm256_min_epi16(
+                _mm256_max_epi16( spatial_pred, _mm256_sub_epi16( d, diff ) ),
+                _mm256_add_epi16( d, diff ) );
+
+        __m256i out = _mm256_packus_epi16( spatial_pred, spatial_pred );
+        out = _mm256_permute4x64_epi64( out, _MM_SHUFFLE(3, 1, 2, 0) );
+        _mm_storeu_si128( (__m128i *)dst, _mm256_castsi256_si128( out ) );
+
+        dst += 16;
+        cur += 16;
+        prev += 16;
+        next += 16;
+        prev2 += 16;
+        next2 += 16;
+    }
+
+    if( x < w )
+        yadif_filter_line_c( dst, prev, cur, next, w - x, prefs, mrefs,
+                             parity, mode );
+}
+#undef SPATIAL_CHECK
+#undef AVG
+#undef ABSDIFF
+#undef LOAD
+
+/*****************************************************************************
+ * Phosphor: AVX2
+ *****************************************************************************/
+
+__attribute__((__target__("avx2")))
+static void DarkenLumaAVX2( uint8_t *p, size_t len, unsigned strength )
+{
+    const __m128i shift = _mm_cvtsi32_si128( strength );
+    const __m256i mask = _mm256_set1_epi8( 0xFF >> strength );
+    size_t x = 0;
+
+    for( ; x + 32 <= len; x += 32 )
+    {
+        __m256i v = _mm256_loadu_si256( (const __m256i *)(p + x) );
+        v = _mm256_and_si256( _mm256_srl_epi16( v, shift ), mask );
+        _mm256_storeu_si256( (__m256i *)(p + x), v );
+    }
+
+    for( ; x < len; x++ )
+        p[x] >>= strength;
+}
+
+__attribute__((__target__("avx2")))
+static void DarkenChromaAVX2( uint8_t *p, size_t len, unsigned strength )
+{
+    const __m128i shift = _mm_cvtsi32_si128( strength );
+    const __m256i bias = _mm256_set1_epi16( (1 << strength) - 1 );
+    const __m256i origin = _mm256_set1_epi16( 128 );
+    size_t x = 0;
+
+    for( ; x + 16 <= len; x += 16 )
+    {
+        __m256i v = _mm256_sub_epi16( _mm256_cvtepu8_epi16(
+                        _mm_loadu_si128( (const __m128i *)(p + x) ) ), origin );
+        /* Round towards zero, as the C division */
+        v = _mm256_add_epi16( v, _mm256_and_si256( _mm256_srai_epi16( v, 15 ),
+                                                   bias ) );
+        v = _mm256_add_epi16( _mm256_sra_epi16( v, shift ), origin );
+        v = _mm256_packus_epi16( v, v );
+        v = _mm256_permute4x64_epi64( v, _MM_SHUFFLE(3, 1, 2, 0) );
+        _mm_storeu_si128( (__m128i *)(p + x), _mm256_castsi256_si128( v ) );
+    }
+
+    for( ; x < len; x++ )
+        p[x] = 128 + ( (p[x] - 128) / (1 << strength) );
+}
+
+/*****************************************************************************
+ * IVTC: AVX2
+ *****************************************************************************/
+
+__attribute__((__target__("avx2")))
+static unsigned CombAVX2( const uint8_t *c, const uint8_t *p,
+                          const uint8_t *n, size_t len )
+{
+    const __m256i threshold = _mm256_set1_epi32( 100 );
+    __m256i count = _mm256_setzero_si256();
+    size_t x = 0;
+
+    for( ; x + 16 <= len; x += 16 )
+    {
+        __m256i vc = _mm256_cvtepu8_epi16(
+                        _mm_loadu_si128( (const __m128i *)(c + x) ) );
+        __m256i vp = _mm256_cvtepu8_epi16(
+                        _mm_loadu_si128( (const __m128i *)(p + x) ) );
+        __m256i vn = _mm256_cvtepu8_epi16(
+                        _mm_loadu_si128( (const __m128i *)(n + x) ) );
+        __m256i a = _mm256_sub_epi16( vp, vc );
+        __m256i b = _mm256_sub_epi16( vn, vc );
+        /* The products need 17 bits */
+        __m256i lo = _mm256_mullo_epi16( a, b );
+        __m256i hi = _mm256_mulhi_epi16( a, b );
+
+        count = _mm256_sub_epi32( count, _mm256_cmpgt_epi32(
+                    _mm256_unpacklo_epi16( lo, hi ), threshold ) );
+        count = _mm256_sub_epi32( count, _mm256_cmpgt_epi32(
+                    _mm256_unpackhi_epi16( lo, hi ), threshold ) );
+    }
+
+    __m128i sum = _mm_add_epi32( _mm256_castsi256_si128( count ),
+                                 _mm256_extracti128_si256( count, 1 ) );
+    sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, _MM_SHUFFLE(1, 0, 3, 2) ) );
+    sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, _MM_SHUFFLE(2, 3, 0, 1) ) );
+    unsigned score = _mm_cvtsi128_si32( sum );
+
+    for( ; x < len; x++ )
+        if( (p[x] - c[x]) * (n[x] - c[x]) > 100 )
+            score++;
+    return score;
+}
+
+/* 4 lines of 8 pixels */
+__attribute__((__target__("avx2")))
+static inline __m256i Load8x4AVX2( const uint8_t *p, ptrdiff_t pitch )
+{
+    uint64_t l[4];
+
+    for( int i = 0; i < 4; i++ )
+        memcpy( &l[i], p + i * pitch, 8 );
+    return _mm256_set_epi64x( l[3], l[2], l[1], l[0] );
+}
+
+__attribute__((__target__("avx2")))
+static int MotionAVX2( const uint8_t *prev, const uint8_t *curr,
+                       ptrdiff_t prev_pitch, ptrdiff_t curr_pitch,
+                       int *top, int *bot )
+{
+    const __m256i threshold = _mm256_set1_epi8( 10 );
+    unsigned i_top = 0, i_bot = 0;
+
+    for( int y = 0; y < 8; y += 4 )
+    {
+        __m256i p = Load8x4AVX2( prev + y * prev_pitch, prev_pitch );
+        __m256i c = Load8x4AVX2( curr + y * curr_pitch, curr_pitch );
+        __m256i d = _mm256_or_si256( _mm256_subs_epu8( p, c ),
+                                     _mm256_subs_epu8( c, p ) );
+        /* Bits of the pixels that did not change by more than the threshold,
+         * 8 bits per line */
+        uint32_t still = _mm256_movemask_epi8( _mm256_cmpeq_epi8(
+                _mm256_subs_epu8( d, threshold ), _mm256_setzero_si256() ) );
+
+        i_top += vlc_popcount( ~still & 0x00FF00FFu );
+        i_bot += vlc_popcount( ~still & 0xFF00FF00u );
+    }
+
+    /* Same thresholds as TestForMotionInBlock() */
+    *top = i_top >= 8;
+    *bot = i_bot >= 8;
+    return i_top + i_bot >= 8;
+}
+#endif
+
+/*****************************************************************************
+ * Callbacks
+ *****************************************************************************/
+
+void ProbeX86( void *data )
+{
+    struct deinterlace_functions *const f = data;
+
+    if( vlc_CPU_SSE2() )
+        f->xdeint_band = XDeintBand8x8SSE2;
+
+#ifdef HAVE_AVX2_INTRINSICS
+    if( vlc_CPU_AVX2() )
+    {
+        f->yadif = YadifLineAVX2;
+        f->darken_luma = DarkenLumaAVX2;
+        f->darken_chroma = DarkenChromaAVX2;
+        f->comb = CombAVX2;
+        f->motion = MotionAVX2;
+    }
+#endif
+}
@@ -49,8 +49,61 @@
 
 typedef void (*merge_cb)(void *d, const void *s1, const void *s2, size_t len);
 
+/**
+ * Interpolates one 8-bit line with Yadif.
+ *
+ * Same semantics as yadif_filter_line_c() in yadif.h.
+ */
+typedef void (*yadif_line_cb)(uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                              uint8_t *next, int w, int prefs, int mrefs,
+                              int parity, int mode);
+
+/**
+ * Dims one 8-bit line in place, dividing the distance to black by
+ * 2^strength (1 <= strength <= 3).
+ *
+ * Black is 0 for luma and 128 for chroma; chroma rounds towards 128.
+ */
+typedef void (*darken_cb)(uint8_t *p, size_t len, unsigned strength);
+
+/**
+ * Counts the combed pixels of one line for the IVTC.
+ *
+ * \param c current line
+ * \param p previous line, from the other field
+ * \param n next line, from the other field
+ * \return number of pixels where (p - c) * (n - c) > 100
+ */
+typedef unsigned (*comb_cb)(const uint8_t *c, const uint8_t *p,
+                            const uint8_t *n, size_t len);
+
+/**
+ * Detects motion in a 8x8 block for the IVTC.
+ *
+ * \param top set if the even lines of the block have motion
+ * \param bot set if the odd lines of the block have motion
+ * \return whether the whole block has motion
+ */
+typedef int (*motion_cb)(const uint8_t *prev, const uint8_t *curr,
+                         ptrdiff_t prev_pitch, ptrdiff_t curr_pitch,
+                         int *top, int *bot);
+
+/**
+ * Deinterlaces a horizontal band of 8x8 blocks with the X algorithm.
+ *
+ * The source lines are read up to 2 lines below the band.
+ *
+ * \param blocks number of blocks in the band
+ */
+typedef void (*xdeint_band_cb)(uint8_t *dst, ptrdiff_t dst_pitch,
+                               const uint8_t *src, ptrdiff_t src_pitch,
+                               unsigned blocks);
+
 /**
  * Deinterlacing optimisation callbacks.
+ *
+ * The algorithm-specific callbacks are NULL when not optimised, in which case
+ * the algorithms use their own C code.
  */
 struct deinterlace_functions {
     /** Element-wise vector average
@@ -58,6 +111,12 @@ struct deinterlace_functions {
      * The first array entries are indexed by the binary order of magnitude
      * of the element size in bytes: 0 for 8-bit, 1 for 16-bit. */
     merge_cb merges[2];
+    yadif_line_cb yadif; /**< Yadif line filter (8-bit) */
+    darken_cb darken_luma; /**< Phosphor luma dimmer */
+    darken_cb darken_chroma; /**< Phosphor chroma dimmer */
+    comb_cb comb; /**< IVTC interlace score */
+    motion_cb motion; /**< IVTC block motion detection */
+    xdeint_band_cb xdeint_band; /**< X deinterlacing of 8x8 blocks */
 };
 
 /*****************************************************************************
@@ -160,6 +219,12 @@ void Merge8BitSSE2( void *, const void *, const void *, size_t );
  * @param i_bytes Number of bytes to merge
  */
 void Merge16BitSSE2( void *, const void *, const void *, size_t );
+
+/**
+ * Fills the algorithm callbacks of a deinterlace_functions structure
+ * with the x86 SIMD kernels that the CPU supports.
+ */
+void ProbeX86( void *funcs );
 #endif
 
 /*****************************************************************************
@@ -35,6 +35,7 @@
 #include <vlc_cpu.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_slices.h>
 
 /*****************************************************************************
  * Module descriptor
@@ -80,6 +81,12 @@ vlc_module_end()
 #else
 #   define HAVE_SSSE3 0
 #endif
+#ifdef HAVE_AVX2_INTRINSICS
+#   define HAVE_AVX2 1
+#   include <immintrin.h>
+#else
+#   define HAVE_AVX2 0
+#endif
 // FIXME too restrictive
 #ifdef __x86_64__
 #   define HAVE_6REGS 1
@@ -100,8 +107,53 @@ typedef struct
     int              radius;
     const vlc_chroma_description_t *chroma;
     struct vf_priv_s cfg;
+
+    /* Bands of lines, filtered in parallel with a buffer each */
+    vlc_slices_t     *slices;
+    size_t           band_size;
+    struct {
+        int w, h, r;
+        unsigned bands;
+        int y[VLC_SLICES_MAX + 1];
+    } plane[PICTURE_PLANE_MAX];
+
+    /* Picture being filtered */
+    picture_t        *src, *dst;
 } filter_sys_t;
 
+/* Smaller bands cost more in synchronization than they save */
+#define BAND_MIN_LINES 32
+
+static unsigned SplitLines(int *y, int height, int r, unsigned count)
+{
+    /* See filter_plane() for the constraints on the band boundaries */
+    unsigned max = height / __MAX(BAND_MIN_LINES, r + 2);
+
+    if (count > max)
+        count = __MAX(max, 1);
+    for (unsigned i = 0; i < count; i++)
+        y[i] = (height * i / count) & ~1;
+    y[count] = height;
+    return count;
+}
+
+static void FilterSlice(void *opaque, unsigned index, unsigned count)
+{
+    filter_sys_t *sys = opaque;
+    VLC_UNUSED(count);
+
+    for (int i = 0; i < sys->dst->i_planes; i++) {
+        if (index >= sys->plane[i].bands)
+            continue;
+        filter_plane(&sys->cfg, sys->cfg.buf + index * sys->band_size,
+                     sys->dst->p[i].p_pixels, sys->src->p[i].p_pixels,
+                     sys->plane[i].w, sys->plane[i].h,
+                     sys->dst->p[i].i_pitch, sys->src->p[i].i_pitch,
+                     sys->plane[i].r,
+                     sys->plane[i].y[index], sys->plane[i].y[index + 1]);
+    }
+}
+
 static int Open(filter_t *filter)
 {
     const vlc_fourcc_t fourcc = filter->fmt_in.video.i_chroma;
@@ -124,18 +176,29 @@ static int Open(filter_t *filter)
     var_AddCallback(filter, CFG_PREFIX "strength", Callback, NULL);
     var_AddCallback(filter, CFG_PREFIX "radius",   Callback, NULL);
     sys->cfg.buf = NULL;
+    sys->slices   = vlc_slices_New(VLC_OBJECT(filter));
 
     struct vf_priv_s *cfg = &sys->cfg;
     cfg->thresh      = 0.0;
     cfg->radius      = 0;
     cfg->buf         = NULL;
 
+#if HAVE_AVX2 && HAVE_SSSE3
+    if (vlc_CPU_AVX2())
+        cfg->blur_line = blur_line_avx2;
+    else
+#endif
 #if HAVE_SSE2 && HAVE_6REGS
     if (vlc_CPU_SSE2())
         cfg->blur_line = blur_line_sse2;
     else
 #endif
         cfg->blur_line   = blur_line_c;
+#if HAVE_AVX2 && HAVE_SSSE3
+    if (vlc_CPU_AVX2())
+        cfg->filter_line = filter_line_avx2;
+    else
+#endif
 #if HAVE_SSSE3
     if (vlc_CPU_SSSE3())
         cfg->filter_line = filter_line_ssse3;
@@ -155,6 +218,7 @@ static void Close(filter_t *filter)
     var_DelCallback(filter, CFG_PREFIX "radius",   Callback, NULL);
     var_DelCallback(filter, CFG_PREFIX "strength", Callback, NULL);
     aligned_free(sys->cfg.buf);
+    vlc_slices_Delete(sys->slices);
     free(sys);
 }
 
@@ -173,10 +237,13 @@ static void Filter(filter_t *filter, picture_t *src, picture_t *dst)
     cfg->thresh = (1 << 15) / strength;
     if (cfg->radius != radius) {
         cfg->radius = radius;
-        cfg->buf    = aligned_alloc(16,
-                                   (((fmt->i_width + 15) & ~15) * (cfg->radius + 1) / 2 + 32) * sizeof(*cfg->buf));
+        aligned_free(cfg->buf);
+        sys->band_size = ((fmt->i_width + 15) & ~15) * (cfg->radius + 1) / 2 + 32;
+        cfg->buf = aligned_alloc(16, vlc_slices_Count(sys->slices) *
+                                     sys->band_size * sizeof(*cfg->buf));
     }
 
+    unsigned count = 1;
     for (int i = 0; i < dst->i_planes; i++) {
         const plane_t *srcp = &src->p[i];
         plane_t       *dstp = &dst->p[i];
@@ -188,12 +255,21 @@ static void Filter(filter_t *filter, picture_t *src, picture_t *dst)
                  cfg->radius  * chroma->p[i].h.num / chroma->p[i].h.den) / 2;
         r = VLC_CLIP((r + 1) & ~1, RADIUS_MIN, RADIUS_MAX);
         if (__MIN(w, h) > 2 * r && cfg->buf) {
-            filter_plane(cfg, dstp->p_pixels, srcp->p_pixels,
-                         w, h, dstp->i_pitch, srcp->i_pitch, r);
+            sys->plane[i].w = w;
+            sys->plane[i].h = h;
+            sys->plane[i].r = r;
+            sys->plane[i].bands = SplitLines(sys->plane[i].y, h, r,
+                                             vlc_slices_Count(sys->slices));
+            count = __MAX(count, sys->plane[i].bands);
         } else {
+            sys->plane[i].bands = 0;
             plane_CopyPixels(dstp, srcp);
         }
     }
+
+    sys->src = src;
+    sys->dst = dst;
+    vlc_slices_Run(sys->slices, count, FilterSlice, sys);
 }
 
 static int Callback(vlc_object_t *object, char const *cmd,
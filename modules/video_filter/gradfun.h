@@ -172,19 +172,86 @@ static void blur_line_sse2(uint16_t *dc, uint16_t *buf, uint16_t *buf1,
 }
 #endif // HAVE_6REGS && HAVE_SSE2
 
-static void filter_plane(struct vf_priv_s *ctx, uint8_t *dst, uint8_t *src,
-                         int width, int height, int dstride, int sstride, int r)
+#if HAVE_AVX2 && HAVE_SSSE3
+__attribute__((__target__("avx2")))
+static void filter_line_avx2(uint8_t *dst, uint8_t *src, uint16_t *dc,
+                             int width, int thresh, const uint16_t *dithers)
+{
+    const __m256i t = _mm256_set1_epi16(thresh);
+    const __m256i d = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)dithers));
+    const __m256i k = _mm256_set1_epi16(127);
+    const __m256i z = _mm256_setzero_si256();
+    int x;
+
+    for (x = 0; x + 16 <= width; x += 16) {
+        __m256i pix = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src+x))), 7);
+        __m256i dcs = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(dc+x/2)));
+        dcs = _mm256_or_si256(dcs, _mm256_slli_epi32(dcs, 16));
+        __m256i delta = _mm256_sub_epi16(dcs, pix);                 // delta = dc - pix
+        __m256i m = _mm256_mulhi_epu16(_mm256_abs_epi16(delta), t); // m = abs(delta) * thresh >> 16
+        m = _mm256_min_epi16(_mm256_sub_epi16(m, k), z);            // m = -max(0, 127-m)
+        m = _mm256_slli_epi16(_mm256_mullo_epi16(m, m), 1);
+        pix = _mm256_add_epi16(pix, d);                             // pix += dither
+        pix = _mm256_add_epi16(pix, _mm256_mulhrs_epi16(delta, m)); // pix += m*m*delta >> 14
+        pix = _mm256_packus_epi16(_mm256_srai_epi16(pix, 7), z);
+        pix = _mm256_permute4x64_epi64(pix, 0x08);
+        _mm_storeu_si128((__m128i *)(dst+x), _mm256_castsi256_si128(pix)); // dst = clip(pix>>7)
+    }
+    // the SSSE3 version rounds the same way, and falls back to C for the rest
+    if (x < width)
+        filter_line_ssse3(dst+x, src+x, dc+x/2, width-x, thresh, dithers);
+}
+
+__attribute__((__target__("avx2")))
+static void blur_line_avx2(uint16_t *dc, uint16_t *buf, uint16_t *buf1,
+                           uint8_t *src, int sstride, int width)
+{
+    const __m256i one = _mm256_set1_epi8(1);
+    int x;
+
+    for (x = 0; x + 16 <= width; x += 16) {
+        __m256i v = _mm256_add_epi16(
+            _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(src+2*x)), one),
+            _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(src+2*x+sstride)), one));
+        v = _mm256_add_epi16(v, _mm256_loadu_si256((const __m256i *)(buf1+x)));
+        __m256i old = _mm256_loadu_si256((const __m256i *)(buf+x));
+        _mm256_storeu_si256((__m256i *)(buf+x), v);
+        _mm256_storeu_si256((__m256i *)(dc+x), _mm256_sub_epi16(v, old));
+    }
+    if (x < width)
+        blur_line_c(dc+x, buf+x, buf1+x, src+2*x, sstride, width-x);
+}
+#endif // HAVE_AVX2 && HAVE_SSSE3
+
+/* Filters the lines [y0, y1) of a plane, using its own buffer. The bands
+ * other than the first one must start on an even line, below the first r+2
+ * lines and above the last r lines. */
+static void filter_plane(struct vf_priv_s *ctx, uint16_t *buffer,
+                         uint8_t *dst, uint8_t *src,
+                         int width, int height, int dstride, int sstride, int r,
+                         int y0, int y1)
 {
     int bstride = ((width+15)&~15)/2;
     int y;
     uint32_t dc_factor = (1<<21)/(r*r);
-    uint16_t *dc = ctx->buf+16;
-    uint16_t *buf = ctx->buf+bstride+32;
+    uint16_t *dc = buffer+16;
+    uint16_t *buf = buffer+bstride+32;
     int thresh = ctx->thresh;
 
     memset(dc, 0, (bstride+16)*sizeof(*buf));
-    for (y=0; y<r; y++)
-        ctx->blur_line(dc, buf+y*bstride, buf+(y-1)*bstride, src+2*y*sstride, sstride, width/2);
+    if (y0 == 0) {
+        for (y=0; y<r; y++)
+            ctx->blur_line(dc, buf+y*bstride, buf+(y-1)*bstride, src+2*y*sstride, sstride, width/2);
+    } else {
+        // restart the running sums from the r pairs of lines above the band:
+        // their differences are the same, modulo 2^16
+        int p0 = (y0+r)/2;
+        for (int p = p0-r; p < p0; p++)
+            ctx->blur_line(dc, buf+(p%r)*bstride,
+                           p > p0-r ? buf+((p-1)%r)*bstride : buf-bstride,
+                           src+2*p*sstride, sstride, width/2);
+        y = y0;
+    }
     for (;;) {
         if (y < height-r) {
             int mod = ((y+r)/2)%r;
@@ -208,9 +275,9 @@ static void filter_plane(struct vf_priv_s *ctx, uint8_t *dst, uint8_t *src,
                 ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
         }
         ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
-        if (++y >= height) break;
+        if (++y >= y1) break;
         ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
-        if (++y >= height) break;
+        if (++y >= y1) break;
     }
 }
 
@@ -33,9 +33,9 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_slices.h>
 #include "filter_picture.h"
 
-
 #include "hqdn3d.h"
 
 /*****************************************************************************
@@ -82,6 +82,9 @@ static const char *const filter_options[] = {
     "luma-spat", "chroma-spat", "luma-temp", "chroma-temp", NULL
 };
 
+/* Narrower bands share too many cache lines */
+#define BAND_MIN_COLUMNS 64
+
 /*****************************************************************************
  * filter_sys_t
  *****************************************************************************/
@@ -94,8 +97,72 @@ typedef struct
     bool   b_recalc_coefs;
     vlc_mutex_t coefs_mutex;
     float  luma_spat, luma_temp, chroma_spat, chroma_temp;
+
+    /* Bands of columns, filtered in parallel */
+    vlc_slices_t *slices;
+    unsigned bands[3];
+    int bounds[3][VLC_SLICES_MAX + 1];
+    unsigned int *seeds[3];
+
+    /* Picture being filtered */
+    picture_t *src, *dst;
 } filter_sys_t;
 
+/*****************************************************************************
+ * Slices
+ *****************************************************************************/
+static unsigned SplitColumns(int *bounds, int width, unsigned count)
+{
+    if (count > (unsigned)width / BAND_MIN_COLUMNS)
+        count = __MAX(width / BAND_MIN_COLUMNS, 1);
+    for (unsigned i = 0; i < count; i++)
+        bounds[i] = (width * i / count) & ~(BAND_MIN_COLUMNS - 1);
+    bounds[count] = width;
+    return count;
+}
+
+/* Runs the horizontal filter over the lines of a slice, up to the bands */
+static void SeedSlice(void *opaque, unsigned index, unsigned count)
+{
+    filter_sys_t *sys = opaque;
+    struct vf_priv_s *cfg = &sys->cfg;
+
+    for (int i = 0; i < 3; i++) {
+        int *spat = cfg->Coefs[i ? 2 : 0];
+
+        if (sys->bands[i] < 2 || !spat[0])
+            continue;
+        deNoiseSeeds(sys->src->p[i].p_pixels, sys->seeds[i],
+                     sys->bounds[i], sys->bands[i], sys->h[i],
+                     sys->h[i] * index / count,
+                     sys->h[i] * (index + 1) / count,
+                     sys->src->p[i].i_pitch, spat);
+    }
+}
+
+static void BandSlice(void *opaque, unsigned index, unsigned count)
+{
+    filter_sys_t *sys = opaque;
+    struct vf_priv_s *cfg = &sys->cfg;
+    unsigned int *line = cfg->Line;
+    VLC_UNUSED(count);
+
+    for (int i = 0; i < 3; line += sys->w[i++]) {
+        int *spat = cfg->Coefs[i ? 2 : 0];
+        int *temp = cfg->Coefs[i ? 3 : 1];
+
+        if (index >= sys->bands[i])
+            continue;
+        deNoise(sys->src->p[i].p_pixels, sys->dst->p[i].p_pixels,
+                line, cfg->Frame[i],
+                index > 0 ? &sys->seeds[i][(index - 1) * sys->h[i]] : NULL,
+                sys->w[i], sys->h[i],
+                sys->src->p[i].i_pitch, sys->dst->p[i].i_pitch,
+                sys->bounds[i][index], sys->bounds[i][index + 1],
+                spat, spat, temp);
+    }
+}
+
 /*****************************************************************************
  * Open
  *****************************************************************************/
@@ -106,7 +173,7 @@ static int Open(filter_t *filter)
     const video_format_t *fmt_in  = &filter->fmt_in.video;
     const video_format_t *fmt_out = &filter->fmt_out.video;
     const vlc_fourcc_t fourcc_in  = fmt_in->i_chroma;
-    int wmax = 0;
+    int wsum = 0;
 
     if ( !video_format_IsSameChroma( fmt_in, fmt_out ) ) {
         msg_Err(filter, "Input and output chromas don't match");
@@ -132,10 +199,11 @@ static int Open(filter_t *filter)
 
     for (int i = 0; i < 3; ++i) {
         sys->w[i] = fmt_in->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
-        if (sys->w[i] > wmax) wmax = sys->w[i];
+        wsum += sys->w[i];
         sys->h[i] = fmt_out->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
     }
-    cfg->Line = malloc(wmax*sizeof(unsigned int));
+    /* One line per plane, as the planes are filtered concurrently */
+    cfg->Line = malloc(wsum*sizeof(unsigned int));
     if (!cfg->Line) {
         free(sys);
         return VLC_ENOMEM;
@@ -144,6 +212,24 @@ static int Open(filter_t *filter)
     config_ChainParse(filter, FILTER_PREFIX, filter_options,
                       filter->p_cfg);
 
+    sys->slices = vlc_slices_New(VLC_OBJECT(filter));
+    for (int i = 0; i < 3; ++i) {
+        sys->bands[i] = SplitColumns(sys->bounds[i], sys->w[i],
+                                     vlc_slices_Count(sys->slices));
+        assert(sys->bands[i] <= sys->bands[0]);
+        if (sys->bands[i] > 1) {
+            sys->seeds[i] = vlc_alloc((sys->bands[i] - 1) * sys->h[i],
+                                      sizeof (*sys->seeds[i]));
+            if (!sys->seeds[i]) {
+                for (int j = 0; j < i; ++j)
+                    free(sys->seeds[j]);
+                vlc_slices_Delete(sys->slices);
+                free(cfg->Line);
+                free(sys);
+                return VLC_ENOMEM;
+            }
+        }
+    }
 
     vlc_mutex_init( &sys->coefs_mutex );
     sys->b_recalc_coefs = true;
@@ -183,8 +269,10 @@ static void Close(filter_t *filter)
 
     for (int i = 0; i < 3; ++i) {
         free(cfg->Frame[i]);
+        free(sys->seeds[i]);
     }
     free(cfg->Line);
+    vlc_slices_Delete(sys->slices);
     free(sys);
 }
 
@@ -220,32 +308,23 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     }
     vlc_mutex_unlock( &sys->coefs_mutex );
 
-    deNoise(src->p[0].p_pixels, dst->p[0].p_pixels,
-            cfg->Line, &cfg->Frame[0], sys->w[0], sys->h[0],
-            src->p[0].i_pitch, dst->p[0].i_pitch,
-            cfg->Coefs[0],
-            cfg->Coefs[0],
-            cfg->Coefs[1]);
-    deNoise(src->p[1].p_pixels, dst->p[1].p_pixels,
-            cfg->Line, &cfg->Frame[1], sys->w[1], sys->h[1],
-            src->p[1].i_pitch, dst->p[1].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-    deNoise(src->p[2].p_pixels, dst->p[2].p_pixels,
-            cfg->Line, &cfg->Frame[2], sys->w[2], sys->h[2],
-            src->p[2].i_pitch, dst->p[2].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-
-    if(unlikely(!cfg->Frame[0] || !cfg->Frame[1] || !cfg->Frame[2]))
-    {
-        picture_Release( src );
-        picture_Release( dst );
-        return NULL;
+    for (int i = 0; i < 3; ++i) {
+        if (unlikely(!deNoiseFrameAnt(src->p[i].p_pixels, &cfg->Frame[i],
+                                      sys->w[i], sys->h[i],
+                                      src->p[i].i_pitch)))
+        {
+            picture_Release( src );
+            picture_Release( dst );
+            return NULL;
+        }
     }
 
+    sys->src = src;
+    sys->dst = dst;
+    if (cfg->Coefs[0][0] || cfg->Coefs[2][0])
+        vlc_slices_Run(sys->slices, sys->bands[0], SeedSlice, sys);
+    vlc_slices_Run(sys->slices, sys->bands[0], BandSlice, sys);
+
     return CopyInfoAndRelease(dst, src);
 }
 
@@ -46,17 +46,24 @@ static /*inline*/ unsigned int LowPassMul(unsigned int PrevMul, unsigned int Cur
     return CurrMul + Coef[d];
 }
 
+/* The pictures are filtered in bands of columns [X0, X1): the vertical and
+ * temporal filters only depend on the pixels of the same column, and the
+ * horizontal filter of a band is seeded with the filtered value of the last
+ * pixel of the previous band, computed by deNoiseSeeds(). Seeds[Y] is the
+ * seed of the line Y, unused for the first band. */
+
 static void deNoiseTemporal(
                     unsigned char *Frame,        // mpi->planes[x]
                     unsigned char *FrameDest,    // dmpi->planes[x]
                     unsigned short *FrameAnt,
                     int W, int H, int sStride, int dStride,
+                    int X0, int X1,
                     int *Temporal)
 {
     unsigned int PixelDst;
 
     for (long Y = 0; Y < H; Y++){
-        for (long X = 0; X < W; X++){
+        for (long X = X0; X < X1; X++){
             PixelDst = LowPassMul(FrameAnt[X]<<8, Frame[X]<<16, Temporal);
             FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
             FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
@@ -67,35 +74,71 @@ static void deNoiseTemporal(
     }
 }
 
+/* Filters horizontally the lines [Y0, Y1), up to the start of the last band,
+ * and stores the seeds of the bands starting at Bounds[1..Bands-1] in
+ * Seeds[(band - 1) * H + Y]. */
+static void deNoiseSeeds(
+                    const unsigned char *Frame,  // mpi->planes[x]
+                    unsigned int *Seeds,
+                    const int *Bounds, int Bands,
+                    int H, int Y0, int Y1, int sStride,
+                    int *Horizontal)
+{
+    for (long Y = Y0; Y < Y1; Y++){
+        const unsigned char *Line = Frame + Y*sStride;
+        unsigned int PixelAnt = Line[0]<<16;
+        long X = 1;
+
+        for (int b = 1; b < Bands; b++){
+            for (; X < Bounds[b]; X++)
+                PixelAnt = LowPassMul(PixelAnt, Line[X]<<16, Horizontal);
+            Seeds[(b-1)*H + Y] = PixelAnt;
+        }
+    }
+}
+
 static void deNoiseSpacial(
                     unsigned char *Frame,        // mpi->planes[x]
                     unsigned char *FrameDest,    // dmpi->planes[x]
                     unsigned int *LineAnt,       // vf->priv->Line (width bytes)
-                    int W, int H, int sStride, int dStride,
+                    const unsigned int *Seeds,
+                    int H, int sStride, int dStride,
+                    int X0, int X1,
                     int *Horizontal, int *Vertical)
 {
     long sLineOffs = 0, dLineOffs = 0;
     unsigned int PixelAnt;
     unsigned int PixelDst;
+    long X = X0;
 
-    /* First pixel has no left nor top neighbor. */
-    PixelDst = LineAnt[0] = PixelAnt = Frame[0]<<16;
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
+    if (X0 == 0){
+        /* First pixel has no left nor top neighbor. */
+        PixelDst = LineAnt[0] = PixelAnt = Frame[0]<<16;
+        FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
+        X = 1;
+    } else
+        PixelAnt = Frame[0]<<16;
 
-    /* First line has no top neighbor, only left. */
-    for (long X = 1; X < W; X++){
+    /* First line has no top neighbor, only left. Each pixel is filtered
+     * against the first one, without running the horizontal filter. */
+    for (; X < X1; X++){
         PixelDst = LineAnt[X] = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
         FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
     }
 
     for (long Y = 1; Y < H; Y++){
         sLineOffs += sStride, dLineOffs += dStride;
-        /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        PixelDst = LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
+        X = X0;
+        if (X0 == 0){
+            /* First pixel on each line doesn't have previous pixel */
+            PixelAnt = Frame[sLineOffs]<<16;
+            PixelDst = LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
+            FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
+            X = 1;
+        } else
+            PixelAnt = Seeds[Y];
 
-        for (long X = 1; X < W; X++){
+        for (; X < X1; X++){
             /* The rest are normal */
             PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
             PixelDst = LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
@@ -104,49 +147,65 @@ static void deNoiseSpacial(
     }
 }
 
-static void deNoise(unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned int *LineAnt,      // vf->priv->Line (width bytes)
+/* Allocates the previous frame from the first one, if needed */
+static unsigned short *deNoiseFrameAnt(
+                    const unsigned char *Frame,  // mpi->planes[x]
                     unsigned short **FrameAntPtr,
-                    int W, int H, int sStride, int dStride,
-                    int *Horizontal, int *Vertical, int *Temporal)
+                    int W, int H, int sStride)
 {
-    long sLineOffs = 0, dLineOffs = 0;
-    unsigned int PixelAnt;
-    unsigned int PixelDst;
     unsigned short* FrameAnt=(*FrameAntPtr);
 
     if(!FrameAnt){
         (*FrameAntPtr)=FrameAnt=malloc(W*H*sizeof(unsigned short));
         if(!FrameAnt)
-            return;
+            return NULL;
         for (long Y = 0; Y < H; Y++){
             unsigned short* dst=&FrameAnt[Y*W];
-            unsigned char* src=Frame+Y*sStride;
+            const unsigned char* src=Frame+Y*sStride;
             for (long X = 0; X < W; X++) dst[X]=src[X]<<8;
         }
     }
+    return FrameAnt;
+}
+
+static void deNoise(unsigned char *Frame,        // mpi->planes[x]
+                    unsigned char *FrameDest,    // dmpi->planes[x]
+                    unsigned int *LineAnt,      // vf->priv->Line (width bytes)
+                    unsigned short *FrameAnt,
+                    const unsigned int *Seeds,
+                    int W, int H, int sStride, int dStride,
+                    int X0, int X1,
+                    int *Horizontal, int *Vertical, int *Temporal)
+{
+    long sLineOffs = 0, dLineOffs = 0;
+    unsigned int PixelAnt;
+    unsigned int PixelDst;
+    long X = X0;
 
     if(!Horizontal[0] && !Vertical[0]){
         deNoiseTemporal(Frame, FrameDest, FrameAnt,
-                        W, H, sStride, dStride, Temporal);
+                        W, H, sStride, dStride, X0, X1, Temporal);
         return;
     }
     if(!Temporal[0]){
-        deNoiseSpacial(Frame, FrameDest, LineAnt,
-                       W, H, sStride, dStride, Horizontal, Vertical);
+        deNoiseSpacial(Frame, FrameDest, LineAnt, Seeds,
+                       H, sStride, dStride, X0, X1, Horizontal, Vertical);
         return;
     }
 
-    /* First pixel has no left nor top neighbor. Only previous frame */
-    LineAnt[0] = PixelAnt = Frame[0]<<16;
-    PixelDst = LowPassMul(FrameAnt[0]<<8, PixelAnt, Temporal);
-    FrameAnt[0] = ((PixelDst+0x1000007F)>>8);
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
+    if (X0 == 0){
+        /* First pixel has no left nor top neighbor. Only previous frame */
+        LineAnt[0] = PixelAnt = Frame[0]<<16;
+        PixelDst = LowPassMul(FrameAnt[0]<<8, PixelAnt, Temporal);
+        FrameAnt[0] = ((PixelDst+0x1000007F)>>8);
+        FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
+        X = 1;
+    } else
+        PixelAnt = Seeds[0];
 
     /* First line has no top neighbor. Only left one for each pixel and
      * last frame */
-    for (long X = 1; X < W; X++){
+    for (; X < X1; X++){
         LineAnt[X] = PixelAnt = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
         PixelDst = LowPassMul(FrameAnt[X]<<8, PixelAnt, Temporal);
         FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
@@ -156,14 +215,19 @@ static void deNoise(unsigned char *Frame,        // mpi->planes[x]
     for (long Y = 1; Y < H; Y++){
         unsigned short* LinePrev=&FrameAnt[Y*W];
         sLineOffs += sStride, dLineOffs += dStride;
-        /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        PixelDst = LowPassMul(LinePrev[0]<<8, LineAnt[0], Temporal);
-        LinePrev[0] = ((PixelDst+0x1000007F)>>8);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
-
-        for (long X = 1; X < W; X++){
+        X = X0;
+        if (X0 == 0){
+            /* First pixel on each line doesn't have previous pixel */
+            PixelAnt = Frame[sLineOffs]<<16;
+            LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
+            PixelDst = LowPassMul(LinePrev[0]<<8, LineAnt[0], Temporal);
+            LinePrev[0] = ((PixelDst+0x1000007F)>>8);
+            FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
+            X = 1;
+        } else
+            PixelAnt = Seeds[Y];
+
+        for (; X < X1; X++){
             /* The rest are normal */
             PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
             LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
@@ -158,7 +158,13 @@ struct vlc_input_decoder_t
     vlc_clock_t     *p_clock;
     const char *psz_id;
 
+    /* Startup trace of the first output (owned by the ModuleThread) */
+    struct vlc_tracer *startup_tracer;
+    vlc_tick_t startup_date;
+
     bool hw_dec;
+    /* Thumbnailing from the first keyframe only */
+    bool keyframe_only;
 
     const struct vlc_input_decoder_callbacks *cbs;
     void *cbs_userdata;
@@ -216,6 +222,8 @@ struct vlc_input_decoder_t
 
     sout_stream_t *p_sout;
     sout_packetizer_input_t *p_sout_input;
+    /* complete access units, sent to the sout without packetizer */
+    bool b_sout_forward;
 
     /* -- Theses variables need locking on read *and* write -- */
     /* Preroll */
@@ -1275,6 +1283,32 @@ static void DecoderSendSubstream(vlc_input_decoder_t *p_owner)
     }
 }
 
+static vlc_frame_t *DecoderForwardSout( vlc_input_decoder_t *p_owner,
+                                        vlc_frame_t **ppframe )
+{
+    decoder_t *p_dec = &p_owner->dec;
+
+    if( !p_owner->b_sout_forward )
+        return p_dec->pf_packetize( p_dec, ppframe );
+
+    if( ppframe == NULL || *ppframe == NULL )
+        return NULL;
+
+    vlc_frame_t *frame = *ppframe;
+    *ppframe = NULL;
+
+    if( frame->i_dts == VLC_TICK_INVALID )
+        frame->i_dts = frame->i_pts;
+
+    if( (frame->i_flags & VLC_FRAME_FLAG_CORRUPTED) ||
+        frame->i_dts == VLC_TICK_INVALID )
+    {
+        block_Release( frame );
+        return NULL;
+    }
+    return frame;
+}
+
 /* This function process a frame for sout
  */
 static void DecoderThread_ProcessSout( vlc_input_decoder_t *p_owner, vlc_frame_t *frame )
@@ -1283,8 +1317,7 @@ static void DecoderThread_ProcessSout( vlc_input_decoder_t *p_owner, vlc_frame_t
     vlc_frame_t *sout_frame;
     vlc_frame_t **ppframe = frame ? &frame : NULL;
 
-    while( ( sout_frame =
-                 p_dec->pf_packetize( p_dec, ppframe ) ) )
+    while( ( sout_frame = DecoderForwardSout( p_owner, ppframe ) ) )
     {
         if( p_owner->p_sout_input == NULL )
         {
@@ -1557,6 +1590,16 @@ static int ModuleThread_PlayVideo( vlc_input_decoder_t *p_owner, picture_t *p_pi
     return VLC_SUCCESS;
 }
 
+static void ModuleThread_TraceFirstOutput( vlc_input_decoder_t *p_owner )
+{
+    if( p_owner->startup_tracer == NULL )
+        return;
+
+    vlc_startup_Trace( p_owner->startup_tracer, p_owner->psz_id,
+                       "first frame", p_owner->startup_date, vlc_tick_now() );
+    p_owner->startup_tracer = NULL;
+}
+
 static void ModuleThread_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
 {
     assert( p_pic );
@@ -1564,6 +1607,8 @@ static void ModuleThread_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
     assert( p_owner->cat == VIDEO_ES );
     struct vlc_tracer *tracer = vlc_object_get_tracer( &p_dec->obj );
 
+    ModuleThread_TraceFirstOutput( p_owner );
+
     if ( tracer != NULL )
     {
         vlc_tracer_TraceStreamPTS( tracer, "DEC", p_owner->psz_id,
@@ -1705,6 +1750,8 @@ static void ModuleThread_QueueAudio( decoder_t *p_dec, vlc_frame_t *p_aout_buf )
         vlc_tracer_TraceStreamDTS( tracer, "DEC", p_owner->psz_id, "OUT",
                             p_aout_buf->i_pts, p_aout_buf->i_dts );
     }
+    if( p_aout_buf != NULL )
+        ModuleThread_TraceFirstOutput( p_owner );
 
     vlc_fifo_Lock(p_owner->p_fifo);
 
@@ -1782,6 +1829,19 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t
     decoder_t *p_dec = &p_owner->dec;
     struct vlc_tracer *tracer = vlc_object_get_tracer( &p_dec->obj );
 
+    bool drain = false;
+    if( p_owner->keyframe_only && frame != NULL )
+    {
+        /* The thumbnail is made from the keyframe the demuxer seeked to */
+        if( frame->i_flags & ( BLOCK_FLAG_TYPE_P | BLOCK_FLAG_TYPE_B
+                             | BLOCK_FLAG_TYPE_PB ) )
+        {
+            block_Release( frame );
+            return;
+        }
+        drain = p_owner->b_first && ( frame->i_flags & BLOCK_FLAG_TYPE_I );
+    }
+
     vlc_fifo_Unlock(p_owner->p_fifo);
 
     if ( tracer != NULL && frame != NULL )
@@ -1792,6 +1852,10 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t
 
     int ret = p_dec->pf_decode( p_dec, frame );
 
+    /* Don't wait for the next frames to output the keyframe */
+    if( drain && ret == VLCDEC_SUCCESS )
+        ret = p_dec->pf_decode( p_dec, NULL );
+
     vlc_fifo_Lock(p_owner->p_fifo);
     switch( ret )
     {
@@ -2140,6 +2204,33 @@ static const struct decoder_owner_callbacks dec_spu_cbs =
     .get_attachments = InputThread_GetInputAttachments,
 };
 
+/**
+ * Passes the thumbnailing hints to the decoder module
+ *
+ * Only one picture is needed: the decoder should output it as soon as
+ * possible and, given the thumbnail size, may decode at a lower resolution.
+ */
+static void CreateThumbnailerVars( vlc_input_decoder_t *p_owner,
+                                   const struct input_thumbnail_cfg *cfg )
+{
+    decoder_t *p_dec = &p_owner->dec;
+
+    if( !cfg->keyframe_only )
+        return;
+    p_owner->keyframe_only = true;
+
+    var_Create( p_dec, "low-delay", VLC_VAR_BOOL );
+    var_SetBool( p_dec, "low-delay", true );
+
+    /* Hardware decoders output the full size */
+    if( p_owner->hw_dec || ( cfg->width == 0 && cfg->height == 0 ) )
+        return;
+    var_Create( p_dec, "thumbnail-width", VLC_VAR_INTEGER );
+    var_SetInteger( p_dec, "thumbnail-width", cfg->width );
+    var_Create( p_dec, "thumbnail-height", VLC_VAR_INTEGER );
+    var_SetInteger( p_dec, "thumbnail-height", cfg->height );
+}
+
 /**
  * Create a decoder object
  *
@@ -2165,10 +2256,13 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
     p_dec = &p_owner->dec;
 
     p_owner->psz_id = cfg->str_id;
+    p_owner->startup_tracer = vlc_startup_GetTracer( VLC_OBJECT(p_dec) );
+    p_owner->startup_date = vlc_tick_now();
     p_owner->p_clock = cfg->clock;
     p_owner->i_preroll_end = PREROLL_NONE;
     p_owner->p_resource = cfg->resource;
     p_owner->hw_dec = cfg->hw_dec;
+    p_owner->keyframe_only = false;
     p_owner->cbs = cfg->cbs;
     p_owner->cbs_userdata = cfg->cbs_data;
     p_owner->p_sout = cfg->sout;
@@ -2246,7 +2340,10 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
             p_owner->video.pf_pts = VLC_TICK_INVALID;
 
             if( cfg->input_type == INPUT_TYPE_THUMBNAILING )
+            {
                 p_dec->cbs = &dec_thumbnailer_cbs;
+                CreateThumbnailerVars( p_owner, &cfg->thumbnail );
+            }
             else
                 p_dec->cbs = &dec_video_cbs;
             break;
@@ -2273,6 +2370,13 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
 
     assert( p_dec->fmt_in->i_cat == p_dec->fmt_out.i_cat && fmt->i_cat == p_dec->fmt_in->i_cat);
 
+    /* A pass-through packetizer only holds each frame to compute its length,
+     * which the muxers compute from the next dts anyway */
+    p_owner->b_sout_forward = cfg->sout != NULL && fmt->b_packetized &&
+                              p_dec->b_passthrough;
+    if( p_owner->b_sout_forward )
+        msg_Dbg( p_dec, "sending the frames to the stream output as they are" );
+
     /* Copy ourself the input replay gain */
     if( fmt->i_cat == AUDIO_ES )
     {
@@ -76,6 +76,8 @@ struct vlc_input_decoder_cfg
     sout_stream_t *sout;
     enum input_type input_type;
     bool hw_dec;
+    /* Only used by INPUT_TYPE_THUMBNAILING */
+    struct input_thumbnail_cfg thumbnail;
     unsigned cc_decoder;
     const struct vlc_input_decoder_callbacks *cbs;
     void *cbs_data;
@@ -40,6 +40,7 @@ void decoder_Init( decoder_t *p_dec, es_format_t *restrict fmt_in, const es_form
 {
     p_dec->i_extra_picture_buffers = 0;
     p_dec->b_frame_drop_allowed = false;
+    p_dec->b_passthrough = false;
 
     p_dec->pf_decode = NULL;
     p_dec->pf_get_cc = NULL;
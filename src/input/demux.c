@@ -36,6 +36,10 @@
 #include <vlc_modules.h>
 #include <vlc_strings.h>
 #include "input_internal.h"
+#include "modules/modules.h"
+
+/* Number of leading bytes checked against the demuxer signatures */
+#define DEMUX_SIGNATURE_PEEK 32
 
 typedef const struct
 {
@@ -193,8 +197,25 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
         strict = false;
     }
 
-    priv->module = vlc_module_load(vlc_object_logger(p_demux), "demux", module,
-                                   strict, demux_Probe, p_demux);
+    /* Skip the demuxers whose signatures do not match the stream start.
+     * The data is copied as probing invalidates the peek buffer. */
+    uint8_t peek[DEMUX_SIGNATURE_PEEK];
+    ssize_t peek_size = -1;
+
+    if (vlc_stream_Tell(s) == 0)
+    {
+        const uint8_t *buf;
+
+        peek_size = vlc_stream_Peek(s, &buf, sizeof (peek));
+        if (peek_size > 0)
+            memcpy(peek, buf, peek_size);
+    }
+
+    priv->module = vlc_module_load_peek(vlc_object_logger(p_demux), "demux",
+                                        module, strict,
+                                        (peek_size > 0) ? peek : NULL,
+                                        (peek_size > 0) ? peek_size : 0,
+                                        demux_Probe, p_demux);
     free(modbuf);
 
     if (priv->module == NULL)
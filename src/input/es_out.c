@@ -2525,6 +2525,7 @@ static void EsOutCreateDecoder(es_out_sys_t *p_sys, es_out_id_t *p_es)
         .sout = priv->p_sout,
         .input_type = p_sys->input_type,
         .hw_dec = priv->hw_dec,
+        .thumbnail = priv->thumbnail,
         .cc_decoder = p_sys->cc_decoder,
         .cbs = &decoder_cbs,
         .cbs_data = p_es,
@@ -36,6 +36,11 @@
 #endif
 #include <sys/stat.h>
 #include <unistd.h>
+#if defined(HAVE_MMAP) && defined(HAVE_POSIX_FALLOCATE)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  define TS_STORAGE_MMAP 1
+#endif
 
 #include <vlc_common.h>
 #include <vlc_arrays.h>
@@ -202,8 +207,12 @@ struct ts_storage_t
 #endif
     size_t  i_file_max; /* Max size in bytes */
     int64_t i_file_size;/* Current size in bytes */
+#ifdef TS_STORAGE_MMAP
+    uint8_t *p_map;     /* Shared mapping of the whole file */
+#else
     FILE    *p_filew;   /* FILE handle for data writing */
     FILE    *p_filer;   /* FILE handle for data reading */
+#endif
 
     /* */
     uint8_t *p_cmd_r;
@@ -243,6 +252,7 @@ typedef struct
     /* */
     ts_storage_t   *p_storage_r;
     ts_storage_t   *p_storage_w;
+    ts_storage_t   *p_storage_free; /* Drained storage kept for reuse */
 
     vlc_tick_t     i_cmd_delay;
 
@@ -299,6 +309,7 @@ static void         *TsRun( void * );
 
 static ts_storage_t *TsStorageNew( const char *psz_path, int64_t i_tmp_size_max );
 static void         TsStorageDelete( ts_storage_t * );
+static int          TsStorageReset( ts_storage_t * );
 static void         TsStoragePack( ts_storage_t *p_storage );
 static bool         TsStorageIsFull( ts_storage_t *, const ts_cmd_t *p_cmd );
 static bool         TsStorageIsEmpty( ts_storage_t * );
@@ -1001,6 +1012,7 @@ static int TsStart(struct es_out_timeshift *p_sys)
     p_ts->i_cmd_delay = 0;
     p_ts->p_storage_r = NULL;
     p_ts->p_storage_w = NULL;
+    p_ts->p_storage_free = NULL;
 
     p_sys->b_delayed = true;
     if( vlc_clone( &p_ts->thread, TsRun, p_ts ) )
@@ -1048,6 +1060,8 @@ static void TsStop( ts_thread_t *p_ts )
     assert( !p_ts->p_storage_r || !p_ts->p_storage_r->p_next );
     if( p_ts->p_storage_r )
         TsStorageDelete( p_ts->p_storage_r );
+    if( p_ts->p_storage_free )
+        TsStorageDelete( p_ts->p_storage_free );
     vlc_mutex_unlock( &p_ts->lock );
 
     TsDestroy( p_ts );
@@ -1058,7 +1072,27 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 
     if( !p_ts->p_storage_w || TsStorageIsFull( p_ts->p_storage_w, p_cmd ) )
     {
-        ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max );
+        /* A block larger than the storage gets a storage of its own */
+        int64_t i_size_max = p_ts->i_tmp_size_max;
+        if( p_cmd->header.i_type == C_SEND )
+        {
+            size_t i_size = sizeof(*p_cmd->send.p_block)
+                          + p_cmd->send.p_block->i_buffer;
+            if( (uint64_t)i_size >= (uint64_t)i_size_max )
+                i_size_max = i_size + 1;
+        }
+
+        /* Reuse the last drained storage rather than creating a new file */
+        ts_storage_t *p_storage = p_ts->p_storage_free;
+        p_ts->p_storage_free = NULL;
+        if( p_storage && ( (int64_t)p_storage->i_file_max < i_size_max
+                        || TsStorageReset( p_storage ) ) )
+        {
+            TsStorageDelete( p_storage );
+            p_storage = NULL;
+        }
+        if( !p_storage )
+            p_storage = TsStorageNew( p_ts->psz_tmp_path, i_size_max );
 
         if( !p_storage )
         {
@@ -1102,7 +1136,10 @@ static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
         if( !p_next )
             break;
 
-        TsStorageDelete( p_ts->p_storage_r );
+        if( p_ts->p_storage_free )
+            TsStorageDelete( p_ts->p_storage_free );
+        p_ts->p_storage_free = p_ts->p_storage_r;
+        p_ts->p_storage_free->p_next = NULL;
         p_ts->p_storage_r = p_next;
     }
 
@@ -1319,6 +1356,28 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
         return NULL;
     }
 
+#ifdef TS_STORAGE_MMAP
+    /* Reserve the whole file up front: running out of space while writing
+     * to the mapping would raise SIGBUS instead of failing cleanly. */
+    p_storage->p_map = MAP_FAILED;
+    if( (uint64_t)i_tmp_size_max <= SIZE_MAX
+     && posix_fallocate( fd, 0, i_tmp_size_max ) == 0 )
+        p_storage->p_map = mmap( NULL, i_tmp_size_max, PROT_READ|PROT_WRITE,
+                                 MAP_SHARED, fd, 0 );
+    vlc_close( fd );
+    vlc_unlink( psz_file );
+    free( psz_file );
+
+    if( p_storage->p_map == MAP_FAILED )
+    {
+        free( p_storage );
+        return NULL;
+    }
+# ifdef MADV_HUGEPAGE
+    /* Only effective if the file lives in RAM (tmpfs) */
+    madvise( p_storage->p_map, i_tmp_size_max, MADV_HUGEPAGE );
+# endif
+#else
     p_storage->p_filew = fdopen( fd, "w+b" );
     if( p_storage->p_filew == NULL )
     {
@@ -1340,6 +1399,7 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
     free( psz_file );
 #else
     p_storage->psz_file = psz_file;
+#endif
 #endif
     p_storage->p_next = NULL;
 
@@ -1360,10 +1420,12 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
         return NULL;
     }
     return p_storage;
+#ifndef TS_STORAGE_MMAP
 error:
     free( psz_file );
     free( p_storage );
     return NULL;
+#endif
 }
 
 static void TsStorageDelete( ts_storage_t *p_storage )
@@ -1378,15 +1440,46 @@ static void TsStorageDelete( ts_storage_t *p_storage )
     }
     free( p_storage->p_cmd_buf );
 
+#ifdef TS_STORAGE_MMAP
+    munmap( p_storage->p_map, p_storage->i_file_max );
+#else
     fclose( p_storage->p_filer );
     fclose( p_storage->p_filew );
 #ifdef _WIN32
     vlc_unlink( p_storage->psz_file );
     free( p_storage->psz_file );
+#endif
 #endif
     free( p_storage );
 }
 
+/* Rewinds a drained storage so that it can be written again */
+static int TsStorageReset( ts_storage_t *p_storage )
+{
+    assert( TsStorageIsEmpty( p_storage ) );
+
+    /* Undo TsStoragePack() */
+    const size_t i_cmd_buf = TS_STORAGE_COMMAND_PREALLOC * MAX_COMMAND_SIZE;
+    if( p_storage->i_cmd_buf != i_cmd_buf )
+    {
+        uint8_t *p_realloc = realloc( p_storage->p_cmd_buf, i_cmd_buf );
+        if( !p_realloc )
+            return VLC_ENOMEM;
+        p_storage->p_cmd_buf = p_realloc;
+        p_storage->i_cmd_buf = i_cmd_buf;
+    }
+    p_storage->p_cmd_w = p_storage->p_cmd_buf;
+    p_storage->p_cmd_r = p_storage->p_cmd_buf;
+
+#ifndef TS_STORAGE_MMAP
+    if( fseek( p_storage->p_filew, 0, SEEK_SET ) )
+        return VLC_EGENERIC;
+#endif
+    p_storage->i_file_size = 0;
+    p_storage->p_next = NULL;
+    return VLC_SUCCESS;
+}
+
 static void TsStoragePack( ts_storage_t *p_storage )
 {
     /* Try to release a bit of memory */
@@ -1432,6 +1525,21 @@ static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bo
         block_t *p_block = cmd.send.p_block;
 
         cmd.send.p_block = NULL;
+#ifdef TS_STORAGE_MMAP
+        /* The file was reserved when created, and sized to hold any block
+         * that TsStorageIsFull() let through: writes cannot fail. */
+        uint8_t *p = p_storage->p_map + p_storage->i_file_size;
+
+        assert( sizeof(*p_block) + p_block->i_buffer
+                  < p_storage->i_file_max - p_storage->i_file_size );
+        cmd.send.i_offset = p_storage->i_file_size;
+        memcpy( p, p_block, sizeof(*p_block) );
+        if( p_block->i_buffer > 0 )
+            memcpy( p + sizeof(*p_block), p_block->p_buffer, p_block->i_buffer );
+        p_storage->i_file_size += sizeof(*p_block) + p_block->i_buffer;
+        block_Release( p_block );
+        (void) b_flush;
+#else
         cmd.send.i_offset = ftell( p_storage->p_filew );
 
         if( fwrite( p_block, sizeof(*p_block), 1, p_storage->p_filew ) != 1 )
@@ -1453,6 +1561,7 @@ static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bo
 
         if( b_flush )
             fflush( p_storage->p_filew );
+#endif
     }
     size_t i_cmdsize = TsStorageSizeofCommand[ cmd.header.i_type ];
     memcpy( p_storage->p_cmd_w, &cmd, i_cmdsize );
@@ -1472,6 +1581,25 @@ static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_fl
     {
         block_t block;
 
+#ifdef TS_STORAGE_MMAP
+        if( !b_flush )
+        {
+            const uint8_t *p = p_storage->p_map + p_cmd->send.i_offset;
+
+            memcpy( &block, p, sizeof(block) );
+            block_t *p_block = block_Alloc( block.i_buffer );
+            if( p_block )
+            {
+                p_block->i_dts      = block.i_dts;
+                p_block->i_pts      = block.i_pts;
+                p_block->i_flags    = block.i_flags;
+                p_block->i_length   = block.i_length;
+                p_block->i_nb_samples = block.i_nb_samples;
+                memcpy( p_block->p_buffer, p + sizeof(block), block.i_buffer );
+            }
+            p_cmd->send.p_block = p_block;
+        }
+#else
         if( !b_flush &&
             !fseek( p_storage->p_filer, p_cmd->send.i_offset, SEEK_SET ) &&
             fread( &block, sizeof(block), 1, p_storage->p_filer ) == 1 )
@@ -1488,6 +1616,7 @@ static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_fl
             }
             p_cmd->send.p_block = p_block;
         }
+#endif
         else
         {
             //perror( "TsStoragePopCmd" );
@@ -268,6 +268,7 @@ input_thread_t * input_Create( vlc_object_t *p_parent, input_item_t *p_item,
     priv->cbs_data = cfg->cbs_data;
     priv->type = cfg->type;
     priv->preparse_subitems = cfg->preparsing.subitems;
+    priv->thumbnail = cfg->thumbnailing;
     priv->i_start = 0;
     priv->i_stop  = 0;
     priv->i_title_offset = input_priv(p_input)->i_seekpoint_offset = 0;
@@ -624,6 +625,15 @@ static void MainLoopStatistics( input_thread_t *p_input )
         struct input_stats_t new_stats;
         input_stats_Compute(priv->stats, &new_stats);
 
+        stream_t *stream = priv->master->p_demux->s;
+        if( stream == NULL
+         || vlc_stream_GetBuffering( stream, &new_stats.i_buffered_bytes,
+                                     &new_stats.i_buffer_underruns ) )
+        {
+            new_stats.i_buffered_bytes = 0;
+            new_stats.i_buffer_underruns = 0;
+        }
+
         vlc_mutex_lock(&priv->p_item->lock);
         *priv->p_item->p_stats = new_stats;
         vlc_mutex_unlock(&priv->p_item->lock);
@@ -1284,6 +1294,7 @@ static int Init( input_thread_t * p_input )
 {
     input_thread_private_t *priv = input_priv(p_input);
     input_source_t *master;
+    vlc_tick_t start = vlc_tick_now();
 
     /* */
     input_ChangeState( p_input, OPENING_S, VLC_TICK_INVALID );
@@ -1386,7 +1397,10 @@ static int Init( input_thread_t * p_input )
              input_priv(p_input)->p_item->psz_uri );
 
     /* initialization is complete */
-    input_ChangeState( p_input, PLAYING_S, vlc_tick_now() );
+    vlc_tick_t now = vlc_tick_now();
+    vlc_startup_Trace( vlc_startup_GetTracer( VLC_OBJECT(p_input) ),
+                       master->str_id, "input init", start, now );
+    input_ChangeState( p_input, PLAYING_S, now );
 
     return VLC_SUCCESS;
 
@@ -2705,6 +2719,8 @@ static demux_t *InputDemuxNew( input_thread_t *p_input, es_out_t *p_es_out,
 {
     input_thread_private_t *priv = input_priv(p_input );
     vlc_object_t *obj = VLC_OBJECT(p_input);
+    struct vlc_tracer *tracer = vlc_startup_GetTracer( obj );
+    vlc_tick_t start = vlc_tick_now();
 
     /* create the underlying access stream */
     bool preparsing = priv->type == INPUT_TYPE_PREPARSING;
@@ -2714,6 +2730,9 @@ static demux_t *InputDemuxNew( input_thread_t *p_input, es_out_t *p_es_out,
         return NULL;
 
     p_stream = stream_FilterAutoNew( p_stream );
+    vlc_tick_t access_date = vlc_tick_now();
+    vlc_startup_Trace( tracer, p_source->str_id, "access", start,
+                       access_date );
 
     if(( p_stream->ops != NULL && (p_stream->ops->stream.read == NULL &&
                     p_stream->ops->stream.block == NULL && p_stream->ops->stream.readdir == NULL))
@@ -2746,7 +2765,11 @@ static demux_t *InputDemuxNew( input_thread_t *p_input, es_out_t *p_es_out,
     demux_t *demux = demux_NewAdvanced( obj, p_input, psz_demux, url, p_stream,
                                         p_es_out, preparsing );
     if( demux != NULL )
+    {
+        vlc_startup_Trace( tracer, p_source->str_id, "demux probe",
+                           access_date, vlc_tick_now() );
         return demux;
+    }
 
 error:
     vlc_stream_Delete( p_stream );
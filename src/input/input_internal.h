@@ -55,6 +55,17 @@ enum input_type {
     INPUT_TYPE_THUMBNAILING,
 };
 
+/**
+ * Thumbnailing hints, forwarded to the video decoder
+ */
+struct input_thumbnail_cfg
+{
+    /** Decode the first keyframe only, skipping the frames flagged as P/B */
+    bool keyframe_only;
+    /** Minimum size of the thumbnail picture, 0 if unconstrained */
+    unsigned width, height;
+};
+
 /**
  * Input state
  *
@@ -382,6 +393,7 @@ struct vlc_input_thread_cfg
     struct {
         bool subitems;
     } preparsing;
+    struct input_thumbnail_cfg thumbnailing;
     bool interact;
 };
 /**
@@ -500,6 +512,7 @@ typedef struct input_thread_private_t
     enum input_type type;
     bool hw_dec;
     bool preparse_subitems;
+    struct input_thumbnail_cfg thumbnail;
 
     /* Current state */
     int         i_state;
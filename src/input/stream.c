@@ -811,6 +811,13 @@ int vlc_stream_vaControl(stream_t *s, int cmd, va_list args)
                 return s->ops->stream.get_mtime(s, mtime);
             }
             return VLC_EGENERIC;
+        case STREAM_GET_BUFFERING:
+            if (s->ops->stream.get_buffering != NULL) {
+                uint64_t *buffered = va_arg(args, uint64_t *);
+                uint64_t *underruns = va_arg(args, uint64_t *);
+                return s->ops->stream.get_buffering(s, buffered, underruns);
+            }
+            return VLC_EGENERIC;
         case STREAM_GET_PTS_DELAY:
         {
             vlc_tick_t *pts_delay = va_arg(args, vlc_tick_t *);
@@ -37,6 +37,7 @@
 #include <vlc_cpu.h>
 #include <vlc_vout_display.h>
 #include <vlc_subpicture.h>
+#include <vlc_slices.h>
 #include "libvlc.h"
 #include "modules/modules.h"
 
@@ -379,13 +380,13 @@ static const char * const  ppsz_deinterlace_text[] = {
     "Deinterlace method to use for video processing.")
 static const char * const ppsz_deinterlace_mode[] = {
     "auto", "discard", "blend", "mean", "bob",
-    "linear", "x", "yadif", "yadif2x", "phosphor",
-    "ivtc"
+    "linear", "x", "yadif", "yadif2x", "bwdif", "bwdif2x",
+    "phosphor", "ivtc"
 };
 static const char * const ppsz_deinterlace_mode_text[] = {
     N_("Auto"), N_("Discard"), N_("Blend"), N_("Mean"), N_("Bob"),
-    N_("Linear"), "X", "Yadif", "Yadif (2x)", N_("Phosphor"),
-    N_("Film NTSC (IVTC)")
+    N_("Linear"), "X", "Yadif", "Yadif (2x)", "Bwdif", "Bwdif (2x)",
+    N_("Phosphor"), N_("Film NTSC (IVTC)")
 };
 
 #define DEINTERLACE_FILTER_TEXT N_("Deinterlace filter")
@@ -443,6 +444,12 @@ static const char *const screensaver_texts[] = {
     "picture quality, for instance deinterlacing, or distort " \
     "the video.")
 
+#define SLICE_THREADS_TEXT N_("Picture processing threads")
+#define SLICE_THREADS_LONGTEXT N_( \
+    "Number of threads processing each picture, in slices, for the " \
+    "software chroma converters, scalers and video filters. " \
+    "0 uses as many threads as there are CPUs.")
+
 #define SNAP_PATH_TEXT N_("Video snapshot directory (or filename)")
 #define SNAP_PATH_LONGTEXT N_( \
     "Directory where the video snapshots will be stored.")
@@ -1109,6 +1116,11 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define TRACER_LONGTEXT N_( \
     "This allow to select which tracer module you want to use." )
 
+#define STARTUP_TRACE_TEXT N_("Trace startup phases")
+#define STARTUP_TRACE_LONGTEXT N_( \
+    "Send the durations of the startup phases, from the module bank " \
+    "loading to the first decoded frame, to the tracer module." )
+
 #define VLM_CONF_TEXT N_("VLM configuration file")
 #define VLM_CONF_LONGTEXT N_( \
     "Read a VLM configuration file as soon as VLM is started." )
@@ -1207,6 +1219,11 @@ static const char *const clock_sources_text[] = {
 #define PREPARSE_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to preparse items" )
 
+#define PREPARSE_PROCESS_MEMORY_TEXT N_( "Preparsing process memory limit" )
+#define PREPARSE_PROCESS_MEMORY_LONGTEXT N_( \
+    "Memory used by a preparsing process, in MiB, above which it is " \
+    "restarted after its current request (0 for no limit)." )
+
 #define FETCH_ART_THREADS_TEXT N_( "Fetch-art threads" )
 #define FETCH_ART_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to fetch art" )
@@ -1777,6 +1794,9 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_VIDEO_VFILTER )
     add_module_list("video-filter", "video filter", NULL,
                     VIDEO_FILTER_TEXT, VIDEO_FILTER_LONGTEXT)
+    add_integer( "slice-threads", 0, SLICE_THREADS_TEXT,
+                 SLICE_THREADS_LONGTEXT )
+        change_integer_range( 0, VLC_SLICES_MAX )
 
 #if 0
     add_string( "pixel-ratio", "1", PIXEL_RATIO_TEXT, PIXEL_RATIO_TEXT )
@@ -2093,6 +2113,8 @@ vlc_module_begin ()
     add_obsolete_string("vod-server") /* since 4.0.0 */
     add_module("tracer", "tracer", "none",
                TRACER_TEXT, TRACER_LONGTEXT)
+    add_bool("startup-trace", false, STARTUP_TRACE_TEXT,
+             STARTUP_TRACE_LONGTEXT)
 
     set_section( N_("Plugins" ), NULL )
 #ifdef HAVE_DYNAMIC_PLUGINS
@@ -2176,6 +2198,10 @@ vlc_module_begin ()
     add_integer( "preparse-threads", 1, PREPARSE_THREADS_TEXT,
                  PREPARSE_THREADS_LONGTEXT )
 
+    add_integer_with_range( "preparse-process-memory", 512, 0, 65536,
+                            PREPARSE_PROCESS_MEMORY_TEXT,
+                            PREPARSE_PROCESS_MEMORY_LONGTEXT )
+
     add_integer( "fetch-art-threads", 1, FETCH_ART_THREADS_TEXT,
                  FETCH_ART_THREADS_LONGTEXT )
 
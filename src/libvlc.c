@@ -133,6 +133,8 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     libvlc_priv_t *priv = libvlc_priv (p_libvlc);
     char        *psz_val;
     int          i_ret = VLC_EGENERIC;
+    /* Startup phases dates, traced once the tracer is loaded */
+    vlc_tick_t   start = vlc_tick_now(), bank_date, cmdline_date, config_date;
 
     if (unlikely(vlc_LogPreinit(p_libvlc)))
         return VLC_ENOMEM;
@@ -160,6 +162,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
      * saved settings handling can function properly.
      */
     module_LoadPlugins (p_libvlc);
+    bank_date = vlc_tick_now();
 
     /*
      * Fully process command line settings.
@@ -168,6 +171,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     int vlc_optind;
     if( config_LoadCmdLine( p_libvlc, i_argc, ppsz_argv, &vlc_optind ) )
         goto error;
+    cmdline_date = vlc_tick_now();
 
     /*
      * Load saved settings into the config system, as applicable.
@@ -179,6 +183,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
         else
             config_LoadConfigFile( p_libvlc );
     }
+    config_date = vlc_tick_now();
 
     vlc_LogInit(p_libvlc);
 
@@ -186,6 +191,17 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     priv->tracer = vlc_tracer_Create(VLC_OBJECT(p_libvlc), tracer_name);
     free(tracer_name);
 
+    struct vlc_tracer *startup_tracer =
+        vlc_startup_GetTracer(VLC_OBJECT(p_libvlc));
+    if (startup_tracer == NULL && var_InheritBool(p_libvlc, "startup-trace"))
+        msg_Warn(p_libvlc, "startup trace requires a tracer module");
+    vlc_startup_Trace(startup_tracer, "libvlc", "module bank", start,
+                      bank_date);
+    vlc_startup_Trace(startup_tracer, "libvlc", "command line", bank_date,
+                      cmdline_date);
+    vlc_startup_Trace(startup_tracer, "libvlc", "configuration file",
+                      cmdline_date, config_date);
+
     /*
      * Support for gettext
      */
@@ -324,6 +340,8 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     /* Create a variable for showing the main interface */
     var_Create(p_libvlc, "intf-show", VLC_VAR_VOID);
 
+    vlc_startup_Trace(startup_tracer, "libvlc", "init", start,
+                      vlc_tick_now());
     return VLC_SUCCESS;
 
 error:
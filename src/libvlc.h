@@ -209,6 +209,29 @@ libvlc_GetMainPlaylist(libvlc_int_t *libvlc);
  */
 void var_OptionParse (vlc_object_t *, const char *, bool trusted);
 
+/*
+ * Startup tracing
+ */
+
+/**
+ * Gets the tracer for startup phases.
+ *
+ * \return the object tracer if --startup-trace is enabled, or NULL
+ */
+struct vlc_tracer *vlc_startup_GetTracer(vlc_object_t *obj);
+
+/**
+ * Traces the duration of a startup phase.
+ *
+ * \param tracer tracer from vlc_startup_GetTracer() (can be NULL)
+ * \param id identifier of the traced instance (libvlc, input, ES)
+ * \param phase name of the phase
+ * \param start date the phase started
+ * \param end date the phase ended, also used as trace timestamp
+ */
+void vlc_startup_Trace(struct vlc_tracer *tracer, const char *id,
+                       const char *phase, vlc_tick_t start, vlc_tick_t end);
+
 # ifdef __cplusplus
 } // extern "C"
 # endif
@@ -113,6 +113,7 @@ unsigned vlc_CPU_raw(void)
     {
         char *p, *cap;
         uint_fast32_t core_caps = 0;
+        bool avx512f = false, avx512bw = false;
 
         if (strncmp(line, "flags", 5))
             continue;
@@ -136,8 +137,15 @@ unsigned vlc_CPU_raw(void)
                 core_caps |= VLC_CPU_AVX;
             if (!strcmp (cap, "avx2"))
                 core_caps |= VLC_CPU_AVX2;
+            if (!strcmp (cap, "avx512f"))
+                avx512f = true;
+            if (!strcmp (cap, "avx512bw"))
+                avx512bw = true;
         }
 
+        if (avx512f && avx512bw)
+            core_caps |= VLC_CPU_AVX512;
+
         /* Take the intersection of capabilities of each processor */
         all_caps &= core_caps;
     }
@@ -116,6 +116,45 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
     if (i_ecx & 0x00080000)
         i_capabilities |= VLC_CPU_SSE4_1;
 
+    /* AVX needs both the CPU and the OS (OSXSAVE, saved YMM state) support */
+    if ((i_ecx & 0x18000000) == 0x18000000)
+    {
+        uint32_t xcr0;
+#if defined(_MSC_VER) && !defined(__clang__)
+        xcr0 = (uint32_t)_xgetbv(0);
+#else
+        uint32_t xcr0_hi;
+        asm (".byte 0x0f, 0x01, 0xd0" /* xgetbv */
+             : "=a" (xcr0), "=d" (xcr0_hi) : "c" (0));
+        (void) xcr0_hi;
+#endif
+        if ((xcr0 & 0x06) == 0x06)
+        {
+            i_capabilities |= VLC_CPU_AVX;
+
+            cpuid( 0x00000000 );
+            if( i_eax >= 0x00000007 )
+            {
+# if defined(_MSC_VER) && !defined(__clang__)
+                int cpuInfo[4];
+                __cpuidex(cpuInfo, 7, 0);
+                i_ebx = cpuInfo[1];
+# else
+                asm ("cpuid"
+                     : "=a" (i_eax), "=b" (i_ebx), "=c" (i_ecx), "=d" (i_edx)
+                     : "a" (7), "c" (0)
+                     : "cc");
+# endif
+                if (i_ebx & 0x00000020)
+                    i_capabilities |= VLC_CPU_AVX2;
+                /* AVX-512 F + BW, with opmask and ZMM state saved by the OS */
+                if ((i_ebx & 0x40010000) == 0x40010000
+                 && (xcr0 & 0xE0) == 0xE0)
+                    i_capabilities |= VLC_CPU_AVX512;
+            }
+        }
+    }
+
     /* test for additional capabilities */
     cpuid( 0x80000000 );
 
@@ -176,6 +215,8 @@ void vlc_CPU_dump (vlc_object_t *obj)
         vlc_memstream_puts(&stream, "AVX ");
     if (vlc_CPU_AVX2())
         vlc_memstream_puts(&stream, "AVX2 ");
+    if (vlc_CPU_AVX512())
+        vlc_memstream_puts(&stream, "AVX-512 ");
 
 #elif defined (__powerpc__) || defined (__ppc__) || defined (__ppc64__)
     if (vlc_CPU_ALTIVEC())
@@ -0,0 +1,173 @@
+/*****************************************************************************
+ * slices.c: slice-parallel picture processing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_executor.h>
+#include <vlc_slices.h>
+
+struct vlc_slice
+{
+    struct vlc_runnable runnable;
+    vlc_slices_t *slices;
+    unsigned index;
+};
+
+struct vlc_slices
+{
+    vlc_executor_t *executor;
+    unsigned count;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    unsigned pending;
+
+    vlc_slice_cb cb;
+    void *opaque;
+    unsigned run_count;
+    struct vlc_slice slice[VLC_SLICES_MAX];
+};
+
+/* Worker threads, shared by all the slices. The executor only starts its
+ * threads on demand, so the pool does not cost more than the slices use. */
+static vlc_mutex_t pool_lock = VLC_STATIC_MUTEX;
+static vlc_executor_t *pool;
+static unsigned pool_refs;
+
+static vlc_executor_t *PoolHold(void)
+{
+    vlc_mutex_lock(&pool_lock);
+    if (pool == NULL)
+        /* The calling thread processes a slice too */
+        pool = vlc_executor_New(VLC_SLICES_MAX - 1);
+    if (pool != NULL)
+        pool_refs++;
+    vlc_executor_t *executor = pool;
+    vlc_mutex_unlock(&pool_lock);
+    return executor;
+}
+
+static void PoolRelease(void)
+{
+    vlc_mutex_lock(&pool_lock);
+    assert(pool_refs > 0);
+    if (--pool_refs == 0)
+    {
+        vlc_executor_Delete(pool);
+        pool = NULL;
+    }
+    vlc_mutex_unlock(&pool_lock);
+}
+
+vlc_slices_t *vlc_slices_New(vlc_object_t *obj)
+{
+    int64_t threads = var_InheritInteger(obj, "slice-threads");
+    if (threads <= 0)
+        threads = vlc_GetCPUCount();
+    if (threads > VLC_SLICES_MAX)
+        threads = VLC_SLICES_MAX;
+    if (threads <= 1)
+        return NULL;
+
+    vlc_slices_t *slices = malloc(sizeof (*slices));
+    if (unlikely(slices == NULL))
+        return NULL;
+
+    slices->executor = PoolHold();
+    if (slices->executor == NULL)
+    {
+        free(slices);
+        return NULL;
+    }
+
+    slices->count = threads;
+    vlc_mutex_init(&slices->lock);
+    vlc_cond_init(&slices->wait);
+    msg_Dbg(obj, "processing pictures in up to %u slices", slices->count);
+    return slices;
+}
+
+void vlc_slices_Delete(vlc_slices_t *slices)
+{
+    if (slices == NULL)
+        return;
+    PoolRelease();
+    free(slices);
+}
+
+unsigned vlc_slices_Count(const vlc_slices_t *slices)
+{
+    return slices != NULL ? slices->count : 1;
+}
+
+static void SliceRun(void *data)
+{
+    struct vlc_slice *slice = data;
+    vlc_slices_t *slices = slice->slices;
+
+    slices->cb(slices->opaque, slice->index, slices->run_count);
+
+    vlc_mutex_lock(&slices->lock);
+    assert(slices->pending > 0);
+    if (--slices->pending == 0)
+        vlc_cond_signal(&slices->wait);
+    vlc_mutex_unlock(&slices->lock);
+}
+
+void vlc_slices_Run(vlc_slices_t *slices, unsigned count,
+                    vlc_slice_cb cb, void *opaque)
+{
+    assert(count >= 1 && count <= vlc_slices_Count(slices));
+    if (count <= 1)
+    {
+        cb(opaque, 0, 1);
+        return;
+    }
+
+    slices->cb = cb;
+    slices->opaque = opaque;
+    slices->run_count = count;
+    slices->pending = count - 1;
+
+    for (unsigned i = 1; i < count; i++)
+    {
+        struct vlc_slice *slice = &slices->slice[i];
+
+        slice->slices = slices;
+        slice->index = i;
+        slice->runnable.run = SliceRun;
+        slice->runnable.userdata = slice;
+        vlc_executor_Submit(slices->executor, &slice->runnable);
+    }
+
+    /* Process the first slice while the workers take the others */
+    cb(opaque, 0, count);
+
+    vlc_mutex_lock(&slices->lock);
+    while (slices->pending > 0)
+        vlc_cond_wait(&slices->wait, &slices->lock);
+    vlc_mutex_unlock(&slices->lock);
+}
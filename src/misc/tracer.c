@@ -46,6 +46,26 @@ struct vlc_tracer_module {
     void *opaque;
 };
 
+struct vlc_tracer *vlc_startup_GetTracer(vlc_object_t *obj)
+{
+    if (!var_InheritBool(obj, "startup-trace"))
+        return NULL;
+    return vlc_object_get_tracer(obj);
+}
+
+void vlc_startup_Trace(struct vlc_tracer *tracer, const char *id,
+                       const char *phase, vlc_tick_t start, vlc_tick_t end)
+{
+    if (tracer == NULL)
+        return;
+
+    vlc_tracer_TraceWithTs(tracer, end, VLC_TRACE("type", "STARTUP"),
+                           VLC_TRACE("id", id),
+                           VLC_TRACE("phase", phase),
+                           VLC_TRACE_TICK_NS("duration", end - start),
+                           VLC_TRACE_END);
+}
+
 #undef vlc_tracer_TraceWithTs
 void vlc_tracer_TraceWithTs(struct vlc_tracer *tracer, vlc_tick_t ts,
                             const struct vlc_tracer_trace *trace)
@@ -36,9 +36,6 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
-#ifdef HAVE_SEARCH_H
-# include <search.h>
-#endif
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
@@ -54,95 +51,206 @@ VLC_DECL_MODULE_ENTRY(core);
 
 typedef struct vlc_modcap
 {
-    char *name;
+    const char *name;
     module_t **modv;
     size_t modc;
 } vlc_modcap_t;
 
-static int vlc_modcap_cmp(const void *a, const void *b)
+static int vlc_modcap_cmp(const void *key, const void *elem)
 {
-    const vlc_modcap_t *capa = a, *capb = b;
-    return strcmp(capa->name, capb->name);
-}
-
-static void vlc_modcap_free(void *data)
-{
-    vlc_modcap_t *cap = data;
-
-    free(cap->modv);
-    free(cap->name);
-    free(cap);
+    const vlc_modcap_t *cap = elem;
+    return strcmp(key, cap->name);
 }
 
 static int vlc_module_cmp (const void *a, const void *b)
 {
     module_t *const *ma = a, *const *mb = b;
+    int ret = strcmp(module_get_capability(*ma), module_get_capability(*mb));
+    if (ret != 0)
+        return ret;
     /* Note that qsort() uses _ascending_ order,
      * so the smallest module is the one with the biggest score. */
     return (*mb)->i_score - (*ma)->i_score;
 }
 
-static void vlc_modcap_sort(const void *node, const VISIT which,
-                            const int depth)
-{
-    vlc_modcap_t *const *cp = node, *cap = *cp;
-
-    if (which != postorder && which != leaf)
-        return;
-
-    qsort(cap->modv, cap->modc, sizeof (*cap->modv), vlc_module_cmp);
-    (void) depth;
-}
-
 static struct
 {
     vlc_mutex_t lock;
     block_t *caches;
-    void *caps_tree;
+#ifdef HAVE_DYNAMIC_PLUGINS
+    vlc_cache_index_t *index;
+#endif
+    vlc_modcap_t *caps;
+    size_t capc;
+    module_t **modv;
     size_t count;
     unsigned usage;
-} modules = { VLC_STATIC_MUTEX, NULL, NULL, 0, 0 };
+} modules = { VLC_STATIC_MUTEX, NULL,
+#ifdef HAVE_DYNAMIC_PLUGINS
+              NULL,
+#endif
+              NULL, 0, NULL, 0, 0 };
 
 vlc_plugin_t *vlc_plugins = NULL;
 
 /**
- * Adds a module to the bank
+ * Groups a table of modules sorted by capability and score.
  */
-static int vlc_module_store(module_t *mod)
+static size_t vlc_modcap_group(vlc_modcap_t *caps, module_t **modv, size_t n)
 {
-    const char *name = module_get_capability(mod);
-    vlc_modcap_t *cap = malloc(sizeof (*cap));
-    if (unlikely(cap == NULL))
-        return -1;
+    size_t capc = 0;
 
-    cap->name = strdup(name);
-    cap->modv = NULL;
-    cap->modc = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        const char *name = module_get_capability(modv[i]);
 
-    if (unlikely(cap->name == NULL))
-        goto error;
+        if (capc == 0 || strcmp(caps[capc - 1].name, name))
+        {
+            caps[capc].name = name;
+            caps[capc].modv = modv + i;
+            caps[capc].modc = 0;
+            capc++;
+        }
+        caps[capc - 1].modc++;
+    }
+    return capc;
+}
 
-    void **cp = tsearch(cap, &modules.caps_tree, vlc_modcap_cmp);
-    if (unlikely(cp == NULL))
-        goto error;
+#ifdef HAVE_DYNAMIC_PLUGINS
+/**
+ * Merges the pre-sorted capability index of the plugins cache with the
+ * modules that are not described by the cache (typically only the core).
+ *
+ * \param extv modules not in the cache, sorted by capability and score
+ */
+static size_t vlc_modcap_merge(vlc_modcap_t *caps, module_t **modv,
+                               const vlc_cache_index_t *index,
+                               module_t *const *extv, size_t extc)
+{
+    size_t capc = 0, i = 0, j = 0;
+
+    while (i < index->capc || j < extc)
+    {
+        const struct vlc_cache_cap *cc = index->capv + i;
+        int cmp;
+
+        if (i == index->capc)
+            cmp = 1;
+        else if (j == extc)
+            cmp = -1;
+        else
+            cmp = strcmp(index->strings + cc->name,
+                         module_get_capability(extv[j]));
+
+        vlc_modcap_t *cap = caps + capc++;
+        const uint32_t *ordv = NULL;
+        size_t ordc = 0, k = 0;
+
+        cap->name = (cmp <= 0) ? index->strings + cc->name
+                               : module_get_capability(extv[j]);
+        cap->modv = modv;
+        cap->modc = 0;
+
+        if (cmp <= 0)
+        {
+            ordv = index->ordv + cc->offset;
+            ordc = cc->count;
+            i++;
+        }
+
+        /* Merge both lists by decreasing score */
+        for (;;)
+        {
+            bool ext = j < extc
+                    && !strcmp(cap->name, module_get_capability(extv[j]));
+            module_t *m;
+
+            if (k < ordc
+             && (!ext || index->modv[ordv[k]]->i_score >= extv[j]->i_score))
+                m = index->modv[ordv[k++]];
+            else if (ext)
+                m = extv[j++];
+            else
+                break;
+
+            cap->modv[cap->modc++] = m;
+        }
+        modv += cap->modc;
+    }
+    return capc;
+}
+#endif
+
+/**
+ * Builds the table of modules by capability.
+ *
+ * If the bank was loaded from a single up-to-date plugins cache, its
+ * capability index is used as is, so that no sorting is required.
+ */
+static void vlc_modcap_build(void)
+{
+    size_t count = modules.count;
+    module_t **modv = vlc_alloc(count, sizeof (*modv));
+    vlc_modcap_t *caps = vlc_alloc(count, sizeof (*caps));
+    size_t capc = 0;
 
-    if (*cp != cap)
+    if (unlikely(modv == NULL || caps == NULL))
     {
-        vlc_modcap_free(cap);
-        cap = *cp;
+        free(caps);
+        free(modv);
+        caps = NULL;
+        modv = NULL;
+        goto out;
     }
 
-    module_t **modv = realloc(cap->modv, sizeof (*modv) * (cap->modc + 1));
-    if (unlikely(modv == NULL))
-        return -1;
+    size_t i = 0;
+#ifdef HAVE_DYNAMIC_PLUGINS
+    const vlc_cache_index_t *index = modules.index;
+    size_t cached = 0;
 
-    cap->modv = modv;
-    cap->modv[cap->modc] = mod;
-    cap->modc++;
-    return 0;
-error:
-    vlc_modcap_free(cap);
-    return -1;
+    /* Put the modules not described by the cache first */
+    for (vlc_plugin_t *lib = vlc_plugins; lib != NULL; lib = lib->next)
+    {
+        if (lib->cached)
+            cached += lib->modules_count;
+        else
+            for (module_t *m = lib->module; m != NULL; m = m->next)
+                modv[i++] = m;
+    }
+
+    if (index != NULL && index->modc == cached)
+    {
+        module_t **extv = vlc_alloc(i, sizeof (*extv));
+
+        if (likely(extv != NULL || i == 0))
+        {
+            if (i > 0)
+                memcpy(extv, modv, i * sizeof (*extv));
+            qsort(extv, i, sizeof (*extv), vlc_module_cmp);
+            capc = vlc_modcap_merge(caps, modv, index, extv, i);
+            free(extv);
+            goto out;
+        }
+    }
+
+    for (vlc_plugin_t *lib = vlc_plugins; lib != NULL; lib = lib->next)
+        if (lib->cached)
+            for (module_t *m = lib->module; m != NULL; m = m->next)
+                modv[i++] = m;
+#else
+    for (vlc_plugin_t *lib = vlc_plugins; lib != NULL; lib = lib->next)
+        for (module_t *m = lib->module; m != NULL; m = m->next)
+            modv[i++] = m;
+#endif
+    assert(i == count);
+    qsort(modv, count, sizeof (*modv), vlc_module_cmp);
+    capc = vlc_modcap_group(caps, modv, count);
+out:
+    free(modules.caps);
+    free(modules.modv);
+    modules.caps = caps;
+    modules.capc = capc;
+    modules.modv = modv;
 }
 
 /**
@@ -155,9 +263,6 @@ static void vlc_plugin_store(vlc_plugin_t *lib)
     lib->next = vlc_plugins;
     vlc_plugins = lib;
     modules.count += lib->modules_count;
-
-    for (module_t *m = lib->module; m != NULL; m = m->next)
-        vlc_module_store(m);
 }
 
 /**
@@ -305,6 +410,8 @@ typedef struct module_bank
     size_t        size;
     vlc_plugin_t **plugins;
     vlc_plugin_t *cache;
+    vlc_cache_index_t *index;
+    bool          stale;
 } module_bank_t;
 
 /**
@@ -328,6 +435,7 @@ static int AllocatePluginFile (module_bank_t *bank, const char *abspath,
                     plugin->abspath);
             vlc_plugin_destroy(plugin);
             plugin = NULL;
+            bank->stale = true;
         }
     }
 
@@ -523,7 +631,7 @@ static void AllocatePluginPath(libvlc_int_t *obj, const char *path,
     };
 
     if (mode & CACHE_READ_FILE)
-        bank.cache = vlc_cache_load(obj, path, &modules.caches);
+        bank.cache = vlc_cache_load(obj, path, &modules.caches, &bank.index);
     else
         msg_Dbg(bank.obj, "ignoring plugins cache file");
 
@@ -542,11 +650,20 @@ static void AllocatePluginPath(libvlc_int_t *obj, const char *path,
 
         bank.cache = plugin->next;
         if (mode & CACHE_SCAN_DIR)
+        {
             vlc_plugin_destroy(plugin);
+            bank.stale = true;
+        }
         else
             vlc_plugin_store(plugin);
     }
 
+    /* The capability index is only usable if all cached modules are kept */
+    if (bank.index != NULL && !bank.stale && modules.index == NULL)
+        modules.index = bank.index;
+    else
+        free(bank.index);
+
     if (mode & CACHE_WRITE_FILE)
         CacheSave(obj, path, bank.plugins, bank.size);
 
@@ -736,6 +853,7 @@ void module_InitBank (void)
         if (likely(plugin != NULL))
             vlc_plugin_store(plugin);
         config_SortConfig ();
+        vlc_modcap_build();
     }
     modules.usage++;
 
@@ -757,7 +875,8 @@ void module_EndBank (bool b_plugins)
 {
     vlc_plugin_t *libs = NULL;
     block_t *caches = NULL;
-    void *caps_tree = NULL;
+    vlc_modcap_t *caps = NULL;
+    module_t **modv = NULL;
 
     /* If plugins were _not_ loaded, then the caller still has the bank lock
      * from module_InitBank(). */
@@ -772,15 +891,19 @@ void module_EndBank (bool b_plugins)
         config_UnsortConfig ();
         libs = vlc_plugins;
         caches = modules.caches;
-        caps_tree = modules.caps_tree;
+        caps = modules.caps;
+        modv = modules.modv;
         vlc_plugins = NULL;
         modules.caches = NULL;
-        modules.caps_tree = NULL;
+        modules.caps = NULL;
+        modules.capc = 0;
+        modules.modv = NULL;
         modules.count = 0;
     }
     vlc_mutex_unlock (&modules.lock);
 
-    tdestroy(caps_tree, vlc_modcap_free);
+    free(caps);
+    free(modv);
 
     while (libs != NULL)
     {
@@ -814,7 +937,11 @@ void module_LoadPlugins(libvlc_int_t *obj)
         config_UnsortConfig ();
         config_SortConfig ();
 
-        twalk(modules.caps_tree, vlc_modcap_sort);
+        vlc_modcap_build();
+#ifdef HAVE_DYNAMIC_PLUGINS
+        free(modules.index);
+        modules.index = NULL;
+#endif
     }
     vlc_mutex_unlock (&modules.lock);
 
@@ -852,20 +979,16 @@ module_t **module_list_get (size_t *n)
 
 size_t module_list_cap(module_t *const **restrict list, const char *name)
 {
-    vlc_modcap_t key;
-
     assert(name != NULL);
-    key.name = (char *)name;
 
-    const void **cp = tfind(&key, &modules.caps_tree, vlc_modcap_cmp);
-    if (cp == NULL)
+    const vlc_modcap_t *cap = bsearch(name, modules.caps, modules.capc,
+                                      sizeof (*modules.caps), vlc_modcap_cmp);
+    if (cap == NULL)
     {
         *list = NULL;
         return 0;
     }
 
-    const vlc_modcap_t *cap = *cp;
-
     *list = cap->modv;
     return cap->modc;
 }
@@ -42,6 +42,7 @@
 #include "../libvlc.h"
 
 #include <vlc_plugin.h>
+#include <vlc_modules.h>
 #include <errno.h>
 
 #include "config/configuration.h"
@@ -57,7 +58,7 @@
 #ifdef HAVE_DYNAMIC_PLUGINS
 /* Sub-version number
  * (only used to avoid breakage in dev version when cache structure changes) */
-#define CACHE_SUBVERSION_NUM 36
+#define CACHE_SUBVERSION_NUM 38
 
 /* Cache filename */
 #define CACHE_NAME "plugins.dat"
@@ -293,11 +294,11 @@ error:
     return -1; /* FIXME: leaks */
 }
 
-static int vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
+static module_t *vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
 {
     module_t *module = vlc_module_create(plugin);
     if (unlikely(module == NULL))
-        return -1;
+        return NULL;
 
     LOAD_STRING(module->psz_shortname);
     LOAD_STRING(module->psz_longname);
@@ -319,12 +320,31 @@ static int vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
     LOAD_STRING(module->deactivate_name);
     LOAD_STRING(module->psz_capability);
     LOAD_IMMEDIATE(module->i_score);
-    return 0;
+
+    LOAD_IMMEDIATE(module->i_signatures);
+    if (module->i_signatures > MODULE_SIGNATURE_MAX)
+        goto error;
+    if (module->i_signatures > 0)
+        module->signatures =
+            xmalloc (sizeof (*module->signatures) * module->i_signatures);
+    for (unsigned j = 0; j < module->i_signatures; j++)
+    {
+        struct vlc_module_signature *sig = &module->signatures[j];
+
+        LOAD_IMMEDIATE(sig->offset);
+        LOAD_IMMEDIATE(sig->length);
+        if (sig->length == 0)
+            goto error;
+        LOAD_ARRAY(sig->magic, sig->length);
+    }
+    return module;
 error:
-    return -1;
+    return NULL;
 }
 
-static vlc_plugin_t *vlc_cache_load_plugin(block_t *file)
+static vlc_plugin_t *vlc_cache_load_plugin(block_t *file,
+                                           vlc_cache_index_t *index,
+                                           size_t max)
 {
     vlc_plugin_t *plugin = vlc_plugin_create();
     if (unlikely(plugin == NULL))
@@ -333,9 +353,17 @@ static vlc_plugin_t *vlc_cache_load_plugin(block_t *file)
     uint32_t modules;
     LOAD_IMMEDIATE(modules);
 
+    if (modules > max - index->modc)
+        goto error;
+
     for (size_t i = 0; i < modules; i++)
-        if (vlc_cache_load_module(plugin, file))
+    {
+        module_t *module = vlc_cache_load_module(plugin, file);
+        if (module == NULL)
             goto error;
+        /* Modules are numbered in file order for the capability index */
+        index->modv[index->modc++] = module;
+    }
 
     if (vlc_cache_load_plugin_config(plugin, file))
         goto error;
@@ -354,6 +382,7 @@ static vlc_plugin_t *vlc_cache_load_plugin(block_t *file)
     LOAD_FLAG(plugin->unloadable);
     LOAD_IMMEDIATE(plugin->mtime);
     LOAD_IMMEDIATE(plugin->size);
+    plugin->cached = true;
 
     if (plugin->textdomain != NULL)
         vlc_bindtextdomain(plugin->textdomain);
@@ -365,6 +394,59 @@ error:
     return NULL;
 }
 
+/**
+ * Loads the capability index of a plugins cache file.
+ *
+ * The tables are validated but not copied: they remain in the file mapping.
+ */
+static int vlc_cache_load_index(vlc_cache_index_t *index, block_t *file)
+{
+    uint32_t capc, ordc, size;
+
+    LOAD_IMMEDIATE(capc);
+    LOAD_IMMEDIATE(ordc);
+    LOAD_IMMEDIATE(size);
+
+    /* Each module has exactly one capability */
+    if (ordc != index->modc || capc > ordc)
+        goto error;
+
+    LOAD_ALIGNOF(struct vlc_cache_cap);
+    LOAD_ARRAY(index->capv, capc);
+    LOAD_ARRAY(index->ordv, ordc);
+    LOAD_ARRAY(index->strings, size);
+    index->capc = capc;
+
+    if (size > 0 && index->strings[size - 1] != '\0')
+        goto error;
+
+    size_t offset = 0;
+
+    for (size_t i = 0; i < capc; i++)
+    {
+        const struct vlc_cache_cap *cap = index->capv + i;
+
+        if (cap->name >= size || cap->offset != offset || cap->count == 0
+         || cap->count > ordc - offset)
+            goto error;
+        if (i > 0 && strcmp(index->strings + cap[-1].name,
+                            index->strings + cap->name) >= 0)
+            goto error;
+        offset += cap->count;
+    }
+
+    if (offset != ordc)
+        goto error;
+
+    for (size_t i = 0; i < ordc; i++)
+        if (index->ordv[i] >= index->modc)
+            goto error;
+
+    return 0;
+error:
+    return -1;
+}
+
 /**
  * Loads a plugins cache file.
  *
@@ -372,9 +454,12 @@ error:
  * will in turn be queried by AllocateAllPlugins() to see if it needs to
  * actually load the dynamically loadable module.
  * This allows us to only fully load plugins when they are actually used.
+ *
+ * The capability index of the cache is returned in *indexp. It refers to the
+ * modules of the returned plugins, and must be freed by the caller.
  */
 vlc_plugin_t *vlc_cache_load(libvlc_int_t *p_this, const char *dir,
-                             block_t **backingp)
+                             block_t **backingp, vlc_cache_index_t **indexp)
 {
     char *psz_filename;
 
@@ -444,11 +529,33 @@ vlc_plugin_t *vlc_cache_load(libvlc_int_t *p_this, const char *dir,
         return NULL;
     }
 
+    /* Check plugins and modules counts */
+    uint32_t count, modc;
+
+    if (vlc_cache_load_immediate(&count, file, sizeof (count))
+     || vlc_cache_load_immediate(&modc, file, sizeof (modc))
+     || count > file->i_buffer || modc > file->i_buffer)
+    {
+        msg_Warn( p_this, "This doesn't look like a valid plugins cache "
+                  "(corrupted header)" );
+        block_Release(file);
+        return NULL;
+    }
+
+    vlc_cache_index_t *index = malloc(sizeof (*index)
+                                      + modc * sizeof (index->modv[0]));
+    if (unlikely(index == NULL))
+    {
+        block_Release(file);
+        return NULL;
+    }
+    index->modc = 0;
+
     vlc_plugin_t *cache = NULL;
 
-    while (file->i_buffer > 0)
+    for (uint32_t i = 0; i < count; i++)
     {
-        vlc_plugin_t *plugin = vlc_cache_load_plugin(file);
+        vlc_plugin_t *plugin = vlc_cache_load_plugin(file, index, modc);
         if (plugin == NULL)
             goto error;
 
@@ -464,14 +571,26 @@ vlc_plugin_t *vlc_cache_load(libvlc_int_t *p_this, const char *dir,
         cache = plugin;
     }
 
+    if (index->modc != modc || vlc_cache_load_index(index, file)
+     || file->i_buffer > 0)
+        goto error;
+
     file->p_next = *backingp;
     *backingp = file;
+    *indexp = index;
     return cache;
 
 error:
     msg_Warn( p_this, "plugins cache not loaded (corrupted)" );
 
-    /* TODO: cleanup */
+    while (cache != NULL)
+    {
+        vlc_plugin_t *plugin = cache;
+
+        cache = plugin->next;
+        vlc_plugin_destroy(plugin);
+    }
+    free(index);
     block_Release(file);
     return NULL;
 }
@@ -593,8 +712,110 @@ static int CacheSaveModule(FILE *file, const module_t *module)
     SAVE_STRING(module->deactivate_name);
     SAVE_STRING(module->psz_capability);
     SAVE_IMMEDIATE(module->i_score);
+    SAVE_IMMEDIATE(module->i_signatures);
+
+    for (unsigned j = 0; j < module->i_signatures; j++)
+    {
+        const struct vlc_module_signature *sig = &module->signatures[j];
+
+        SAVE_IMMEDIATE(sig->offset);
+        SAVE_IMMEDIATE(sig->length);
+        if (fwrite(sig->magic, 1, sig->length, file) != sig->length)
+            goto error;
+    }
+    return 0;
+error:
+    return -1;
+}
+
+struct vlc_cache_entry
+{
+    const module_t *module;
+    uint32_t ordinal;
+};
+
+static int vlc_cache_entry_cmp(const void *a, const void *b)
+{
+    const struct vlc_cache_entry *ea = a, *eb = b;
+    int ret = strcmp(module_get_capability(ea->module),
+                     module_get_capability(eb->module));
+    if (ret != 0)
+        return ret;
+
+    /* Highest score first, then in file order to keep the sort stable */
+    int sa = module_get_score(ea->module), sb = module_get_score(eb->module);
+    if (sa != sb)
+        return (sa < sb) ? 1 : -1;
+    return (ea->ordinal < eb->ordinal) ? -1 : (ea->ordinal > eb->ordinal);
+}
+
+static int CacheSaveIndex(FILE *file, vlc_plugin_t *const *cache, size_t n,
+                          uint32_t modc)
+{
+    struct vlc_cache_entry *entries = vlc_alloc(modc, sizeof (*entries));
+    struct vlc_cache_cap *caps = vlc_alloc(modc, sizeof (*caps));
+    uint32_t capc = 0, size = 0, ordinal = 0;
+
+    if (unlikely((entries == NULL || caps == NULL) && modc > 0))
+        goto error;
+
+    for (size_t i = 0; i < n; i++)
+        for (const module_t *module = cache[i]->module;
+             module != NULL;
+             module = module->next)
+        {
+            entries[ordinal].module = module;
+            entries[ordinal].ordinal = ordinal;
+            ordinal++;
+        }
+    assert(ordinal == modc);
+
+    if (modc > 0)
+        qsort(entries, modc, sizeof (*entries), vlc_cache_entry_cmp);
+
+    for (uint32_t i = 0; i < modc; i++)
+    {
+        const char *name = module_get_capability(entries[i].module);
+
+        if (capc == 0
+         || strcmp(module_get_capability(entries[caps[capc - 1].offset].module),
+                   name))
+        {
+            caps[capc].name = size;
+            caps[capc].offset = i;
+            caps[capc].count = 0;
+            size += strlen(name) + 1;
+            capc++;
+        }
+        caps[capc - 1].count++;
+    }
+
+    SAVE_IMMEDIATE(capc);
+    SAVE_IMMEDIATE(modc);
+    SAVE_IMMEDIATE(size);
+    SAVE_ALIGNOF(struct vlc_cache_cap);
+
+    if (fwrite(caps, sizeof (*caps), capc, file) != capc)
+        goto error;
+
+    for (uint32_t i = 0; i < modc; i++)
+        SAVE_IMMEDIATE(entries[i].ordinal);
+
+    for (uint32_t i = 0; i < capc; i++)
+    {
+        const char *name =
+            module_get_capability(entries[caps[i].offset].module);
+
+        if (fwrite(name, 1, strlen(name) + 1, file) != strlen(name) + 1)
+            goto error;
+    }
+
+    free(caps);
+    free(entries);
     return 0;
 error:
+    free(caps);
+    free(entries);
     return -1;
 }
 
@@ -621,6 +842,15 @@ static int CacheSaveBank(FILE *file, vlc_plugin_t *const *cache, size_t n)
     if (fwrite (&i_file_size, sizeof (i_file_size), 1, file) != 1)
         goto error;
 
+    /* Plugins and modules counts */
+    uint32_t plugins = n, modc = 0;
+
+    for (size_t i = 0; i < n; i++)
+        modc += cache[i]->modules_count;
+
+    SAVE_IMMEDIATE(plugins);
+    SAVE_IMMEDIATE(modc);
+
     for (size_t i = 0; i < n; i++)
     {
         const vlc_plugin_t *plugin = cache[i];
@@ -646,6 +876,10 @@ static int CacheSaveBank(FILE *file, vlc_plugin_t *const *cache, size_t n)
         SAVE_IMMEDIATE(plugin->size);
     }
 
+    /* Capability index */
+    if (CacheSaveIndex(file, cache, n, modc))
+        goto error;
+
     if (fflush (file)) /* flush libc buffers */
         goto error;
     return 0; /* success! */
@@ -72,6 +72,8 @@ module_t *vlc_module_create(vlc_plugin_t *plugin)
     module->i_shortcuts = 0;
     module->psz_capability = NULL;
     module->i_score = (parent != NULL) ? parent->i_score : 1;
+    module->i_signatures = 0;
+    module->signatures = NULL;
     module->activate_name = NULL;
     module->deactivate_name = NULL;
     module->pf_activate = NULL;
@@ -89,6 +91,7 @@ void vlc_module_destroy (module_t *module)
         module_t *next = module->next;
 
         free(module->pp_shortcuts);
+        free(module->signatures);
         free(module);
         module = next;
     }
@@ -111,6 +114,7 @@ vlc_plugin_t *vlc_plugin_create(void)
     atomic_init(&plugin->handle, 0);
     plugin->abspath = NULL;
     plugin->path = NULL;
+    plugin->cached = false;
 #endif
     plugin->module = NULL;
 
@@ -316,6 +320,32 @@ static int vlc_plugin_desc_cb(void *ctx, void *tgt, int propid, ...)
             module->psz_help_html = va_arg (ap, const char *);
             break;
 
+        case VLC_MODULE_SIGNATURE:
+        {
+            unsigned offset = va_arg (ap, unsigned);
+            const char *magic = va_arg (ap, const char *);
+            size_t length = va_arg (ap, size_t);
+            /* The cache loader accept only a small number of signatures,
+             * with 16-bits offsets and lengths */
+            assert(module->i_signatures < MODULE_SIGNATURE_MAX);
+            assert(offset <= UINT16_MAX && length > 0 && length <= UINT16_MAX);
+
+            struct vlc_module_signature *tab =
+                realloc (module->signatures,
+                         sizeof (*tab) * (module->i_signatures + 1));
+            if (unlikely(tab == NULL))
+            {
+                ret = -1;
+                break;
+            }
+            module->signatures = tab;
+            tab += module->i_signatures++;
+            tab->offset = offset;
+            tab->length = length;
+            tab->magic = magic;
+            break;
+        }
+
         case VLC_MODULE_TEXTDOMAIN:
             plugin->textdomain = va_arg(ap, const char *);
             break;
@@ -192,9 +192,30 @@ void *vlc_module_map(vlc_logger_t *log, module_t *module)
     return vlc_plugin_Map(log, module->plugin) ? NULL : module->pf_activate;
 }
 
-module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
-                            const char *name, bool strict,
-                            vlc_activate_t probe, ...)
+bool vlc_module_match_signature(const module_t *module, const void *data,
+                                size_t size)
+{
+    if (module->i_signatures == 0)
+        return true;
+
+    for (unsigned i = 0; i < module->i_signatures; i++) {
+        const struct vlc_module_signature *sig = &module->signatures[i];
+
+        /* Data that was not peeked cannot rule the module out. */
+        if ((size_t)sig->offset + sig->length > size)
+            return true;
+        if (memcmp((const char *)data + sig->offset, sig->magic,
+                   sig->length) == 0)
+            return true;
+    }
+    return false;
+}
+
+static module_t *vlc_module_load_va(struct vlc_logger *log,
+                                    const char *capability, const char *name,
+                                    bool strict, const void *peek,
+                                    size_t peek_size, vlc_activate_t probe,
+                                    va_list args)
 {
     if (name == NULL || name[0] == '\0')
         name = "any";
@@ -212,13 +233,19 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
               capability, name, total);
 
     module_t *module = NULL;
-    va_list args;
-
-    va_start(args, probe);
+    size_t skipped = 0;
 
     for (size_t i = 0; i < (size_t)total; i++) {
         module_t *cand = mods[i];
         int ret = VLC_EGENERIC;
+
+        /* Modules requested by name are probed regardless of signatures. */
+        if (peek != NULL && i >= strict_total
+         && !vlc_module_match_signature(cand, peek, peek_size)) {
+            skipped++;
+            continue;
+        }
+
         void *cb = vlc_module_map(log, cand);
 
         if (cb == NULL)
@@ -242,8 +269,9 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
     }
 
 done:
-    va_end (args);
-
+    if (skipped > 0)
+        vlc_debug(log, "skipped %zu %s modules with mismatching signatures",
+                  skipped, capability);
     if (module == NULL)
         vlc_debug(log, "no %s modules matched with name %s", capability, name);
 
@@ -251,6 +279,33 @@ done:
     return module;
 }
 
+module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
+                            const char *name, bool strict,
+                            vlc_activate_t probe, ...)
+{
+    va_list args;
+
+    va_start(args, probe);
+    module_t *module = vlc_module_load_va(log, capability, name, strict,
+                                          NULL, 0, probe, args);
+    va_end(args);
+    return module;
+}
+
+module_t *vlc_module_load_peek(struct vlc_logger *log, const char *capability,
+                               const char *name, bool strict,
+                               const void *peek, size_t peek_size,
+                               vlc_activate_t probe, ...)
+{
+    va_list args;
+
+    va_start(args, probe);
+    module_t *module = vlc_module_load_va(log, capability, name, strict,
+                                          peek, peek_size, probe, args);
+    va_end(args);
+    return module;
+}
+
 static int generic_start(void *func, bool forced, va_list ap)
 {
     vlc_object_t *obj = va_arg(ap, vlc_object_t *);
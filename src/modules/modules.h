@@ -25,6 +25,7 @@
 
 # include <stdatomic.h>
 # include <vlc_plugin.h>
+# include <vlc_modules.h>
 
 struct vlc_param;
 
@@ -56,6 +57,7 @@ typedef struct vlc_plugin_t
     char *path; /**< Relative path (within plug-in directory) */
     int64_t mtime; /**< Last modification time */
     uint64_t size; /**< File size */
+    bool cached; /**< Whether the plug-in was described by the cache */
 #endif
 } vlc_plugin_t;
 
@@ -65,6 +67,15 @@ typedef struct vlc_plugin_t
 extern struct vlc_plugin_t *vlc_plugins;
 
 #define MODULE_SHORTCUT_MAX 20
+#define MODULE_SIGNATURE_MAX 32
+
+/** Stream signature of a module */
+struct vlc_module_signature
+{
+    uint16_t offset; /**< Offset of the signature from the stream start */
+    uint16_t length; /**< Length of the signature in bytes */
+    const char *magic; /**< Signature bytes (not nul-terminated) */
+};
 
 /** Plugin deactivation callback */
 typedef void (*vlc_deactivate_cb)(vlc_object_t*);
@@ -93,6 +104,10 @@ struct module_t
     const char *psz_capability;                              /**< Capability */
     int      i_score;                          /**< Score for the capability */
 
+    /** Stream signatures (none if the module must always be probed) */
+    unsigned i_signatures;
+    struct vlc_module_signature *signatures;
+
     /* Callbacks */
     const char *activate_name;
     const char *deactivate_name;
@@ -130,6 +145,32 @@ void *vlc_plugin_Symbol(struct vlc_logger *, vlc_plugin_t *, const char *name);
  */
 size_t module_list_cap(module_t *const **tab, const char *name);
 
+/**
+ * Checks a stream against the signatures of a module.
+ *
+ * @param data first bytes of the stream
+ * @param size number of bytes in data
+ * @return false if the module declares signatures and none of them match the
+ * data, true otherwise (signatures reaching beyond the data count as matches)
+ */
+bool vlc_module_match_signature(const module_t *, const void *data,
+                                size_t size);
+
+/**
+ * Loads a module, skipping modules whose signatures do not match.
+ *
+ * This function works like vlc_module_load(), except that candidates that
+ * were not requested by name are not probed if they declare signatures and
+ * none of them match the peeked data.
+ *
+ * \param peek first bytes of the stream
+ * \param peek_size number of bytes in peek
+ */
+module_t *vlc_module_load_peek(struct vlc_logger *log, const char *cap,
+                               const char *name, bool strict,
+                               const void *peek, size_t peek_size,
+                               vlc_activate_t probe, ...) VLC_USED;
+
 int vlc_bindtextdomain (const char *);
 
 /* Low-level OS-dependent handler */
@@ -177,7 +218,34 @@ void *vlc_dlsym(void *handle, const char *name) VLC_USED;
 char *vlc_dlerror(void) VLC_USED;
 
 /* Plugins cache */
-vlc_plugin_t *vlc_cache_load(libvlc_int_t *, const char *, block_t **);
+
+/** Capability entry of a plugins cache index */
+struct vlc_cache_cap
+{
+    uint32_t name; /**< Offset of the name within the string table */
+    uint32_t offset; /**< Offset of the first module in the ordinals table */
+    uint32_t count; /**< Number of modules */
+};
+
+/**
+ * Capability index of a plugins cache file.
+ *
+ * The tables are referenced in place from the (memory-mapped) cache file.
+ * Capabilities are sorted by name, and the modules of each capability by
+ * decreasing score.
+ */
+typedef struct vlc_cache_index
+{
+    const struct vlc_cache_cap *capv; /**< Capabilities */
+    size_t capc; /**< Number of capabilities */
+    const uint32_t *ordv; /**< Module ordinals, grouped by capability */
+    const char *strings; /**< Capability names */
+    size_t modc; /**< Number of modules in the cache */
+    module_t *modv[]; /**< Modules by ordinal */
+} vlc_cache_index_t;
+
+vlc_plugin_t *vlc_cache_load(libvlc_int_t *, const char *, block_t **,
+                             vlc_cache_index_t **);
 vlc_plugin_t *vlc_cache_lookup(vlc_plugin_t **, const char *relpath);
 
 void CacheSave(libvlc_int_t *, const char *, vlc_plugin_t *const *, size_t);
@@ -25,6 +25,7 @@
 #include "content.h"
 
 #include "control.h"
+#include "index.h"
 #include "item.h"
 #include "notify.h"
 #include "playlist.h"
@@ -37,6 +38,53 @@ vlc_playlist_ClearItems(vlc_playlist_t *playlist)
     vlc_vector_foreach(item, &playlist->items)
         vlc_playlist_item_Release(item);
     vlc_vector_clear(&playlist->items);
+    playlist_map_Clear(&playlist->ids);
+    playlist_map_Clear(&playlist->media);
+    playlist->indexed = 0;
+}
+
+/*
+ * Lookups
+ *
+ * The ids and the media are indexed by hash maps to find the items. Each item
+ * also stores its position in the vector, which is only a hint: the items
+ * moved by an insertion, a removal or a move are renumbered lazily, on the
+ * next lookup, from the first position changed (playlist->indexed).
+ *
+ * That way, several changes at the start of a large playlist only cost one
+ * renumbering. Before renumbering, a stale item is searched around its hint,
+ * since a few insertions or removals only move it by a few positions.
+ */
+
+static bool
+vlc_playlist_ReserveIndex(vlc_playlist_t *playlist, size_t count)
+{
+    return playlist_map_Reserve(&playlist->ids, count)
+        && playlist_map_Reserve(&playlist->media, count);
+}
+
+/* the room must have been reserved by vlc_playlist_ReserveIndex() */
+static void
+vlc_playlist_IndexItem(vlc_playlist_t *playlist, vlc_playlist_item_t *item,
+                       size_t index)
+{
+    bool ok = playlist_map_Add(&playlist->ids, item->id, item);
+    assert(ok);
+    ok = playlist_map_Add(&playlist->media, (uintptr_t) item->media, item);
+    assert(ok);
+    VLC_UNUSED(ok);
+
+    item->index = index;
+}
+
+static void
+vlc_playlist_UnindexItem(vlc_playlist_t *playlist, vlc_playlist_item_t *item)
+{
+    bool ok = playlist_map_Remove(&playlist->ids, item->id, item);
+    assert(ok);
+    ok = playlist_map_Remove(&playlist->media, (uintptr_t) item->media, item);
+    assert(ok);
+    VLC_UNUSED(ok);
 }
 
 static void
@@ -61,6 +109,10 @@ static void
 vlc_playlist_ItemsInserted(vlc_playlist_t *playlist, size_t index, size_t count,
                            bool subitems)
 {
+    for (size_t i = index; i < index + count; ++i)
+        vlc_playlist_IndexItem(playlist, playlist->items.data[i], i);
+    vlc_playlist_InvalidateIndex(playlist, index + count);
+
     if (playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
         randomizer_Add(&playlist->randomizer,
                        &playlist->items.data[index], count);
@@ -89,6 +141,8 @@ static void
 vlc_playlist_ItemsMoved(vlc_playlist_t *playlist, size_t index, size_t count,
                         size_t target)
 {
+    vlc_playlist_InvalidateIndex(playlist, index < target ? index : target);
+
     struct vlc_playlist_state state;
     vlc_playlist_state_Save(playlist, &state);
 
@@ -129,6 +183,10 @@ vlc_playlist_ItemsRemoving(vlc_playlist_t *playlist, size_t index, size_t count)
     if (playlist->order == VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM)
         randomizer_Remove(&playlist->randomizer,
                           &playlist->items.data[index], count);
+
+    for (size_t i = index; i < index + count; ++i)
+        vlc_playlist_UnindexItem(playlist, playlist->items.data[i]);
+    vlc_playlist_InvalidateIndex(playlist, index);
 }
 
 /* return whether the current media has changed */
@@ -200,9 +258,27 @@ vlc_playlist_IndexOf(vlc_playlist_t *playlist, const vlc_playlist_item_t *item)
 {
     vlc_playlist_AssertLocked(playlist);
 
-    ssize_t index;
-    vlc_vector_index_of(&playlist->items, item, &index);
-    return index;
+    playlist_item_vector_t *items = &playlist->items;
+    if (item->index < items->size && items->data[item->index] == item)
+        return item->index;
+
+    /* only the items from playlist->indexed may have moved */
+    ssize_t index = playlist_index_Find(items->data, items->size,
+                                        playlist->indexed, item->index, item);
+    if (index != -1)
+    {
+        items->data[index]->index = index;
+        return index;
+    }
+
+    /* renumber the items which moved since the last lookup */
+    for (size_t i = playlist->indexed; i < items->size; ++i)
+        items->data[i]->index = i;
+    playlist->indexed = items->size;
+
+    if (item->index < items->size && items->data[item->index] == item)
+        return item->index;
+    return -1; /* not in the playlist */
 }
 
 ssize_t
@@ -210,11 +286,21 @@ vlc_playlist_IndexOfMedia(vlc_playlist_t *playlist, const input_item_t *media)
 {
     vlc_playlist_AssertLocked(playlist);
 
-    playlist_item_vector_t *items = &playlist->items;
-    for (size_t i = 0; i < items->size; ++i)
-        if (items->data[i]->media == media)
-            return i;
-    return -1;
+    /* the same media may be inserted several times, return the first one */
+    ssize_t first = -1;
+    size_t iter;
+    for (vlc_playlist_item_t *item =
+            playlist_map_Get(&playlist->media, (uintptr_t) media, &iter);
+         item != NULL;
+         item = playlist_map_GetNext(&playlist->media, (uintptr_t) media,
+                                     &iter))
+    {
+        ssize_t index = vlc_playlist_IndexOf(playlist, item);
+        assert(index != -1);
+        if (first == -1 || index < first)
+            first = index;
+    }
+    return first;
 }
 
 ssize_t
@@ -222,11 +308,9 @@ vlc_playlist_IndexOfId(vlc_playlist_t *playlist, uint64_t id)
 {
     vlc_playlist_AssertLocked(playlist);
 
-    playlist_item_vector_t *items = &playlist->items;
-    for (size_t i = 0; i < items->size; ++i)
-        if (items->data[i]->id == id)
-            return i;
-    return -1;
+    size_t iter;
+    vlc_playlist_item_t *item = playlist_map_Get(&playlist->ids, id, &iter);
+    return item != NULL ? vlc_playlist_IndexOf(playlist, item) : -1;
 }
 
 void
@@ -274,6 +358,9 @@ vlc_playlist_Insert(vlc_playlist_t *playlist, size_t index,
     vlc_playlist_AssertLocked(playlist);
     assert(index <= playlist->items.size);
 
+    if (!vlc_playlist_ReserveIndex(playlist, count))
+        return VLC_ENOMEM;
+
     /* make space in the vector */
     if (!vlc_vector_insert_hole(&playlist->items, index, count))
         return VLC_ENOMEM;
@@ -342,6 +429,9 @@ vlc_playlist_Replace(vlc_playlist_t *playlist, size_t index,
     vlc_playlist_AssertLocked(playlist);
     assert(index < playlist->items.size);
 
+    if (!vlc_playlist_ReserveIndex(playlist, 1))
+        return VLC_ENOMEM;
+
     uint64_t id = playlist->idgen++;
     vlc_playlist_item_t *item = vlc_playlist_item_New(media, id);
     if (!item)
@@ -358,8 +448,10 @@ vlc_playlist_Replace(vlc_playlist_t *playlist, size_t index,
     if (playlist->parser != NULL
             && old->preparser_req != NULL)
         vlc_preparser_Cancel(playlist->parser, old->preparser_req);
+    vlc_playlist_UnindexItem(playlist, old);
     vlc_playlist_item_Release(old);
     playlist->items.data[index] = item;
+    vlc_playlist_IndexItem(playlist, item, index);
 
     vlc_playlist_ItemReplaced(playlist, index);
     return VLC_SUCCESS;
@@ -382,6 +474,9 @@ vlc_playlist_Expand(vlc_playlist_t *playlist, size_t index,
 
         if (count > 1)
         {
+            if (!vlc_playlist_ReserveIndex(playlist, count - 1))
+                return VLC_ENOMEM;
+
             /* make space in the vector */
             if (!vlc_vector_insert_hole(&playlist->items, index + 1, count - 1))
                 return VLC_ENOMEM;
@@ -0,0 +1,71 @@
+/*****************************************************************************
+ * playlist/index.h
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_PLAYLIST_INDEX_H
+#define VLC_PLAYLIST_INDEX_H
+
+#include <vlc_common.h>
+
+typedef struct vlc_playlist_item vlc_playlist_item_t;
+
+/**
+ * \defgroup playlist_index Playlist position hints helper
+ * \ingroup playlist
+ *
+ * The items store their position as a hint. When items are moved, the hints
+ * from the first position changed are renumbered lazily, on the next lookup.
+ * Until then, a few insertions or removals only move an item by a few
+ * positions, so it is first searched around its hint.
+ *
+ *  @{ */
+
+#define PLAYLIST_INDEX_HINT_WINDOW 1024
+
+/**
+ * Search an item around its position hint.
+ *
+ * \param items the items
+ * \param count the number of items
+ * \param from the first position which may have moved
+ * \param hint the (stale) position hint of the item
+ * \param item the item to search
+ * \return the position of the item, or -1 if it is not near its hint
+ */
+static inline ssize_t
+playlist_index_Find(vlc_playlist_item_t *const *items, size_t count,
+                    size_t from, size_t hint, const vlc_playlist_item_t *item)
+{
+    if (hint > count)
+        hint = count;
+    size_t start = hint > PLAYLIST_INDEX_HINT_WINDOW
+                 ? hint - PLAYLIST_INDEX_HINT_WINDOW : 0;
+    if (start < from)
+        start = from;
+    size_t end = count - hint > PLAYLIST_INDEX_HINT_WINDOW
+               ? hint + PLAYLIST_INDEX_HINT_WINDOW : count;
+    for (size_t i = start; i < end; ++i)
+        if (items[i] == item)
+            return i;
+    return -1;
+}
+
+/** @} */
+
+#endif
@@ -37,6 +37,8 @@ vlc_playlist_item_New(input_item_t *media, uint64_t id)
     vlc_atomic_rc_init(&item->rc);
     item->id = id;
     item->preparser_req = NULL;
+    item->index = SIZE_MAX;
+    item->random_index = SIZE_MAX;
     item->media = media;
     input_item_Hold(media);
     return item;
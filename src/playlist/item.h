@@ -33,6 +33,9 @@ struct vlc_playlist_item
     uint64_t id;
     vlc_preparser_req *preparser_req;
     vlc_atomic_rc_t rc;
+    /* position hints, see vlc_playlist_IndexOf() and randomizer.c */
+    size_t index;
+    size_t random_index;
 };
 
 /* _New() is private, it is called when inserting new media in the playlist */
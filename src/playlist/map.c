@@ -0,0 +1,185 @@
+/*****************************************************************************
+ * playlist/map.c
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include "map.h"
+
+/*
+ * Open addressing with linear probing. An entry is free if its value is NULL.
+ *
+ * The entries are removed by shifting the following ones backwards, so there
+ * are no tombstones: a lookup stops at the first free entry.
+ */
+
+#define MIN_BITS 4
+
+static inline size_t
+playlist_map_Home(const struct playlist_map *map, uint64_t key)
+{
+    /* Fibonacci hashing, the pointers are aligned so the low bits are poor */
+    return (key * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - map->bits);
+}
+
+static inline size_t
+playlist_map_Capacity(const struct playlist_map *map)
+{
+    return map->bits ? (size_t) 1 << map->bits : 0;
+}
+
+void
+playlist_map_Init(struct playlist_map *map)
+{
+    map->entries = NULL;
+    map->size = 0;
+    map->bits = 0;
+}
+
+void
+playlist_map_Destroy(struct playlist_map *map)
+{
+    free(map->entries);
+}
+
+void
+playlist_map_Clear(struct playlist_map *map)
+{
+    free(map->entries);
+    playlist_map_Init(map);
+}
+
+static void
+playlist_map_Insert(struct playlist_map *map, uint64_t key, void *value)
+{
+    size_t mask = playlist_map_Capacity(map) - 1;
+    size_t i = playlist_map_Home(map, key);
+    while (map->entries[i].value != NULL)
+        i = (i + 1) & mask;
+
+    map->entries[i].key = key;
+    map->entries[i].value = value;
+    map->size++;
+}
+
+bool
+playlist_map_Reserve(struct playlist_map *map, size_t count)
+{
+    /* keep the load factor under 3/4 */
+    size_t needed = map->size + count;
+    if (needed > SIZE_MAX / 4)
+        return false;
+    needed += needed / 3;
+
+    unsigned bits = map->bits ? map->bits : MIN_BITS;
+    while (((size_t) 1 << bits) < needed)
+        bits++;
+    if (bits == map->bits)
+        return true;
+
+    struct playlist_map_entry *entries =
+        vlc_alloc((size_t) 1 << bits, sizeof(*entries));
+    if (unlikely(!entries))
+        return false;
+    for (size_t i = 0; i < (size_t) 1 << bits; ++i)
+        entries[i].value = NULL;
+
+    struct playlist_map old = *map;
+    map->entries = entries;
+    map->size = 0;
+    map->bits = bits;
+
+    for (size_t i = 0; i < playlist_map_Capacity(&old); ++i)
+        if (old.entries[i].value != NULL)
+            playlist_map_Insert(map, old.entries[i].key, old.entries[i].value);
+    free(old.entries);
+    return true;
+}
+
+bool
+playlist_map_Add(struct playlist_map *map, uint64_t key, void *value)
+{
+    assert(value != NULL);
+    if (!playlist_map_Reserve(map, 1))
+        return false;
+    playlist_map_Insert(map, key, value);
+    return true;
+}
+
+bool
+playlist_map_Remove(struct playlist_map *map, uint64_t key, const void *value)
+{
+    if (map->size == 0)
+        return false;
+
+    size_t mask = playlist_map_Capacity(map) - 1;
+    size_t i = playlist_map_Home(map, key);
+    /* the keys of the free entries are not initialized */
+    for (;; i = (i + 1) & mask)
+    {
+        if (map->entries[i].value == NULL)
+            return false;
+        if (map->entries[i].value == value && map->entries[i].key == key)
+            break;
+    }
+
+    /* move back the following entries which would not be found anymore */
+    for (size_t j = (i + 1) & mask; map->entries[j].value != NULL;
+         j = (j + 1) & mask)
+    {
+        size_t home = playlist_map_Home(map, map->entries[j].key);
+        if (((j - home) & mask) >= ((j - i) & mask))
+        {
+            map->entries[i] = map->entries[j];
+            i = j;
+        }
+    }
+    map->entries[i].value = NULL;
+    map->size--;
+    return true;
+}
+
+void *
+playlist_map_GetNext(const struct playlist_map *map, uint64_t key,
+                     size_t *iter)
+{
+    size_t mask = playlist_map_Capacity(map) - 1;
+    for (size_t i = *iter; map->entries[i].value != NULL; i = (i + 1) & mask)
+    {
+        if (map->entries[i].key == key)
+        {
+            *iter = (i + 1) & mask;
+            return map->entries[i].value;
+        }
+    }
+    return NULL;
+}
+
+void *
+playlist_map_Get(const struct playlist_map *map, uint64_t key, size_t *iter)
+{
+    if (map->size == 0)
+        return NULL;
+    *iter = playlist_map_Home(map, key);
+    return playlist_map_GetNext(map, key, iter);
+}
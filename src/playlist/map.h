@@ -0,0 +1,100 @@
+/*****************************************************************************
+ * playlist/map.h
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_PLAYLIST_MAP_H
+#define VLC_PLAYLIST_MAP_H
+
+#include <vlc_common.h>
+
+/**
+ * \defgroup playlist_map Playlist hash map helper
+ * \ingroup playlist
+ *  @{ */
+
+/**
+ * Hash multimap from 64-bit keys (ids or pointers) to pointers.
+ *
+ * Several entries may share the same key. The values must not be NULL.
+ */
+struct playlist_map {
+    struct playlist_map_entry {
+        uint64_t key;
+        void *value;
+    } *entries;
+    size_t size;
+    unsigned bits; /* log2 of the capacity, 0 if not allocated */
+};
+
+/**
+ * Initialize an empty map.
+ */
+void
+playlist_map_Init(struct playlist_map *map);
+
+/**
+ * Destroy a map.
+ */
+void
+playlist_map_Destroy(struct playlist_map *map);
+
+/**
+ * Remove all the entries.
+ */
+void
+playlist_map_Clear(struct playlist_map *map);
+
+/**
+ * Make room for count more entries.
+ *
+ * Once reserved, adding up to count entries cannot fail.
+ */
+bool
+playlist_map_Reserve(struct playlist_map *map, size_t count);
+
+/**
+ * Add an entry, even if another one has the same key.
+ */
+bool
+playlist_map_Add(struct playlist_map *map, uint64_t key, void *value);
+
+/**
+ * Remove the entry matching both the key and the value, if any.
+ */
+bool
+playlist_map_Remove(struct playlist_map *map, uint64_t key, const void *value);
+
+/**
+ * Return the first value for the key, or NULL if none.
+ *
+ * \param iter iterator to pass to playlist_map_GetNext()
+ */
+void *
+playlist_map_Get(const struct playlist_map *map, uint64_t key, size_t *iter);
+
+/**
+ * Return the next value for the key, or NULL if none.
+ */
+void *
+playlist_map_GetNext(const struct playlist_map *map, uint64_t key,
+                     size_t *iter);
+
+/** @} */
+
+#endif
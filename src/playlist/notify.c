@@ -127,7 +127,6 @@ vlc_playlist_NotifyMediaUpdated(vlc_playlist_t *playlist, input_item_t *media)
         index = playlist->current;
     else
     {
-        /* linear search */
         index = vlc_playlist_IndexOfMedia(playlist, media);
         if (index == -1)
             return;
@@ -73,6 +73,9 @@ vlc_playlist_New(vlc_object_t *parent, enum vlc_playlist_preparsing rec,
     playlist->stopped_action = VLC_PLAYLIST_MEDIA_STOPPED_CONTINUE;
 
     vlc_vector_init(&playlist->items);
+    playlist->indexed = 0;
+    playlist_map_Init(&playlist->ids);
+    playlist_map_Init(&playlist->media);
     randomizer_Init(&playlist->randomizer);
     playlist->current = -1;
     playlist->has_prev = false;
@@ -97,6 +100,8 @@ vlc_playlist_Delete(vlc_playlist_t *playlist)
     vlc_playlist_PlayerDestroy(playlist);
     randomizer_Destroy(&playlist->randomizer);
     vlc_playlist_ClearItems(playlist);
+    playlist_map_Destroy(&playlist->ids);
+    playlist_map_Destroy(&playlist->media);
     free(playlist);
 }
 
@@ -26,6 +26,7 @@
 #include <vlc_preparser.h>
 #include <vlc_vector.h>
 #include "../player/player.h"
+#include "map.h"
 #include "randomizer.h"
 
 typedef struct input_item_t input_item_t;
@@ -55,6 +56,10 @@ struct vlc_playlist
     /* all remaining fields are protected by the lock of the player */
     struct vlc_player_listener_id *player_listener;
     playlist_item_vector_t items;
+    /* the items before this position know their index (see content.c) */
+    size_t indexed;
+    struct playlist_map ids; /**< id -> item */
+    struct playlist_map media; /**< media -> items */
     struct randomizer randomizer;
     ssize_t current;
     bool has_prev;
@@ -76,4 +81,12 @@ vlc_playlist_AssertLocked(vlc_playlist_t *playlist)
 #define vlc_playlist_AssertLocked(x) ((void) (0))
 #endif
 
+/* the items from index may have moved, their position hint is not reliable */
+static inline void
+vlc_playlist_InvalidateIndex(vlc_playlist_t *playlist, size_t index)
+{
+    if (playlist->indexed > index)
+        playlist->indexed = index;
+}
+
 #endif
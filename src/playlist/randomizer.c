@@ -31,6 +31,17 @@
 #include <vlc_common.h>
 #include <vlc_rand.h>
 #include "randomizer.h"
+#include "index.h"
+
+#ifdef TEST_RANDOMIZER
+/* fake structure to simplify tests */
+struct vlc_playlist_item {
+    size_t index;
+    size_t random_index;
+};
+#else
+# include "item.h"
+#endif
 
 /**
  * \addtogroup playlist_randomizer Playlist randomizer helper
@@ -269,6 +280,7 @@ randomizer_Init(struct randomizer *r)
     r->head = 0;
     r->next = 0;
     r->history = 0;
+    r->indexed = 0;
 }
 
 void
@@ -283,12 +295,42 @@ randomizer_SetLoop(struct randomizer *r, bool loop)
     r->loop = loop;
 }
 
-static inline ssize_t
+/* The items store their position as a hint. When items are moved, the hints
+ * from the first position changed are renumbered lazily, on the next lookup,
+ * except for swaps which update both items. A stale item is first searched
+ * around its hint, like in vlc_playlist_IndexOf(). */
+
+static inline void
+randomizer_Invalidate(struct randomizer *r, size_t index)
+{
+    if (r->indexed > index)
+        r->indexed = index;
+}
+
+static ssize_t
 randomizer_IndexOf(struct randomizer *r, const vlc_playlist_item_t *item)
 {
-    ssize_t index;
-    vlc_vector_index_of(&r->items, item, &index);
-    return index;
+    if (item->random_index < r->items.size
+     && r->items.data[item->random_index] == item)
+        return item->random_index;
+
+    /* only the items from r->indexed may have moved */
+    ssize_t index = playlist_index_Find(r->items.data, r->items.size,
+                                        r->indexed, item->random_index, item);
+    if (index != -1)
+    {
+        r->items.data[index]->random_index = index;
+        return index;
+    }
+
+    for (size_t i = r->indexed; i < r->items.size; ++i)
+        r->items.data[i]->random_index = i;
+    r->indexed = r->items.size;
+
+    if (item->random_index < r->items.size
+     && r->items.data[item->random_index] == item)
+        return item->random_index;
+    return -1;
 }
 
 bool
@@ -312,6 +354,8 @@ swap_items(struct randomizer *r, int i, int j)
     vlc_playlist_item_t *item = r->items.data[i];
     r->items.data[i] = r->items.data[j];
     r->items.data[j] = item;
+    r->items.data[i]->random_index = i;
+    r->items.data[j]->random_index = j;
 }
 
 static inline void
@@ -425,6 +469,9 @@ randomizer_Add(struct randomizer *r, vlc_playlist_item_t *items[], size_t count)
 {
     if (!vlc_vector_insert_all(&r->items, r->history, items, count))
         return false;
+    for (size_t i = 0; i < count; ++i)
+        items[i]->random_index = r->history + i;
+    randomizer_Invalidate(r, r->history + count);
     /* the insertion shifted history (and possibly next) */
     if (r->next > r->history)
         r->next += count;
@@ -440,6 +487,7 @@ randomizer_SelectIndex(struct randomizer *r, size_t index)
     {
         if (index > r->history)
         {
+            randomizer_Invalidate(r, r->history);
             memmove(&r->items.data[r->history + 1],
                     &r->items.data[r->history],
                     (index - r->history) * sizeof(selected));
@@ -450,12 +498,12 @@ randomizer_SelectIndex(struct randomizer *r, size_t index)
 
     if (index >= r->head)
     {
-        r->items.data[index] = r->items.data[r->head];
-        r->items.data[r->head] = selected;
+        swap_items(r, index, r->head);
         r->head++;
     }
     else if (index < r->items.size - 1)
     {
+        randomizer_Invalidate(r, index);
         memmove(&r->items.data[index],
                 &r->items.data[index + 1],
                 (r->head - index - 1) * sizeof(selected));
@@ -490,6 +538,7 @@ randomizer_RemoveAt(struct randomizer *r, size_t index)
     if (index < r->head)
     {
         /* item was selected, keep the selected part ordered */
+        randomizer_Invalidate(r, index);
         memmove(&r->items.data[index],
                 &r->items.data[index + 1],
                 (r->head - index - 1) * sizeof(*r->items.data));
@@ -497,17 +546,22 @@ randomizer_RemoveAt(struct randomizer *r, size_t index)
         index = r->head; /* the new index to remove */
     }
 
-    if (index < r->history)
+    /* without history, all the items after head are unordered */
+    size_t history = r->history ? r->history : r->items.size;
+    if (index < history)
     {
         /* this part is unordered, no need to shift all items */
-        r->items.data[index] = r->items.data[r->history - 1];
-        index = r->history - 1;
-        r->history--;
+        r->items.data[index] = r->items.data[history - 1];
+        r->items.data[index]->random_index = index;
+        index = history - 1;
+        if (r->history)
+            r->history--;
     }
 
     if (index < r->items.size - 1)
     {
         /* shift the ordered history part by one */
+        randomizer_Invalidate(r, index);
         memmove(&r->items.data[index],
                 &r->items.data[index + 1],
                 (r->items.size - index - 1) * sizeof(*r->items.data));
@@ -524,12 +578,38 @@ randomizer_RemoveOne(struct randomizer *r, const vlc_playlist_item_t *item)
     randomizer_RemoveAt(r, index);
 }
 
+static int
+CompareIndexDesc(const void *lhs, const void *rhs)
+{
+    size_t a = *(const size_t *) lhs;
+    size_t b = *(const size_t *) rhs;
+    return a < b ? 1 : a > b ? -1 : 0;
+}
+
 void
 randomizer_Remove(struct randomizer *r, vlc_playlist_item_t *const items[],
                   size_t count)
 {
-    for (size_t i = 0; i < count; ++i)
-        randomizer_RemoveOne(r, items[i]);
+    size_t *indices = count > 1 ? vlc_alloc(count, sizeof(*indices)) : NULL;
+    if (indices)
+    {
+        /* Removing an item only moves the items after it: remove from the
+         * last one, so that the positions of the others are found at once. */
+        for (size_t i = 0; i < count; ++i)
+        {
+            ssize_t index = randomizer_IndexOf(r, items[i]);
+            assert(index >= 0); /* item must exist */
+            indices[i] = index;
+        }
+        qsort(indices, count, sizeof(*indices), CompareIndexDesc);
+
+        for (size_t i = 0; i < count; ++i)
+            randomizer_RemoveAt(r, indices[i]);
+        free(indices);
+    }
+    else
+        for (size_t i = 0; i < count; ++i)
+            randomizer_RemoveOne(r, items[i]);
 
     vlc_vector_autoshrink(&r->items);
 }
@@ -541,16 +621,12 @@ randomizer_Clear(struct randomizer *r)
     r->head = 0;
     r->next = 0;
     r->history = 0;
+    r->indexed = 0;
 }
 
 #ifndef DOC
 #ifdef TEST_RANDOMIZER
 
-/* fake structure to simplify tests */
-struct vlc_playlist_item {
-    size_t index;
-};
-
 static void
 ArrayInit(vlc_playlist_item_t *array[], size_t len)
 {
@@ -43,6 +43,7 @@ struct randomizer {
     size_t head;
     size_t next;
     size_t history;
+    size_t indexed; /* the items before know their position */
 };
 
 /**
@@ -56,6 +56,7 @@ vlc_playlist_Shuffle(vlc_playlist_t *playlist)
         playlist->items.data[i] = playlist->items.data[selected];
         playlist->items.data[selected] = tmp;
     }
+    vlc_playlist_InvalidateIndex(playlist, 0);
 
     struct vlc_playlist_state state;
     if (current)
@@ -22,7 +22,11 @@
 # include "config.h"
 #endif
 
+#include <ctype.h>
+
 #include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_executor.h>
 #include <vlc_rand.h>
 #include <vlc_sort.h>
 #include <vlc_strings.h>
@@ -31,17 +35,27 @@
 #include "notify.h"
 #include "playlist.h"
 
+/* playlists from this size are sorted in parallel */
+#define SORT_PARALLEL_MIN_ITEMS 16384
+#define SORT_MAX_THREADS 16
+
 /**
  * Struct containing a copy of (parsed) media metadata, used for sorting
  * without locking all the items.
+ *
+ * The strings compared case-insensitively are stored lowercase, and the
+ * collation keys (see strxfrm()) are computed once per item, instead of
+ * calling strcasecmp() and strcoll() on every comparison.
  */
 struct vlc_playlist_item_meta {
     vlc_playlist_item_t *item;
     size_t index;
     const char *title_or_name;
+    const char *title_key;
     vlc_tick_t duration;
     const char *artist;
     const char *album;
+    const char *album_key;
     const char *album_artist;
     const char *genre;
     const char *url;
@@ -71,6 +85,33 @@ vlc_playlist_item_meta_CopyString(const char **to, const char *from)
     return VLC_SUCCESS;
 }
 
+static int
+vlc_playlist_item_meta_CopyLowerString(const char **to, const char *from)
+{
+    int ret = vlc_playlist_item_meta_CopyString(to, from);
+    if (ret == VLC_SUCCESS && *to)
+        for (char *str = (char *) *to; *str; ++str)
+            *str = tolower((unsigned char) *str);
+    return ret;
+}
+
+static int
+vlc_playlist_item_meta_CopyCollationKey(const char **to, const char *from)
+{
+    if (from)
+    {
+        size_t len = strxfrm(NULL, from, 0);
+        char *key = malloc(len + 1);
+        if (unlikely(!key))
+            return VLC_ENOMEM;
+        strxfrm(key, from, len + 1);
+        *to = key;
+    }
+    else
+        *to = NULL;
+    return VLC_SUCCESS;
+}
+
 static int
 vlc_playlist_item_meta_GetNumber(const char * str, int64_t * to)
 {
@@ -106,8 +147,12 @@ vlc_playlist_item_meta_InitField(struct vlc_playlist_item_meta *meta,
             const char *value = input_item_GetMetaLocked(media, vlc_meta_Title);
             if (EMPTY_STR(value))
                 value = media->psz_name;
-            return vlc_playlist_item_meta_CopyString(&meta->title_or_name,
-                                                     value);
+            int ret = vlc_playlist_item_meta_CopyString(&meta->title_or_name,
+                                                        value);
+            if (ret != VLC_SUCCESS)
+                return ret;
+            return vlc_playlist_item_meta_CopyCollationKey(&meta->title_key,
+                                                           value);
         }
         case VLC_PLAYLIST_SORT_KEY_DURATION:
         {
@@ -122,24 +167,29 @@ vlc_playlist_item_meta_InitField(struct vlc_playlist_item_meta *meta,
         {
             const char *value = input_item_GetMetaLocked(media,
                                                          vlc_meta_Artist);
-            return vlc_playlist_item_meta_CopyString(&meta->artist, value);
+            return vlc_playlist_item_meta_CopyLowerString(&meta->artist,
+                                                          value);
         }
         case VLC_PLAYLIST_SORT_KEY_ALBUM:
         {
             const char *value = input_item_GetMetaLocked(media, vlc_meta_Album);
-            return vlc_playlist_item_meta_CopyString(&meta->album, value);
+            int ret = vlc_playlist_item_meta_CopyString(&meta->album, value);
+            if (ret != VLC_SUCCESS)
+                return ret;
+            return vlc_playlist_item_meta_CopyCollationKey(&meta->album_key,
+                                                           value);
         }
         case VLC_PLAYLIST_SORT_KEY_ALBUM_ARTIST:
         {
             const char *value = input_item_GetMetaLocked(media,
                                                          vlc_meta_AlbumArtist);
-            return vlc_playlist_item_meta_CopyString(&meta->album_artist,
-                                                     value);
+            return vlc_playlist_item_meta_CopyLowerString(&meta->album_artist,
+                                                          value);
         }
         case VLC_PLAYLIST_SORT_KEY_GENRE:
         {
             const char *value = input_item_GetMetaLocked(media, vlc_meta_Genre);
-            return vlc_playlist_item_meta_CopyString(&meta->genre, value);
+            return vlc_playlist_item_meta_CopyLowerString(&meta->genre, value);
         }
         case VLC_PLAYLIST_SORT_KEY_DATE:
         {
@@ -216,81 +266,60 @@ static void
 vlc_playlist_item_meta_DestroyFields(struct vlc_playlist_item_meta *meta)
 {
     free((void *) meta->title_or_name);
+    free((void *) meta->title_key);
     free((void *) meta->artist);
     free((void *) meta->album);
+    free((void *) meta->album_key);
     free((void *) meta->album_artist);
     free((void *) meta->genre);
     free((void *) meta->url);
 }
 
+/* on error, the fields initialized must still be destroyed */
 static int
-vlc_playlist_item_meta_InitFields(struct vlc_playlist_item_meta *meta,
-        const struct vlc_playlist_sort_criterion criteria[], size_t count)
-{
-    for (size_t i = 0; i < count; ++i)
-    {
-        const struct vlc_playlist_sort_criterion *criterion = &criteria[i];
-        int ret = vlc_playlist_item_meta_InitField(meta, criterion->key);
-        if (unlikely(ret != VLC_SUCCESS))
-        {
-            vlc_playlist_item_meta_DestroyFields(meta);
-            return ret;
-        }
-    }
-    return VLC_SUCCESS;
-}
-
-static struct vlc_playlist_item_meta *
-vlc_playlist_item_meta_New(size_t index, vlc_playlist_item_t *item,
-                           const struct vlc_playlist_sort_criterion criteria[],
-                           size_t count)
+vlc_playlist_item_meta_Init(struct vlc_playlist_item_meta *meta, size_t index,
+                            vlc_playlist_item_t *item,
+                            const struct vlc_playlist_sort_criterion criteria[],
+                            size_t count)
 {
     /* assume that NULL representation is all-zeros */
-    struct vlc_playlist_item_meta *meta = calloc(1, sizeof(*meta));
-    if (unlikely(!meta))
-        return NULL;
-
+    memset(meta, 0, sizeof(*meta));
     meta->item = item;
     meta->index = index;
 
+    int ret = VLC_SUCCESS;
     vlc_mutex_lock(&item->media->lock);
-    int ret = vlc_playlist_item_meta_InitFields(meta, criteria, count);
+    for (size_t i = 0; i < count && ret == VLC_SUCCESS; ++i)
+        ret = vlc_playlist_item_meta_InitField(meta, criteria[i].key);
     vlc_mutex_unlock(&item->media->lock);
-
-    if (unlikely(ret != VLC_SUCCESS))
-    {
-        free(meta);
-        return NULL;
-    }
-
-    return meta;
-}
-
-static void
-vlc_playlist_item_meta_Delete(struct vlc_playlist_item_meta *meta)
-{
-    vlc_playlist_item_meta_DestroyFields(meta);
-    free(meta);
+    return ret;
 }
 
+/* the strings are lowercase, like strcasecmp() */
 static inline int
 CompareStrings(const char *a, const char *b)
 {
     if (a && b)
-        return strcasecmp(a, b);
+        return strcmp(a, b);
     if (!a && !b)
         return 0;
     return a ? 1 : -1;
 }
 
+/* vlc_filenamecmp(), with the collation keys instead of strcoll() */
 static inline int
-CompareFilenameStrings(const char *a, const char *b)
+CompareFilenameStrings(const char *a, const char *a_key,
+                       const char *b, const char *b_key)
 {
-    if (a && b)
-        return vlc_filenamecmp(a, b);
-    if (!a && !b)
-        return 0;
-    return a ? 1 : -1;
+    if (!a || !b)
+    {
+        if (!a && !b)
+            return 0;
+        return a ? 1 : -1;
+    }
+
+    int ret = vlc_filenamecmp_numbers(a, b);
+    return ret != 0 ? ret : strcmp(a_key, b_key);
 }
 
 static inline int
@@ -333,13 +362,15 @@ CompareMetaByKey(const struct vlc_playlist_item_meta *a,
     switch (key)
     {
         case VLC_PLAYLIST_SORT_KEY_TITLE:
-            return CompareFilenameStrings(a->title_or_name, b->title_or_name);
+            return CompareFilenameStrings(a->title_or_name, a->title_key,
+                                          b->title_or_name, b->title_key);
         case VLC_PLAYLIST_SORT_KEY_DURATION:
             return CompareIntegers(a->duration, b->duration);
         case VLC_PLAYLIST_SORT_KEY_ARTIST:
             return CompareStrings(a->artist, b->artist);
         case VLC_PLAYLIST_SORT_KEY_ALBUM:
-            return CompareFilenameStrings(a->album, b->album);
+            return CompareFilenameStrings(a->album, a->album_key,
+                                          b->album, b->album_key);
         case VLC_PLAYLIST_SORT_KEY_ALBUM_ARTIST:
             return CompareStrings(a->album_artist, b->album_artist);
         case VLC_PLAYLIST_SORT_KEY_GENRE:
@@ -403,42 +434,168 @@ compare_meta(const void *lhs, const void *rhs, void *userdata)
     return a->index < b->index ? -1 : 1;
 }
 
+/**
+ * Sorting context.
+ *
+ * The items are split into runs, one per thread. Each thread copies the
+ * metadata of its run and sorts it, then the runs are merged two by two.
+ */
+struct sort_context
+{
+    vlc_playlist_t *playlist;
+    struct sort_request req;
+
+    struct vlc_playlist_item_meta *metas;
+    struct vlc_playlist_item_meta **array;
+    struct vlc_playlist_item_meta **tmp; /* merge output */
+
+    /* run i is [bounds[i], bounds[i+1]) */
+    size_t bounds[SORT_MAX_THREADS + 1];
+    unsigned runs;
+
+    vlc_executor_t *executor;
+    void (*run)(struct sort_context *ctx, unsigned index);
+    struct sort_task
+    {
+        struct vlc_runnable runnable;
+        struct sort_context *ctx;
+        unsigned index;
+    } tasks[SORT_MAX_THREADS];
+
+    vlc_mutex_t lock;
+    int error;
+};
+
 static void
-vlc_playlist_DeleteMetaArray(struct vlc_playlist_item_meta *array[],
-                             size_t count)
+sort_task_Run(void *userdata)
 {
-    for (size_t i = 0; i < count; ++i)
-        vlc_playlist_item_meta_Delete(array[i]);
-    free(array);
+    struct sort_task *task = userdata;
+    task->ctx->run(task->ctx, task->index);
 }
 
-static struct vlc_playlist_item_meta **
-vlc_playlist_NewMetaArray(vlc_playlist_t *playlist,
-        const struct vlc_playlist_sort_criterion criteria[], size_t count)
+/* run the tasks in parallel, the calling thread runs the first one */
+static void
+sort_context_RunTasks(struct sort_context *ctx, unsigned count,
+                      void (*run)(struct sort_context *ctx, unsigned index))
+{
+    ctx->run = run;
+    for (unsigned i = 1; i < count; ++i)
+    {
+        struct sort_task *task = &ctx->tasks[i];
+        task->ctx = ctx;
+        task->index = i;
+        task->runnable.run = sort_task_Run;
+        task->runnable.userdata = task;
+        vlc_executor_Submit(ctx->executor, &task->runnable);
+    }
+
+    run(ctx, 0);
+
+    if (count > 1)
+        vlc_executor_WaitIdle(ctx->executor);
+}
+
+static void
+sort_context_SortRun(struct sort_context *ctx, unsigned index)
 {
-    struct vlc_playlist_item_meta **array =
-            vlc_alloc(playlist->items.size, sizeof(*array));
+    size_t begin = ctx->bounds[index];
+    size_t end = ctx->bounds[index + 1];
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        struct vlc_playlist_item_meta *meta = &ctx->metas[i];
+        int ret = vlc_playlist_item_meta_Init(meta, i,
+                                              ctx->playlist->items.data[i],
+                                              ctx->req.criteria,
+                                              ctx->req.count);
+        if (unlikely(ret != VLC_SUCCESS))
+        {
+            vlc_mutex_lock(&ctx->lock);
+            ctx->error = ret;
+            vlc_mutex_unlock(&ctx->lock);
+            /* the metas not initialized must still be destroyable */
+            memset(&ctx->metas[i + 1], 0, (end - i - 1) * sizeof(*meta));
+            return;
+        }
+        ctx->array[i] = meta;
+    }
+
+    vlc_qsort(&ctx->array[begin], end - begin, sizeof(*ctx->array),
+              compare_meta, &ctx->req);
+}
+
+/* merge the runs 2*index and 2*index+1 from array to tmp */
+static void
+sort_context_MergeRuns(struct sort_context *ctx, unsigned index)
+{
+    unsigned first = 2 * index;
+    size_t i = ctx->bounds[first];
+    size_t out = i;
+
+    if (first + 1 >= ctx->runs)
+    {
+        /* odd number of runs, the last one is kept as is */
+        memcpy(&ctx->tmp[i], &ctx->array[i],
+               (ctx->bounds[ctx->runs] - i) * sizeof(*ctx->array));
+        return;
+    }
 
-    if (unlikely(!array))
-        return NULL;
+    size_t mid = ctx->bounds[first + 1];
+    size_t j = mid;
+    size_t end = ctx->bounds[first + 2];
 
-    size_t i;
-    for (i = 0; i < playlist->items.size; ++i)
+    while (i < mid && j < end)
     {
-        array[i] = vlc_playlist_item_meta_New(i, playlist->items.data[i],
-                                              criteria, count);
-        if (unlikely(!array[i]))
-            break;
+        if (compare_meta(&ctx->array[j], &ctx->array[i], &ctx->req) < 0)
+            ctx->tmp[out++] = ctx->array[j++];
+        else
+            ctx->tmp[out++] = ctx->array[i++];
     }
+    memcpy(&ctx->tmp[out], &ctx->array[i], (mid - i) * sizeof(*ctx->array));
+    out += mid - i;
+    memcpy(&ctx->tmp[out], &ctx->array[j], (end - j) * sizeof(*ctx->array));
+}
+
+static int
+sort_context_Sort(struct sort_context *ctx)
+{
+    size_t size = ctx->playlist->items.size;
+
+    ctx->bounds[0] = 0;
+    for (unsigned i = 1; i <= ctx->runs; ++i)
+        ctx->bounds[i] = size * i / ctx->runs;
 
-    if (i < playlist->items.size)
+    sort_context_RunTasks(ctx, ctx->runs, sort_context_SortRun);
+    if (unlikely(ctx->error != VLC_SUCCESS))
+        return ctx->error;
+
+    while (ctx->runs > 1)
     {
-        /* allocation failure */
-        vlc_playlist_DeleteMetaArray(array, i);
-        return NULL;
+        unsigned merged = (ctx->runs + 1) / 2;
+        sort_context_RunTasks(ctx, merged, sort_context_MergeRuns);
+
+        struct vlc_playlist_item_meta **array = ctx->array;
+        ctx->array = ctx->tmp;
+        ctx->tmp = array;
+
+        for (unsigned i = 1; i < merged; ++i)
+            ctx->bounds[i] = ctx->bounds[2 * i];
+        ctx->bounds[merged] = size;
+        ctx->runs = merged;
     }
+    return VLC_SUCCESS;
+}
 
-    return array;
+static unsigned
+vlc_playlist_SortThreads(size_t size)
+{
+    if (size < SORT_PARALLEL_MIN_ITEMS)
+        return 1;
+
+    unsigned threads = vlc_GetCPUCount();
+    if (threads > SORT_MAX_THREADS)
+        threads = SORT_MAX_THREADS;
+    return threads;
 }
 
 int
@@ -449,24 +606,63 @@ vlc_playlist_Sort(vlc_playlist_t *playlist,
     assert(count > 0);
     vlc_playlist_AssertLocked(playlist);
 
+    size_t size = playlist->items.size;
+    if (size < 2)
+        /* nothing to sort */
+        return VLC_SUCCESS;
+
     vlc_playlist_item_t *current = playlist->current != -1
                                  ? playlist->items.data[playlist->current]
                                  : NULL;
 
-    struct vlc_playlist_item_meta **array =
-        vlc_playlist_NewMetaArray(playlist, criteria, count);
-    if (unlikely(!array))
+    struct sort_context ctx = {
+        .playlist = playlist,
+        .req = { criteria, count },
+        .runs = vlc_playlist_SortThreads(size),
+        .error = VLC_SUCCESS,
+    };
+    vlc_mutex_init(&ctx.lock);
+
+    ctx.metas = vlc_alloc(size, sizeof(*ctx.metas));
+    ctx.array = vlc_alloc(size, sizeof(*ctx.array));
+    ctx.tmp = ctx.runs > 1 ? vlc_alloc(size, sizeof(*ctx.tmp)) : NULL;
+    if (unlikely(!ctx.metas || !ctx.array || (ctx.runs > 1 && !ctx.tmp)))
+    {
+        free(ctx.metas);
+        free(ctx.array);
+        free(ctx.tmp);
         return VLC_ENOMEM;
+    }
 
-    struct sort_request req = { criteria, count };
+    if (ctx.runs > 1)
+    {
+        /* the calling thread sorts a run too */
+        ctx.executor = vlc_executor_New(ctx.runs - 1);
+        if (!ctx.executor)
+            ctx.runs = 1;
+    }
+
+    int ret = sort_context_Sort(&ctx);
 
-    vlc_qsort(array, playlist->items.size, sizeof(*array), compare_meta, &req);
+    if (ctx.executor)
+        vlc_executor_Delete(ctx.executor);
+
+    if (ret == VLC_SUCCESS)
+    {
+        /* apply the sorting result to the playlist */
+        for (size_t i = 0; i < size; ++i)
+            playlist->items.data[i] = ctx.array[i]->item;
+        vlc_playlist_InvalidateIndex(playlist, 0);
+    }
 
-    /* apply the sorting result to the playlist */
-    for (size_t i = 0; i < playlist->items.size; ++i)
-        playlist->items.data[i] = array[i]->item;
+    for (size_t i = 0; i < size; ++i)
+        vlc_playlist_item_meta_DestroyFields(&ctx.metas[i]);
+    free(ctx.metas);
+    free(ctx.array);
+    free(ctx.tmp);
 
-    vlc_playlist_DeleteMetaArray(array, playlist->items.size);
+    if (ret != VLC_SUCCESS)
+        return ret;
 
     struct vlc_playlist_state state;
     if (current)
@@ -25,6 +25,9 @@
 #endif
 
 #include <stdio.h>
+#include <vlc_common.h>
+#include <vlc_strings.h>
+#include "content.h"
 #include "item.h"
 #include "playlist.h"
 #include "preparse.h"
@@ -1065,6 +1068,83 @@ test_index_of(void)
     vlc_playlist_Delete(playlist);
 }
 
+/* compare the indexed lookups with a linear search */
+static void
+CheckIndices(vlc_playlist_t *playlist, input_item_t *const media[],
+             size_t media_count)
+{
+    for (size_t i = 0; i < playlist->items.size; ++i)
+    {
+        vlc_playlist_item_t *item = playlist->items.data[i];
+        assert(vlc_playlist_IndexOf(playlist, item) == (ssize_t) i);
+        assert(vlc_playlist_IndexOfId(playlist, item->id) == (ssize_t) i);
+    }
+
+    for (size_t i = 0; i < media_count; ++i)
+    {
+        ssize_t expected = -1;
+        for (size_t j = 0; j < playlist->items.size; ++j)
+            if (playlist->items.data[j]->media == media[i])
+            {
+                expected = j;
+                break;
+            }
+        assert(vlc_playlist_IndexOfMedia(playlist, media[i]) == expected);
+    }
+
+    assert(vlc_playlist_IndexOfId(playlist, playlist->idgen) == -1);
+}
+
+static void
+test_index_of_after_changes(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL, VLC_PLAYLIST_PREPARSING_DISABLED, 0, 0);
+    assert(playlist);
+
+    input_item_t *media[10];
+    CreateDummyMediaArray(media, 10);
+
+    /* add the same media several times */
+    for (int i = 0; i < 8; ++i)
+    {
+        int ret = vlc_playlist_Append(playlist, media, 10);
+        assert(ret == VLC_SUCCESS);
+    }
+    CheckIndices(playlist, media, 10);
+
+    vlc_playlist_RemoveOne(playlist, 0);
+    vlc_playlist_Remove(playlist, 20, 15);
+    CheckIndices(playlist, media, 10);
+
+    int ret = vlc_playlist_Insert(playlist, 3, &media[5], 5);
+    assert(ret == VLC_SUCCESS);
+    vlc_playlist_Move(playlist, 40, 10, 2);
+    CheckIndices(playlist, media, 10);
+
+    vlc_playlist_Move(playlist, 0, 10, 50);
+    vlc_playlist_Remove(playlist, 59, 10);
+    CheckIndices(playlist, media, 10);
+
+    ret = vlc_playlist_Expand(playlist, 10, media, 3);
+    assert(ret == VLC_SUCCESS);
+    CheckIndices(playlist, media, 10);
+
+    vlc_playlist_Shuffle(playlist);
+    CheckIndices(playlist, media, 10);
+
+    /* remove all the items of a media */
+    ssize_t index;
+    while ((index = vlc_playlist_IndexOfMedia(playlist, media[7])) != -1)
+        vlc_playlist_RemoveOne(playlist, index);
+    CheckIndices(playlist, media, 10);
+
+    vlc_playlist_Clear(playlist);
+    CheckIndices(playlist, media, 10);
+
+    DestroyMediaArray(media, 10);
+    vlc_playlist_Delete(playlist);
+}
+
 static void
 test_prev(void)
 {
@@ -2423,6 +2503,87 @@ test_stable_sort(void)
     vlc_playlist_Delete(playlist);
 }
 
+static void
+test_sort_large(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL, VLC_PLAYLIST_PREPARSING_DISABLED, 0, 0);
+    assert(playlist);
+
+    /* large enough to be sorted in parallel */
+    size_t count = 40000;
+    input_item_t **media = vlc_alloc(count, sizeof(*media));
+    assert(media);
+    for (size_t i = 0; i < count; ++i)
+    {
+        media[i] = CreateDummyMedia((i * 7919) % 1000);
+        assert(media[i]);
+        media[i]->i_duration = (i * 31) % 100;
+    }
+    /* compared case-insensitively */
+    input_item_SetArtist(media[0], "b");
+    input_item_SetArtist(media[1], "A");
+    input_item_SetArtist(media[2], "c");
+
+    int ret = vlc_playlist_Append(playlist, media, count);
+    assert(ret == VLC_SUCCESS);
+
+    struct callback_ctx ctx = CALLBACK_CTX_INITIALIZER;
+    struct vlc_playlist_callbacks cbs = {
+        .on_items_reset = callback_on_items_reset,
+    };
+    vlc_playlist_listener_id *listener =
+            vlc_playlist_AddListener(playlist, &cbs, &ctx, false);
+    assert(listener);
+
+    struct vlc_playlist_sort_criterion criteria[] = {
+        { VLC_PLAYLIST_SORT_KEY_TITLE, VLC_PLAYLIST_SORT_ORDER_ASCENDING },
+        { VLC_PLAYLIST_SORT_KEY_DURATION, VLC_PLAYLIST_SORT_ORDER_DESCENDING },
+    };
+    ret = vlc_playlist_Sort(playlist, criteria, 2);
+    assert(ret == VLC_SUCCESS);
+    assert(ctx.vec_items_reset.size == 1);
+    assert(ctx.vec_items_reset.data[0].count == count);
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        input_item_t *a = vlc_playlist_Get(playlist, i - 1)->media;
+        input_item_t *b = vlc_playlist_Get(playlist, i)->media;
+        int cmp = vlc_filenamecmp(a->psz_name, b->psz_name);
+        assert(cmp <= 0);
+        assert(cmp < 0 || a->i_duration >= b->i_duration);
+    }
+
+    /* stable: the items equal for both criteria keep their order */
+    size_t prev = vlc_playlist_IndexOfMedia(playlist, media[0]);
+    for (size_t i = 1000; i < count; i += 1000)
+    {
+        /* media[i] has the same title and duration as media[0] */
+        size_t index = vlc_playlist_IndexOfMedia(playlist, media[i]);
+        assert(index == prev + 1);
+        prev = index;
+    }
+
+    struct vlc_playlist_sort_criterion by_artist = {
+        VLC_PLAYLIST_SORT_KEY_ARTIST, VLC_PLAYLIST_SORT_ORDER_DESCENDING,
+    };
+    ret = vlc_playlist_Sort(playlist, &by_artist, 1);
+    assert(ret == VLC_SUCCESS);
+    assert(ctx.vec_items_reset.size == 2);
+
+    assert(vlc_playlist_Get(playlist, 0)->media == media[2]);
+    assert(vlc_playlist_Get(playlist, 1)->media == media[0]);
+    assert(vlc_playlist_Get(playlist, 2)->media == media[1]);
+
+    vlc_playlist_Shuffle(playlist);
+    assert(ctx.vec_items_reset.size == 3);
+
+    callback_ctx_destroy(&ctx);
+    vlc_playlist_RemoveListener(playlist, listener);
+    DestroyMediaArray(media, count);
+    free(media);
+    vlc_playlist_Delete(playlist);
+}
+
 #undef EXPECT_AT
 
 int main(void)
@@ -2441,6 +2602,7 @@ int main(void)
     test_playback_order_changed_callbacks();
     test_callbacks_on_add_listener();
     test_index_of();
+    test_index_of_after_changes();
     test_prev();
     test_next();
     test_goto();
@@ -2459,6 +2621,7 @@ int main(void)
     test_shuffle();
     test_sort();
     test_stable_sort();
+    test_sort_large();
     return 0;
 }
 
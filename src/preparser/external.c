@@ -16,6 +16,7 @@
 #endif
 
 #include <assert.h>
+#include <limits.h>
 
 #include <vlc_common.h>
 #include <vlc_configuration.h>
@@ -38,6 +39,11 @@
 
 #define VLC_PREPARSER_PATH "vlc-preparser"
 
+/* Number of requests sent to a process before receiving their responses. The
+ * process handles them one by one, but it can start the next one as soon as
+ * it has sent a response. */
+#define PREPARSER_PIPELINE_DEPTH 2
+
 /*****************************************************************************
  * Preparser serdes callbacks functions
  *****************************************************************************/
@@ -46,6 +52,9 @@ struct preparser_serdes_cbs_ctx {
     vlc_tick_t timeout;
     vlc_tick_t start;
     struct vlc_process *process;
+
+    /* The process closed its end of the pipe */
+    bool eof;
 };
 
 static ssize_t
@@ -66,6 +75,9 @@ write_cbs(const void *data, size_t size, void *userdata)
     }
 
     int ret = vlc_process_fd_Write(ctx->process, data, size, timeout_ms);
+    if (ret < 0 && (errno == EPIPE || errno == ECONNRESET)) {
+        ctx->eof = true;
+    }
     return ret;
 }
 
@@ -87,6 +99,11 @@ read_cbs(void *data, size_t size, void *userdata)
     }
 
     int ret = vlc_process_fd_Read(ctx->process, data, size, timeout_ms);
+    /* The connection is reset if the process exits without reading the
+     * requests sent in advance */
+    if (ret == 0 || (ret < 0 && (errno == EPIPE || errno == ECONNRESET))) {
+        ctx->eof = true;
+    }
     return ret;
 }
 
@@ -128,8 +145,9 @@ struct preparser_process_thread {
     /* Status of the current thread */
     bool stopped;
 
-    /* The current task */
-    struct preparser_task *task;
+    /* The tasks sent to the process, in the order of their responses */
+    struct preparser_task *tasks[PREPARSER_PIPELINE_DEPTH];
+    size_t ntasks;
 
     /* The thread serializer */
     struct vlc_preparser_msg_serdes *serdes;
@@ -163,6 +181,7 @@ struct preparser_task {
 
     /* Thread interrupt */
     vlc_interrupt_t *interrupt;
+    bool cancelled;
 
     /** Preparser callbacks */
     union preparser_task_cbs cbs;
@@ -241,43 +260,58 @@ preparser_task_ExecCallback(struct preparser_task *task, int status)
 }
 
 /**
- * Execute a task: Send a request and wait for a response then call callbacks.
+ * Send the request of a task.
  */
 static int
-preparser_task_Run(struct preparser_process_thread *thread, vlc_tick_t timeout)
+preparser_task_Send(struct preparser_process_thread *thread,
+                    struct preparser_task *task, vlc_tick_t timeout,
+                    bool *eof)
 {
-    vlc_thread_set_name("vlc-task-run");
-
     assert(thread != NULL);
     assert(thread->process != NULL);
-    assert(thread->task != NULL);
-
-    struct preparser_task *task = thread->task;
-    assert(task->item != NULL);
+    assert(task != NULL);
 
     struct preparser_serdes_cbs_ctx serdes_ctx = {
         .start = vlc_tick_now(),
         .timeout = timeout,
         .process = thread->process,
+        .eof = false,
     };
 
-    int status = VLC_SUCCESS;
     int ret = vlc_preparser_msg_serdes_Serialize(thread->serdes,
                                                  &task->req_msg, &serdes_ctx);
-    if (ret != VLC_SUCCESS) {
-        status = ret;
-        goto end;
-    }
+    *eof = serdes_ctx.eof;
+    return ret;
+}
 
-    ret = vlc_preparser_msg_serdes_Deserialize(thread->serdes, &task->res_msg,
-                                               &serdes_ctx);
-    if (ret != VLC_SUCCESS) {
-        status = ret;
-    }
+/**
+ * Wait for the response of a task.
+ *
+ * The timeout starts now: the process only handles this request once it has
+ * answered the previous ones.
+ */
+static int
+preparser_task_Receive(struct preparser_process_thread *thread,
+                       struct preparser_task *task, vlc_tick_t timeout,
+                       bool *eof)
+{
+    assert(thread != NULL);
+    assert(thread->process != NULL);
+    assert(task != NULL);
+    assert(task->item != NULL);
 
-end:
-    preparser_task_ExecCallback(task, status);
-    return status;
+    struct preparser_serdes_cbs_ctx serdes_ctx = {
+        .start = vlc_tick_now(),
+        .timeout = timeout,
+        .process = thread->process,
+        .eof = false,
+    };
+
+    int ret = vlc_preparser_msg_serdes_Deserialize(thread->serdes,
+                                                   &task->res_msg,
+                                                   &serdes_ctx);
+    *eof = serdes_ctx.eof;
+    return ret;
 }
 
 static struct vlc_preparser_req *
@@ -358,6 +392,7 @@ preparser_task_New(input_item_t *item,
     }
 
     task->item = input_item_Hold(item);
+    task->cancelled = false;
     task->cbs_userdata = NULL;
     vlc_list_init(&task->node);
 
@@ -505,6 +540,7 @@ struct preparser_process_pool {
     /** Preparser process arguments */
     vlc_tick_t timeout;
     int types;
+    unsigned max_memory;
 
     char **argv;
     int argc;
@@ -529,15 +565,16 @@ preparser_pool_QueuePush(struct preparser_process_pool *pool,
 }
 
 /**
- * Take a task on the queue or wait for a new one to be added.
+ * Take a task on the queue, or wait for a new one to be added if `wait` is
+ * true.
  */
 static struct preparser_task*
-preparser_pool_QueueTake(struct preparser_process_pool *pool)
+preparser_pool_QueueTake(struct preparser_process_pool *pool, bool wait)
 {
     assert(pool != NULL);
     vlc_mutex_assert(&pool->lock);
 
-    while (!pool->closing && vlc_list_is_empty(&pool->queue)) {
+    while (wait && !pool->closing && vlc_list_is_empty(&pool->queue)) {
         vlc_cond_wait(&pool->queue_wait, &pool->lock);
     }
 
@@ -548,8 +585,9 @@ preparser_pool_QueueTake(struct preparser_process_pool *pool)
     struct preparser_task *task = NULL;
     task = vlc_list_first_entry_or_null(&pool->queue, struct preparser_task,
                                         node);
-    assert(task != NULL);
-    vlc_list_remove(&task->node);
+    if (task != NULL) {
+        vlc_list_remove(&task->node);
+    }
 
     return task;
 }
@@ -570,12 +608,20 @@ preparser_pool_SpawnProcess(struct preparser_process_thread *thread)
         free(str_timeout);
         return VLC_ENOMEM;
     }
+    char *str_memory = NULL;
+    if (asprintf(&str_memory, "%u", pool->max_memory) < 0) {
+        free(str_timeout);
+        free(str_types);
+        return VLC_ENOMEM;
+    }
 
     const char *argv[] = {
         "--timeout-tick",
         str_timeout,
         "--types",
         str_types,
+        "--max-memory",
+        str_memory,
         "--daemon",
         NULL,
     };
@@ -601,6 +647,7 @@ preparser_pool_SpawnProcess(struct preparser_process_thread *thread)
                          lib_path, static_name) < 0) {
                 free(str_timeout);
                 free(str_types);
+                free(str_memory);
                 return VLC_ENOMEM;
             }
         }
@@ -619,6 +666,7 @@ preparser_pool_SpawnProcess(struct preparser_process_thread *thread)
     free(path);
     free(str_timeout);
     free(str_types);
+    free(str_memory);
 
     if (thread->process == NULL) {
         return VLC_EGENERIC;
@@ -626,9 +674,100 @@ preparser_pool_SpawnProcess(struct preparser_process_thread *thread)
     return VLC_SUCCESS;
 }
 
+/**
+ * Remove a finished task from the pool and delete it.
+ */
+static void
+preparser_pool_FinishTask(struct preparser_process_pool *pool,
+                          struct preparser_task *task)
+{
+    vlc_mutex_assert(&pool->lock);
+
+    preparser_task_Delete(task);
+    assert(pool->unfinished > 0);
+    --pool->unfinished;
+}
+
+/**
+ * Restart the process after a failure and reschedule the pending tasks.
+ *
+ * The process may have exited on its own after its last response, to release
+ * its memory: the tasks sent in advance are then queued again. Otherwise, the
+ * `failed` task ends with `status` and the other tasks are queued again.
+ *
+ * Return false if the thread must stop.
+ */
+static bool
+preparser_pool_Recover(struct preparser_process_thread *thread,
+                       struct preparser_task *failed, int status, bool eof)
+{
+    struct preparser_process_pool *pool = thread->owner;
+    vlc_mutex_assert(&pool->lock);
+
+    int exit_status = vlc_process_Terminate(thread->process, !eof);
+    thread->process = NULL;
+    thread->process_running = false;
+
+    bool recycled = eof && exit_status == 0;
+    if (recycled) {
+        msg_Dbg(pool->parent, "preparser process recycled");
+    }
+
+    /* If preparser_task_Receive fails, it may indicate that the preparser is
+     * stuck or not functioning correctly. In this case, the process is
+     * stopped and deleted. Since the thread is not supposed to exit on its
+     * own, it restarts the process unless the pool is shutting down. */
+    int ret = VLC_EGENERIC;
+    if (!pool->closing) {
+        ret = preparser_pool_SpawnProcess(thread);
+        if (ret == VLC_SUCCESS) {
+            thread->process_running = true;
+        }
+    }
+
+    struct preparser_task *ended[PREPARSER_PIPELINE_DEPTH];
+    int ended_status[PREPARSER_PIPELINE_DEPTH];
+    size_t nended = 0;
+
+    /* Reversed, to keep the order of the tasks queued again */
+    for (size_t i = thread->ntasks; i-- > 0;) {
+        struct preparser_task *task = thread->tasks[i];
+        vlc_list_remove(&task->node);
+
+        int task_status;
+        if (task == failed && !recycled) {
+            task_status = status;
+        } else if (pool->closing || task->cancelled) {
+            task_status = -EINTR;
+        } else if (ret != VLC_SUCCESS) {
+            task_status = ret;
+        } else {
+            vlc_list_prepend(&task->node, &pool->queue);
+            vlc_cond_signal(&pool->queue_wait);
+            continue;
+        }
+        ended[nended] = task;
+        ended_status[nended++] = task_status;
+    }
+    thread->ntasks = 0;
+
+    vlc_mutex_unlock(&pool->lock);
+    for (size_t i = nended; i-- > 0;) {
+        preparser_task_ExecCallback(ended[i], ended_status[i]);
+    }
+    vlc_mutex_lock(&pool->lock);
+
+    for (size_t i = 0; i < nended; i++) {
+        preparser_pool_FinishTask(pool, ended[i]);
+    }
+
+    return ret == VLC_SUCCESS;
+}
+
 /**
  * Process thread loop.
- * Take a task on the queue, then execute the task and delete it.
+ * Take tasks on the queue and send them to the process ahead of time, then
+ * wait for their responses in order, execute their callbacks and delete them.
  * Check that the external process has not crashed otherwise start a new one.
  */
 static void*
@@ -638,58 +777,84 @@ preparser_pool_Run(void *data)
     assert(thread != NULL);
     assert(thread->owner != NULL);
     assert(thread->process != NULL);
+    struct preparser_process_pool *pool = thread->owner;
 
     vlc_thread_set_name("vlc-pool-runner");
 
+    vlc_mutex_lock(&pool->lock);
+    for (;;) {
+        struct preparser_task *task = NULL;
+        int status = VLC_SUCCESS;
+        bool eof = false;
 
-    vlc_mutex_lock(&thread->owner->lock);
-    struct preparser_task *task = NULL;
-    while ((task = preparser_pool_QueueTake(thread->owner))) {
-        thread->task = task;
-        vlc_list_append(&task->node, &thread->owner->running);
+        /* Only wait for a new task if there is no response to wait for */
+        while (thread->ntasks < PREPARSER_PIPELINE_DEPTH
+            && (task = preparser_pool_QueueTake(pool, thread->ntasks == 0))) {
+            thread->tasks[thread->ntasks++] = task;
+            vlc_list_append(&task->node, &pool->running);
 
-        vlc_tick_t timeout = thread->owner->timeout;
-        vlc_interrupt_t *old = vlc_interrupt_set(task->interrupt);
+            vlc_tick_t timeout = pool->timeout;
+            vlc_interrupt_t *old = vlc_interrupt_set(task->interrupt);
 
-        vlc_mutex_unlock(&thread->owner->lock);
-        int status = preparser_task_Run(thread, timeout);
-        vlc_mutex_lock(&thread->owner->lock);
+            vlc_mutex_unlock(&pool->lock);
+            status = preparser_task_Send(thread, task, timeout, &eof);
+            vlc_mutex_lock(&pool->lock);
 
-        vlc_thread_set_name("vlc-pool-runner");
-        vlc_interrupt_set(old);
+            vlc_interrupt_set(old);
+            if (status != VLC_SUCCESS) {
+                break;
+            }
+        }
 
-        vlc_list_remove(&task->node);
-        preparser_task_Delete(task);
-        thread->task = NULL;
+        if (thread->ntasks == 0) {
+            /* The pool is closing */
+            break;
+        }
 
-        assert(thread->owner->unfinished > 0);
-        --thread->owner->unfinished;
+        if (status == VLC_SUCCESS) {
+            task = thread->tasks[0];
 
-        if (thread->owner->closing) {
-            break;
+            vlc_tick_t timeout = pool->timeout;
+            vlc_interrupt_t *old = vlc_interrupt_set(task->interrupt);
+
+            vlc_mutex_unlock(&pool->lock);
+            status = preparser_task_Receive(thread, task, timeout, &eof);
+            if (status == VLC_SUCCESS) {
+                preparser_task_ExecCallback(task, VLC_SUCCESS);
+            }
+            vlc_mutex_lock(&pool->lock);
+
+            vlc_thread_set_name("vlc-pool-runner");
+            vlc_interrupt_set(old);
         }
 
         if (status == VLC_SUCCESS) {
-            continue;
+            vlc_list_remove(&task->node);
+            thread->ntasks--;
+            memmove(&thread->tasks[0], &thread->tasks[1],
+                    thread->ntasks * sizeof(*thread->tasks));
+            preparser_pool_FinishTask(pool, task);
+
+            if (!pool->closing) {
+                continue;
+            }
+            if (thread->ntasks == 0) {
+                break;
+            }
+            /* Don't wait for the responses of the other tasks */
+            status = -EINTR;
+            task = NULL;
         }
 
-        /* If preparser_task_Run fails, it may indicate that the preparser is
-         * stuck or not functioning correctly. In this case, the process is
-         * stopped and deleted. Since the thread is not supposed to exit on
-         * its own, it repeatedly attempts to restart the process every second
-         * until it succeeds or the pool is shutting down. */
-        vlc_process_Terminate(thread->process, true);
-        thread->process_running = false;
-        if (preparser_pool_SpawnProcess(thread) != VLC_SUCCESS) {
-            goto end;
+        if (!preparser_pool_Recover(thread, task, status, eof)) {
+            break;
         }
-        thread->process_running = true;
     }
-end:
-    thread->owner->nthreads--;
-    thread->owner->nthreads_stopped++;
+    assert(thread->ntasks == 0);
+    pool->nthreads--;
+    pool->nthreads_stopped++;
     thread->stopped = true;
-    vlc_mutex_unlock(&thread->owner->lock);
+    vlc_mutex_unlock(&pool->lock);
     return NULL;
 }
 
@@ -709,7 +874,7 @@ preparser_pool_SpawnThreadLocked(struct preparser_process_pool *pool)
     }
 
     thread->owner = pool;
-    thread->task = NULL;
+    thread->ntasks = 0;
     thread->stopped = false;
 
     static struct vlc_preparser_msg_serdes_cbs cbs = {
@@ -865,6 +1030,8 @@ preparser_pool_Cancel(struct preparser_process_pool *pool,
     vlc_list_foreach(task, &pool->running, node) {
         if (req == NULL || req == &task->req) {
             count++;
+            /* The task must not be queued again if its process is restarted */
+            task->cancelled = true;
             if (task->interrupt != NULL) {
                 vlc_interrupt_raise(task->interrupt);
             }
@@ -925,7 +1092,7 @@ preparser_pool_Delete(struct preparser_process_pool *pool)
  */
 static struct preparser_process_pool*
 preparser_pool_New(vlc_object_t *obj, size_t max, vlc_tick_t timeout,
-                   int types)
+                   int types, unsigned max_memory)
 {
     assert(obj != NULL);
     assert(max != 0);
@@ -943,6 +1110,7 @@ preparser_pool_New(vlc_object_t *obj, size_t max, vlc_tick_t timeout,
     pool->unfinished = 0;
     pool->timeout = timeout;
     pool->types = types;
+    pool->max_memory = max_memory;
 
     vlc_list_init(&pool->threads);
     vlc_list_init(&pool->queue);
@@ -1153,6 +1321,12 @@ void *vlc_preparser_external_New(vlc_preparser_t *owner, vlc_object_t *parent,
     sys->pool_preparser = NULL;
     sys->pool_thumbnailer = NULL;
 
+    /* Maximum memory of a process (in MiB) before it is recycled */
+    int64_t max_memory = var_InheritInteger(parent, "preparse-process-memory");
+    if (max_memory < 0 || max_memory > UINT_MAX) {
+        max_memory = 0;
+    }
+
     if (cfg->types & VLC_PREPARSER_TYPE_PARSE) {
         size_t nprocess = cfg->max_parser_threads;
         if (nprocess == 0) {
@@ -1160,7 +1334,7 @@ void *vlc_preparser_external_New(vlc_preparser_t *owner, vlc_object_t *parent,
         }
         sys->pool_preparser = preparser_pool_New(parent, nprocess,
                                                  cfg->timeout,
-                                                 cfg->types);
+                                                 cfg->types, max_memory);
         if (sys->pool_preparser == NULL) {
             goto end;
         }
@@ -1174,7 +1348,7 @@ void *vlc_preparser_external_New(vlc_preparser_t *owner, vlc_object_t *parent,
         }
         sys->pool_thumbnailer = preparser_pool_New(parent, nprocess,
                                                    cfg->timeout,
-                                                   cfg->types);
+                                                   cfg->types, max_memory);
         if (sys->pool_thumbnailer == NULL) {
             goto end;
         }
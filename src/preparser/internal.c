@@ -485,6 +485,37 @@ error:
     free(result_array);
 }
 
+/**
+ * Returns the smallest picture size that still fits all the outputs, or 0x0
+ * if one of them keeps the original size
+ */
+static struct input_thumbnail_cfg
+GetThumbnailCfg(const struct vlc_preparser_req_owner *req_owner,
+                bool keyframe_only)
+{
+    struct input_thumbnail_cfg cfg = {
+        .keyframe_only = keyframe_only,
+    };
+
+    for (size_t i = 0; i < req_owner->output_count; ++i)
+    {
+        const struct task_thumbnail_output *output = &req_owner->outputs[i];
+
+        if (output->fourcc == VLC_CODEC_UNKNOWN)
+            continue;
+        if (output->width <= 0 && output->height <= 0)
+        {
+            cfg.width = cfg.height = 0;
+            return cfg;
+        }
+        if (output->width > 0 && (unsigned)output->width > cfg.width)
+            cfg.width = output->width;
+        if (output->height > 0 && (unsigned)output->height > cfg.height)
+            cfg.height = output->height;
+    }
+    return cfg;
+}
+
 static void
 ThumbnailerRun(void *userdata)
 {
@@ -498,12 +529,21 @@ ThumbnailerRun(void *userdata)
         .on_event = on_thumbnailer_input_event,
     };
 
+    assert(req_owner->thumb_arg.seek.speed == VLC_THUMBNAILER_SEEK_PRECISE
+        || req_owner->thumb_arg.seek.speed == VLC_THUMBNAILER_SEEK_FAST
+        || req_owner->thumb_arg.seek.speed == VLC_THUMBNAILER_SEEK_KEYFRAME);
+    bool keyframe_only =
+        req_owner->thumb_arg.seek.speed == VLC_THUMBNAILER_SEEK_KEYFRAME;
+    bool fast_seek = keyframe_only
+        || req_owner->thumb_arg.seek.speed == VLC_THUMBNAILER_SEEK_FAST;
+
     const struct vlc_input_thread_cfg cfg = {
         .type = INPUT_TYPE_THUMBNAILING,
         .hw_dec = req_owner->thumb_arg.hw_dec ? INPUT_CFG_HW_DEC_ENABLED
                                         : INPUT_CFG_HW_DEC_DISABLED,
         .cbs = &cbs,
         .cbs_data = req,
+        .thumbnailing = GetThumbnailCfg(req_owner, keyframe_only),
     };
 
     vlc_tick_t deadline = preparser->timeout != VLC_TICK_INVALID ?
@@ -515,10 +555,6 @@ ThumbnailerRun(void *userdata)
     if (!input)
         goto error;
 
-    assert(req_owner->thumb_arg.seek.speed == VLC_THUMBNAILER_SEEK_PRECISE
-        || req_owner->thumb_arg.seek.speed == VLC_THUMBNAILER_SEEK_FAST);
-    bool fast_seek = req_owner->thumb_arg.seek.speed == VLC_THUMBNAILER_SEEK_FAST;
-
     switch (req_owner->thumb_arg.seek.type)
     {
         case VLC_THUMBNAILER_SEEK_NONE:
@@ -661,9 +697,12 @@ preparser_Push( void *opaque, input_item_t *item,
     {
         PreparserAddTask(preparser, req);
 
+        /* The task may end (and release its reference) before the executor
+         * returns */
+        PreparserRequestRetain(req);
         vlc_executor_Submit(preparser->parser, &req_owner->runnable);
 
-        return PreparserRequestRetain(req);
+        return req;
     }
 
     int ret = Fetch(req);
@@ -696,9 +735,12 @@ preparser_GenerateThumbnail( void *opaque, input_item_t *item,
 
     struct vlc_preparser_req_owner *req_owner = preparser_req_get_owner(req);
 
+    /* The task may end (and release its reference) before the executor
+     * returns */
+    PreparserRequestRetain(req);
     vlc_executor_Submit(preparser->thumbnailer, &req_owner->runnable);
 
-    return PreparserRequestRetain(req);
+    return req;
 }
 
 static int
@@ -835,9 +877,12 @@ preparser_GenerateThumbnailToFiles( void *opaque, input_item_t *item,
 
     PreparserAddTask(preparser, req);
 
+    /* The task may end (and release its reference) before the executor
+     * returns */
+    PreparserRequestRetain(req);
     vlc_executor_Submit(preparser->thumbnailer, &req_owner->runnable);
 
-    return PreparserRequestRetain(req);
+    return req;
 }
 
 static size_t preparser_Cancel( void *opaque, vlc_preparser_req *req )
@@ -0,0 +1,254 @@
+/*****************************************************************************
+ * pcm_bench.c: PCM volume and format conversion benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+#include <vlc_aout.h>
+#include <vlc_aout_volume.h>
+#include <vlc_filter.h>
+#include <vlc_tick.h>
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#define BENCH_SAMPLES   (1024 * 1024)
+#define BENCH_LOOPS     64
+
+static size_t SampleSize(vlc_fourcc_t codec)
+{
+    return aout_BitsPerSample(codec) / 8;
+}
+
+/* Pseudo random full scale signal, with a few out of range float samples */
+static void FillSamples(vlc_fourcc_t codec, void *buf, size_t count)
+{
+    uint32_t seed = 0x56434C00;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        switch (codec)
+        {
+            case VLC_CODEC_S16N:
+                ((int16_t *)buf)[i] = seed >> 16;
+                break;
+            case VLC_CODEC_S32N:
+                ((int32_t *)buf)[i] = seed;
+                break;
+            case VLC_CODEC_FL32:
+                ((float *)buf)[i] = (int32_t)seed * 0x1.2p-31f;
+                break;
+            case VLC_CODEC_FL64:
+                ((double *)buf)[i] = (int32_t)seed * 0x1.2p-31;
+                break;
+        }
+    }
+}
+
+/*** Volume ***/
+static block_t *Amplify(vlc_object_t *obj, vlc_fourcc_t codec,
+                        const char *name, const block_t *in, float amp,
+                        vlc_tick_t *elapsed)
+{
+    audio_volume_t *volume = vlc_object_create(obj, sizeof (*volume));
+    if (volume == NULL)
+        return NULL;
+    volume->format = codec;
+
+    module_t *module = module_need(volume, "audio volume", name, true);
+    if (module == NULL)
+    {
+        vlc_object_delete(volume);
+        return NULL;
+    }
+
+    block_t *out = block_Alloc(in->i_buffer);
+    if (out != NULL)
+    {
+        *elapsed = 0;
+        for (unsigned i = 0; i < BENCH_LOOPS; i++)
+        {
+            memcpy(out->p_buffer, in->p_buffer, in->i_buffer);
+            vlc_tick_t start = vlc_tick_now();
+            volume->amplify(volume, out, amp);
+            *elapsed += vlc_tick_now() - start;
+        }
+    }
+
+    module_unneed(volume, module);
+    vlc_object_delete(volume);
+    return out;
+}
+
+static void BenchVolume(vlc_object_t *obj, vlc_fourcc_t codec,
+                        const char *ref_name, float amp)
+{
+    block_t *in = block_Alloc(BENCH_SAMPLES * SampleSize(codec));
+    if (in == NULL)
+        return;
+    FillSamples(codec, in->p_buffer, BENCH_SAMPLES);
+
+    vlc_tick_t ref_time, simd_time;
+    block_t *ref = Amplify(obj, codec, ref_name, in, amp, &ref_time);
+    block_t *simd = Amplify(obj, codec, "volume_x86", in, amp, &simd_time);
+
+    if (ref == NULL || simd == NULL)
+        printf("volume %4.4s: %s module not available\n", (char *)&codec,
+               ref == NULL ? ref_name : "volume_x86");
+    else
+    {
+        assert(memcmp(ref->p_buffer, simd->p_buffer, in->i_buffer) == 0);
+        printf("volume %4.4s: %-14s %7.1f Msamples/s, %-14s %7.1f Msamples/s"
+               " (x%.2f)\n", (char *)&codec,
+               ref_name, BENCH_SAMPLES * BENCH_LOOPS
+                          / (1e6 * secf_from_vlc_tick(ref_time)),
+               "volume_x86", BENCH_SAMPLES * BENCH_LOOPS
+                          / (1e6 * secf_from_vlc_tick(simd_time)),
+               (double)ref_time / simd_time);
+    }
+
+    if (ref != NULL)
+        block_Release(ref);
+    if (simd != NULL)
+        block_Release(simd);
+    block_Release(in);
+}
+
+/*** Conversion ***/
+static block_t *Convert(vlc_object_t *obj, vlc_fourcc_t src, vlc_fourcc_t dst,
+                        const char *name, const block_t *in,
+                        vlc_tick_t *elapsed)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    if (filter == NULL)
+        return NULL;
+
+    audio_format_t fmt = {
+        .i_rate = 48000,
+        .i_physical_channels = AOUT_CHANS_STEREO,
+        .i_chan_mode = 0,
+    };
+    es_format_Init(&filter->fmt_in, AUDIO_ES, src);
+    fmt.i_format = src;
+    aout_FormatPrepare(&fmt);
+    filter->fmt_in.audio = fmt;
+    es_format_Init(&filter->fmt_out, AUDIO_ES, dst);
+    fmt.i_format = dst;
+    aout_FormatPrepare(&fmt);
+    filter->fmt_out.audio = fmt;
+
+    filter->p_module = module_need(filter, "audio converter", name, true);
+    if (filter->p_module == NULL)
+    {
+        vlc_object_delete(filter);
+        return NULL;
+    }
+
+    block_t *out = NULL;
+    *elapsed = 0;
+    for (unsigned i = 0; i < BENCH_LOOPS; i++)
+    {
+        if (out != NULL)
+            block_Release(out);
+
+        block_t *block = block_Alloc(in->i_buffer);
+        if (block == NULL)
+        {
+            out = NULL;
+            break;
+        }
+        memcpy(block->p_buffer, in->p_buffer, in->i_buffer);
+
+        vlc_tick_t start = vlc_tick_now();
+        out = filter->ops->filter_audio(filter, block);
+        *elapsed += vlc_tick_now() - start;
+        if (out == NULL)
+            break;
+    }
+
+    vlc_filter_Delete(filter);
+    return out;
+}
+
+static void BenchConversion(vlc_object_t *obj, vlc_fourcc_t src,
+                            vlc_fourcc_t dst)
+{
+    block_t *in = block_Alloc(BENCH_SAMPLES * SampleSize(src));
+    if (in == NULL)
+        return;
+    FillSamples(src, in->p_buffer, BENCH_SAMPLES);
+
+    vlc_tick_t ref_time, simd_time;
+    block_t *ref = Convert(obj, src, dst, "audio_format", in, &ref_time);
+    block_t *simd = Convert(obj, src, dst, "audio_format_x86", in, &simd_time);
+
+    if (ref == NULL || simd == NULL)
+        printf("%4.4s->%4.4s: %s module not available\n",
+               (char *)&src, (char *)&dst,
+               ref == NULL ? "audio_format" : "audio_format_x86");
+    else
+    {
+        assert(ref->i_buffer == simd->i_buffer);
+        assert(memcmp(ref->p_buffer, simd->p_buffer, ref->i_buffer) == 0);
+        printf("%4.4s->%4.4s: %-14s %7.1f Msamples/s, %-14s %7.1f Msamples/s"
+               " (x%.2f)\n", (char *)&src, (char *)&dst,
+               "C", BENCH_SAMPLES * BENCH_LOOPS
+                     / (1e6 * secf_from_vlc_tick(ref_time)),
+               "SIMD", BENCH_SAMPLES * BENCH_LOOPS
+                     / (1e6 * secf_from_vlc_tick(simd_time)),
+               (double)ref_time / simd_time);
+    }
+
+    if (ref != NULL)
+        block_Release(ref);
+    if (simd != NULL)
+        block_Release(simd);
+    block_Release(in);
+}
+
+int main(void)
+{
+    /* No alarm: a slow machine may need more than the test timeout */
+    test_setup();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (vlc == NULL)
+        return 1;
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    BenchVolume(obj, VLC_CODEC_FL32, "float_mixer", .8f);
+    BenchVolume(obj, VLC_CODEC_FL64, "float_mixer", .8f);
+    BenchVolume(obj, VLC_CODEC_S16N, "integer_mixer", .8f);
+    BenchVolume(obj, VLC_CODEC_S16N, "integer_mixer", 3.f);
+
+    BenchConversion(obj, VLC_CODEC_S16N, VLC_CODEC_FL32);
+    BenchConversion(obj, VLC_CODEC_FL32, VLC_CODEC_S16N);
+    BenchConversion(obj, VLC_CODEC_S32N, VLC_CODEC_FL32);
+    BenchConversion(obj, VLC_CODEC_FL32, VLC_CODEC_S32N);
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,184 @@
+/*****************************************************************************
+ * polyphase.c: polyphase resampler test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#define TEST_FRAMES 48000
+#define TEST_MARGIN 64 /* output frames skipped at both ends */
+
+static const float freqs[2] = { 1000.f, 3000.f };
+
+struct scenario
+{
+    unsigned in_rate;
+    unsigned out_rate;
+    bool low_latency;
+    float max_error;
+};
+
+static const struct scenario scenarios[] =
+{
+    { 44100, 48000, false, 1e-4f },
+    { 48000, 44100, false, 1e-4f },
+    { 48000, 96000, false, 1e-4f },
+    { 96000, 48000, false, 1e-4f },
+    { 22050, 48000, false, 1e-4f },
+    /* drift compensation like rates: interpolated phases */
+    { 48013, 48000, false, 1e-4f },
+    { 44100, 48000, true,  5e-3f },
+    { 47981, 48000, true,  5e-3f },
+};
+
+static filter_t *CreateResampler(vlc_object_t *obj, const struct scenario *sc)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    var_Create(filter, "polyphase-low-latency", VLC_VAR_BOOL);
+    var_SetBool(filter, "polyphase-low-latency", sc->low_latency);
+
+    audio_format_t fmt = {
+        .i_format = VLC_CODEC_FL32,
+        .i_physical_channels = AOUT_CHANS_STEREO,
+    };
+    fmt.i_rate = sc->in_rate;
+    aout_FormatPrepare(&fmt);
+    es_format_Init(&filter->fmt_in, AUDIO_ES, fmt.i_format);
+    filter->fmt_in.audio = fmt;
+
+    fmt.i_rate = sc->out_rate;
+    es_format_Init(&filter->fmt_out, AUDIO_ES, fmt.i_format);
+    filter->fmt_out.audio = fmt;
+
+    filter->p_module = module_need(filter, "audio resampler", "polyphase",
+                                   true);
+    assert(filter->p_module != NULL);
+    return filter;
+}
+
+static size_t Check(const struct scenario *sc, const block_t *out,
+                    size_t done)
+{
+    const float *p = (const float *)out->p_buffer;
+
+    for (size_t i = 0; i < out->i_nb_samples; i++, done++)
+    {
+        const double t = (double)done / sc->out_rate;
+
+        for (unsigned c = 0; c < 2; c++)
+        {
+            const float expected = .5 * sin(2. * M_PI * freqs[c] * t);
+            const float v = *(p++);
+
+            assert(isfinite(v));
+            /* the first and last frames see the implicit silence */
+            if (done >= TEST_MARGIN
+             && (double)done / sc->out_rate
+                  < (double)(TEST_FRAMES - TEST_MARGIN) / sc->in_rate)
+            {
+                if (fabsf(v - expected) > sc->max_error)
+                {
+                    fprintf(stderr, "%u->%u Hz: frame %zu channel %u: "
+                            "%f instead of %f\n", sc->in_rate, sc->out_rate,
+                            done, c, v, expected);
+                    abort();
+                }
+            }
+        }
+    }
+    return done;
+}
+
+static void RunScenario(vlc_object_t *obj, const struct scenario *sc)
+{
+    filter_t *filter = CreateResampler(obj, sc);
+    size_t in_done = 0, out_done = 0;
+    unsigned chunk = 0;
+
+    while (in_done < TEST_FRAMES)
+    {
+        /* odd block sizes, down to a single frame */
+        static const unsigned sizes[] = { 1024, 1, 37, 480, 4096, 3 };
+        unsigned count = sizes[chunk++ % ARRAY_SIZE(sizes)];
+        if (count > TEST_FRAMES - in_done)
+            count = TEST_FRAMES - in_done;
+
+        block_t *in = block_Alloc(count * 2 * sizeof (float));
+        assert(in != NULL);
+        in->i_nb_samples = count;
+        in->i_pts = VLC_TICK_0 + vlc_tick_from_samples(in_done, sc->in_rate);
+
+        float *p = (float *)in->p_buffer;
+        for (unsigned i = 0; i < count; i++)
+        {
+            const double t = (double)(in_done + i) / sc->in_rate;
+            *(p++) = .5 * sin(2. * M_PI * freqs[0] * t);
+            *(p++) = .5 * sin(2. * M_PI * freqs[1] * t);
+        }
+        in_done += count;
+
+        block_t *out = filter->ops->filter_audio(filter, in);
+        assert(out != NULL);
+        out_done = Check(sc, out, out_done);
+        block_Release(out);
+    }
+
+    block_t *out = filter->ops->drain_audio(filter);
+    if (out != NULL)
+    {
+        out_done = Check(sc, out, out_done);
+        block_Release(out);
+    }
+
+    /* Every input frame made it to the output */
+    const double expected = (double)TEST_FRAMES * sc->out_rate / sc->in_rate;
+    assert(fabs(out_done - expected) <= 2.);
+
+    vlc_filter_Delete(filter);
+    printf("%u -> %u Hz%s: %zu frames\n", sc->in_rate, sc->out_rate,
+           sc->low_latency ? " (low latency)" : "", out_done);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+
+    for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++)
+        RunScenario(VLC_OBJECT(vlc->p_libvlc_int), &scenarios[i]);
+
+    libvlc_release(vlc);
+    return 0;
+}
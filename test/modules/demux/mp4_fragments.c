@@ -0,0 +1,182 @@
+/*****************************************************************************
+ * mp4_fragments.c: MP4 fragments index tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_threads.h>
+
+#define MODULE_STRING "test_demux_mp4_fragments"
+
+#include "../../../modules/demux/mp4/fragments.h"
+
+const char vlc_module_name[] = MODULE_STRING;
+
+#define ASSERT(a) do {\
+if(!(a)) { \
+        fprintf(stderr, "failed line %d\n", __LINE__); \
+        return 1; } \
+} while(0)
+
+/* Fragment i starts at pos (i + 1) * 1000, at i * 100 on track 0 and
+ * i * 100 + 10 on track 1, and ends at (i + 1) * 100 */
+#define FRAGS 10
+
+static bool AddFragment(mp4_fragments_index_t *index, unsigned i)
+{
+    const stime_t times[2] = { i * 100, i * 100 + 10 };
+    return MP4_Fragments_Index_Add(index, (i + 1) * 1000, times,
+                                   (i + 1) * 100);
+}
+
+static int CheckLookup(mp4_fragments_index_t *index)
+{
+    stime_t time;
+    uint64_t pos;
+
+    /* before the first fragment: the first one */
+    time = -5;
+    ASSERT(MP4_Fragments_Index_Lookup(index, &time, &pos, 0));
+    ASSERT(time == 0 && pos == 1000);
+
+    /* within a fragment: its start */
+    time = 250;
+    ASSERT(MP4_Fragments_Index_Lookup(index, &time, &pos, 0));
+    ASSERT(time == 200 && pos == 3000);
+
+    /* on a fragment start */
+    time = 300;
+    ASSERT(MP4_Fragments_Index_Lookup(index, &time, &pos, 0));
+    ASSERT(time == 300 && pos == 4000);
+
+    /* per track */
+    time = 305;
+    ASSERT(MP4_Fragments_Index_Lookup(index, &time, &pos, 1));
+    ASSERT(time == 210 && pos == 3000);
+
+    time = 999;
+    ASSERT(MP4_Fragments_Index_Lookup(index, &time, &pos, 0));
+    ASSERT(time == 900 && pos == 10000);
+
+    /* past the indexed fragments, or invalid track */
+    time = 1000;
+    ASSERT(!MP4_Fragments_Index_Lookup(index, &time, &pos, 0));
+    time = 0;
+    ASSERT(!MP4_Fragments_Index_Lookup(index, &time, &pos, 2));
+    return 0;
+}
+
+static int CheckTrackStartTime(mp4_fragments_index_t *index)
+{
+    stime_t time;
+
+    /* the fragment at or after the position */
+    ASSERT(MP4_Fragment_Index_GetTrackStartTime(index, 1, 3000, &time));
+    ASSERT(time == 210);
+    ASSERT(MP4_Fragment_Index_GetTrackStartTime(index, 0, 2500, &time));
+    ASSERT(time == 200);
+    ASSERT(MP4_Fragment_Index_GetTrackStartTime(index, 0, 0, &time));
+    ASSERT(time == 0);
+    ASSERT(!MP4_Fragment_Index_GetTrackStartTime(index, 0, 10001, &time));
+    return 0;
+}
+
+struct indexer
+{
+    vlc_thread_t thread;
+    mp4_fragments_index_t *index;
+};
+
+static void *Indexer(void *data)
+{
+    struct indexer *indexer = data;
+
+    vlc_tick_t date = vlc_tick_now();
+    for (unsigned i = 0; i < FRAGS; i++)
+    {
+        date += VLC_TICK_FROM_MS(1);
+        vlc_tick_wait(date);
+        AddFragment(indexer->index, i);
+    }
+    MP4_Fragments_Index_Complete(indexer->index);
+    return NULL;
+}
+
+static int CheckWait(void)
+{
+    mp4_fragments_index_t *index = MP4_Fragments_Index_New(2, 1);
+    ASSERT(index != NULL);
+
+    struct indexer indexer = { .index = index };
+    ASSERT(vlc_clone(&indexer.thread, Indexer, &indexer) == 0);
+
+    /* waits until the time is indexed */
+    MP4_Fragments_Index_Wait(index, 450);
+    ASSERT(MP4_Fragment_Index_GetTracksDuration(index) > 450);
+
+    stime_t time = 450;
+    uint64_t pos;
+    ASSERT(MP4_Fragments_Index_Lookup(index, &time, &pos, 0));
+    ASSERT(time == 400 && pos == 5000);
+
+    /* or until the index is complete */
+    MP4_Fragments_Index_Wait(index, 5000);
+    ASSERT(MP4_Fragment_Index_GetTracksDuration(index) == FRAGS * 100);
+
+    vlc_join(indexer.thread, NULL);
+    MP4_Fragments_Index_Delete(index);
+    return 0;
+}
+
+int main(void)
+{
+    ASSERT(MP4_Fragments_Index_New(0, 1) == NULL);
+
+    /* grown from a single entry */
+    mp4_fragments_index_t *index = MP4_Fragments_Index_New(2, 1);
+    ASSERT(index != NULL);
+
+    stime_t time = 0;
+    uint64_t pos;
+    ASSERT(!MP4_Fragments_Index_Lookup(index, &time, &pos, 0));
+    ASSERT(!MP4_Fragment_Index_GetTrackStartTime(index, 0, 0, &time));
+    ASSERT(MP4_Fragment_Index_GetTracksDuration(index) == 0);
+
+    for (unsigned i = 0; i < FRAGS; i++)
+        ASSERT(AddFragment(index, i));
+    ASSERT(index->i_entries == FRAGS);
+    ASSERT(MP4_Fragment_Index_GetTracksDuration(index) == FRAGS * 100);
+
+    int ret = CheckLookup(index);
+    if (ret == 0)
+        ret = CheckTrackStartTime(index);
+    if (ret == 0)
+    {   /* the end time does not go backward */
+        const stime_t times[2] = { FRAGS * 100, FRAGS * 100 };
+        if (!MP4_Fragments_Index_Add(index, (FRAGS + 1) * 1000, times, 50)
+         || MP4_Fragment_Index_GetTracksDuration(index) != FRAGS * 100)
+            ret = 1;
+    }
+    MP4_Fragments_Index_Delete(index);
+    if (ret == 0)
+        ret = CheckWait();
+    return ret;
+}
@@ -0,0 +1,597 @@
+/*****************************************************************************
+ * preparser_serializer.c: binary preparser serializer test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Serializes every kind of message and checks that it is deserialized
+ * unchanged, then checks that truncated and corrupted frames are rejected.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_input.h>
+#include <vlc_input_item.h>
+#include <vlc_meta.h>
+#include <vlc_picture.h>
+#include <vlc_preparser_ipc.h>
+#include "../../../lib/libvlc_internal.h"
+
+/* Same values as in the serializer */
+#define BIN_VERSION 1
+#define BIN_NODE_DEPTH_MAX 256
+
+/* The serialized frames, in memory */
+struct buffer
+{
+    uint8_t *data;
+    size_t size;
+    size_t offset; /**< Read position */
+};
+
+static ssize_t buffer_Write(const void *data, size_t size, void *userdata)
+{
+    struct buffer *buf = userdata;
+
+    uint8_t *grown = realloc(buf->data, buf->size + size);
+    assert(grown != NULL);
+    memcpy(grown + buf->size, data, size);
+    buf->data = grown;
+    buf->size += size;
+    return size;
+}
+
+static ssize_t buffer_Read(void *data, size_t size, void *userdata)
+{
+    struct buffer *buf = userdata;
+
+    if (size > buf->size - buf->offset)
+        size = buf->size - buf->offset;
+    memcpy(data, buf->data + buf->offset, size);
+    buf->offset += size;
+    return size;
+}
+
+static void buffer_Reset(struct buffer *buf)
+{
+    free(buf->data);
+    buf->data = NULL;
+    buf->size = buf->offset = 0;
+}
+
+static void buffer_Set(struct buffer *buf, const uint8_t *data, size_t size)
+{
+    buffer_Reset(buf);
+    buffer_Write(data, size, buf);
+}
+
+static struct vlc_preparser_msg_serdes *serdes;
+
+static int Deserialize(struct buffer *buf, struct vlc_preparser_msg *msg)
+{
+    buf->offset = 0;
+    return vlc_preparser_msg_serdes_Deserialize(serdes, msg, buf);
+}
+
+/* Serializes, then deserializes the whole frame */
+static void RoundTrip(const struct vlc_preparser_msg *in,
+                      struct vlc_preparser_msg *out)
+{
+    struct buffer buf = { 0 };
+
+    assert(vlc_preparser_msg_serdes_Serialize(serdes, in, &buf)
+           == VLC_SUCCESS);
+    /* The binary module, not the JSON one */
+    assert(buf.size > 5 && buf.data[4] == BIN_VERSION);
+    assert(GetDWLE(buf.data) == buf.size - 4);
+
+    assert(Deserialize(&buf, out) == VLC_SUCCESS);
+    assert(buf.offset == buf.size);
+    assert(out->type == in->type && out->req_type == in->req_type);
+    buffer_Reset(&buf);
+}
+
+static bool StrEqual(const char *a, const char *b)
+{
+    return a == NULL ? b == NULL : b != NULL && !strcmp(a, b);
+}
+
+/*****************************************************************************
+ * Requests
+ *****************************************************************************/
+
+static void test_request_parse(void)
+{
+    struct vlc_preparser_msg in, out;
+
+    vlc_preparser_msg_Init(&in, VLC_PREPARSER_MSG_TYPE_REQ,
+                           VLC_PREPARSER_MSG_REQ_TYPE_PARSE);
+    in.req.options = 0x1f;
+    in.req.uri = strdup("file:///tmp/caf%C3%A9.mkv");
+    assert(in.req.uri != NULL);
+
+    RoundTrip(&in, &out);
+    assert(out.req.options == in.req.options);
+    assert(StrEqual(out.req.uri, in.req.uri));
+
+    vlc_preparser_msg_Clean(&out);
+    vlc_preparser_msg_Clean(&in);
+}
+
+static void test_request_thumbnail(void)
+{
+    struct vlc_preparser_msg in, out;
+
+    vlc_preparser_msg_Init(&in, VLC_PREPARSER_MSG_TYPE_REQ,
+                           VLC_PREPARSER_MSG_REQ_TYPE_THUMBNAIL);
+    in.req.arg.seek.type = VLC_THUMBNAILER_SEEK_TIME;
+    in.req.arg.seek.time = VLC_TICK_FROM_SEC(-3);
+    in.req.arg.seek.speed = VLC_THUMBNAILER_SEEK_FAST;
+    in.req.arg.hw_dec = true;
+    in.req.uri = strdup("mock://");
+    assert(in.req.uri != NULL);
+
+    RoundTrip(&in, &out);
+    assert(out.req.arg.seek.type == in.req.arg.seek.type);
+    assert(out.req.arg.seek.time == in.req.arg.seek.time);
+    assert(out.req.arg.seek.speed == in.req.arg.seek.speed);
+    assert(out.req.arg.hw_dec == in.req.arg.hw_dec);
+    assert(StrEqual(out.req.uri, in.req.uri));
+
+    vlc_preparser_msg_Clean(&out);
+    vlc_preparser_msg_Clean(&in);
+}
+
+static void test_request_thumbnail_to_files(void)
+{
+    struct vlc_preparser_msg in, out;
+
+    vlc_preparser_msg_Init(&in, VLC_PREPARSER_MSG_TYPE_REQ,
+                           VLC_PREPARSER_MSG_REQ_TYPE_THUMBNAIL_TO_FILES);
+    in.req.arg.seek.type = VLC_THUMBNAILER_SEEK_POS;
+    in.req.arg.seek.pos = 0.375;
+    for (int i = 0; i < 2; i++)
+    {
+        char *path;
+        assert(asprintf(&path, "/tmp/thumb%d", i) > 0);
+        assert(vlc_vector_push(&in.req.outputs_path, path));
+
+        struct vlc_thumbnailer_output output = {
+            .format = i ? VLC_THUMBNAILER_FORMAT_JPEG
+                        : VLC_THUMBNAILER_FORMAT_PNG,
+            .width = 320 * i,
+            .height = -1,
+            .crop = i,
+            .file_path = path,
+            .creat_mode = 0644,
+        };
+        assert(vlc_vector_push(&in.req.outputs, output));
+    }
+    in.req.uri = strdup("mock://");
+    assert(in.req.uri != NULL);
+
+    RoundTrip(&in, &out);
+    assert(out.req.arg.seek.type == in.req.arg.seek.type);
+    assert(out.req.arg.seek.pos == in.req.arg.seek.pos);
+    assert(out.req.outputs.size == in.req.outputs.size);
+    for (size_t i = 0; i < in.req.outputs.size; i++)
+    {
+        const struct vlc_thumbnailer_output *a = &in.req.outputs.data[i];
+        const struct vlc_thumbnailer_output *b = &out.req.outputs.data[i];
+        assert(a->format == b->format);
+        assert(a->width == b->width && a->height == b->height);
+        assert(a->crop == b->crop);
+        assert(StrEqual(a->file_path, b->file_path));
+        assert(a->creat_mode == b->creat_mode);
+    }
+    assert(StrEqual(out.req.uri, in.req.uri));
+
+    vlc_preparser_msg_Clean(&out);
+    vlc_preparser_msg_Clean(&in);
+}
+
+/*****************************************************************************
+ * Responses
+ *****************************************************************************/
+
+static input_item_t *NewItem(const char *name)
+{
+    input_item_t *item = input_item_NewExt("mock://", name,
+                                           VLC_TICK_FROM_SEC(42),
+                                           ITEM_TYPE_FILE, ITEM_LOCAL);
+    assert(item != NULL);
+
+    struct input_item_es item_es = { .id = strdup("video/0"),
+                                     .id_stable = true };
+    assert(item_es.id != NULL);
+    es_format_Init(&item_es.es, VIDEO_ES, VLC_CODEC_H264);
+    item_es.es.video.i_width = item_es.es.video.i_visible_width = 1920;
+    item_es.es.video.i_height = item_es.es.video.i_visible_height = 1080;
+    item_es.es.psz_language = strdup("fre");
+    assert(vlc_vector_push(&item->es_vec, item_es));
+
+    input_item_SetMeta(item, vlc_meta_Title, name);
+    input_item_SetMetaExtra(item, "extra", "value");
+
+    input_item_slave_t *slave =
+        input_item_slave_New("file:///tmp/sub.srt", SLAVE_TYPE_SPU,
+                             SLAVE_PRIORITY_MATCH_ALL);
+    assert(slave != NULL);
+    assert(input_item_AddSlave(item, slave) == VLC_SUCCESS);
+    return item;
+}
+
+static void CheckItem(input_item_t *a, input_item_t *b)
+{
+    assert(StrEqual(a->psz_name, b->psz_name));
+    assert(StrEqual(a->psz_uri, b->psz_uri));
+    assert(a->i_duration == b->i_duration);
+    assert(a->i_type == b->i_type && a->b_net == b->b_net);
+
+    assert(a->es_vec.size == b->es_vec.size);
+    for (size_t i = 0; i < a->es_vec.size; i++)
+    {
+        const struct input_item_es *ea = &a->es_vec.data[i];
+        const struct input_item_es *eb = &b->es_vec.data[i];
+        assert(StrEqual(ea->id, eb->id) && ea->id_stable == eb->id_stable);
+        assert(es_format_IsSimilar(&ea->es, &eb->es));
+        assert(StrEqual(ea->es.psz_language, eb->es.psz_language));
+    }
+
+    char *ta = input_item_GetTitle(a), *tb = input_item_GetTitle(b);
+    assert(StrEqual(ta, tb));
+    free(ta);
+    free(tb);
+    assert(StrEqual(vlc_meta_GetExtra(a->p_meta, "extra"),
+                    vlc_meta_GetExtra(b->p_meta, "extra")));
+
+    assert(a->i_slaves == b->i_slaves);
+    for (int i = 0; i < a->i_slaves; i++)
+    {
+        assert(StrEqual(a->pp_slaves[i]->psz_uri, b->pp_slaves[i]->psz_uri));
+        assert(a->pp_slaves[i]->i_type == b->pp_slaves[i]->i_type);
+        assert(a->pp_slaves[i]->i_priority == b->pp_slaves[i]->i_priority);
+    }
+}
+
+static void CheckNode(input_item_node_t *a, input_item_node_t *b)
+{
+    CheckItem(a->p_item, b->p_item);
+    assert(a->i_children == b->i_children);
+    for (int i = 0; i < a->i_children; i++)
+        CheckNode(a->pp_children[i], b->pp_children[i]);
+}
+
+static void InitParseResponse(struct vlc_preparser_msg *msg)
+{
+    vlc_preparser_msg_Init(msg, VLC_PREPARSER_MSG_TYPE_RES,
+                           VLC_PREPARSER_MSG_REQ_TYPE_PARSE);
+    msg->res.status = VLC_SUCCESS;
+    msg->res.item = NewItem("root");
+
+    static const uint8_t cover[] = { 0x89, 'P', 'N', 'G', 0, 1, 2, 3 };
+    input_attachment_t *a = vlc_input_attachment_New("cover.png", "image/png",
+                                                     NULL, cover,
+                                                     sizeof (cover));
+    assert(a != NULL);
+    assert(vlc_vector_push(&msg->res.attachments, a));
+
+    input_item_t *item = NewItem("root");
+    msg->res.subtree = input_item_node_Create(item);
+    input_item_Release(item);
+    assert(msg->res.subtree != NULL);
+    for (int i = 0; i < 2; i++)
+    {
+        item = NewItem(i ? "child 1" : "child 0");
+        input_item_node_t *child =
+            input_item_node_AppendItem(msg->res.subtree, item);
+        input_item_Release(item);
+        assert(child != NULL);
+
+        item = NewItem("grandchild");
+        assert(input_item_node_AppendItem(child, item) != NULL);
+        input_item_Release(item);
+    }
+}
+
+static void test_response_parse(void)
+{
+    struct vlc_preparser_msg in, out;
+
+    InitParseResponse(&in);
+    RoundTrip(&in, &out);
+
+    assert(out.res.status == in.res.status);
+    CheckItem(in.res.item, out.res.item);
+    assert(out.res.attachments.size == 1);
+    const input_attachment_t *a = in.res.attachments.data[0];
+    const input_attachment_t *b = out.res.attachments.data[0];
+    assert(StrEqual(a->psz_name, b->psz_name));
+    assert(StrEqual(a->psz_mime, b->psz_mime));
+    assert(a->i_data == b->i_data && !memcmp(a->p_data, b->p_data, a->i_data));
+    CheckNode(in.res.subtree, out.res.subtree);
+
+    vlc_preparser_msg_Clean(&out);
+    vlc_preparser_msg_Clean(&in);
+}
+
+static void test_response_thumbnail(void)
+{
+    struct vlc_preparser_msg in, out;
+    video_format_t fmt;
+
+    vlc_preparser_msg_Init(&in, VLC_PREPARSER_MSG_TYPE_RES,
+                           VLC_PREPARSER_MSG_REQ_TYPE_THUMBNAIL);
+    in.res.status = VLC_SUCCESS;
+    in.res.item = NewItem("thumbnail");
+
+    /* Odd dimensions, so that the chroma planes are rounded up */
+    video_format_Init(&fmt, VLC_CODEC_I420);
+    video_format_Setup(&fmt, VLC_CODEC_I420, 33, 17, 33, 17, 1, 1);
+    fmt.orientation = ORIENT_ROTATED_90;
+    in.res.pic = picture_NewFromFormat(&fmt);
+    assert(in.res.pic != NULL);
+    in.res.pic->date = VLC_TICK_0 + VLC_TICK_FROM_MS(1234);
+
+    uint32_t seed = 0x56434C00;
+    for (int i = 0; i < in.res.pic->i_planes; i++)
+    {
+        plane_t *p = &in.res.pic->p[i];
+        for (int y = 0; y < p->i_lines; y++)
+            for (int x = 0; x < p->i_pitch; x++)
+            {
+                seed = seed * 1103515245 + 12345;
+                p->p_pixels[y * p->i_pitch + x] = seed >> 24;
+            }
+    }
+
+    RoundTrip(&in, &out);
+    CheckItem(in.res.item, out.res.item);
+
+    const picture_t *a = in.res.pic, *b = out.res.pic;
+    assert(b != NULL);
+    assert(b->format.i_chroma == a->format.i_chroma);
+    assert(b->format.i_width == a->format.i_width);
+    assert(b->format.i_height == a->format.i_height);
+    assert(b->format.i_visible_width == a->format.i_visible_width);
+    assert(b->format.i_visible_height == a->format.i_visible_height);
+    assert(b->format.orientation == a->format.orientation);
+    assert(b->date == a->date);
+    assert(b->i_planes == a->i_planes);
+    for (int i = 0; i < a->i_planes; i++)
+    {
+        const plane_t *pa = &a->p[i], *pb = &b->p[i];
+        assert(pa->i_visible_lines == pb->i_visible_lines);
+        assert(pa->i_visible_pitch == pb->i_visible_pitch);
+        for (int y = 0; y < pa->i_visible_lines; y++)
+            assert(!memcmp(pa->p_pixels + y * pa->i_pitch,
+                           pb->p_pixels + y * pb->i_pitch,
+                           pa->i_visible_pitch));
+    }
+
+    vlc_preparser_msg_Clean(&out);
+    vlc_preparser_msg_Clean(&in);
+}
+
+static void test_response_thumbnail_to_files(void)
+{
+    struct vlc_preparser_msg in, out;
+
+    vlc_preparser_msg_Init(&in, VLC_PREPARSER_MSG_TYPE_RES,
+                           VLC_PREPARSER_MSG_REQ_TYPE_THUMBNAIL_TO_FILES);
+    in.res.status = VLC_ETIMEOUT;
+    for (int i = 0; i < 3; i++)
+        assert(vlc_vector_push(&in.res.result, i != 1));
+
+    RoundTrip(&in, &out);
+    assert(out.res.status == in.res.status);
+    assert(out.res.item == NULL);
+    assert(out.res.result.size == in.res.result.size);
+    for (size_t i = 0; i < in.res.result.size; i++)
+        assert(out.res.result.data[i] == in.res.result.data[i]);
+
+    vlc_preparser_msg_Clean(&out);
+    vlc_preparser_msg_Clean(&in);
+}
+
+/*****************************************************************************
+ * Invalid frames
+ *****************************************************************************/
+
+static void test_truncated(void)
+{
+    struct vlc_preparser_msg in, out;
+    struct buffer buf = { 0 }, cut = { 0 };
+
+    InitParseResponse(&in);
+    assert(vlc_preparser_msg_serdes_Serialize(serdes, &in, &buf)
+           == VLC_SUCCESS);
+    vlc_preparser_msg_Clean(&in);
+
+    /* The stream ends within the frame */
+    for (size_t size = 0; size < buf.size; size++)
+    {
+        buffer_Set(&cut, buf.data, size);
+        assert(Deserialize(&cut, &out) != VLC_SUCCESS);
+    }
+
+    /* The frame is complete, but its payload ends within the message */
+    for (size_t size = 5; size < buf.size; size++)
+    {
+        buffer_Set(&cut, buf.data, size);
+        SetDWLE(cut.data, size - 4);
+        assert(Deserialize(&cut, &out) != VLC_SUCCESS);
+    }
+
+    /* Trailing garbage */
+    buffer_Set(&cut, buf.data, buf.size);
+    buffer_Write("", 1, &cut);
+    SetDWLE(cut.data, buf.size - 3);
+    assert(Deserialize(&cut, &out) != VLC_SUCCESS);
+
+    buffer_Reset(&cut);
+    buffer_Reset(&buf);
+}
+
+static void test_invalid(void)
+{
+    struct vlc_preparser_msg out;
+    struct buffer buf = { 0 };
+
+    /* Empty, oversized and unknown frames */
+    static const uint8_t empty[] = { 0, 0, 0, 0 };
+    buffer_Set(&buf, empty, sizeof (empty));
+    assert(Deserialize(&buf, &out) != VLC_SUCCESS);
+
+    static const uint8_t huge[] = { 0x01, 0x00, 0x00, 0x80, BIN_VERSION };
+    buffer_Set(&buf, huge, sizeof (huge));
+    assert(Deserialize(&buf, &out) != VLC_SUCCESS);
+
+    static const uint8_t version[] = { 3, 0, 0, 0, BIN_VERSION + 1, 0, 0 };
+    buffer_Set(&buf, version, sizeof (version));
+    assert(Deserialize(&buf, &out) != VLC_SUCCESS);
+
+    static const uint8_t type[] = { 3, 0, 0, 0, BIN_VERSION, 2, 0 };
+    buffer_Set(&buf, type, sizeof (type));
+    assert(Deserialize(&buf, &out) != VLC_SUCCESS);
+
+    static const uint8_t req_type[] = { 3, 0, 0, 0, BIN_VERSION, 0, 3 };
+    buffer_Set(&buf, req_type, sizeof (req_type));
+    assert(Deserialize(&buf, &out) != VLC_SUCCESS);
+
+    /* A varint of more than 64 bits */
+    uint8_t varint[5 + 12];
+    memset(varint, 0xff, sizeof (varint));
+    SetDWLE(varint, sizeof (varint) - 4);
+    varint[4] = BIN_VERSION;
+    varint[sizeof (varint) - 1] = 0x01;
+    buffer_Set(&buf, varint, sizeof (varint));
+    assert(Deserialize(&buf, &out) != VLC_SUCCESS);
+
+    /* A string longer than the frame, as the URI of a parse request */
+    static const uint8_t string[] = {
+        7, 0, 0, 0, BIN_VERSION, 0, 0, 0, 0xff, 0xff, 0x7f,
+    };
+    buffer_Set(&buf, string, sizeof (string));
+    assert(Deserialize(&buf, &out) != VLC_SUCCESS);
+
+    /* More attachments than the remaining bytes, so nothing is allocated */
+    static const uint8_t count[] = {
+        9, 0, 0, 0, BIN_VERSION, 1, 0, 0xff, 0xff, 0xff, 0xff, 0x0f, 0,
+    };
+    buffer_Set(&buf, count, sizeof (count));
+    assert(Deserialize(&buf, &out) != VLC_SUCCESS);
+
+    /* A boolean that is neither 0 nor 1, as the presence of the item */
+    static const uint8_t boolean[] = {
+        6, 0, 0, 0, BIN_VERSION, 1, 2, 0, 0, 2,
+    };
+    buffer_Set(&buf, boolean, sizeof (boolean));
+    assert(Deserialize(&buf, &out) != VLC_SUCCESS);
+
+    buffer_Reset(&buf);
+}
+
+/* A branch of depth nodes under the root of a parse response */
+static int SerializeDepth(struct buffer *buf, unsigned depth)
+{
+    struct vlc_preparser_msg msg;
+
+    vlc_preparser_msg_Init(&msg, VLC_PREPARSER_MSG_TYPE_RES,
+                           VLC_PREPARSER_MSG_REQ_TYPE_PARSE);
+    msg.res.status = VLC_SUCCESS;
+
+    input_item_t *item = input_item_New("mock://", "node");
+    assert(item != NULL);
+    msg.res.subtree = input_item_node_Create(item);
+    assert(msg.res.subtree != NULL);
+
+    input_item_node_t *node = msg.res.subtree;
+    for (unsigned i = 1; i < depth; i++)
+    {
+        node = input_item_node_AppendItem(node, item);
+        assert(node != NULL);
+    }
+    input_item_Release(item);
+
+    int ret = vlc_preparser_msg_serdes_Serialize(serdes, &msg, buf);
+    vlc_preparser_msg_Clean(&msg);
+    return ret;
+}
+
+static void test_depth(void)
+{
+    struct vlc_preparser_msg out;
+    struct buffer buf = { 0 };
+
+    assert(SerializeDepth(&buf, BIN_NODE_DEPTH_MAX) == VLC_SUCCESS);
+    assert(Deserialize(&buf, &out) == VLC_SUCCESS);
+    unsigned depth = 0;
+    for (input_item_node_t *node = out.res.subtree; node != NULL;
+         node = node->i_children ? node->pp_children[0] : NULL)
+        depth++;
+    assert(depth == BIN_NODE_DEPTH_MAX);
+    vlc_preparser_msg_Clean(&out);
+    buffer_Reset(&buf);
+
+    /* Too deep for the recursive deserialization */
+    assert(SerializeDepth(&buf, BIN_NODE_DEPTH_MAX + 1) == VLC_SUCCESS);
+    assert(Deserialize(&buf, &out) != VLC_SUCCESS);
+    buffer_Reset(&buf);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+
+    static const struct vlc_preparser_msg_serdes_cbs cbs = {
+        .write = buffer_Write,
+        .read = buffer_Read,
+    };
+    serdes = vlc_preparser_msg_serdes_Create(VLC_OBJECT(vlc->p_libvlc_int),
+                                             &cbs, true);
+    assert(serdes != NULL);
+
+    test_request_parse();
+    test_request_thumbnail();
+    test_request_thumbnail_to_files();
+    test_response_parse();
+    test_response_thumbnail();
+    test_response_thumbnail_to_files();
+    test_truncated();
+    test_invalid();
+    test_depth();
+
+    vlc_preparser_msg_serdes_Delete(serdes);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -87,6 +87,44 @@ static int run_annexb_sets( const uint8_t *p_set, const uint8_t *p_end,
     }
     else printf("asm not built in, skipping test:\n");
 
+#ifdef CAN_COMPILE_SSE2
+    if( vlc_CPU_SSE2() )
+    {
+        printf("checking sse2 code:\n");
+        i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                           startcode_FindAnnexB_SSE2 );
+        if( i_ret != 0 )
+            return i_ret;
+    }
+#endif
+#ifdef CAN_COMPILE_AVX2
+    if( vlc_CPU_AVX2() )
+    {
+        printf("checking avx2 code:\n");
+        i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                           startcode_FindAnnexB_AVX2 );
+        if( i_ret != 0 )
+            return i_ret;
+    }
+#endif
+#if defined(CAN_COMPILE_AVX512) && defined(__x86_64__)
+    if( vlc_CPU_AVX512() )
+    {
+        printf("checking avx512 code:\n");
+        i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                           startcode_FindAnnexB_AVX512 );
+        if( i_ret != 0 )
+            return i_ret;
+    }
+#endif
+#if defined(__ARM_NEON)
+    printf("checking neon code:\n");
+    i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                       startcode_FindAnnexB_NEON );
+    if( i_ret != 0 )
+        return i_ret;
+#endif
+
     return 0;
 }
 
@@ -134,5 +172,27 @@ int main( void )
             return i_ret;
     }
 
+    /* Slide the set over every alignment and vector block boundary */
+    p_data = malloc( 4096 );
+    if( p_data )
+    {
+        for( ssize_t i_dataoffset = 0; i_dataoffset < 160; i_dataoffset++ )
+        {
+            memset( p_data, 0x42, 4096 );
+            memcpy( &p_data[i_dataoffset],
+                    test1_annexbdata, sizeof(test1_annexbdata) );
+            printf("* Running tests on set 1 at offset %zd:\n", i_dataoffset);
+            i_ret = run_annexb_sets( p_data,
+                                     p_data + 1024 + i_dataoffset,
+                                     test1_results, ARRAY_SIZE(test1_results),
+                                     i_dataoffset );
+            if( i_ret != 0 )
+                break;
+        }
+        free( p_data );
+        if( i_ret != 0 )
+            return i_ret;
+    }
+
     return 0;
 }
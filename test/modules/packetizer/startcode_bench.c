@@ -0,0 +1,129 @@
+/*****************************************************************************
+ * startcode_bench.c: AnnexB startcode and EP3B unescaping benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "../modules/packetizer/startcode_helper.h"
+#include "../modules/packetizer/hxxx_ep3b.h"
+
+#define BENCH_SIZE      (16 * 1024 * 1024)
+#define BENCH_NAL_SIZE  (256 * 1024) /* ~ one intra slice of a high rate feed */
+#define BENCH_LOOPS     16
+
+/* Pseudo random, non zero, payload with startcodes and escape sequences */
+static void fill_set( uint8_t *p, size_t i_size )
+{
+    uint32_t seed = 0x56434C00;
+    for( size_t i = 0; i < i_size; i++ )
+    {
+        seed = seed * 1103515245 + 12345;
+        p[i] = (seed >> 16) | 0x01;
+    }
+    for( size_t i = 0; i + 4 < i_size; i += BENCH_NAL_SIZE )
+    {
+        p[i] = p[i + 1] = 0; p[i + 2] = 1;
+        for( size_t j = i + 4096; j + 3 < i + BENCH_NAL_SIZE && j + 3 < i_size;
+             j += 4096 )
+        {
+            p[j] = p[j + 1] = 0; p[j + 2] = 3;
+        }
+    }
+}
+
+static void bench_find( const char *psz_name, const uint8_t *p_set, size_t i_set,
+                        const uint8_t *(*pf_find)(const uint8_t *, const uint8_t *) )
+{
+    unsigned i_found = 0;
+    vlc_tick_t start = vlc_tick_now();
+    for( unsigned i = 0; i < BENCH_LOOPS; i++ )
+    {
+        const uint8_t *p = p_set;
+        const uint8_t *end = p_set + i_set;
+        while( (p = pf_find( p, end )) != NULL )
+        {
+            i_found++;
+            p += 3;
+        }
+    }
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+    printf( "%-16s %8.1f MiB/s (%u startcodes)\n", psz_name,
+            (double) i_set * BENCH_LOOPS / (1024 * 1024)
+            / secf_from_vlc_tick( elapsed ), i_found / BENCH_LOOPS );
+}
+
+static void bench_ep3b( uint8_t *p_set, size_t i_set )
+{
+    size_t i_bytes = 0;
+    vlc_tick_t start = vlc_tick_now();
+    for( unsigned i = 0; i < BENCH_LOOPS; i++ )
+    {
+        bs_t bs;
+        struct hxxx_bsfw_ep3b_ctx_s bsctx;
+        hxxx_bsfw_ep3b_ctx_init( &bsctx );
+        bs_init_custom( &bs, p_set, i_set, &hxxx_bsfw_ep3b_callbacks, &bsctx );
+        /* SEI/slice data skipping pattern */
+        while( !bs_eof( &bs ) )
+        {
+            bs_read( &bs, 8 );
+            bs_skip( &bs, 8 * 1023 );
+        }
+        i_bytes += bs_pos( &bs ) / 8;
+    }
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+    printf( "%-16s %8.1f MiB/s (%zu unescaped bytes)\n", "ep3b skip",
+            (double) i_set * BENCH_LOOPS / (1024 * 1024)
+            / secf_from_vlc_tick( elapsed ), i_bytes / BENCH_LOOPS );
+}
+
+int main( void )
+{
+    uint8_t *p_set = malloc( BENCH_SIZE );
+    if( !p_set )
+        return 1;
+    fill_set( p_set, BENCH_SIZE );
+
+    bench_find( "bits", p_set, BENCH_SIZE, startcode_FindAnnexB_Bits );
+#ifdef CAN_COMPILE_SSE2
+    if( vlc_CPU_SSE2() )
+        bench_find( "sse2", p_set, BENCH_SIZE, startcode_FindAnnexB_SSE2 );
+#endif
+#ifdef CAN_COMPILE_AVX2
+    if( vlc_CPU_AVX2() )
+        bench_find( "avx2", p_set, BENCH_SIZE, startcode_FindAnnexB_AVX2 );
+#endif
+#if defined(CAN_COMPILE_AVX512) && defined(__x86_64__)
+    if( vlc_CPU_AVX512() )
+        bench_find( "avx512", p_set, BENCH_SIZE, startcode_FindAnnexB_AVX512 );
+#endif
+#if defined(__ARM_NEON)
+    bench_find( "neon", p_set, BENCH_SIZE, startcode_FindAnnexB_NEON );
+#endif
+    bench_find( "dispatched", p_set, BENCH_SIZE, startcode_FindAnnexB );
+
+    bench_ep3b( p_set, BENCH_SIZE );
+
+    free( p_set );
+    return 0;
+}
@@ -0,0 +1,186 @@
+/*****************************************************************************
+ * prefetch.c: prefetch stream filter test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Reads a live-like source, which cannot seek and only delivers data a bit
+ * ahead of the consumer, through the prefetch filter. The consumption rate
+ * is high at first, so that the buffer grows, then drops, so that the buffer
+ * shrinks while it still holds unread data. Every byte must come out in
+ * order, without the filter failing on a backward seek.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <inttypes.h>
+
+#include <vlc_common.h>
+#include <vlc_stream.h>
+#include <vlc_interrupt.h>
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+/* How far ahead of the consumer the source delivers data */
+#define SOURCE_AHEAD 65536
+/* How long the source waits for the consumer before delivering anyway */
+#define SOURCE_WAIT VLC_TICK_FROM_MS(100)
+
+struct source
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    uint64_t offset; /* produced */
+    uint64_t limit;  /* allowed to produce */
+};
+
+static uint8_t Pattern(uint64_t offset)
+{
+    return (uint32_t)offset * UINT32_C(2654435761) >> 24;
+}
+
+static ssize_t SourceRead(stream_t *s, void *buf, size_t len)
+{
+    struct source *src = s->p_sys;
+    uint8_t *p = buf;
+
+    vlc_mutex_lock(&src->lock);
+    vlc_tick_t deadline = vlc_tick_now() + SOURCE_WAIT;
+    while (src->offset >= src->limit)
+    {
+        if (vlc_killed())
+        {
+            vlc_mutex_unlock(&src->lock);
+            return -1;
+        }
+        if (vlc_cond_timedwait(&src->wait, &src->lock, deadline))
+            /* A live source does not wait for the consumer forever */
+            src->limit = src->offset + SOURCE_AHEAD;
+    }
+
+    if (len > src->limit - src->offset)
+        len = src->limit - src->offset;
+    for (size_t i = 0; i < len; i++)
+        p[i] = Pattern(src->offset + i);
+    src->offset += len;
+    vlc_mutex_unlock(&src->lock);
+    return len;
+}
+
+static int SourceControl(stream_t *s, int query, va_list args)
+{
+    (void) s;
+
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+        case STREAM_CAN_PAUSE:
+            *va_arg(args, bool *) = false;
+            break;
+        case STREAM_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = true;
+            break;
+        case STREAM_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) = DEFAULT_PTS_DELAY;
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static void SourceDestroy(stream_t *s)
+{
+    (void) s;
+}
+
+static uint64_t Consume(stream_t *s, struct source *src, uint64_t offset,
+                        size_t chunk, vlc_tick_t duration)
+{
+    uint8_t buf[16384];
+    vlc_tick_t date = vlc_tick_now();
+    vlc_tick_t deadline = date + duration;
+
+    assert(chunk <= sizeof (buf));
+    while (date < deadline)
+    {
+        ssize_t val = vlc_stream_Read(s, buf, chunk);
+        assert(val == (ssize_t)chunk);
+        (void) val;
+        for (size_t i = 0; i < chunk; i++)
+            assert(buf[i] == Pattern(offset + i));
+        offset += chunk;
+
+        vlc_mutex_lock(&src->lock);
+        src->limit = offset + SOURCE_AHEAD;
+        vlc_cond_signal(&src->wait);
+        vlc_mutex_unlock(&src->lock);
+
+        date += VLC_TICK_FROM_MS(10);
+        vlc_tick_wait(date);
+    }
+    return offset;
+}
+
+int main(void)
+{
+    test_init();
+
+    static const char *const args[] = {
+        "--prefetch-buffer-size=2048", "--prefetch-buffer-duration=1",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    if (vlc == NULL)
+        return 1;
+
+    struct source src = { .offset = 0, .limit = SOURCE_AHEAD };
+    vlc_mutex_init(&src.lock);
+    vlc_cond_init(&src.wait);
+
+    stream_t *source = vlc_stream_CommonNew(VLC_OBJECT(vlc->p_libvlc_int),
+                                            SourceDestroy);
+    assert(source != NULL);
+    source->pf_read = SourceRead;
+    source->pf_control = SourceControl;
+    source->p_sys = &src;
+
+    stream_t *s = vlc_stream_FilterNew(source, "prefetch");
+    if (s == NULL)
+    {
+        vlc_stream_Delete(source);
+        libvlc_release(vlc);
+        return 77;
+    }
+
+    /* More than 1 MiB/s: the buffer grows to 2 MiB */
+    uint64_t offset = Consume(s, &src, 0, 16384, VLC_TICK_FROM_SEC(1));
+    test_log("%"PRIu64" bytes read at a high rate\n", offset);
+
+    /* A few KiB/s: the buffer shrinks to a quarter or less */
+    offset = Consume(s, &src, offset, 256, VLC_TICK_FROM_MS(3500));
+    test_log("%"PRIu64" bytes read in total\n", offset);
+
+    vlc_stream_Delete(s);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,246 @@
+/*****************************************************************************
+ * freetype_blend.c: freetype glyph blenders test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Checks that the SIMD glyph blenders of the freetype text renderer give the
+ * same pictures as the C ones, in both blending modes, including the pixels
+ * left over after the vectors.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_picture.h>
+
+#include "../../../modules/text_renderer/freetype/text_layout.h"
+#include "../../../modules/text_renderer/freetype/blend/rgb.h"
+#include "../../../modules/text_renderer/freetype/blend/yuv.h"
+
+#include "../../libvlc/test.h"
+
+#ifdef CAN_COMPILE_SSE2
+static const struct
+{
+    const char *name;
+    vlc_fourcc_t chroma;
+    ft_drawing_functions draw;
+    ft_glyph_blender simd;
+} blenders[] = {
+    { "YUVA", VLC_CODEC_YUVA,
+      { YUVFromXRGB, FillYUVAPicture, BlendGlyphToYUVA },
+      BlendGlyphToYUVA_SSE2 },
+    { "YUVA knockout", VLC_CODEC_YUVA,
+      { YUVFromXRGB, FillYUVAPicture, BlendGlyphToYUVAKnockout },
+      BlendGlyphToYUVAKnockout_SSE2 },
+    { "RGBA", VLC_CODEC_RGBA,
+      { RGBFromXRGB, FillRGBAPicture, BlendGlyphToRGBA },
+      BlendGlyphToRGBA_SSE2 },
+    { "RGBA knockout", VLC_CODEC_RGBA,
+      { RGBFromXRGB, FillRGBAPicture, BlendGlyphToRGBAKnockout },
+      BlendGlyphToRGBAKnockout_SSE2 },
+    { "ARGB", VLC_CODEC_ARGB,
+      { RGBFromXRGB, FillARGBPicture, BlendGlyphToARGB },
+      BlendGlyphToARGB_SSE2 },
+    { "ARGB knockout", VLC_CODEC_ARGB,
+      { RGBFromXRGB, FillARGBPicture, BlendGlyphToARGBKnockout },
+      BlendGlyphToARGBKnockout_SSE2 },
+};
+
+#define WIDTH  67
+#define HEIGHT 35
+
+/* Glyph widths below and above the vector sizes */
+static const unsigned widths[] = { 1, 3, 4, 7, 8, 9, 17, 33 };
+static const unsigned heights[] = { 1, 5, 13 };
+
+static const struct
+{
+    int x, y;
+} positions[] = {
+    { 0, 0 }, { 1, 2 }, { 5, 7 }, { 13, 21 },
+};
+
+static const int alphas[] = { 0, 1, 128, 255 };
+
+static uint32_t seed = 0x56434C00;
+
+static uint8_t Random(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 24;
+}
+
+/* Mostly random values, with many null and full ones */
+static uint8_t RandomLevel(void)
+{
+    uint8_t v = Random();
+    switch (v % 4)
+    {
+        case 0:
+            return 0;
+        case 1:
+            return 255;
+        default:
+            return Random();
+    }
+}
+
+static void FillPicture(picture_t *pic)
+{
+    const bool yuva = pic->format.i_chroma == VLC_CODEC_YUVA;
+    const int apos = pic->format.i_chroma == VLC_CODEC_RGBA ? 3 : 0;
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        plane_t *p = &pic->p[i];
+        for (int y = 0; y < p->i_lines; y++)
+        {
+            uint8_t *row = &p->p_pixels[y * p->i_pitch];
+            for (int x = 0; x < p->i_pitch; x++)
+            {
+                if (yuva ? i == A_PLANE : x % 4 == apos)
+                    row[x] = RandomLevel();
+                else
+                    row[x] = Random();
+            }
+        }
+    }
+}
+
+/* The coverage has blank spans of a vector too, and a padded pitch */
+static void FillGlyph(FT_BitmapGlyph glyph, unsigned width, unsigned rows)
+{
+    glyph->bitmap.width = width;
+    glyph->bitmap.rows = rows;
+    glyph->bitmap.pitch = width + 3;
+
+    for (unsigned y = 0; y < rows; y++)
+    {
+        uint8_t *row = &glyph->bitmap.buffer[y * glyph->bitmap.pitch];
+        for (int x = 0; x < glyph->bitmap.pitch; x++)
+            row[x] = (y % 4 == 1 && x < 8) ? 0 : RandomLevel();
+    }
+}
+
+static bool SamePictures(const picture_t *a, const picture_t *b)
+{
+    assert(a->i_planes == b->i_planes);
+    for (int i = 0; i < a->i_planes; i++)
+    {
+        const plane_t *pa = &a->p[i], *pb = &b->p[i];
+        for (int y = 0; y < pa->i_visible_lines; y++)
+            if (memcmp(&pa->p_pixels[y * pa->i_pitch],
+                       &pb->p_pixels[y * pb->i_pitch], pa->i_visible_pitch))
+                return false;
+    }
+    return true;
+}
+
+static void CheckBlender(size_t index, FT_BitmapGlyph glyph)
+{
+    const ft_drawing_functions *draw = &blenders[index].draw;
+    video_format_t fmt;
+
+    video_format_Init(&fmt, blenders[index].chroma);
+    video_format_Setup(&fmt, blenders[index].chroma, WIDTH, HEIGHT,
+                       WIDTH, HEIGHT, 1, 1);
+
+    picture_t *dst = picture_NewFromFormat(&fmt);
+    picture_t *ref = picture_NewFromFormat(&fmt);
+    assert(dst != NULL && ref != NULL);
+
+    /* A transparent band, as drawn under the text of a region */
+    line_character_t band = {
+        .p_glyph = glyph,
+        .i_line_offset = 0,
+        .i_line_thickness = 4,
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(widths); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(heights); j++)
+            for (size_t k = 0; k < ARRAY_SIZE(positions); k++)
+                for (size_t l = 0; l < ARRAY_SIZE(alphas); l++)
+                {
+                    const int x = positions[k].x, y = positions[k].y;
+                    uint8_t cx, cy, cz;
+
+                    FillGlyph(glyph, widths[i], heights[j]);
+                    FillPicture(dst);
+                    BlendAXYZLine(dst, x, y + 1, 0, 0, 0, 0, &band, NULL, draw);
+                    picture_CopyPixels(ref, dst);
+
+                    uint32_t rgb = Random() << 16 | Random() << 8 | Random();
+                    draw->extract(rgb, &cx, &cy, &cz);
+
+                    blenders[index].simd(dst, x, y, alphas[l], cx, cy, cz, glyph);
+                    draw->blend(ref, x, y, alphas[l], cx, cy, cz, glyph);
+                    if (!SamePictures(dst, ref))
+                    {
+                        test_log("%s: %ux%u at %d,%d, alpha %d differs\n",
+                                 blenders[index].name, widths[i], heights[j],
+                                 x, y, alphas[l]);
+                        assert(!"SIMD and C glyph blending differ");
+                    }
+                }
+
+    picture_Release(ref);
+    picture_Release(dst);
+    video_format_Clean(&fmt);
+}
+
+int main(void)
+{
+    test_init();
+
+    if (!vlc_CPU_SSE2())
+    {
+        test_log("no SSE2 support, skipping\n");
+        return 77;
+    }
+
+    uint8_t buffer[(33 + 3) * 13];
+    FT_BitmapGlyphRec glyph = {
+        .bitmap = {
+            .buffer = buffer,
+            .num_grays = 256,
+            .pixel_mode = FT_PIXEL_MODE_GRAY,
+        },
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(blenders); i++)
+    {
+        test_log("%s\n", blenders[i].name);
+        CheckBlender(i, &glyph);
+    }
+    return 0;
+}
+#else
+int main(void)
+{
+    test_log("no SIMD glyph blenders, skipping\n");
+    return 77;
+}
+#endif
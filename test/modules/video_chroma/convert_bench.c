@@ -0,0 +1,211 @@
+/*****************************************************************************
+ * convert_bench.c: slice-parallel chroma conversion benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Usage: bench_modules_video_chroma_convert [threads]
+ *
+ * Compares the single-threaded conversions with the slice-parallel ones,
+ * using as many threads as there are CPUs by default.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_tick.h>
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+/* Pixels converted per conversion, whatever the resolution */
+#define BENCH_PIXELS (64 * 1920 * 1080)
+
+static const struct
+{
+    const char *name;
+    unsigned width;
+    unsigned height;
+} resolutions[] = {
+    { "1080p", 1920, 1080 },
+    { "4K",    3840, 2160 },
+};
+
+static const struct
+{
+    const char *module;
+    vlc_fourcc_t src;
+    vlc_fourcc_t dst;
+    bool exact; /**< Whether the threads must not change the output */
+} conversions[] = {
+    { "i420_rgb",      VLC_CODEC_I420, VLC_CODEC_RGB565,  true },
+    { "i420_rgb",      VLC_CODEC_I420, VLC_CODEC_XRGB,    true },
+    { "i420_rgb_sse2", VLC_CODEC_I420, VLC_CODEC_XRGB,    true },
+    { "i422_i420",     VLC_CODEC_I422, VLC_CODEC_I420,    true },
+    { "yuy2_i420",     VLC_CODEC_YUYV, VLC_CODEC_I420,    true },
+    { "swscale",       VLC_CODEC_I420, VLC_CODEC_RGBA,    false },
+    { "swscale",       VLC_CODEC_YUYV, VLC_CODEC_I420,    false },
+};
+
+/* Pseudo random picture content */
+static void FillPicture(picture_t *pic)
+{
+    uint32_t seed = 0x56434C00;
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        plane_t *p = &pic->p[i];
+        for (int y = 0; y < p->i_lines; y++)
+            for (int x = 0; x < p->i_pitch; x++)
+            {
+                seed = seed * 1103515245 + 12345;
+                p->p_pixels[y * p->i_pitch + x] = seed >> 24;
+            }
+    }
+}
+
+static bool ComparePictures(const picture_t *a, const picture_t *b)
+{
+    assert(a->i_planes == b->i_planes);
+    for (int i = 0; i < a->i_planes; i++)
+    {
+        const plane_t *pa = &a->p[i], *pb = &b->p[i];
+        for (int y = 0; y < pa->i_visible_lines; y++)
+            if (memcmp(pa->p_pixels + y * pa->i_pitch,
+                       pb->p_pixels + y * pb->i_pitch,
+                       pa->i_visible_pitch))
+                return false;
+    }
+    return true;
+}
+
+static picture_t *Convert(vlc_object_t *obj, const char *module,
+                          picture_t *in, vlc_fourcc_t dst, int64_t threads,
+                          unsigned loops, vlc_tick_t *elapsed)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    if (filter == NULL)
+        return NULL;
+
+    var_Create(filter, "slice-threads", VLC_VAR_INTEGER);
+    var_SetInteger(filter, "slice-threads", threads);
+
+    es_format_Init(&filter->fmt_in, VIDEO_ES, in->format.i_chroma);
+    filter->fmt_in.video = in->format;
+    es_format_Init(&filter->fmt_out, VIDEO_ES, dst);
+    video_format_Copy(&filter->fmt_out.video, &in->format);
+    filter->fmt_out.video.i_chroma = dst;
+
+    filter->p_module = module_need(filter, "video converter", module, true);
+    if (filter->p_module == NULL)
+    {
+        es_format_Clean(&filter->fmt_in);
+        es_format_Clean(&filter->fmt_out);
+        vlc_object_delete(filter);
+        return NULL;
+    }
+
+    picture_t *out = NULL;
+    *elapsed = 0;
+    for (unsigned i = 0; i < loops; i++)
+    {
+        if (out != NULL)
+            picture_Release(out);
+
+        vlc_tick_t start = vlc_tick_now();
+        out = filter->ops->filter_video(filter, picture_Hold(in));
+        *elapsed += vlc_tick_now() - start;
+        if (out == NULL)
+            break;
+    }
+
+    es_format_Clean(&filter->fmt_in);
+    es_format_Clean(&filter->fmt_out);
+    vlc_filter_Delete(filter);
+    return out;
+}
+
+static void Bench(vlc_object_t *obj, const char *module, vlc_fourcc_t src,
+                  vlc_fourcc_t dst, bool exact, int64_t threads,
+                  const char *res_name, unsigned width, unsigned height)
+{
+    picture_t *in = picture_New(src, width, height, 1, 1);
+    if (in == NULL)
+        return;
+    FillPicture(in);
+
+    const unsigned loops = BENCH_PIXELS / (width * height);
+    vlc_tick_t ref_time, mt_time;
+    picture_t *ref = Convert(obj, module, in, dst, 1, loops, &ref_time);
+    picture_t *mt = Convert(obj, module, in, dst, threads, loops,
+                            &mt_time);
+
+    printf("%-13s %4.4s->%4.4s %-5s: ", module, (char *)&src, (char *)&dst,
+           res_name);
+    if (ref == NULL || mt == NULL)
+        printf("not available\n");
+    else
+    {
+        bool same = ComparePictures(ref, mt);
+        assert(same || !exact);
+        printf("1 thread %7.1f Mpixels/s, %s %7.1f Mpixels/s (x%.2f)%s\n",
+               (double)width * height * loops
+                   / (1e6 * secf_from_vlc_tick(ref_time)),
+               threads > 0 ? "sliced" : "all CPUs",
+               (double)width * height * loops
+                   / (1e6 * secf_from_vlc_tick(mt_time)),
+               (double)ref_time / mt_time, same ? "" : ", output differs");
+    }
+
+    if (ref != NULL)
+        picture_Release(ref);
+    if (mt != NULL)
+        picture_Release(mt);
+    picture_Release(in);
+}
+
+int main(int argc, char *argv[])
+{
+    int64_t threads = argc > 1 ? atoi(argv[1]) : 0;
+
+    /* No alarm: a slow machine may need more than the test timeout */
+    test_setup();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (vlc == NULL)
+        return 1;
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    for (size_t i = 0; i < ARRAY_SIZE(conversions); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(resolutions); j++)
+            Bench(obj, conversions[i].module, conversions[i].src,
+                  conversions[i].dst, conversions[i].exact, threads,
+                  resolutions[j].name, resolutions[j].width,
+                  resolutions[j].height);
+
+    libvlc_release(vlc);
+    return 0;
+}
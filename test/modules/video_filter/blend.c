@@ -0,0 +1,254 @@
+/*****************************************************************************
+ * blend.c: video blending SIMD routines test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Checks that the blend module renders the same pictures with and without
+ * its SIMD routines, for every chroma pair they handle, including the edges
+ * of odd sizes and positions.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+/* The chroma pairs with a SIMD routine */
+static const struct
+{
+    vlc_fourcc_t dst;
+    vlc_fourcc_t src;
+} pairs[] = {
+    { VLC_CODEC_RGBX, VLC_CODEC_RGBA },
+    { VLC_CODEC_XRGB, VLC_CODEC_RGBA },
+    { VLC_CODEC_BGRX, VLC_CODEC_RGBA },
+    { VLC_CODEC_XBGR, VLC_CODEC_RGBA },
+    { VLC_CODEC_YV12, VLC_CODEC_YUVA },
+    { VLC_CODEC_YV12, VLC_CODEC_RGBA },
+    { VLC_CODEC_NV12, VLC_CODEC_YUVA },
+    { VLC_CODEC_NV12, VLC_CODEC_RGBA },
+    { VLC_CODEC_NV21, VLC_CODEC_YUVA },
+    { VLC_CODEC_NV21, VLC_CODEC_RGBA },
+    { VLC_CODEC_I420, VLC_CODEC_YUVA },
+    { VLC_CODEC_I420, VLC_CODEC_RGBA },
+};
+
+#define DST_WIDTH  67
+#define DST_HEIGHT 35
+
+/* Visible source sizes, below and above the vector size */
+static const struct
+{
+    unsigned width, height;
+} src_sizes[] = {
+    { 1, 1 }, { 7, 3 }, { 8, 2 }, { 17, 9 }, { 41, 23 }, { DST_WIDTH, DST_HEIGHT },
+};
+
+/* Destination positions, the last ones clip the source */
+static const struct
+{
+    int x, y;
+} positions[] = {
+    { 0, 0 }, { 1, 1 }, { 2, 3 }, { 9, 4 }, { 40, 20 }, { DST_WIDTH - 1, DST_HEIGHT - 1 },
+};
+
+static const int alphas[] = { 1, 128, 255 };
+
+static uint32_t seed = 0x56434C00;
+
+static uint8_t Random(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 24;
+}
+
+/* Mostly random alpha, with many fully transparent and opaque pixels */
+static uint8_t RandomAlpha(void)
+{
+    uint8_t v = Random();
+    switch (v % 4)
+    {
+        case 0:
+            return 0;
+        case 1:
+            return 255;
+        default:
+            return Random();
+    }
+}
+
+static void FillPicture(picture_t *pic)
+{
+    const bool yuva = pic->format.i_chroma == VLC_CODEC_YUVA;
+    const bool rgba = pic->format.i_chroma == VLC_CODEC_RGBA;
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        plane_t *p = &pic->p[i];
+        for (int y = 0; y < p->i_lines; y++)
+        {
+            uint8_t *row = &p->p_pixels[y * p->i_pitch];
+            for (int x = 0; x < p->i_pitch; x++)
+            {
+                if ((yuva && i == A_PLANE) || (rgba && x % 4 == 3))
+                    row[x] = RandomAlpha();
+                else
+                    row[x] = Random();
+            }
+        }
+    }
+}
+
+static bool SamePictures(const picture_t *a, const picture_t *b)
+{
+    assert(a->i_planes == b->i_planes);
+    for (int i = 0; i < a->i_planes; i++)
+    {
+        const plane_t *pa = &a->p[i], *pb = &b->p[i];
+        for (int y = 0; y < pa->i_visible_lines; y++)
+            if (memcmp(&pa->p_pixels[y * pa->i_pitch],
+                       &pb->p_pixels[y * pb->i_pitch], pa->i_visible_pitch))
+                return false;
+    }
+    return true;
+}
+
+static vlc_blender_t *CreateBlender(vlc_object_t *obj, bool simd,
+                                    const video_format_t *dst,
+                                    const video_format_t *src)
+{
+    var_SetBool(obj, "blend-simd", simd);
+
+    vlc_blender_t *blend = filter_NewBlend(obj, dst);
+    assert(blend != NULL);
+    /* The module reads the option when it is loaded, and is not reloaded
+     * while the source chroma stays the same */
+    int ret = filter_ConfigureBlend(blend, dst->i_visible_width,
+                                    dst->i_visible_height, src);
+    assert(ret == VLC_SUCCESS);
+    return blend;
+}
+
+static void CheckPair(vlc_object_t *obj, vlc_fourcc_t dst_chroma,
+                      vlc_fourcc_t src_chroma)
+{
+    video_format_t dst_fmt, src_fmt;
+
+    video_format_Init(&dst_fmt, dst_chroma);
+    video_format_Setup(&dst_fmt, dst_chroma, DST_WIDTH, DST_HEIGHT,
+                       DST_WIDTH, DST_HEIGHT, 1, 1);
+    video_format_Init(&src_fmt, src_chroma);
+
+    picture_t *dst = picture_NewFromFormat(&dst_fmt);
+    picture_t *ref = picture_NewFromFormat(&dst_fmt);
+    assert(dst != NULL && ref != NULL);
+
+    video_format_Setup(&src_fmt, src_chroma, 1, 1, 1, 1, 1, 1);
+    vlc_blender_t *simd = CreateBlender(obj, true, &dst_fmt, &src_fmt);
+    vlc_blender_t *c = CreateBlender(obj, false, &dst_fmt, &src_fmt);
+
+    for (size_t i = 0; i < ARRAY_SIZE(src_sizes); i++)
+    {
+        /* Also read the source from odd offsets */
+        for (unsigned offset = 0; offset < 2; offset++)
+        {
+            const unsigned ox = 3 * offset, oy = offset;
+
+            video_format_Setup(&src_fmt, src_chroma,
+                               src_sizes[i].width + ox,
+                               src_sizes[i].height + oy,
+                               src_sizes[i].width, src_sizes[i].height, 1, 1);
+            src_fmt.i_x_offset = ox;
+            src_fmt.i_y_offset = oy;
+
+            int ret = filter_ConfigureBlend(simd, DST_WIDTH, DST_HEIGHT,
+                                            &src_fmt);
+            assert(ret == VLC_SUCCESS);
+            ret = filter_ConfigureBlend(c, DST_WIDTH, DST_HEIGHT, &src_fmt);
+            assert(ret == VLC_SUCCESS);
+
+            picture_t *src = picture_NewFromFormat(&src_fmt);
+            assert(src != NULL);
+
+            for (size_t j = 0; j < ARRAY_SIZE(positions); j++)
+                for (size_t k = 0; k < ARRAY_SIZE(alphas); k++)
+                {
+                    FillPicture(src);
+                    FillPicture(dst);
+                    picture_CopyPixels(ref, dst);
+
+                    filter_Blend(simd, dst, positions[j].x, positions[j].y,
+                                 src, alphas[k]);
+                    filter_Blend(c, ref, positions[j].x, positions[j].y,
+                                 src, alphas[k]);
+                    if (!SamePictures(dst, ref))
+                    {
+                        test_log("%4.4s over %4.4s: %ux%u at %d,%d (+%u,%u), "
+                                 "alpha %d differs\n",
+                                 (const char *)&src_chroma,
+                                 (const char *)&dst_chroma,
+                                 src_sizes[i].width, src_sizes[i].height,
+                                 positions[j].x, positions[j].y, ox, oy,
+                                 alphas[k]);
+                        assert(!"SIMD and C blending differ");
+                    }
+                }
+            picture_Release(src);
+        }
+    }
+
+    filter_DeleteBlend(c);
+    filter_DeleteBlend(simd);
+    picture_Release(ref);
+    picture_Release(dst);
+    video_format_Clean(&src_fmt);
+    video_format_Clean(&dst_fmt);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (vlc == NULL)
+        return 1;
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    /* Without SIMD routines for the CPU, both blenders use the C ones */
+    var_Create(obj, "blend-simd", VLC_VAR_BOOL);
+    for (size_t i = 0; i < ARRAY_SIZE(pairs); i++)
+    {
+        test_log("%4.4s over %4.4s\n", (const char *)&pairs[i].src,
+                 (const char *)&pairs[i].dst);
+        CheckPair(obj, pairs[i].dst, pairs[i].src);
+    }
+    var_Destroy(obj, "blend-simd");
+
+    libvlc_release(vlc);
+    return 0;
+}
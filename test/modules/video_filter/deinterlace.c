@@ -0,0 +1,130 @@
+/*****************************************************************************
+ * deinterlace.c: deinterlacer kernels and slices test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Checks that the optimised kernels of the CPU give the same output as the
+ * C code, and that the sliced modes render the same pictures with any number
+ * of threads.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+#include "deinterlace_common.h"
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+/* Also with widths that are not a multiple of the vector sizes */
+static const struct
+{
+    int width, height;
+} sizes[] = {
+    { WIDTH, HEIGHT }, { 720, 576 }, { 712, 480 }, { 136, 34 },
+};
+
+static void CheckKernels(void)
+{
+    struct kernel kernels[KERNEL_COUNT];
+
+    GetKernels(kernels);
+    for (size_t i = 0; i < ARRAY_SIZE(sizes); i++)
+    {
+        struct kernel_pictures b;
+
+        KernelPicturesInit(&b, sizes[i].width, sizes[i].height);
+        for (size_t j = 0; j < KERNEL_COUNT; j++)
+        {
+            if (kernels[j].simd == NULL)
+                continue;
+            test_log("%s kernel, %dx%d\n", kernels[j].name,
+                     sizes[i].width, sizes[i].height);
+            assert(KernelIsExact(&b, &kernels[j]));
+        }
+        KernelPicturesClean(&b);
+    }
+}
+
+/* The slices of the threaded modes must not change the output */
+static void CheckSlices(vlc_object_t *obj, const char *mode)
+{
+    video_format_t fmt;
+    VideoFormat(&fmt);
+
+    filter_t *ref = CreateFilter(obj, mode, 1, &fmt);
+    filter_t *sliced = CreateFilter(obj, mode, 7, &fmt);
+    assert(ref != NULL && sliced != NULL);
+
+    picture_t *in[INPUT_FRAMES];
+    NewInput(in, &fmt);
+
+    for (unsigned i = 0; i < 2 * INPUT_FRAMES; i++)
+    {
+        picture_t *a = FilterFrame(ref, in, i);
+        picture_t *b = FilterFrame(sliced, in, i);
+
+        assert((a == NULL) == (b == NULL));
+        if (a == NULL)
+            continue;
+
+        vlc_picture_chain_t ca = picture_GetAndResetChain(a);
+        vlc_picture_chain_t cb = picture_GetAndResetChain(b);
+        assert(SamePlanes(a, b));
+        while (!vlc_picture_chain_IsEmpty(&ca))
+        {
+            assert(!vlc_picture_chain_IsEmpty(&cb));
+            picture_t *na = vlc_picture_chain_PopFront(&ca);
+            picture_t *nb = vlc_picture_chain_PopFront(&cb);
+            assert(SamePlanes(na, nb));
+            picture_Release(na);
+            picture_Release(nb);
+        }
+        assert(vlc_picture_chain_IsEmpty(&cb));
+        picture_Release(a);
+        picture_Release(b);
+    }
+
+    DeleteInput(in);
+    DeleteFilter(sliced);
+    DeleteFilter(ref);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (vlc == NULL)
+        return 1;
+
+    CheckKernels();
+    CheckSlices(VLC_OBJECT(vlc->p_libvlc_int), "bwdif");
+    CheckSlices(VLC_OBJECT(vlc->p_libvlc_int), "bwdif2x");
+
+    libvlc_release(vlc);
+    return 0;
+}
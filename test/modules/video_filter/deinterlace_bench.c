@@ -0,0 +1,149 @@
+/*****************************************************************************
+ * deinterlace_bench.c: deinterlacer kernels and algorithms benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Usage: bench_modules_video_filter_deinterlace [frames]
+ *
+ * Compares the speeds of the optimised kernels of the CPU and of the C code,
+ * then measures the deinterlacing modes on 1080i input, with as many threads
+ * as there are CPUs. The outputs are checked by
+ * test_modules_video_filter_deinterlace.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_tick.h>
+
+#include "deinterlace_common.h"
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+/* 1080i at 29.97 frames per second */
+#define FRAME_RATE (30000. / 1001.)
+
+static vlc_tick_t TimeKernel(struct kernel_pictures *b, kernel_run run,
+                             const void *kernel, picture_t *dst,
+                             unsigned frames)
+{
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < frames; i++)
+        run(b, kernel, dst);
+    return vlc_tick_now() - start;
+}
+
+static void BenchKernel(struct kernel_pictures *b, const struct kernel *k,
+                        unsigned frames)
+{
+    printf("%-14s: ", k->name);
+    if (k->simd == NULL)
+    {
+        printf("not optimised\n");
+        return;
+    }
+
+    vlc_tick_t ref_time = TimeKernel(b, k->run, k->ref, b->ref, frames);
+    vlc_tick_t simd_time = TimeKernel(b, k->run, k->simd, b->out, frames);
+    printf("C %8.1f frames/s, SIMD %8.1f frames/s (x%.2f)\n",
+           frames / secf_from_vlc_tick(ref_time),
+           frames / secf_from_vlc_tick(simd_time),
+           (double)ref_time / simd_time);
+}
+
+static void BenchKernels(unsigned frames)
+{
+    struct kernel kernels[KERNEL_COUNT];
+    struct kernel_pictures b;
+
+    GetKernels(kernels);
+    KernelPicturesInit(&b, WIDTH, HEIGHT);
+    for (size_t i = 0; i < KERNEL_COUNT; i++)
+    {
+        picture_CopyPixels(b.ref, b.cur);
+        picture_CopyPixels(b.out, b.cur);
+        BenchKernel(&b, &kernels[i], frames);
+    }
+    KernelPicturesClean(&b);
+}
+
+static void BenchMode(vlc_object_t *obj, const char *mode, unsigned frames)
+{
+    video_format_t fmt;
+    VideoFormat(&fmt);
+
+    printf("%-8s: ", mode);
+    filter_t *filter = CreateFilter(obj, mode, 0, &fmt);
+    if (filter == NULL)
+    {
+        printf("not available\n");
+        return;
+    }
+
+    picture_t *in[INPUT_FRAMES];
+    NewInput(in, &fmt);
+
+    vlc_tick_t elapsed = 0;
+    for (unsigned i = 0; i < frames; i++)
+    {
+        vlc_tick_t start = vlc_tick_now();
+        picture_t *out = FilterFrame(filter, in, i);
+        elapsed += vlc_tick_now() - start;
+        if (out != NULL)
+            ReleaseChain(out);
+    }
+
+    double fps = frames / secf_from_vlc_tick(elapsed);
+    printf("%7.1f frames/s (x%.2f real time)\n", fps, fps / FRAME_RATE);
+
+    DeleteInput(in);
+    DeleteFilter(filter);
+}
+
+int main(int argc, char *argv[])
+{
+    static const char *const modes[] = {
+        "x", "yadif", "yadif2x", "bwdif", "bwdif2x", "phosphor", "ivtc",
+    };
+    unsigned frames = argc > 1 ? strtoul(argv[1], NULL, 10) : 100;
+
+    /* No alarm: the benchmark takes as long as the frames count asks */
+    test_setup();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (vlc == NULL)
+        return 1;
+
+    printf("1080i kernels (luma only, full frames for the phosphor):\n");
+    BenchKernels(frames);
+
+    printf("\n1080i deinterlacing (I420):\n");
+    for (size_t i = 0; i < ARRAY_SIZE(modes); i++)
+        BenchMode(VLC_OBJECT(vlc->p_libvlc_int), modes[i], frames);
+
+    libvlc_release(vlc);
+    return 0;
+}
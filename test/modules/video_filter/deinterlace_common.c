@@ -0,0 +1,413 @@
+/*****************************************************************************
+ * deinterlace_common.c: deinterlacer test and benchmark helpers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_modules.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+#include "../../../modules/video_filter/deinterlace/common.h"
+#include "../../../modules/video_filter/deinterlace/merge.h"
+#include "../../../modules/video_filter/deinterlace/yadif.h"
+
+#include "deinterlace_common.h"
+
+/*****************************************************************************
+ * Synthetic interlaced content
+ *****************************************************************************/
+
+/* Moving bars over a gradient, with some noise */
+static uint8_t Pixel(int x, int y, int t, uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    int v = ((x + t) / 24) % 2 ? 200 : 40;
+    v += y / 16 + (int)(*seed >> 29);
+    return v;
+}
+
+/* The fields of a frame are half a frame apart */
+static void FillFrame(picture_t *pic, int t)
+{
+    uint32_t seed = 0x56434C00 + t;
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        plane_t *p = &pic->p[i];
+        for (int y = 0; y < p->i_lines; y++)
+            for (int x = 0; x < p->i_pitch; x++)
+                p->p_pixels[y * p->i_pitch + x] =
+                    Pixel(x, y, 8 * t + 4 * (y & 1), &seed);
+    }
+}
+
+/*****************************************************************************
+ * Reference C kernels, as in the deinterlace plugin
+ *****************************************************************************/
+
+static void DarkenLumaC(uint8_t *p, size_t len, unsigned strength)
+{
+    for (size_t x = 0; x < len; x++)
+        p[x] >>= strength;
+}
+
+static void DarkenChromaC(uint8_t *p, size_t len, unsigned strength)
+{
+    for (size_t x = 0; x < len; x++)
+        p[x] = 128 + ((p[x] - 128) / (1 << strength));
+}
+
+static unsigned CombC(const uint8_t *c, const uint8_t *p, const uint8_t *n,
+                      size_t len)
+{
+    unsigned score = 0;
+
+    for (size_t x = 0; x < len; x++)
+        if ((p[x] - c[x]) * (n[x] - c[x]) > 100)
+            score++;
+    return score;
+}
+
+static int MotionC(const uint8_t *prev, const uint8_t *curr,
+                   ptrdiff_t prev_pitch, ptrdiff_t curr_pitch,
+                   int *top, int *bot)
+{
+    int score[2] = { 0, 0 };
+
+    for (int y = 0; y < 8; y++)
+        for (int x = 0; x < 8; x++)
+            if (abs(curr[y * curr_pitch + x] - prev[y * prev_pitch + x]) > 10)
+                score[y & 1]++;
+
+    *top = score[0] >= 8;
+    *bot = score[1] >= 8;
+    return score[0] + score[1] >= 8;
+}
+
+static bool XDetectC(const uint8_t *src, ptrdiff_t i_src)
+{
+    for (int y = 0; y < 7; y += 2, src += 2 * i_src)
+    {
+        int ff = 0, fr = 0;
+        for (int x = 0; x < 8; x++)
+        {
+            int a = src[x], b = src[i_src + x];
+            int c = src[2 * i_src + x], d = src[3 * i_src + x];
+            fr += (a - b) * (a - b) + (b - c) * (b - c);
+            ff += (a - c) * (a - c) + (b - d) * (b - d);
+        }
+        if (ff < 6 * fr / 8 && fr > 32)
+            return true;
+    }
+    return false;
+}
+
+static void XBlockC(uint8_t *dst, ptrdiff_t i_dst,
+                    const uint8_t *src, ptrdiff_t i_src, bool edge)
+{
+    const bool field = XDetectC(src, i_src);
+
+    for (int y = 0; y < 8; y += 2, dst += 2 * i_dst, src += 2 * i_src)
+    {
+        const uint8_t *s1 = src + i_src, *s2 = src + 2 * i_src;
+
+        memcpy(dst, src, 8);
+        for (int x = 0; x < 8; x++)
+        {
+            int v;
+
+            if (!field)
+                v = (src[x] + 6 * s1[x] + s2[x] + 4) >> 3;
+            else if (edge)
+                v = (src[x] + s2[x]) >> 1;
+            else
+            {
+                int c[3] = { 0, 0, 0 };
+                for (int k = 0; k < 8; k++)
+                {
+                    c[0] += abs(src[x - 4 + k] - s2[x - 2 + k]);
+                    c[1] += abs(src[x - 3 + k] - s2[x - 3 + k]);
+                    c[2] += abs(src[x - 2 + k] - s2[x - 4 + k]);
+                }
+                if (c[0] < c[1] && c[1] <= c[2])
+                    v = (src[x - 1] + s2[x + 1]) >> 1;
+                else if (c[2] < c[1] && c[1] <= c[0])
+                    v = (src[x + 1] + s2[x - 1]) >> 1;
+                else
+                    v = (src[x] + s2[x]) >> 1;
+            }
+            dst[i_dst + x] = v;
+        }
+    }
+}
+
+static void XBandC(uint8_t *dst, ptrdiff_t i_dst,
+                   const uint8_t *src, ptrdiff_t i_src, unsigned blocks)
+{
+    for (unsigned x = 0; x < blocks; x++)
+        XBlockC(dst + 8 * x, i_dst, src + 8 * x, i_src,
+                x == 0 || x == blocks - 1);
+}
+
+/*****************************************************************************
+ * Kernels
+ *****************************************************************************/
+
+static void RunYadif(struct kernel_pictures *b, const void *kernel,
+                     picture_t *dst)
+{
+    yadif_line_cb yadif = (yadif_line_cb)kernel;
+    const plane_t *cur = &b->cur->p[Y_PLANE];
+    const ptrdiff_t pitch = cur->i_pitch;
+
+    for (int y = 1; y < cur->i_visible_lines - 1; y++)
+    {
+        int mode = (y >= 2 && y < cur->i_visible_lines - 2) ? 0 : 2;
+        yadif(&dst->p[Y_PLANE].p_pixels[y * dst->p[Y_PLANE].i_pitch],
+              &b->prev->p[Y_PLANE].p_pixels[y * pitch],
+              &cur->p_pixels[y * pitch],
+              &b->next->p[Y_PLANE].p_pixels[y * pitch],
+              cur->i_visible_pitch,
+              y < cur->i_visible_lines - 2 ? pitch : -pitch,
+              y - 1 ? -pitch : pitch, y & 1, mode);
+    }
+}
+
+static void RunDarken(struct kernel_pictures *b, const void *kernel,
+                      picture_t *dst)
+{
+    darken_cb darken = (darken_cb)kernel;
+    picture_CopyPixels(dst, b->cur);
+
+    for (int i = 0; i < dst->i_planes; i++)
+    {
+        plane_t *p = &dst->p[i];
+        for (int y = 0; y < p->i_visible_lines; y++)
+            darken(&p->p_pixels[y * p->i_pitch], p->i_visible_pitch,
+                   1 + y % 3);
+    }
+}
+
+static void RunComb(struct kernel_pictures *b, const void *kernel,
+                    picture_t *dst)
+{
+    comb_cb comb = (comb_cb)kernel;
+    const plane_t *p = &b->cur->p[Y_PLANE];
+    VLC_UNUSED(dst);
+
+    for (int y = 1; y < p->i_visible_lines - 1; y++)
+        b->score += comb(&p->p_pixels[y * p->i_pitch],
+                         &p->p_pixels[(y - 1) * p->i_pitch],
+                         &p->p_pixels[(y + 1) * p->i_pitch],
+                         p->i_visible_pitch);
+}
+
+static void RunMotion(struct kernel_pictures *b, const void *kernel,
+                      picture_t *dst)
+{
+    motion_cb motion = (motion_cb)kernel;
+    const plane_t *p = &b->cur->p[Y_PLANE], *n = &b->next->p[Y_PLANE];
+    VLC_UNUSED(dst);
+
+    for (int y = 0; y + 8 <= p->i_visible_lines; y += 8)
+        for (int x = 0; x + 8 <= p->i_visible_pitch; x += 8)
+        {
+            int top, bot;
+            int all = motion(&p->p_pixels[y * p->i_pitch + x],
+                             &n->p_pixels[y * n->i_pitch + x],
+                             p->i_pitch, n->i_pitch, &top, &bot);
+            b->score += all + 2 * top + 4 * bot;
+        }
+}
+
+static void RunX(struct kernel_pictures *b, const void *kernel,
+                 picture_t *dst)
+{
+    xdeint_band_cb band = (xdeint_band_cb)kernel;
+    const plane_t *p = &b->cur->p[Y_PLANE];
+    const int bands = (p->i_visible_lines + 7) / 8 - 1;
+
+    for (int y = 0; y < bands; y++)
+        band(&dst->p[Y_PLANE].p_pixels[8 * y * dst->p[Y_PLANE].i_pitch],
+             dst->p[Y_PLANE].i_pitch, &p->p_pixels[8 * y * p->i_pitch],
+             p->i_pitch, p->i_visible_pitch / 8);
+}
+
+bool SamePlanes(const picture_t *a, const picture_t *b)
+{
+    for (int i = 0; i < a->i_planes; i++)
+    {
+        const plane_t *pa = &a->p[i], *pb = &b->p[i];
+        for (int y = 0; y < pa->i_visible_lines; y++)
+            if (memcmp(pa->p_pixels + y * pa->i_pitch,
+                       pb->p_pixels + y * pb->i_pitch, pa->i_visible_pitch))
+                return false;
+    }
+    return true;
+}
+
+void GetKernels(struct kernel kernels[KERNEL_COUNT])
+{
+    struct deinterlace_functions funcs;
+
+    memset(&funcs, 0, sizeof (funcs));
+    vlc_CPU_functions_init("deinterlace functions", &funcs);
+
+    kernels[KERNEL_YADIF] = (struct kernel) {
+        "yadif", RunYadif, yadif_filter_line_c, funcs.yadif };
+    kernels[KERNEL_DARKEN_LUMA] = (struct kernel) {
+        "phosphor Y", RunDarken, DarkenLumaC, funcs.darken_luma };
+    kernels[KERNEL_DARKEN_CHROMA] = (struct kernel) {
+        "phosphor UV", RunDarken, DarkenChromaC, funcs.darken_chroma };
+    kernels[KERNEL_COMB] = (struct kernel) {
+        "ivtc comb", RunComb, CombC, funcs.comb };
+    kernels[KERNEL_MOTION] = (struct kernel) {
+        "ivtc motion", RunMotion, MotionC, funcs.motion };
+    kernels[KERNEL_X] = (struct kernel) {
+        "x", RunX, XBandC, funcs.xdeint_band };
+}
+
+void KernelPicturesInit(struct kernel_pictures *b, int width, int height)
+{
+    b->prev = picture_New(VLC_CODEC_I422, width, height, 1, 1);
+    b->cur = picture_New(VLC_CODEC_I422, width, height, 1, 1);
+    b->next = picture_New(VLC_CODEC_I422, width, height, 1, 1);
+    b->ref = picture_New(VLC_CODEC_I422, width, height, 1, 1);
+    b->out = picture_New(VLC_CODEC_I422, width, height, 1, 1);
+    assert(b->prev != NULL && b->cur != NULL && b->next != NULL);
+    assert(b->ref != NULL && b->out != NULL);
+    FillFrame(b->prev, 0);
+    FillFrame(b->cur, 1);
+    FillFrame(b->next, 2);
+    b->score = 0;
+}
+
+void KernelPicturesClean(struct kernel_pictures *b)
+{
+    picture_Release(b->out);
+    picture_Release(b->ref);
+    picture_Release(b->next);
+    picture_Release(b->cur);
+    picture_Release(b->prev);
+}
+
+bool KernelIsExact(struct kernel_pictures *b, const struct kernel *k)
+{
+    picture_CopyPixels(b->ref, b->cur);
+    picture_CopyPixels(b->out, b->cur);
+    b->score = 0;
+    k->run(b, k->ref, b->ref);
+    unsigned ref_score = b->score;
+    b->score = 0;
+    k->run(b, k->simd, b->out);
+    return b->score == ref_score && SamePlanes(b->ref, b->out);
+}
+
+/*****************************************************************************
+ * Algorithms
+ *****************************************************************************/
+
+void ReleaseChain(picture_t *pic)
+{
+    vlc_picture_chain_t chain = picture_GetAndResetChain(pic);
+
+    picture_Release(pic);
+    while (!vlc_picture_chain_IsEmpty(&chain))
+        picture_Release(vlc_picture_chain_PopFront(&chain));
+}
+
+filter_t *CreateFilter(vlc_object_t *obj, const char *mode,
+                       int64_t threads, const video_format_t *fmt)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    var_Create(filter, "sout-deinterlace-mode", VLC_VAR_STRING);
+    var_SetString(filter, "sout-deinterlace-mode", mode);
+    var_Create(filter, "slice-threads", VLC_VAR_INTEGER);
+    var_SetInteger(filter, "slice-threads", threads);
+
+    es_format_Init(&filter->fmt_in, VIDEO_ES, fmt->i_chroma);
+    filter->fmt_in.video = *fmt;
+    es_format_Init(&filter->fmt_out, VIDEO_ES, fmt->i_chroma);
+    filter->fmt_out.video = *fmt;
+
+    filter->p_module = module_need(filter, "video filter", "deinterlace",
+                                   true);
+    if (filter->p_module == NULL)
+    {
+        es_format_Clean(&filter->fmt_in);
+        es_format_Clean(&filter->fmt_out);
+        vlc_object_delete(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+void DeleteFilter(filter_t *filter)
+{
+    es_format_Clean(&filter->fmt_in);
+    es_format_Clean(&filter->fmt_out);
+    vlc_filter_Delete(filter);
+}
+
+void NewInput(picture_t *in[INPUT_FRAMES], const video_format_t *fmt)
+{
+    for (size_t i = 0; i < INPUT_FRAMES; i++)
+    {
+        in[i] = picture_NewFromFormat(fmt);
+        assert(in[i] != NULL);
+        FillFrame(in[i], i);
+        in[i]->b_progressive = false;
+        in[i]->b_top_field_first = true;
+        in[i]->i_nb_fields = 2;
+    }
+}
+
+void DeleteInput(picture_t *in[INPUT_FRAMES])
+{
+    for (size_t i = 0; i < INPUT_FRAMES; i++)
+        picture_Release(in[i]);
+}
+
+picture_t *FilterFrame(filter_t *filter, picture_t *in[INPUT_FRAMES],
+                       unsigned i)
+{
+    picture_t *pic = picture_Hold(in[i % INPUT_FRAMES]);
+    pic->date = VLC_TICK_0 + vlc_tick_from_samples(i * 1001, 30000);
+    return filter->ops->filter_video(filter, pic);
+}
+
+void VideoFormat(video_format_t *fmt)
+{
+    video_format_Init(fmt, VLC_CODEC_I420);
+    video_format_Setup(fmt, VLC_CODEC_I420, WIDTH, HEIGHT, WIDTH, HEIGHT,
+                       1, 1);
+    fmt->i_frame_rate = 30000;
+    fmt->i_frame_rate_base = 1001;
+}
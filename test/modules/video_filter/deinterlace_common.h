@@ -0,0 +1,85 @@
+/*****************************************************************************
+ * deinterlace_common.h: deinterlacer test and benchmark helpers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+#define WIDTH  1920
+#define HEIGHT 1080
+
+/* The kernels of the deinterlace plugin */
+enum
+{
+    KERNEL_YADIF,
+    KERNEL_DARKEN_LUMA,
+    KERNEL_DARKEN_CHROMA,
+    KERNEL_COMB,
+    KERNEL_MOTION,
+    KERNEL_X,
+    KERNEL_COUNT,
+};
+
+struct kernel_pictures
+{
+    picture_t *prev, *cur, *next;
+    picture_t *ref, *out;
+    unsigned score; /**< Sum of the kernel results */
+};
+
+typedef void (*kernel_run)(struct kernel_pictures *, const void *kernel,
+                           picture_t *dst);
+
+struct kernel
+{
+    const char *name;
+    kernel_run run;
+    const void *ref; /**< C kernel */
+    const void *simd; /**< Optimised kernel of the CPU, or NULL */
+};
+
+/** Fills the kernels table, in the order of the enumeration above */
+void GetKernels(struct kernel kernels[KERNEL_COUNT]);
+
+/** Allocates and fills the pictures of the kernels */
+void KernelPicturesInit(struct kernel_pictures *, int width, int height);
+void KernelPicturesClean(struct kernel_pictures *);
+
+/**
+ * Runs the C and the optimised kernel on the same input.
+ *
+ * \return true if they have the same output and the same results
+ */
+bool KernelIsExact(struct kernel_pictures *, const struct kernel *);
+
+bool SamePlanes(const picture_t *a, const picture_t *b);
+
+/* A few distinct frames, so that the history makes sense */
+#define INPUT_FRAMES 4
+
+void VideoFormat(video_format_t *fmt);
+filter_t *CreateFilter(vlc_object_t *obj, const char *mode,
+                       int64_t threads, const video_format_t *fmt);
+void DeleteFilter(filter_t *filter);
+void NewInput(picture_t *in[INPUT_FRAMES], const video_format_t *fmt);
+void DeleteInput(picture_t *in[INPUT_FRAMES]);
+picture_t *FilterFrame(filter_t *filter, picture_t *in[INPUT_FRAMES],
+                       unsigned i);
+void ReleaseChain(picture_t *pic);
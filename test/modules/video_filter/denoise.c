@@ -0,0 +1,202 @@
+/*****************************************************************************
+ * denoise.c: hqdn3d and gradfun filters test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Filters a fixed synthetic sequence and checks the hash of the output
+ * pictures, whatever the number of threads and the CPU optimisations.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <inttypes.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_modules.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#define WIDTH  1280
+#define HEIGHT 720
+#define FRAMES 5
+
+struct scenario
+{
+    const char *module;
+    const char *options[4][2]; /**< Float options, as strings */
+    uint64_t hash;
+#ifdef CAN_COMPILE_SSSE3
+    uint64_t hash_ssse3; /**< With the SSSE3 rounding, if it differs */
+#endif
+};
+
+static const struct scenario scenarios[] =
+{
+    { "hqdn3d", { { NULL, NULL } },
+      UINT64_C(0x094b24e9b5a5c3a1),
+#ifdef CAN_COMPILE_SSSE3
+      0,
+#endif
+    },
+    { "hqdn3d", { { "hqdn3d-luma-temp", "0" }, { "hqdn3d-chroma-temp", "0" },
+                  { NULL, NULL } },
+      UINT64_C(0xd442a2d7311122e7),
+#ifdef CAN_COMPILE_SSSE3
+      0,
+#endif
+    },
+    { "hqdn3d", { { "hqdn3d-luma-spat", "0" }, { "hqdn3d-chroma-spat", "0" },
+                  { NULL, NULL } },
+      UINT64_C(0xf5945b23dc5b58f1),
+#ifdef CAN_COMPILE_SSSE3
+      0,
+#endif
+    },
+    { "gradfun", { { NULL, NULL } },
+      UINT64_C(0xef0dbd21b0a096b7),
+#ifdef CAN_COMPILE_SSSE3
+      UINT64_C(0xf7d80d2fa9f2310c),
+#endif
+    },
+    { "gradfun", { { "gradfun-strength", "8" }, { NULL, NULL } },
+      UINT64_C(0x2ff35450d5902187),
+#ifdef CAN_COMPILE_SSSE3
+      UINT64_C(0xa3189bab090bb063),
+#endif
+    },
+};
+
+static const unsigned threads[] = { 1, 2, 3, 7, 16 };
+
+/* Smooth moving gradients with a bit of noise, the worst case for banding */
+static void FillFrame(picture_t *pic, unsigned t)
+{
+    uint32_t seed = 0x56434C00 + t;
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        plane_t *p = &pic->p[i];
+        for (int y = 0; y < p->i_visible_lines; y++)
+            for (int x = 0; x < p->i_visible_pitch; x++)
+            {
+                seed = seed * 1103515245 + 12345;
+                p->p_pixels[y * p->i_pitch + x] =
+                    64 + (x + 3 * t) / 16 + y / 24 + (seed >> 30);
+            }
+    }
+}
+
+/* FNV-1a over the visible pixels */
+static uint64_t HashPicture(uint64_t hash, const picture_t *pic)
+{
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        const plane_t *p = &pic->p[i];
+        for (int y = 0; y < p->i_visible_lines; y++)
+            for (int x = 0; x < p->i_visible_pitch; x++)
+            {
+                hash ^= p->p_pixels[y * p->i_pitch + x];
+                hash *= UINT64_C(0x100000001b3);
+            }
+    }
+    return hash;
+}
+
+static uint64_t Run(vlc_object_t *obj, const struct scenario *s,
+                    unsigned thread_count)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    var_Create(filter, "slice-threads", VLC_VAR_INTEGER);
+    var_SetInteger(filter, "slice-threads", thread_count);
+    for (size_t i = 0; s->options[i][0] != NULL; i++)
+    {
+        var_Create(filter, s->options[i][0], VLC_VAR_FLOAT);
+        var_SetFloat(filter, s->options[i][0], atof(s->options[i][1]));
+    }
+
+    video_format_t fmt;
+    video_format_Init(&fmt, VLC_CODEC_I420);
+    video_format_Setup(&fmt, VLC_CODEC_I420, WIDTH, HEIGHT, WIDTH, HEIGHT,
+                       1, 1);
+    es_format_Init(&filter->fmt_in, VIDEO_ES, VLC_CODEC_I420);
+    filter->fmt_in.video = fmt;
+    es_format_Init(&filter->fmt_out, VIDEO_ES, VLC_CODEC_I420);
+    filter->fmt_out.video = fmt;
+
+    filter->p_module = module_need(filter, "video filter", s->module, true);
+    assert(filter->p_module != NULL);
+
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    for (unsigned t = 0; t < FRAMES; t++)
+    {
+        picture_t *in = picture_NewFromFormat(&fmt);
+        assert(in != NULL);
+        FillFrame(in, t);
+
+        picture_t *out = filter->ops->filter_video(filter, in);
+        assert(out != NULL);
+        hash = HashPicture(hash, out);
+        picture_Release(out);
+    }
+
+    es_format_Clean(&filter->fmt_in);
+    es_format_Clean(&filter->fmt_out);
+    vlc_filter_Delete(filter);
+    return hash;
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (vlc == NULL)
+        return 1;
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    for (size_t i = 0; i < ARRAY_SIZE(scenarios); i++)
+    {
+        const struct scenario *s = &scenarios[i];
+        uint64_t expected = s->hash;
+#ifdef CAN_COMPILE_SSSE3
+        if (s->hash_ssse3 != 0 && vlc_CPU_SSSE3())
+            expected = s->hash_ssse3;
+#endif
+
+        for (size_t j = 0; j < ARRAY_SIZE(threads); j++)
+        {
+            uint64_t hash = Run(obj, s, threads[j]);
+            test_log("%s #%zu, %u thread(s): %016"PRIx64"\n", s->module, i,
+                     threads[j], hash);
+            assert(hash == expected);
+        }
+    }
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,175 @@
+/*****************************************************************************
+ * demux_signature.c: demux probing by signature test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_stream.h>
+
+#include <vlc/vlc.h>
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#define MODULE_NAME test_src_input_demux_signature
+#undef VLC_DYNAMIC_PLUGIN
+#include <vlc_plugin.h>
+
+/* Probe counts of the test modules */
+static struct
+{
+    unsigned magic;
+    unsigned offset;
+    unsigned legacy;
+    bool forced;
+    const char *accepted; /**< Name of the accepting module */
+} probes;
+
+static int Demux(demux_t *demux)
+{
+    (void) demux;
+    return VLC_DEMUXER_EOF;
+}
+
+static int Control(demux_t *demux, int query, va_list args)
+{
+    (void) demux; (void) query; (void) args;
+    return VLC_EGENERIC;
+}
+
+static int Accept(demux_t *demux, const char *name)
+{
+    probes.accepted = name;
+    demux->pf_demux = Demux;
+    demux->pf_control = Control;
+    return VLC_SUCCESS;
+}
+
+static int OpenMagic(vlc_object_t *obj)
+{
+    demux_t *demux = (demux_t *)obj;
+    const uint8_t *peek;
+
+    probes.magic++;
+    probes.forced = obj->force;
+    if (vlc_stream_Peek(demux->s, &peek, 4) < 4 || memcmp(peek, "VLC\0", 4))
+        return VLC_EGENERIC;
+    return Accept(demux, "test_magic");
+}
+
+static int OpenOffset(vlc_object_t *obj)
+{
+    demux_t *demux = (demux_t *)obj;
+    const uint8_t *peek;
+
+    probes.offset++;
+    if (vlc_stream_Peek(demux->s, &peek, 8) < 8
+     || (memcmp(peek + 4, "sig1", 4) && memcmp(peek + 4, "sig2", 4)))
+        return VLC_EGENERIC;
+    return Accept(demux, "test_offset");
+}
+
+static int OpenLegacy(vlc_object_t *obj)
+{
+    probes.legacy++;
+    return Accept((demux_t *)obj, "test_legacy");
+}
+
+/* Scores above any real demuxer, so that the test modules are tried first */
+vlc_module_begin()
+    set_capability("demux", 100002)
+    set_callback(OpenMagic)
+    add_signature(0, "VLC\0")
+    add_shortcut("test_magic")
+    add_submodule()
+        set_capability("demux", 100001)
+        set_callback(OpenOffset)
+        add_signature(4, "sig1")
+        add_signature(4, "sig2")
+        add_shortcut("test_offset")
+    add_submodule()
+        set_capability("demux", 100000)
+        set_callback(OpenLegacy)
+        add_shortcut("test_legacy")
+vlc_module_end()
+
+VLC_EXPORT const vlc_plugin_cb vlc_static_modules[] = {
+    VLC_SYMBOL(vlc_entry),
+    NULL
+};
+
+static const char *Probe(vlc_object_t *obj, const char *name,
+                         const void *data, size_t size)
+{
+    stream_t *s = vlc_stream_MemoryNew(obj, (uint8_t *)data, size, true);
+    assert(s != NULL);
+
+    memset(&probes, 0, sizeof (probes));
+
+    demux_t *demux = demux_New(obj, name, "memory://", s, NULL);
+    assert(demux != NULL);
+    assert(probes.accepted != NULL);
+
+    demux_Delete(demux); /* deletes the stream too */
+    return probes.accepted;
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    /* Only the module with a matching signature is probed */
+    static const char magic[] = "VLC\0data";
+    assert(strcmp(Probe(obj, "any", magic, 8), "test_magic") == 0);
+    assert(probes.magic == 1 && probes.offset == 0 && probes.legacy == 0);
+    assert(!probes.forced);
+
+    /* Any signature of a module may match, at any offset */
+    static const char offset[] = "xxxxsig2";
+    assert(strcmp(Probe(obj, "any", offset, 8), "test_offset") == 0);
+    assert(probes.magic == 0 && probes.offset == 1 && probes.legacy == 0);
+
+    /* Modules without signatures are always probed */
+    static const char other[] = "nothing to see here";
+    assert(strcmp(Probe(obj, "any", other, 8), "test_legacy") == 0);
+    assert(probes.magic == 0 && probes.offset == 0 && probes.legacy == 1);
+
+    /* Short streams cannot rule out signatures beyond their end */
+    assert(strcmp(Probe(obj, "any", other, 5), "test_legacy") == 0);
+    assert(probes.magic == 0 && probes.offset == 1 && probes.legacy == 1);
+
+    /* Modules requested by name are probed regardless of their signatures */
+    assert(strcmp(Probe(obj, "test_magic,any", other, 8),
+                  "test_legacy") == 0);
+    assert(probes.magic == 1 && probes.offset == 0 && probes.legacy == 1);
+    assert(probes.forced);
+
+    libvlc_release(vlc);
+    return 0;
+}
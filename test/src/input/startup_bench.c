@@ -0,0 +1,310 @@
+/*****************************************************************************
+ * startup_bench.c: startup and time-to-first-frame benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Usage: bench_src_input_startup [-n runs] [file or MRL]...
+ *
+ * Each run creates a new LibVLC instance, then plays every sample until its
+ * first frame is decoded. The phase durations are collected from the
+ * --startup-trace traces of the core.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_threads.h>
+#include <vlc_tick.h>
+#include <vlc_tracer.h>
+#include <vlc_url.h>
+
+#include <vlc/vlc.h>
+#include "../../libvlc/test.h"
+
+#define MODULE_NAME bench_src_input_startup
+#undef VLC_DYNAMIC_PLUGIN
+#include <vlc_plugin.h>
+
+#define MAX_RUNS    64
+#define MAX_SAMPLES 32
+#define FIRST_FRAME_TIMEOUT VLC_TICK_FROM_SEC(5)
+
+static const char *const libvlc_phases[] = {
+    "module bank", "command line", "configuration file", "init",
+    "libvlc_new",
+};
+
+static const char *const input_phases[] = {
+    "access", "demux probe", "input init", "first frame",
+    "time to first frame",
+};
+
+#define LIBVLC_PHASES ARRAY_SIZE(libvlc_phases)
+#define INPUT_PHASES  ARRAY_SIZE(input_phases)
+
+struct phase_result
+{
+    vlc_tick_t durations[MAX_RUNS];
+    unsigned count;
+};
+
+static struct
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+
+    /* Current run and sample (-1 while libvlc is starting) */
+    unsigned run;
+    int sample;
+    vlc_tick_t first_frame; /**< Date of the first frame (or invalid) */
+
+    struct phase_result libvlc[LIBVLC_PHASES];
+    struct phase_result input[MAX_SAMPLES][INPUT_PHASES];
+} bench = {
+    .lock = VLC_STATIC_MUTEX,
+    .wait = VLC_STATIC_COND,
+};
+
+static void Record(struct phase_result *res, vlc_tick_t duration)
+{
+    /* Keep the first occurrence of each phase in a run */
+    if (res->count <= bench.run)
+        res->durations[res->count++] = duration;
+}
+
+static int PhaseIndex(const char *const *phases, size_t count,
+                      const char *phase)
+{
+    for (size_t i = 0; i < count; i++)
+        if (strcmp(phases[i], phase) == 0)
+            return i;
+    return -1;
+}
+
+static void TracerTrace(void *opaque, vlc_tick_t ts,
+                        const struct vlc_tracer_trace *trace)
+{
+    const char *type = NULL, *phase = NULL;
+    vlc_tick_t duration = VLC_TICK_INVALID;
+
+    (void) opaque;
+    for (const struct vlc_tracer_entry *entry = trace->entries;
+         entry->key != NULL; entry++)
+    {
+        if (strcmp(entry->key, "type") == 0
+         && entry->type == VLC_TRACER_STRING)
+            type = entry->value.string;
+        else if (strcmp(entry->key, "phase") == 0
+              && entry->type == VLC_TRACER_STRING)
+            phase = entry->value.string;
+        else if (strcmp(entry->key, "duration") == 0)
+        {
+            if (entry->type == VLC_TRACER_INT)
+                duration = VLC_TICK_FROM_NS(entry->value.integer);
+            else if (entry->type == VLC_TRACER_UINT)
+                duration = VLC_TICK_FROM_NS(entry->value.uinteger);
+        }
+    }
+
+    if (type == NULL || strcmp(type, "STARTUP") || phase == NULL
+     || duration == VLC_TICK_INVALID)
+        return;
+
+    vlc_mutex_lock(&bench.lock);
+    if (bench.sample < 0)
+    {
+        int idx = PhaseIndex(libvlc_phases, LIBVLC_PHASES, phase);
+        if (idx >= 0)
+            Record(&bench.libvlc[idx], duration);
+    }
+    else
+    {
+        int idx = PhaseIndex(input_phases, INPUT_PHASES, phase);
+        if (idx >= 0)
+            Record(&bench.input[bench.sample][idx], duration);
+        if (strcmp(phase, "first frame") == 0
+         && bench.first_frame == VLC_TICK_INVALID)
+        {
+            bench.first_frame = ts;
+            vlc_cond_signal(&bench.wait);
+        }
+    }
+    vlc_mutex_unlock(&bench.lock);
+}
+
+static const struct vlc_tracer_operations *
+OpenTracer(vlc_object_t *obj, void **restrict sysp)
+{
+    static const struct vlc_tracer_operations ops =
+    {
+        .trace = TracerTrace,
+    };
+
+    (void) obj;
+    *sysp = NULL;
+    return &ops;
+}
+
+vlc_module_begin()
+    set_callback(OpenTracer)
+    set_capability("tracer", 0)
+    add_shortcut("startup_bench")
+vlc_module_end()
+
+VLC_EXPORT const vlc_plugin_cb vlc_static_modules[] = {
+    VLC_SYMBOL(vlc_entry),
+    NULL
+};
+
+static void PlaySample(libvlc_instance_t *vlc, const char *mrl, int sample)
+{
+    libvlc_media_t *md = libvlc_media_new_location(mrl);
+    assert(md != NULL);
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(vlc, md);
+    assert(mp != NULL);
+    libvlc_media_release(md);
+
+    vlc_mutex_lock(&bench.lock);
+    bench.sample = sample;
+    bench.first_frame = VLC_TICK_INVALID;
+    vlc_mutex_unlock(&bench.lock);
+
+    vlc_tick_t start = vlc_tick_now();
+    libvlc_media_player_play(mp);
+
+    vlc_mutex_lock(&bench.lock);
+    while (bench.first_frame == VLC_TICK_INVALID)
+        if (vlc_cond_timedwait(&bench.wait, &bench.lock,
+                               start + FIRST_FRAME_TIMEOUT))
+            break;
+    if (bench.first_frame != VLC_TICK_INVALID)
+        Record(&bench.input[sample][INPUT_PHASES - 1],
+               bench.first_frame - start);
+    else
+        fprintf(stderr, "%s: no frame decoded\n", mrl);
+    vlc_mutex_unlock(&bench.lock);
+
+    libvlc_media_player_stop_async(mp);
+    libvlc_media_player_release(mp);
+
+    vlc_mutex_lock(&bench.lock);
+    bench.sample = -1;
+    vlc_mutex_unlock(&bench.lock);
+}
+
+static int tick_cmp(const void *a, const void *b)
+{
+    const vlc_tick_t *ta = a, *tb = b;
+    return (*ta > *tb) - (*ta < *tb);
+}
+
+static void PrintPhase(const char *name, struct phase_result *res)
+{
+    if (res->count == 0)
+    {
+        printf("  %-22s %10s\n", name, "n/a");
+        return;
+    }
+
+    qsort(res->durations, res->count, sizeof (res->durations[0]), tick_cmp);
+    printf("  %-22s %10.3f %10.3f %10.3f\n", name,
+           secf_from_vlc_tick(res->durations[0]) * 1000.f,
+           secf_from_vlc_tick(res->durations[res->count / 2]) * 1000.f,
+           secf_from_vlc_tick(res->durations[res->count - 1]) * 1000.f);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned runs = 5;
+    int first = 1;
+
+    test_setup();
+
+    if (argc > 2 && strcmp(argv[1], "-n") == 0)
+    {
+        runs = atoi(argv[2]);
+        first = 3;
+    }
+    if (runs == 0 || runs > MAX_RUNS)
+        runs = 5;
+
+    char *mrls[MAX_SAMPLES];
+    int count = 0;
+
+    for (int i = first; i < argc && count < MAX_SAMPLES; i++)
+        mrls[count++] = strstr(argv[i], "://") != NULL ? strdup(argv[i])
+                                                       : vlc_path2uri(argv[i],
+                                                                      NULL);
+    if (count == 0)
+    {
+        mrls[count++] = strdup("mock://video_track_count=1;"
+                               "audio_track_count=1;length=10000000");
+        mrls[count++] = vlc_path2uri(SRCDIR "/samples/image.jpg", NULL);
+    }
+    for (int i = 0; i < count; i++)
+        assert(mrls[i] != NULL);
+
+    static const char *args[] = {
+        "--tracer=startup_bench", "--startup-trace",
+        "--vout=vdummy", "--aout=adummy", "--text-renderer=tdummy",
+        "--no-video-title-show", "--ignore-config", "-q",
+    };
+
+    for (bench.run = 0; bench.run < runs; bench.run++)
+    {
+        vlc_mutex_lock(&bench.lock);
+        bench.sample = -1;
+        vlc_mutex_unlock(&bench.lock);
+
+        vlc_tick_t start = vlc_tick_now();
+        libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+        if (vlc == NULL)
+        {
+            fprintf(stderr, "cannot create LibVLC instance\n");
+            return 1;
+        }
+        Record(&bench.libvlc[LIBVLC_PHASES - 1], vlc_tick_now() - start);
+
+        for (int i = 0; i < count; i++)
+            PlaySample(vlc, mrls[i], i);
+
+        libvlc_release(vlc);
+    }
+
+    printf("%u runs, durations in ms: %10s %10s %10s\n", runs, "min",
+           "median", "max");
+    printf("libvlc:\n");
+    for (size_t i = 0; i < LIBVLC_PHASES; i++)
+        PrintPhase(libvlc_phases[i], &bench.libvlc[i]);
+
+    for (int i = 0; i < count; i++)
+    {
+        printf("%s:\n", mrls[i]);
+        for (size_t j = 0; j < INPUT_PHASES; j++)
+            PrintPhase(input_phases[j], &bench.input[i][j]);
+        free(mrls[i]);
+    }
+    return 0;
+}
@@ -335,6 +335,23 @@ static int test_annexb( const char *psz_tag )
     for(size_t i=0; i<ARRAY_SIZE(seinalunesc); i++)
         test_assert(bs_read(&bs, 8), seinalunesc[i]);
 
+    /* same through multiple bytes forwarding */
+    for(size_t i=0; i<ARRAY_SIZE(seinalunesc); i++)
+    {
+        bs_init( &bs, seinal, ARRAY_SIZE(seinal) );
+        hxxx_bsfw_ep3b_ctx_init( &bsctx );
+        bs.cb = hxxx_bsfw_ep3b_callbacks;
+        bs.p_priv = &bsctx;
+        bs_skip( &bs, i * 8 );
+        test_assert(bs_pos( &bs ), i * 8);
+        test_assert(bs_read(&bs, 8), seinalunesc[i]);
+        if( i + 1 < ARRAY_SIZE(seinalunesc) )
+        {
+            bs_skip( &bs, 8 * (ARRAY_SIZE(seinalunesc) - i - 2) );
+            test_assert(bs_read(&bs, 8), seinalunesc[ARRAY_SIZE(seinalunesc) - 1]);
+        }
+    }
+
     return 0;
 }
 
@@ -0,0 +1,165 @@
+/*****************************************************************************
+ * cache.c: plugins cache test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+static int strcmp_cb(const void *a, const void *b)
+{
+    char *const *sa = a, *const *sb = b;
+    return strcmp(*sa, *sb);
+}
+
+/**
+ * Describes the module bank of an instance as a sorted list of lines, and
+ * checks that capability lookups are consistent with the module list.
+ */
+static char **DumpBank(const char *const *args, int argc, size_t *countp)
+{
+    libvlc_instance_t *vlc = libvlc_new(argc, args);
+    assert(vlc != NULL);
+
+    size_t count;
+    module_t **list = module_list_get(&count);
+    assert(count > 0 && list != NULL);
+
+    char **lines = malloc(count * sizeof (*lines));
+    assert(lines != NULL);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const module_t *m = list[i];
+        const char *cap = module_get_capability(m);
+        int score = module_get_score(m);
+
+        int ret = asprintf(&lines[i], "%s %d %s", cap, score,
+                           module_get_object(m));
+        assert(ret >= 0);
+
+        /* Count the modules of that capability with a positive score */
+        size_t expected = 0;
+        for (size_t j = 0; j < count; j++)
+            if (strcmp(module_get_capability(list[j]), cap) == 0
+             && module_get_score(list[j]) > 0)
+                expected++;
+
+        module_t **matches;
+        ssize_t n = vlc_module_match(cap, NULL, false, &matches, NULL);
+        assert(n >= 0 && (size_t)n == expected);
+
+        bool found = score <= 0;
+        for (ssize_t j = 0; j < n; j++)
+        {
+            assert(strcmp(module_get_capability(matches[j]), cap) == 0);
+            if (j > 0)
+                assert(module_get_score(matches[j - 1])
+                       >= module_get_score(matches[j]));
+            if (matches[j] == m)
+                found = true;
+        }
+        assert(found);
+        free(matches);
+    }
+
+    /* Unknown capabilities have no modules */
+    module_t **matches;
+    assert(vlc_module_match("no such capability", NULL, false, &matches,
+                            NULL) == 0);
+    free(matches);
+
+    module_list_free(list);
+    libvlc_release(vlc);
+
+    qsort(lines, count, sizeof (*lines), strcmp_cb);
+    *countp = count;
+    return lines;
+}
+
+static void FreeBank(char **lines, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        free(lines[i]);
+    free(lines);
+}
+
+static void CheckBank(char **ref, size_t ref_count, const char *const *args,
+                      int argc)
+{
+    size_t count;
+    char **lines = DumpBank(args, argc, &count);
+
+    assert(count == ref_count);
+    for (size_t i = 0; i < count; i++)
+        assert(strcmp(lines[i], ref[i]) == 0);
+    FreeBank(lines, count);
+}
+
+int main(void)
+{
+    test_init();
+
+    /* Write the cache in a scratch directory rather than the build tree */
+    char dir[] = "/tmp/vlc-cache-test-XXXXXX";
+    char link[sizeof (dir) + sizeof ("/modules")];
+    char cache[sizeof (dir) + sizeof ("/plugins.dat")];
+
+    assert(mkdtemp(dir) != NULL);
+    snprintf(link, sizeof (link), "%s/modules", dir);
+    snprintf(cache, sizeof (cache), "%s/plugins.dat", dir);
+    assert(symlink(TOP_BUILDDIR"/modules", link) == 0);
+    setenv("VLC_PLUGIN_PATH", dir, 1);
+
+    /* Reference: scan the plugins and write the cache */
+    static const char *const reset[] = { "--reset-plugins-cache" };
+    size_t count;
+    char **ref = DumpBank(reset, ARRAY_SIZE(reset), &count);
+
+    struct stat st;
+    assert(stat(cache, &st) == 0 && st.st_size > 0);
+
+    /* Cache only: the capability index is used as is */
+    static const char *const cached[] = { "--no-plugins-scan" };
+    CheckBank(ref, count, cached, ARRAY_SIZE(cached));
+
+    /* Cache and scan: cached entries are matched against the files */
+    CheckBank(ref, count, NULL, 0);
+
+    /* No cache: the capabilities are sorted at load time */
+    static const char *const nocache[] = { "--no-plugins-cache" };
+    CheckBank(ref, count, nocache, ARRAY_SIZE(nocache));
+
+    FreeBank(ref, count);
+    unlink(cache);
+    unlink(link);
+    rmdir(dir);
+    return 0;
+}
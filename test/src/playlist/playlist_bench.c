@@ -0,0 +1,221 @@
+/*****************************************************************************
+ * playlist_bench.c: large playlist benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Usage: bench_src_playlist [-n items]
+ *
+ * Fills a playlist (1 million items by default), then measures the sort, the
+ * lookups, the random order navigation and the removals.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_input_item.h>
+#include <vlc_playlist.h>
+#include <vlc_tick.h>
+
+#include <vlc/vlc.h>
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#define DEFAULT_ITEMS 1000000
+#define LOOKUPS       100000
+#define MOVES         1000
+#define REMOVALS      10000
+
+static uint32_t seed = 0x56434C00;
+
+static size_t Random(size_t max)
+{
+    seed = seed * 1103515245 + 12345;
+    return ((size_t) seed << 15 ^ seed >> 16) % max;
+}
+
+static void Report(const char *name, vlc_tick_t start, unsigned count)
+{
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+    printf("%-24s %10.1f ms %10.3f us/op\n", name,
+           secf_from_vlc_tick(elapsed) * 1000.,
+           secf_from_vlc_tick(elapsed) * 1000000. / count);
+}
+
+static void Fill(vlc_playlist_t *playlist, size_t count)
+{
+    input_item_t **media = vlc_alloc(count, sizeof(*media));
+    assert(media != NULL);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "item-%zu", i);
+        media[i] = input_item_New("vlc://nop", name);
+        assert(media[i] != NULL);
+    }
+
+    vlc_tick_t start = vlc_tick_now();
+    int ret = vlc_playlist_Append(playlist, media, count);
+    assert(ret == VLC_SUCCESS);
+    Report("append", start, count);
+
+    for (size_t i = 0; i < count; i++)
+        input_item_Release(media[i]);
+    free(media);
+}
+
+static void Sort(vlc_playlist_t *playlist)
+{
+    static const struct vlc_playlist_sort_criterion criteria[] = {
+        { VLC_PLAYLIST_SORT_KEY_TITLE, VLC_PLAYLIST_SORT_ORDER_DESCENDING },
+        { VLC_PLAYLIST_SORT_KEY_DURATION, VLC_PLAYLIST_SORT_ORDER_ASCENDING },
+    };
+
+    size_t count = vlc_playlist_Count(playlist);
+    vlc_tick_t start = vlc_tick_now();
+    int ret = vlc_playlist_Sort(playlist, criteria, ARRAY_SIZE(criteria));
+    assert(ret == VLC_SUCCESS);
+    (void) ret;
+    Report("sort", start, count);
+}
+
+static void Lookups(vlc_playlist_t *playlist)
+{
+    size_t count = vlc_playlist_Count(playlist);
+    vlc_playlist_item_t **items = vlc_alloc(LOOKUPS, sizeof(*items));
+    assert(items != NULL);
+    for (unsigned i = 0; i < LOOKUPS; i++)
+        items[i] = vlc_playlist_Get(playlist, Random(count));
+
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < LOOKUPS; i++)
+    {
+        ssize_t index = vlc_playlist_IndexOf(playlist, items[i]);
+        assert(index >= 0);
+        (void) index;
+    }
+    Report("IndexOf", start, LOOKUPS);
+
+    start = vlc_tick_now();
+    for (unsigned i = 0; i < LOOKUPS; i++)
+    {
+        input_item_t *media = vlc_playlist_item_GetMedia(items[i]);
+        ssize_t index = vlc_playlist_IndexOfMedia(playlist, media);
+        assert(index >= 0);
+        (void) index;
+    }
+    Report("IndexOfMedia", start, LOOKUPS);
+
+    start = vlc_tick_now();
+    for (unsigned i = 0; i < LOOKUPS; i++)
+    {
+        uint64_t id = vlc_playlist_item_GetId(items[i]);
+        ssize_t index = vlc_playlist_IndexOfId(playlist, id);
+        assert(index >= 0);
+        (void) index;
+    }
+    Report("IndexOfId", start, LOOKUPS);
+
+    free(items);
+}
+
+static void RandomMoves(vlc_playlist_t *playlist)
+{
+    vlc_playlist_SetPlaybackOrder(playlist, VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM);
+
+    size_t count = vlc_playlist_Count(playlist);
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < MOVES; i++)
+    {
+        int ret = vlc_playlist_GoTo(playlist, Random(count));
+        assert(ret == VLC_SUCCESS);
+        ret = vlc_playlist_Next(playlist);
+        assert(ret == VLC_SUCCESS);
+        (void) ret;
+    }
+    Report("random GoTo+Next", start, MOVES);
+}
+
+static void Removals(vlc_playlist_t *playlist)
+{
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < REMOVALS; i++)
+    {
+        size_t count = vlc_playlist_Count(playlist);
+        vlc_playlist_item_t *item = vlc_playlist_Get(playlist, Random(count));
+        vlc_playlist_item_Hold(item);
+        int ret = vlc_playlist_RequestRemove(playlist, &item, 1, -1);
+        assert(ret == VLC_SUCCESS);
+        (void) ret;
+        vlc_playlist_item_Release(item);
+    }
+    Report("remove", start, REMOVALS);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = DEFAULT_ITEMS;
+
+    test_setup();
+
+    if (argc > 2 && strcmp(argv[1], "-n") == 0)
+        count = strtoul(argv[2], NULL, 10);
+    if (count < REMOVALS * 2)
+        count = REMOVALS * 2;
+
+    static const char *args[] = {
+        "--vout=vdummy", "--aout=adummy", "--text-renderer=tdummy",
+        "--ignore-config", "-q",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    if (vlc == NULL)
+    {
+        fprintf(stderr, "cannot create LibVLC instance\n");
+        return 1;
+    }
+
+    vlc_playlist_t *playlist =
+        vlc_playlist_New(VLC_OBJECT(vlc->p_libvlc_int),
+                         VLC_PLAYLIST_PREPARSING_DISABLED, 0, 0);
+    assert(playlist != NULL);
+
+    printf("%zu items\n", count);
+
+    vlc_playlist_Lock(playlist);
+    Fill(playlist, count);
+    Sort(playlist);
+    Lookups(playlist);
+    RandomMoves(playlist);
+    Removals(playlist);
+
+    vlc_tick_t start = vlc_tick_now();
+    vlc_playlist_Clear(playlist);
+    Report("clear", start, count);
+    vlc_playlist_Unlock(playlist);
+
+    vlc_playlist_Delete(playlist);
+    libvlc_release(vlc);
+    return 0;
+}
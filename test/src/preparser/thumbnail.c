@@ -38,26 +38,32 @@ const struct
     vlc_tick_t i_time;
     float f_pos;
     bool b_use_pos;
-    bool b_fast_seek;
+    int i_speed;
     bool b_can_control_pace;
     vlc_tick_t i_timeout;
     bool b_expected_success;
 } test_params[] = {
     /* Simple test with a thumbnail at 60s, with a video track */
-    { 1, 0, VLC_TICK_INVALID, VLC_TICK_FROM_SEC( 60 ), .0f, false, true, true,
-      VLC_TICK_INVALID, true },
+    { 1, 0, VLC_TICK_INVALID, VLC_TICK_FROM_SEC( 60 ), .0f, false,
+      VLC_THUMBNAILER_SEEK_FAST, true, VLC_TICK_INVALID, true },
     /* Test without fast-seek */
-    { 1, 0, VLC_TICK_INVALID, VLC_TICK_FROM_SEC( 60 ), .0f, false, false, true,
-      VLC_TICK_INVALID, true },
+    { 1, 0, VLC_TICK_INVALID, VLC_TICK_FROM_SEC( 60 ), .0f, false,
+      VLC_THUMBNAILER_SEEK_PRECISE, true, VLC_TICK_INVALID, true },
+    /* Test with the keyframe only seek */
+    { 1, 0, VLC_TICK_INVALID, VLC_TICK_FROM_SEC( 60 ), .0f, false,
+      VLC_THUMBNAILER_SEEK_KEYFRAME, true, VLC_TICK_INVALID, true },
     /* Seek by position test */
-    { 1, 0, VLC_TICK_INVALID, 0, .3f, true, true, true, VLC_TICK_INVALID, true },
+    { 1, 0, VLC_TICK_INVALID, 0, .3f, true, VLC_THUMBNAILER_SEEK_FAST, true,
+      VLC_TICK_INVALID, true },
     /* Seek at a negative position */
-    { 1, 0, VLC_TICK_INVALID, -12345, .0f, false, true, true, VLC_TICK_INVALID, true },
+    { 1, 0, VLC_TICK_INVALID, -12345, .0f, false, VLC_THUMBNAILER_SEEK_FAST,
+      true, VLC_TICK_INVALID, true },
     /* Take a thumbnail of a file without video, which should timeout. */
-    { 0, 1, VLC_TICK_INVALID, VLC_TICK_FROM_SEC( 60 ), .0f, false, true, false, VLC_TICK_FROM_MS( 100 ), false },
+    { 0, 1, VLC_TICK_INVALID, VLC_TICK_FROM_SEC( 60 ), .0f, false,
+      VLC_THUMBNAILER_SEEK_FAST, false, VLC_TICK_FROM_MS( 100 ), false },
     /* Take a thumbnail of a file with a video track starting later */
-    { 1, 1, VLC_TICK_FROM_SEC( 60 ), VLC_TICK_FROM_SEC( 30 ), .0f, false, true, true,
-      VLC_TICK_INVALID, true },
+    { 1, 1, VLC_TICK_FROM_SEC( 60 ), VLC_TICK_FROM_SEC( 30 ), .0f, false,
+      VLC_THUMBNAILER_SEEK_FAST, true, VLC_TICK_INVALID, true },
 };
 
 struct test_ctx
@@ -157,15 +163,13 @@ static void test_thumbnails( libvlc_instance_t* p_vlc, bool external )
         {
             thumb_arg.seek.type = VLC_THUMBNAILER_SEEK_POS;
             thumb_arg.seek.pos = test_params[i].f_pos;
-            thumb_arg.seek.speed = test_params[i].b_fast_seek ?
-                VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE;
+            thumb_arg.seek.speed = test_params[i].i_speed;
         }
         else
         {
             thumb_arg.seek.type = VLC_THUMBNAILER_SEEK_TIME;
             thumb_arg.seek.time = test_params[i].i_time;
-            thumb_arg.seek.speed = test_params[i].b_fast_seek ?
-                VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE;
+            thumb_arg.seek.speed = test_params[i].i_speed;
         }
         thumb_arg.hw_dec = false;
         static const struct vlc_thumbnailer_cbs cbs = {